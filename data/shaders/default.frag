@@ -32,7 +32,9 @@ float getRangeAttenuation(float range, float distance) {
     return max(min(1.0 - pow(distance / range, 4.0), 1.0), 0.0) / pow(distance, 2.0);
 }
 
-vec3 normalTextureNormal = normalize(texture(normalTexture, inUV0).xyz * 2.0 - 1.0);
+// z is rebuilt from x and y, BC5 normal maps only store those
+vec2 normalTextureXY = texture(normalTexture, inUV0).xy * 2.0 - 1.0;
+vec3 normalTextureNormal = vec3(normalTextureXY, sqrt(max(1.0 - dot(normalTextureXY, normalTextureXY), 0.0)));
 vec3 T = normalize(inTangent);
 vec3 B = -normalize(cross(inNormal, T));
 mat3 TBN = mat3(T, B, inNormal);
@@ -0,0 +1,44 @@
+#version 410 core
+
+layout (location = 0) in vec3 inPos;
+layout (location = 1) in vec3 inNormal;
+layout (location = 2) in vec3 inTangent;
+layout (location = 3) in vec2 inUV0;
+layout (location = 4) in vec2 inUV1;
+layout (location = 5) in uvec4 inJoints;
+layout (location = 6) in vec4 inWeights;
+
+layout (location = 0) out vec3 outPosition;
+layout (location = 1) out vec3 outNormal;
+layout (location = 2) out vec3 outTangent;
+layout (location = 3) out vec2 outUV0;
+layout (location = 4) out vec2 outUV1;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// Rows of the joint matrices, taking the bind pose to world space
+uniform vec4 jointRows[3 * 64];
+
+void main()
+{
+    vec4 rows[3] = vec4[3](vec4(0.0), vec4(0.0), vec4(0.0));
+    for (int influence = 0; influence < 4; influence++)
+    {
+        int joint = int(inJoints[influence]) * 3;
+        rows[0] += inWeights[influence] * jointRows[joint];
+        rows[1] += inWeights[influence] * jointRows[joint + 1];
+        rows[2] += inWeights[influence] * jointRows[joint + 2];
+    }
+
+    mat4x3 skin = transpose(mat3x4(rows[0], rows[1], rows[2]));
+    mat3 normalMatrix = mat3(transpose(inverse(mat3(skin))));
+
+    outPosition = skin * vec4(inPos, 1.0);
+    outNormal = normalize(normalMatrix * inNormal);
+    outTangent = mat3(skin) * inTangent;
+    outUV0 = inUV0;
+    outUV1 = inUV1;
+
+    gl_Position = projection * view * vec4(outPosition, 1.0);
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+
+#include <span>
+#include <vector>
+
+namespace DadEngine
+{
+    class SceneGraph;
+    class ThreadPool;
+
+    enum class AnimationPath : uint8_t
+    {
+        Translation,
+        Rotation,
+        Scale,
+        Weights // Morph target weights, written to the instance rather than the graph
+    };
+
+    enum class AnimationInterpolation : uint8_t
+    {
+        Linear,
+        Step,
+        CubicSpline
+    };
+
+    struct AnimationChannel
+    {
+        uint32_t sampler   = 0U;
+        uint32_t node      = 0U; // In the graph the clip was loaded into
+        AnimationPath path = AnimationPath::Translation;
+
+        // First of the channel weights in the instance ones
+        uint32_t weightsOffset = 0U;
+    };
+
+    // Keyframes shared by every instance playing the clip. Channels are kept
+    // grouped by the kernel sampling them so each group is evaluated four
+    // channels at a time, one per SIMD lane
+    class AnimationClip
+    {
+        public:
+        // _values holds _componentCount floats per key, three times as many
+        // for cubic splines: the in tangent, the value and the out tangent.
+        // Times must be increasing. Returns the sampler index, ~0U when the
+        // sizes do not match
+        uint32_t AddSampler(std::span<const float> _times,
+                            std::span<const float> _values,
+                            uint32_t _componentCount,
+                            AnimationInterpolation _interpolation);
+
+        // Fails when the sampler components do not fit the path
+        bool AddChannel(uint32_t _sampler, uint32_t _node, AnimationPath _path);
+
+        uint32_t GetChannelCount() const
+        {
+            return static_cast<uint32_t>(m_channels.size());
+        }
+
+        const AnimationChannel &GetChannel(uint32_t _channel) const
+        {
+            return m_channels[_channel];
+        }
+
+        // Sum of the weights channel components
+        uint32_t GetWeightCount() const
+        {
+            return m_weightCount;
+        }
+
+        // Time of the last key
+        float GetDuration() const
+        {
+            return m_duration;
+        }
+
+        // Writes every channel at _time in the local transforms of the graph
+        // nodes, offset by _nodeOffset, and marks them dirty. _cursors holds
+        // the last key found for each channel, searched from on the next
+        // call, and the weights GetWeightCount floats
+        void Sample(float _time,
+                    uint32_t _nodeOffset,
+                    uint32_t *_cursors,
+                    float *_weights,
+                    SceneGraph &_graph) const;
+
+        private:
+        enum class Kernel : uint8_t
+        {
+            LinearVector, // Step keys are sampled as linear ones at the start of the interval
+            LinearRotation,
+            CubicVector,
+            CubicRotation,
+            Weights
+        };
+
+        static constexpr uint32_t KERNEL_COUNT = 5U;
+
+        struct SamplerData
+        {
+            uint32_t timesOffset    = 0U;
+            uint32_t keyCount       = 0U;
+            uint32_t valuesOffset   = 0U;
+            uint32_t valueStride    = 0U; // Floats between two values, padded to four but for weights
+            uint32_t componentCount = 0U;
+
+            AnimationInterpolation interpolation = AnimationInterpolation::Linear;
+        };
+
+        static Kernel getKernel(const SamplerData &_sampler, AnimationPath _path);
+
+        std::vector<float> m_times;
+        std::vector<float> m_values;
+        std::vector<SamplerData> m_samplers;
+
+        std::vector<AnimationChannel> m_channels;
+        uint32_t m_kernelEnds[KERNEL_COUNT] = {}; // End of the channels of each kernel
+
+        uint32_t m_weightCount = 0U;
+        float m_duration       = 0.f;
+    };
+
+    // Playback state of a clip on a copy of the nodes it targets, the nodes
+    // of the instance being the clip ones moved by the node offset
+    class AnimationInstance
+    {
+        public:
+        AnimationInstance(const AnimationClip &_clip, uint32_t _nodeOffset = 0U);
+
+        float GetTime() const
+        {
+            return m_time;
+        }
+
+        void SetTime(float _time)
+        {
+            m_time = _time;
+        }
+
+        void SetLooping(bool _looping)
+        {
+            m_looping = _looping;
+        }
+
+        // Wraps around the clip duration when looping, clamps to it otherwise
+        void Advance(float _deltaTime);
+
+        void Evaluate(SceneGraph &_graph);
+
+        std::span<const float> GetWeights() const
+        {
+            return m_weights;
+        }
+
+        private:
+        const AnimationClip *m_clip;
+        uint32_t m_nodeOffset;
+        float m_time   = 0.f;
+        bool m_looping = true;
+
+        std::vector<uint32_t> m_cursors;
+        std::vector<float> m_weights;
+    };
+
+    // Evaluates the instances, in parallel with a pool. Instances must not
+    // share target nodes
+    void EvaluateAnimations(std::span<AnimationInstance> _instances,
+                            SceneGraph &_graph,
+                            ThreadPool *_threadPool = nullptr);
+} // namespace DadEngine
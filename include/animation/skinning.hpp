@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+
+#include <span>
+#include <vector>
+
+#include "math/matrix/matrix3x4.hpp"
+#include "model/model.hpp"
+
+namespace DadEngine
+{
+    class SceneGraph;
+    class ThreadPool;
+
+    // Joints held by the uniforms of the GPU path, skinned.vert declares as
+    // many
+    constexpr uint32_t MAX_GPU_JOINTS = 64U;
+
+    struct Skin
+    {
+        std::vector<uint32_t> joints; // In the graph the skin was loaded into
+        std::vector<Matrix3x4> inverseBindMatrices;
+    };
+
+    // Matrices taking the bind pose vertices to world space, so skinned
+    // meshes are drawn without their node transform. The joints are moved
+    // by _nodeOffset, as the nodes of an AnimationInstance are
+    void ComputeJointMatrices(const Skin &_skin,
+                              const SceneGraph &_graph,
+                              uint32_t _nodeOffset,
+                              std::vector<Matrix3x4> &_jointMatrices);
+
+    // Box holding a primitive once skinned, its bind pose bounds moved by
+    // every joint. Conservative for linear blending, which keeps each vertex
+    // inside the hull of its joint transforms, close for dual quaternions
+    AABB ComputeSkinnedBounds(const AABB &_bindBounds, std::span<const Matrix3x4> _jointMatrices);
+
+    enum class SkinningMethod : uint8_t
+    {
+        LinearBlend,
+        DualQuaternion // Keeps the volume around twisting joints, their scale is dropped
+    };
+
+    // Joint matrices converted once per pose to what the kernel of the
+    // method reads
+    class SkinningPalette
+    {
+        public:
+        void Set(std::span<const Matrix3x4> _jointMatrices, SkinningMethod _method);
+
+        SkinningMethod GetMethod() const
+        {
+            return m_method;
+        }
+
+        uint32_t GetJointCount() const
+        {
+            return m_jointCount;
+        }
+
+        const float *GetData() const
+        {
+            return m_data.data();
+        }
+
+        private:
+        SkinningMethod m_method = SkinningMethod::LinearBlend;
+        uint32_t m_jointCount   = 0U;
+
+        // Per joint, the four matrix columns padded to four floats for
+        // linear blending, the real then the dual quaternion otherwise
+        std::vector<float> m_data;
+    };
+
+    // Skins the positions, normals and tangents of the vertices in
+    // [_begin, _end) with the joints and weights of the same index in
+    // _skin, the other attributes of _output are left untouched. Every
+    // joint of the vertices must be in the palette
+    void SkinVertices(const Vertex *_bindPose,
+                      const SkinVertex *_skin,
+                      Vertex *_output,
+                      uint32_t _begin,
+                      uint32_t _end,
+                      const SkinningPalette &_palette);
+
+    // Copy of a mesh posed on the CPU, its primitives draw dynamic vertex
+    // buffers rewritten by Update. The bind pose is copied from the mesh,
+    // which must still have its CPU data
+    class CPUSkinnedMesh
+    {
+        public:
+        CPUSkinnedMesh(const Mesh &_bindPose);
+
+        // Skins every vertex, in ranges spread over the pool if any, then
+        // uploads them
+        void Update(const SkinningPalette &_palette, ThreadPool *_threadPool = nullptr);
+
+        uint32_t GetVertexCount() const
+        {
+            return m_vertexCount;
+        }
+
+        Mesh &GetMesh()
+        {
+            return m_mesh;
+        }
+
+        private:
+        std::vector<std::vector<Vertex>> m_bindPoses; // One per primitive
+        std::vector<std::vector<SkinVertex>> m_skins;
+        Mesh m_mesh;
+        uint32_t m_jointCount  = 0U; // Highest joint of the vertices plus one
+        uint32_t m_vertexCount = 0U;
+    };
+
+    // GPU alternative to the CPU kernels: the rows of the joint matrices are
+    // sent to a vec4 uniform array, three per joint, and blended by the
+    // vertex shader. Fails when there are more than MAX_GPU_JOINTS joints
+    bool UploadJointMatrices(int32_t _location, std::span<const Matrix3x4> _jointMatrices);
+} // namespace DadEngine
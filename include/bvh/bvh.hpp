@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "math/aabb.hpp"
+#include "math/vector/vector3.hpp"
+
+namespace DadEngine
+{
+    class Mesh;
+
+    struct BVHTriangle
+    {
+        Vector3 v0;
+        Vector3 v1;
+        Vector3 v2;
+
+        // Source of the triangle inside the mesh it was gathered from
+        uint32_t primitiveIndex;
+        uint32_t triangleIndex;
+    };
+
+    // 32 bytes node, inner nodes store their left child right after themselves
+    struct BVHNode
+    {
+        Vector3 boundsMin;
+        uint32_t rightOrFirst; // Right child index for inner nodes, first triangle for leaves
+        Vector3 boundsMax;
+        uint32_t count; // Triangle count, 0 for inner nodes
+
+        bool IsLeaf() const
+        {
+            return count != 0U;
+        }
+    };
+
+    // Child bounds are stored as SoA so a node can be tested against all its
+    // children at once
+    template <uint32_t Width>
+    struct WideBVHNode
+    {
+        static constexpr uint32_t INVALID_CHILD = ~0U;
+
+        float minX[Width];
+        float minY[Width];
+        float minZ[Width];
+        float maxX[Width];
+        float maxY[Width];
+        float maxZ[Width];
+
+        uint32_t child[Width]; // Node index for inner children, first triangle for leaves
+        uint32_t count[Width]; // Triangle count, 0 for inner children
+    };
+
+    struct Ray
+    {
+        Vector3 origin;
+        Vector3 direction;
+        float tMax = 1e30f;
+    };
+
+    struct RayHit
+    {
+        float t = 1e30f;
+        float u = 0.f;
+        float v = 0.f;
+        uint32_t triangle = ~0U; // Index inside the BVH triangle array
+    };
+
+    struct BVHBuildSettings
+    {
+        uint32_t binCount    = 16U;
+        uint32_t maxLeafSize = 4U;
+        // Subtrees above this depth are built on separate threads
+        uint32_t parallelDepth = 4U;
+        // Below this amount of triangles a subtree is always built sequentially
+        uint32_t parallelThreshold = 4096U;
+        // Past this depth, at most 64, ranges are split at their median so
+        // the tree depth stays within the traversal stacks
+        uint32_t maxDepth          = 64U;
+        float traversalCost        = 1.f;
+        float intersectionCost     = 1.f;
+    };
+
+    // Binned SAH bounding volume hierarchy over triangles
+    class BVH
+    {
+        public:
+        void Build(std::vector<BVHTriangle> &&_triangles, const BVHBuildSettings &_settings = {});
+
+        bool Intersect(const Ray &_ray, RayHit &_hit) const;
+
+        // Appends the triangles whose bounds overlap the box
+        void Overlap(const AABB &_box, std::vector<uint32_t> &_triangles) const;
+
+        const std::vector<BVHNode> &GetNodes() const
+        {
+            return m_nodes;
+        }
+
+        const std::vector<BVHTriangle> &GetTriangles() const
+        {
+            return m_triangles;
+        }
+
+        private:
+        std::vector<BVHNode> m_nodes;
+        std::vector<BVHTriangle> m_triangles;
+    };
+
+    // BVH2 collapsed into a 4 or 8 wide tree, leaves are shared with the source BVH
+    template <uint32_t Width>
+    class WideBVH
+    {
+        static_assert(Width == 4U || Width == 8U, "Only 4 and 8 wide BVHs are supported");
+
+        public:
+        void Build(const BVH &_bvh);
+
+        bool Intersect(const Ray &_ray, RayHit &_hit) const;
+
+        void Overlap(const AABB &_box, std::vector<uint32_t> &_triangles) const;
+
+        const std::vector<WideBVHNode<Width>> &GetNodes() const
+        {
+            return m_nodes;
+        }
+
+        private:
+        uint32_t collapse(const BVH &_bvh, uint32_t _nodeIndex);
+
+        std::vector<WideBVHNode<Width>> m_nodes;
+        const std::vector<BVHTriangle> *m_triangles = nullptr;
+    };
+
+    using BVH4 = WideBVH<4U>;
+    using BVH8 = WideBVH<8U>;
+
+    // Gathers every triangle of the mesh primitives drawn as triangle lists
+    std::vector<BVHTriangle> GatherTriangles(const Mesh &_mesh);
+} // namespace DadEngine
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <filesystem>
+
+#include "loaders/texture-compressor.hpp"
+
+namespace DadEngine
+{
+    // Runs the load time processing of a glTF scene once and writes the
+    // result as a scene pack LoadCookedScene maps directly. Triangle lists
+    // are optimized for the vertex cache and fetch, missing tangents are
+    // generated, bounds are computed and images are decoded with their mips,
+    // block compressed when the settings enable it
+    bool CookScene(const std::filesystem::path &_input, const std::filesystem::path &_output,
+                   const TextureCompressionSettings &_compression = {});
+} // namespace DadEngine
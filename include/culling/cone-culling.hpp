@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "math/vector/vector3.hpp"
+
+namespace DadEngine
+{
+    struct Primitive;
+
+    // A cluster is backfacing when dot(normalize(apex - eye), axis) >= cutoff
+    struct ClusterCone
+    {
+        Vector3 apex;
+        Vector3 axis;
+        float cutoff = 2.f; // Never culled
+    };
+
+    // Cones stored as SoA so the culling pass processes several at once
+    class ClusterConeSet
+    {
+        public:
+        void Add(const ClusterCone &_cone);
+
+        void Clear();
+
+        uint32_t GetCount() const
+        {
+            return static_cast<uint32_t>(m_cutoff.size());
+        }
+
+        // Writes the indices of the clusters that may be front facing from
+        // the eye, which must be in the same space as the cones. Returns the
+        // surviving cluster count
+        uint32_t Cull(const Vector3 &_eyePosition, std::vector<uint32_t> &_visibleClusters) const;
+
+        private:
+        std::vector<float> m_apexX;
+        std::vector<float> m_apexY;
+        std::vector<float> m_apexZ;
+        std::vector<float> m_axisX;
+        std::vector<float> m_axisY;
+        std::vector<float> m_axisZ;
+        std::vector<float> m_cutoff;
+    };
+
+    ClusterCone ComputeClusterCone(const Vector3 *_positions, const uint32_t *_indices, uint32_t _triangleCount);
+
+    // Splits the primitive triangle list in clusters of consecutive triangles
+    void BuildClusterCones(const Primitive &_primitive, uint32_t _trianglesPerCluster, ClusterConeSet &_cones);
+} // namespace DadEngine
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "math/aabb.hpp"
+#include "math/matrix/matrix4x4.hpp"
+#include "math/vector/vector3.hpp"
+
+namespace DadEngine
+{
+    class Mesh;
+    class ThreadPool;
+
+    // Triangles kept to rasterize as occluders, in the mesh space
+    struct OccluderMesh
+    {
+        std::vector<Vector3> positions;
+        std::vector<uint32_t> indices;
+    };
+
+    // Low resolution software depth buffer in the style of Masked Software
+    // Occlusion Culling (Hasselgren et al. 2016). Each 8x4 pixels tile stores
+    // a coverage mask and two conservative depths instead of per pixel depths.
+    // Depth grows with the distance, 0 at the near plane and 1 at the far one
+    class MaskedOcclusionCulling
+    {
+        public:
+        static constexpr uint32_t TILE_WIDTH  = 8U;
+        static constexpr uint32_t TILE_HEIGHT = 4U;
+
+        // The resolution is rounded up to a multiple of the tile size
+        MaskedOcclusionCulling(uint32_t _width, uint32_t _height);
+
+        void Clear();
+
+        // Matrix in the shader uniform convention, model * view * projection
+        void SetTransform(const Matrix4x4 &_modelViewProjection);
+
+        // Rows of tiles are rasterized in parallel when a pool is given
+        void RenderTriangles(const Vector3 *_positions,
+                             const uint32_t *_indices,
+                             uint32_t _triangleCount,
+                             ThreadPool *_pool = nullptr);
+
+        // Returns false when the box is entirely hidden or outside the screen
+        bool TestAABB(const AABB &_box) const;
+
+        uint32_t GetWidth() const
+        {
+            return m_width;
+        }
+
+        uint32_t GetHeight() const
+        {
+            return m_height;
+        }
+
+        private:
+        struct ScreenTriangle
+        {
+            float x[3];
+            float y[3];
+            float z[3];
+        };
+
+        void rasterizeTriangle(const ScreenTriangle &_triangle, uint32_t _firstTileRow, uint32_t _lastTileRow);
+
+        void updateTile(uint32_t _tileIndex, uint32_t _coverage, float _zMin, float _zMax);
+
+        uint32_t m_width        = 0;
+        uint32_t m_height       = 0;
+        uint32_t m_tilesPerRow  = 0;
+        uint32_t m_tileRowCount = 0;
+
+        Matrix4x4 m_transform;
+
+        // Tiles stored as SoA so occludee tests compare four tiles at once
+        std::vector<float> m_zMax0; // Reference layer, valid for the whole tile
+        std::vector<float> m_zMax1; // Working layer, valid for the masked pixels
+        std::vector<uint32_t> m_masks;
+    };
+
+    // Keeps the triangles of the mesh larger than a fraction of its bounds
+    // surface area, small detail geometry barely occludes anything
+    OccluderMesh BuildOccluderMesh(const Mesh &_mesh, float _minimumAreaRatio = 1e-5f);
+
+    void RenderOccluders(MaskedOcclusionCulling &_culling, const OccluderMesh &_occluders, ThreadPool *_pool = nullptr);
+
+    // Indices of the mesh primitives whose bounds pass the occlusion test
+    std::vector<uint32_t> CullPrimitives(const Mesh &_mesh, const MaskedOcclusionCulling &_culling);
+} // namespace DadEngine
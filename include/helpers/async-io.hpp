@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "byte-buffer.hpp"
+
+namespace DadEngine
+{
+    // Reads whole files in the background. On Linux the reads go through
+    // io_uring so a batch of files is in flight at once from a single
+    // submission, elsewhere or when io_uring is unavailable each read runs
+    // on the shared thread pool. The bytes follow the ReadFile convention,
+    // NUL terminated and empty on failure
+    class AsyncIO
+    {
+        public:
+        AsyncIO(uint32_t _queueDepth = 64U);
+
+        AsyncIO(const AsyncIO &) = delete;
+
+        AsyncIO &operator=(const AsyncIO &) = delete;
+
+        // Waits for the reads still in flight
+        ~AsyncIO();
+
+        std::future<ByteBuffer> Read(const std::filesystem::path &_filePath);
+
+        // Queues every read before submitting them together
+        std::vector<std::future<ByteBuffer>>
+        Read(const std::vector<std::filesystem::path> &_filePaths);
+
+        bool UsesIORing() const
+        {
+            return m_ring != nullptr;
+        }
+
+        // Process wide service shared by the loaders
+        static AsyncIO &Get();
+
+        private:
+        struct Request;
+        struct Ring;
+
+        std::unique_ptr<Request> openRequest(const std::filesystem::path &_filePath);
+
+        // Moves the pending requests to the ring while it has room
+        void submitPending();
+
+        void completionLoop();
+
+        void completeRequest(Request *_request);
+
+        std::unique_ptr<Ring> m_ring;
+        std::thread m_completionThread;
+
+        std::mutex m_mutex;
+        std::deque<Request *> m_pending;
+        uint32_t m_inFlight = 0;
+        bool m_stopping     = false;
+    };
+} // namespace DadEngine
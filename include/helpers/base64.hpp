@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string_view>
+
+namespace DadEngine
+{
+    // Number of bytes the encoded text decodes to, trailing padding excluded
+    size_t GetBase64DecodedSize(std::string_view _encoded);
+
+    // Decodes standard base64 straight into _destination which must hold
+    // GetBase64DecodedSize bytes. Padding is optional, any other character
+    // outside the alphabet fails the decode
+    bool DecodeBase64(std::string_view _encoded, uint8_t *_destination);
+
+    // Splits a "data:<mime type>;base64,<payload>" URI, false for any other
+    // URI including non base64 data URIs
+    bool ParseBase64DataURI(std::string_view _uri, std::string_view &_mimeType, std::string_view &_payload);
+} // namespace DadEngine
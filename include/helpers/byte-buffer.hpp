@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace DadEngine
+{
+    // Default initializes the elements a resize adds instead of value
+    // initializing them, so buffers about to be overwritten by a read or a
+    // decode are not zeroed first
+    template <typename T>
+    class DefaultInitAllocator : public std::allocator<T>
+    {
+        public:
+        template <typename U>
+        struct rebind
+        {
+            using other = DefaultInitAllocator<U>;
+        };
+
+        using std::allocator<T>::allocator;
+
+        template <typename U>
+        void construct(U *_pointer) noexcept(noexcept(::new (static_cast<void *>(_pointer)) U))
+        {
+            ::new (static_cast<void *>(_pointer)) U;
+        }
+
+        template <typename U, typename... Args>
+        void construct(U *_pointer, Args &&..._args)
+        {
+            std::allocator_traits<std::allocator<T>>::construct(static_cast<std::allocator<T> &>(*this), _pointer,
+                                                                std::forward<Args>(_args)...);
+        }
+    };
+
+    // Bytes read from files, the derived data cache or decoders
+    using ByteBuffer = std::vector<uint8_t, DefaultInitAllocator<uint8_t>>;
+} // namespace DadEngine
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+
+#include <atomic>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "byte-buffer.hpp"
+
+namespace DadEngine
+{
+    // On disk cache of the data the loaders derive from source assets, such
+    // as decoded images or processed geometry. Keys hash the source bytes
+    // together with the processing settings, so editing either one misses.
+    // Each entry stores the hash of its payload, a truncated or corrupted
+    // entry is a miss too. Safe to use from several threads
+    class DerivedDataCache
+    {
+        public:
+        // An empty directory leaves the cache disabled
+        DerivedDataCache(const std::filesystem::path &_directory);
+
+        DerivedDataCache(const DerivedDataCache &) = delete;
+
+        DerivedDataCache &operator=(const DerivedDataCache &) = delete;
+
+        // Payload of the entry, empty on a miss
+        ByteBuffer Load(uint64_t _key);
+
+        // Written to a temporary file then renamed, concurrent stores of the
+        // same key leave one complete entry
+        void Store(uint64_t _key, std::span<const uint8_t> _data);
+
+        bool IsEnabled() const
+        {
+            return m_enabled;
+        }
+
+        void SetEnabled(bool _enabled)
+        {
+            m_enabled = _enabled;
+        }
+
+        uint64_t GetHitCount() const
+        {
+            return m_hits;
+        }
+
+        uint64_t GetMissCount() const
+        {
+            return m_misses;
+        }
+
+        void ResetCounters()
+        {
+            m_hits   = 0;
+            m_misses = 0;
+        }
+
+        // DADENGINE_CACHE_DIR when set, otherwise %LOCALAPPDATA%/dadengine on
+        // Windows and $XDG_CACHE_HOME/dadengine or ~/.cache/dadengine elsewhere
+        static std::filesystem::path GetDefaultDirectory();
+
+        // Process wide cache in the default directory, disabled when
+        // DADENGINE_NO_CACHE is set
+        static DerivedDataCache &Get();
+
+        private:
+        std::filesystem::path getEntryPath(uint64_t _key) const;
+
+        std::filesystem::path m_directory;
+        std::atomic<bool> m_enabled    = false;
+        std::atomic<uint64_t> m_hits   = 0;
+        std::atomic<uint64_t> m_misses = 0;
+    };
+} // namespace DadEngine
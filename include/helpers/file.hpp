@@ -1,11 +1,67 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 #include <filesystem>
+#include <span>
 #include <vector>
 
+#include "byte-buffer.hpp"
+
 namespace DadEngine
 {
-    std::vector<uint8_t> ReadFile(std::filesystem::path _fullpath);
+    // How the mapped pages are going to be read, forwarded to the OS
+    enum class FileAccess : uint8_t
+    {
+        Sequential, // Read ahead aggressively and prefetch the whole file
+        Random
+    };
+
+    // Read only memory mapping of a whole file, pages are loaded on demand
+    // instead of copied into a buffer. The data stays valid as long as the
+    // MappedFile lives
+    class MappedFile
+    {
+        public:
+        MappedFile() = default;
+
+        MappedFile(const std::filesystem::path &_filePath, FileAccess _access = FileAccess::Sequential);
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        MappedFile(MappedFile &&_other) noexcept;
+
+        MappedFile &operator=(MappedFile &&_other) noexcept;
+
+        ~MappedFile();
+
+        // False when the file could not be opened or is empty
+        bool IsValid() const
+        {
+            return m_data != nullptr;
+        }
+
+        std::span<const uint8_t> GetData() const
+        {
+            return { m_data, m_size };
+        }
+
+        private:
+        void release();
+
+        const uint8_t *m_data = nullptr;
+        size_t m_size         = 0;
+
+#if defined(WINDOWS)
+        void *m_mapping = nullptr;
+#endif
+    };
+
+    // Owned copy of the file followed by a NUL terminator, the file size is
+    // the returned size minus one. Allocated once at the exact size and not
+    // zeroed beforehand. Empty when the file cannot be read entirely
+    ByteBuffer ReadFile(const std::filesystem::path &_filePath);
 }
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <initializer_list>
+#include <span>
+
+namespace DadEngine
+{
+    // 64 bits XXH3 with the default secret and a zero seed, the values
+    // match the reference implementation so keys stay stable across builds
+    // and instruction sets
+    uint64_t HashXXH3(const void *_data, size_t _size);
+
+    inline uint64_t HashXXH3(std::span<const uint8_t> _data)
+    {
+        return HashXXH3(_data.data(), _data.size());
+    }
+
+    // Order dependent combination of hashes, for keys made of several parts
+    inline uint64_t CombineHashes(std::initializer_list<uint64_t> _hashes)
+    {
+        return HashXXH3(_hashes.begin(), _hashes.size() * sizeof(uint64_t));
+    }
+} // namespace DadEngine
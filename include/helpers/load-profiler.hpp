@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+namespace DadEngine
+{
+    // Steps of the scene loaders, some of them run on several threads at once
+    enum class LoadStage : uint8_t
+    {
+        JSONParse,          // glTF document or GLB container
+        BufferRead,         // Buffers mapped, decoded from base64 and hashed, cached or packed geometry
+        AttributeCopy,      // Vertex attributes into the interleaved vertices
+        IndexConversion,    // 8 and 16 bits indices widened to 32 bits
+        MeshProcessing,     // Tangents and vertex cache optimization
+        ImageDecode,        // stb_image, mip chains, KTX2 and DDS parsing
+        TextureCompression, // BC encoding of the mip chains
+        MaterialBuild,      // Materials and their texture uploads
+        Count
+    };
+
+    // camelCase name, e.g. for JSON reports
+    const char *GetLoadStageName(LoadStage _stage);
+
+    // Time spent in each loader stage, summed over the threads running it
+    // so parallel stages may add up to more than the load itself. Disabled
+    // by default, the loaders then skip reading the clock. Safe to use from
+    // several threads
+    class LoadProfiler
+    {
+        public:
+        LoadProfiler() = default;
+
+        LoadProfiler(const LoadProfiler &) = delete;
+
+        LoadProfiler &operator=(const LoadProfiler &) = delete;
+
+        void Add(LoadStage _stage, std::chrono::nanoseconds _time)
+        {
+            auto stage = static_cast<size_t>(_stage);
+            m_times[stage].fetch_add(static_cast<uint64_t>(_time.count()), std::memory_order_relaxed);
+            m_counts[stage].fetch_add(1U, std::memory_order_relaxed);
+        }
+
+        std::chrono::nanoseconds GetTime(LoadStage _stage) const
+        {
+            return std::chrono::nanoseconds(m_times[static_cast<size_t>(_stage)].load());
+        }
+
+        // Times the stage ran, e.g. once per primitive or image
+        uint64_t GetCount(LoadStage _stage) const
+        {
+            return m_counts[static_cast<size_t>(_stage)].load();
+        }
+
+        void Reset();
+
+        bool IsEnabled() const
+        {
+            return m_enabled.load(std::memory_order_relaxed);
+        }
+
+        void SetEnabled(bool _enabled)
+        {
+            m_enabled = _enabled;
+        }
+
+        static LoadProfiler &Get();
+
+        private:
+        static constexpr size_t STAGE_COUNT = static_cast<size_t>(LoadStage::Count);
+
+        std::atomic<bool> m_enabled = false;
+        std::array<std::atomic<uint64_t>, STAGE_COUNT> m_times {};
+        std::array<std::atomic<uint64_t>, STAGE_COUNT> m_counts {};
+    };
+
+    // Adds the time until the end of the scope to the stage
+    class ScopedLoadTimer
+    {
+        public:
+        ScopedLoadTimer(LoadStage _stage) : m_stage(_stage), m_enabled(LoadProfiler::Get().IsEnabled())
+        {
+            if (m_enabled) {
+                m_start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ScopedLoadTimer(const ScopedLoadTimer &) = delete;
+
+        ScopedLoadTimer &operator=(const ScopedLoadTimer &) = delete;
+
+        ~ScopedLoadTimer()
+        {
+            if (m_enabled) {
+                LoadProfiler::Get().Add(m_stage, std::chrono::steady_clock::now() - m_start);
+            }
+        }
+
+        private:
+        LoadStage m_stage;
+        bool m_enabled;
+        std::chrono::steady_clock::time_point m_start;
+    };
+} // namespace DadEngine
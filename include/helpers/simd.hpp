@@ -0,0 +1,89 @@
+#pragma once
+
+// Detection of the vector instruction sets the engine kernels can use,
+// every kernel keeps a scalar path for the other targets.
+//
+// GCC and Clang x86 builds compile the kernels of the sets above the build
+// target with a target attribute, which also inlines their helpers, callers
+// check the running CPU with the CPUHas functions before using them. Other compilers only get the kernels
+// of the sets they were told to target
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DADENGINE_SSE2
+#endif
+
+#if defined(DADENGINE_SSE2) && defined(__GNUC__)
+#define DADENGINE_RUNTIME_DISPATCH
+#define DADENGINE_TARGET(_instructionSets) __attribute__((target(_instructionSets), flatten))
+#else
+#define DADENGINE_TARGET(_instructionSets)
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX__) || defined(DADENGINE_RUNTIME_DISPATCH)
+#define DADENGINE_SSSE3
+#endif
+
+#if defined(__SSE4_1__) || defined(__AVX__) || defined(DADENGINE_RUNTIME_DISPATCH)
+#define DADENGINE_SSE41
+#endif
+
+#if defined(__AVX2__) || defined(DADENGINE_RUNTIME_DISPATCH)
+#define DADENGINE_AVX2
+#endif
+
+#if defined(__F16C__) || defined(DADENGINE_RUNTIME_DISPATCH)
+#define DADENGINE_F16C
+#endif
+
+#if defined(DADENGINE_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace DadEngine
+{
+    // Whether the kernels of a set can run, constant when the build
+    // targets it
+    inline bool CPUHasSSSE3()
+    {
+#if defined(__SSSE3__) || defined(__AVX__)
+        return true;
+#elif defined(DADENGINE_RUNTIME_DISPATCH)
+        return __builtin_cpu_supports("ssse3") != 0;
+#else
+        return false;
+#endif
+    }
+
+    inline bool CPUHasSSE41()
+    {
+#if defined(__SSE4_1__) || defined(__AVX__)
+        return true;
+#elif defined(DADENGINE_RUNTIME_DISPATCH)
+        return __builtin_cpu_supports("sse4.1") != 0;
+#else
+        return false;
+#endif
+    }
+
+    inline bool CPUHasAVX2()
+    {
+#if defined(__AVX2__)
+        return true;
+#elif defined(DADENGINE_RUNTIME_DISPATCH)
+        return __builtin_cpu_supports("avx2") != 0;
+#else
+        return false;
+#endif
+    }
+
+    inline bool CPUHasF16C()
+    {
+#if defined(__F16C__)
+        return true;
+#elif defined(DADENGINE_RUNTIME_DISPATCH)
+        return __builtin_cpu_supports("f16c") != 0;
+#else
+        return false;
+#endif
+    }
+} // namespace DadEngine
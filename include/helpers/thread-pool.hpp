@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace DadEngine
+{
+    class ThreadPool
+    {
+        public:
+        ThreadPool(uint32_t _threadCount = std::thread::hardware_concurrency());
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        ~ThreadPool();
+
+        template <typename Function>
+        auto Submit(Function &&_function) -> std::future<decltype(_function())>
+        {
+            using Result = decltype(_function());
+
+            auto task = std::make_shared<std::packaged_task<Result()>>(
+                std::forward<Function>(_function));
+            std::future<Result> future = task->get_future();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_tasks.emplace([task]() { (*task)(); });
+            }
+
+            m_condition.notify_one();
+
+            return future;
+        }
+
+        // Splits [0, _count) in chunks of _grainSize and blocks until every
+        // chunk ran. The calling thread processes chunks too so it is safe to
+        // call from inside a task
+        void ParallelFor(uint32_t _count,
+                         uint32_t _grainSize,
+                         const std::function<void(uint32_t _begin, uint32_t _end)> &_function);
+
+        uint32_t GetThreadCount() const
+        {
+            return static_cast<uint32_t>(m_workers.size());
+        }
+
+        // Process wide pool shared by the engine systems
+        static ThreadPool &Get();
+
+        private:
+        void workerLoop();
+
+        std::vector<std::thread> m_workers;
+        std::queue<std::function<void()>> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_stopping = false;
+    };
+} // namespace DadEngine
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <span>
+#include <vector>
+
+#include "gltf-document.hpp"
+
+namespace DadEngine
+{
+    // glTF component types, same values as the GL enums
+    constexpr uint32_t GLTF_BYTE           = 5120U;
+    constexpr uint32_t GLTF_UNSIGNED_BYTE  = 5121U;
+    constexpr uint32_t GLTF_SHORT          = 5122U;
+    constexpr uint32_t GLTF_UNSIGNED_SHORT = 5123U;
+    constexpr uint32_t GLTF_UNSIGNED_INT   = 5125U;
+    constexpr uint32_t GLTF_FLOAT          = 5126U;
+    // Not part of core glTF, used by cooked assets storing half floats
+    constexpr uint32_t GLTF_HALF_FLOAT = 5131U;
+
+    inline uint32_t GetComponentSize(uint32_t _componentType)
+    {
+        switch (_componentType) {
+        case GLTF_BYTE:
+        case GLTF_UNSIGNED_BYTE:
+            return 1U;
+        case GLTF_SHORT:
+        case GLTF_UNSIGNED_SHORT:
+        case GLTF_HALF_FLOAT:
+            return 2U;
+        default:
+            return 4U;
+        }
+    }
+
+    // Where the elements of an accessor live inside the loaded buffers
+    struct AccessorLayout
+    {
+        const uint8_t *data = nullptr; // Null when the range is invalid
+        size_t stride       = 0;
+        size_t elementSize  = 0;
+        size_t count        = 0;
+    };
+
+    // _buffers holds the bytes of each glTF buffer, in the document order.
+    // The accessor range is checked against its buffer view and the view
+    // range against its buffer
+    AccessorLayout ResolveAccessor(const GLTFDocument &_document,
+                                   const std::vector<std::span<const uint8_t>> &_buffers,
+                                   const GLTFAccessor &_accessor);
+
+    // Typed view over strided elements, reading straight from the buffer
+    // memory. Elements are loaded with memcpy so unaligned data is fine
+    template <typename T>
+    class AccessorView
+    {
+        public:
+        class Iterator
+        {
+            public:
+            Iterator(const uint8_t *_element, size_t _stride)
+                : m_element(_element), m_stride(_stride)
+            {
+            }
+
+            T operator*() const
+            {
+                T value;
+                std::memcpy(&value, m_element, sizeof(T));
+                return value;
+            }
+
+            Iterator &operator++()
+            {
+                m_element += m_stride;
+                return *this;
+            }
+
+            bool operator==(const Iterator &_other) const
+            {
+                return m_element == _other.m_element;
+            }
+
+            bool operator!=(const Iterator &_other) const
+            {
+                return m_element != _other.m_element;
+            }
+
+            private:
+            const uint8_t *m_element;
+            size_t m_stride;
+        };
+
+        AccessorView() = default;
+
+        AccessorView(const uint8_t *_data, size_t _count, size_t _stride)
+            : m_data(_data), m_count(_count), m_stride(_stride ? _stride : sizeof(T))
+        {
+        }
+
+        T operator[](size_t _index) const
+        {
+            T value;
+            std::memcpy(&value, m_data + _index * m_stride, sizeof(T));
+            return value;
+        }
+
+        size_t Size() const
+        {
+            return m_count;
+        }
+
+        bool IsEmpty() const
+        {
+            return m_count == 0;
+        }
+
+        // Tightly packed and aligned elements can be used in place through Data
+        bool IsContiguous() const
+        {
+            return m_stride == sizeof(T)
+                   && reinterpret_cast<uintptr_t>(m_data) % alignof(T) == 0;
+        }
+
+        const T *Data() const
+        {
+            return reinterpret_cast<const T *>(m_data);
+        }
+
+        Iterator begin() const
+        {
+            return { m_data, m_stride };
+        }
+
+        Iterator end() const
+        {
+            return { m_data + m_count * m_stride, m_stride };
+        }
+
+        private:
+        const uint8_t *m_data = nullptr;
+        size_t m_count        = 0;
+        size_t m_stride       = sizeof(T);
+    };
+
+    // Empty view when the accessor elements are not exactly T sized
+    template <typename T>
+    AccessorView<T> GetAccessorView(const GLTFDocument &_document,
+                                    const std::vector<std::span<const uint8_t>> &_buffers,
+                                    const GLTFAccessor &_accessor)
+    {
+        AccessorLayout layout = ResolveAccessor(_document, _buffers, _accessor);
+
+        if (!layout.data || layout.elementSize != sizeof(T)) {
+            return {};
+        }
+
+        return { layout.data, layout.count, layout.stride };
+    }
+
+    // Writes the accessor components as floats, _destinationStride bytes
+    // apart, applying the normalization of integer types. Components past
+    // the accessor ones are left untouched. Returns false when the accessor
+    // cannot be read
+    bool ReadAccessor(const GLTFDocument &_document,
+                      const std::vector<std::span<const uint8_t>> &_buffers,
+                      const GLTFAccessor &_accessor,
+                      uint32_t _componentCount,
+                      float *_destination,
+                      size_t _destinationStride);
+
+    // Widens unsigned integer components, for indices and joint indices
+    bool ReadAccessor(const GLTFDocument &_document,
+                      const std::vector<std::span<const uint8_t>> &_buffers,
+                      const GLTFAccessor &_accessor,
+                      uint32_t _componentCount,
+                      uint32_t *_destination,
+                      size_t _destinationStride);
+
+    // Every component of a float accessor as a flat array. Tightly packed
+    // and aligned float data is used in place through an AccessorView, the
+    // rest is converted into _storage. Returns false when the accessor
+    // cannot be read
+    bool ReadFloatAccessor(const GLTFDocument &_document,
+                           const std::vector<std::span<const uint8_t>> &_buffers,
+                           const GLTFAccessor &_accessor,
+                           std::vector<float> &_storage,
+                           std::span<const float> &_floats);
+
+    // Conversion kernels behind ReadAccessor, usable on any strided data
+    void ConvertToFloat(const uint8_t *_source,
+                        size_t _sourceStride,
+                        uint32_t _componentType,
+                        bool _normalized,
+                        uint32_t _componentCount,
+                        size_t _count,
+                        float *_destination,
+                        size_t _destinationStride);
+
+    void ConvertToUint32(const uint8_t *_source,
+                         size_t _sourceStride,
+                         uint32_t _componentType,
+                         uint32_t _componentCount,
+                         size_t _count,
+                         uint32_t *_destination,
+                         size_t _destinationStride);
+} // namespace DadEngine
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "gltf-document.hpp"
+#include "helpers/file.hpp"
+#include "mip-generator.hpp"
+#include "model/model.hpp"
+
+namespace DadEngine
+{
+    // The compressed image of the texture extensions takes precedence
+    inline uint32_t GetTextureImage(const GLTFTexture &_texture)
+    {
+        return _texture.compressedSource != GLTF_INVALID_INDEX ? _texture.compressedSource
+                                                               : _texture.source;
+    }
+
+    // glTF file with its buffers resolved, everything the CPU side of the
+    // loading needs without touching the rendering API. External buffers are
+    // mapped, the GLB one is used in place and data URIs are decoded in
+    // their own storage
+    class GLTFAsset
+    {
+        public:
+        bool Load(const std::filesystem::path &_path);
+
+        const GLTFDocument &GetDocument() const
+        {
+            return m_document;
+        }
+
+        const std::vector<std::span<const uint8_t>> &GetBuffers() const
+        {
+            return m_buffers;
+        }
+
+        // Interleaved vertices and 32 bits indices, attributes the primitive
+        // lacks are left zeroed. The joints and weights go to _skinVertices
+        // when given, which stays empty for the primitives without a skin
+        void ReadPrimitive(const GLTFPrimitive &_primitive,
+                           std::vector<Vertex> &_vertices,
+                           std::vector<uint32_t> &_indices,
+                           std::vector<SkinVertex> *_skinVertices = nullptr) const;
+
+        // ReadPrimitive followed by ProcessPrimitive, the result is kept in
+        // the derived data cache and read back by the next loads
+        void ReadProcessedPrimitive(uint32_t _meshIndex,
+                                    uint32_t _primitiveIndex,
+                                    std::vector<Vertex> &_vertices,
+                                    std::vector<uint32_t> &_indices,
+                                    std::vector<SkinVertex> *_skinVertices = nullptr) const;
+
+        Sampler GetSampler(const GLTFTexture &_texture) const;
+
+        // Images stored in their own file rather than a buffer or a data URI
+        bool IsExternalImage(uint32_t _imageIndex) const;
+
+        std::filesystem::path GetImagePath(uint32_t _imageIndex) const;
+
+        // Encoded bytes of an image, the external files and data URIs are
+        // read into _storage
+        std::span<const uint8_t> ReadImage(uint32_t _imageIndex, ByteBuffer &_storage) const;
+
+        std::string GetImageName(uint32_t _imageIndex) const;
+
+        bool HasAlpha(uint32_t _imageIndex) const;
+
+        // How the mips of an image are filtered and compressed, from the
+        // material slots using it
+        const MipSettings &GetMipSettings(uint32_t _imageIndex) const
+        {
+            return m_mipSettings[_imageIndex];
+        }
+
+        private:
+        void resolveMipSettings();
+
+        std::filesystem::path m_path;
+        MappedFile m_file;
+        GLTFDocument m_document;
+
+        std::vector<MappedFile> m_externalBuffers;
+        std::vector<std::vector<uint8_t>> m_embeddedBuffers;
+        std::vector<std::span<const uint8_t>> m_buffers; // Empty when unreadable
+
+        // Hash of the glTF file and its buffers, only computed when the
+        // derived data cache is enabled
+        uint64_t m_contentHash = 0;
+
+        std::vector<MipSettings> m_mipSettings;
+    };
+} // namespace DadEngine
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+namespace DadEngine
+{
+    // Typed records of a glTF asset, resolved once from the JSON so the loader
+    // reads plain fields instead of walking the document for each lookup
+    constexpr uint32_t GLTF_INVALID_INDEX = ~0U;
+
+    struct GLTFBuffer
+    {
+        std::string uri;
+        size_t byteLength = 0;
+    };
+
+    struct GLTFBufferView
+    {
+        uint32_t buffer     = GLTF_INVALID_INDEX;
+        size_t byteOffset   = 0;
+        size_t byteLength   = 0;
+        uint32_t byteStride = 0; // 0 when the elements are tightly packed
+    };
+
+    struct GLTFAccessor
+    {
+        uint32_t bufferView     = GLTF_INVALID_INDEX;
+        size_t byteOffset       = 0;
+        uint32_t componentType  = 0;
+        uint32_t componentCount = 0; // 1 for SCALAR up to 16 for MAT4
+        size_t count            = 0;
+        bool normalized         = false;
+    };
+
+    struct GLTFSampler
+    {
+        // Defaults to linear filtering and repeat wrapping, in GL enum values
+        int32_t magFilter = 0x2601;
+        int32_t minFilter = 0x2601;
+        int32_t wrapS     = 0x2901;
+        int32_t wrapT     = 0x2901;
+    };
+
+    struct GLTFImage
+    {
+        std::string uri;
+        std::string mimeType;
+        uint32_t bufferView = GLTF_INVALID_INDEX;
+    };
+
+    struct GLTFTexture
+    {
+        uint32_t sampler = GLTF_INVALID_INDEX;
+        uint32_t source  = GLTF_INVALID_INDEX;
+
+        // KTX2 or DDS image of the KHR_texture_basisu or MSFT_texture_dds
+        // extensions, source is the fallback
+        uint32_t compressedSource = GLTF_INVALID_INDEX;
+    };
+
+    struct GLTFTextureInfo
+    {
+        uint32_t index    = GLTF_INVALID_INDEX;
+        uint32_t texCoord = 0;
+        float scale       = 1.f; // Normal scale or occlusion strength
+    };
+
+    enum class GLTFAlphaMode : uint8_t
+    {
+        Opaque,
+        Mask, // Alpha tested against alphaCutoff
+        Blend
+    };
+
+    // Factors default to the PBRMaterial ones rather than the glTF ones
+    struct GLTFMaterial
+    {
+        float baseColorFactor[4] = { 1.f, 1.f, 1.f, 1.f };
+        GLTFTextureInfo baseColorTexture;
+
+        float metallicFactor  = 1.f;
+        float roughnessFactor = 1.f;
+        GLTFTextureInfo metallicRoughnessTexture;
+
+        GLTFTextureInfo normalTexture;
+        GLTFTextureInfo occlusionTexture;
+
+        float emissiveFactor[3] = { 1.f, 1.f, 1.f };
+        GLTFTextureInfo emissiveTexture;
+
+        GLTFAlphaMode alphaMode = GLTFAlphaMode::Opaque;
+        float alphaCutoff       = 0.5f;
+    };
+
+    struct GLTFPrimitive
+    {
+        // Accessor indices of the attributes the engine vertex layout uses
+        uint32_t position  = GLTF_INVALID_INDEX;
+        uint32_t normal    = GLTF_INVALID_INDEX;
+        uint32_t tangent   = GLTF_INVALID_INDEX;
+        uint32_t texCoord0 = GLTF_INVALID_INDEX;
+        uint32_t joints0   = GLTF_INVALID_INDEX;
+        uint32_t weights0  = GLTF_INVALID_INDEX;
+
+        uint32_t indices  = GLTF_INVALID_INDEX;
+        uint32_t material = GLTF_INVALID_INDEX;
+        uint32_t mode     = 4U; // Triangles
+    };
+
+    struct GLTFMesh
+    {
+        std::vector<GLTFPrimitive> primitives;
+    };
+
+    struct GLTFNode
+    {
+        uint32_t mesh = GLTF_INVALID_INDEX;
+        uint32_t skin = GLTF_INVALID_INDEX;
+        std::vector<uint32_t> children;
+
+        // Either the matrix or the TRS properties describe the local transform
+        bool hasMatrix   = false;
+        float matrix[16] = { 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f,
+                             0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f };
+        float translation[3] = { 0.f, 0.f, 0.f };
+        float rotation[4]    = { 0.f, 0.f, 0.f, 1.f };
+        float scale[3]       = { 1.f, 1.f, 1.f };
+    };
+
+    struct GLTFSkin
+    {
+        uint32_t inverseBindMatrices = GLTF_INVALID_INDEX; // Identities when missing
+        std::vector<uint32_t> joints;
+    };
+
+    struct GLTFScene
+    {
+        std::vector<uint32_t> nodes;
+    };
+
+    enum class GLTFAnimationPath : uint8_t
+    {
+        Translation,
+        Rotation,
+        Scale,
+        Weights // Morph target weights of the node mesh
+    };
+
+    enum class GLTFInterpolation : uint8_t
+    {
+        Linear,
+        Step,
+        CubicSpline // Each output key is an in tangent, a value and an out tangent
+    };
+
+    struct GLTFAnimationChannel
+    {
+        uint32_t sampler       = GLTF_INVALID_INDEX;
+        uint32_t node          = GLTF_INVALID_INDEX; // Left invalid for unknown paths
+        GLTFAnimationPath path = GLTFAnimationPath::Translation;
+    };
+
+    struct GLTFAnimationSampler
+    {
+        uint32_t input                  = GLTF_INVALID_INDEX; // Key times in seconds
+        uint32_t output                 = GLTF_INVALID_INDEX;
+        GLTFInterpolation interpolation = GLTFInterpolation::Linear;
+    };
+
+    struct GLTFAnimation
+    {
+        std::vector<GLTFAnimationChannel> channels;
+        std::vector<GLTFAnimationSampler> samplers;
+    };
+
+    struct GLTFDocument
+    {
+        std::vector<GLTFBuffer> buffers;
+        std::vector<GLTFBufferView> bufferViews;
+        std::vector<GLTFAccessor> accessors;
+        std::vector<GLTFSampler> samplers;
+        std::vector<GLTFImage> images;
+        std::vector<GLTFTexture> textures;
+        std::vector<GLTFMaterial> materials;
+        std::vector<GLTFMesh> meshes;
+        std::vector<GLTFNode> nodes;
+        std::vector<GLTFSkin> skins;
+        std::vector<GLTFScene> scenes;
+        std::vector<GLTFAnimation> animations;
+        uint32_t scene = 0;
+    };
+
+    // Chunks of a binary glTF, pointing inside the container bytes
+    struct GLBChunks
+    {
+        const uint8_t *json = nullptr;
+        size_t jsonSize     = 0;
+        const uint8_t *bin  = nullptr; // Null when the file has no BIN chunk
+        size_t binSize      = 0;
+    };
+
+    // Validates the GLB header and locates its chunks without copying them
+    bool ParseGLBContainer(const uint8_t *_data, size_t _size, GLBChunks &_chunks);
+
+    // Reads the glTF JSON in a single pass straight into the typed records,
+    // without building a DOM. Unknown properties are skipped. Returns false
+    // when the JSON is malformed
+    bool ParseGLTFDocument(const uint8_t *_json, size_t _size, GLTFDocument &_document);
+} // namespace DadEngine
@@ -1,11 +1,48 @@
 #pragma once
 
+#include <cstdint>
+
 #include <filesystem>
 #include <vector>
 
+#include "texture-compressor.hpp"
+
 namespace DadEngine
 {
     class Mesh;
+    class GeometryPool;
+    class SceneGraph;
+    class AnimationClip;
+    struct Skin;
+    class GLTFAsset;
+    struct GLTFDocument;
+
+    // Primitives are suballocated from the pool when one is given. Images
+    // that are not block compressed already are compressed before upload
+    // when the settings enable it. The nodes of the default scene are
+    // flattened into the graph when one is given, their mesh indices
+    // pointing in the returned meshes. The animations are read into
+    // _animations along with the graph, one clip per glTF animation, and
+    // the skins into _skins, indexed by the skins of the graph nodes
+    std::vector<Mesh> LoadGLTF(std::filesystem::path &_path, GeometryPool *_pool = nullptr,
+                               const TextureCompressionSettings &_compression = {},
+                               SceneGraph *_sceneGraph = nullptr,
+                               std::vector<AnimationClip> *_animations = nullptr,
+                               std::vector<Skin> *_skins = nullptr);
+
+    // Appends the node hierarchy of the default scene to the graph, depth
+    // first. Every node without a parent is a root when the asset has no
+    // scene. Matrices are decomposed into their TRS. Returns the graph node
+    // of each glTF node, INVALID_NODE for the ones outside the scene
+    std::vector<uint32_t> BuildSceneGraph(const GLTFDocument &_document, SceneGraph &_graph);
+
+    // Clips whose channels target the graph nodes returned by
+    // BuildSceneGraph, the channels of nodes outside the scene and the
+    // unreadable samplers are dropped
+    std::vector<AnimationClip> LoadGLTFAnimations(const GLTFAsset &_asset, const std::vector<uint32_t> &_graphNodes);
 
-    std::vector<Mesh> LoadGLTF(std::filesystem::path &_path);
+    // Skins whose joints are the graph nodes returned by BuildSceneGraph,
+    // INVALID_NODE for the ones outside the scene. A skin with unreadable
+    // inverse bind matrices keeps identities
+    std::vector<Skin> LoadGLTFSkins(const GLTFAsset &_asset, const std::vector<uint32_t> &_graphNodes);
 } // namespace DadEngine
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+#include <vector>
+
+#include "gltf-document.hpp"
+#include "model/model.hpp"
+
+namespace DadEngine
+{
+    // Processing of triangle lists done once per asset, by the cooker or
+    // through the derived data cache, the renderer draws the result as is
+
+    // Reorders the triangles so consecutive ones reuse the vertices still in
+    // the post transform cache (Tipsify, Sander et al. 2007)
+    void OptimizeVertexCache(std::vector<uint32_t> &_indices, uint32_t _vertexCount, uint32_t _cacheSize = 16U);
+
+    // Stores the vertices in the order the indices first reference them and
+    // drops the unreferenced ones, so the vertex fetch reads linearly. The
+    // skin stream, when not empty, is reordered along
+    void OptimizeVertexFetch(std::vector<Vertex> &_vertices,
+                             std::vector<uint32_t> &_indices,
+                             std::vector<SkinVertex> *_skinVertices = nullptr);
+
+    // Per vertex tangents from the UV gradients of the triangles (Lengyel),
+    // the handedness of the bitangent is stored in w
+    void GenerateTangents(std::vector<Vertex> &_vertices, const std::vector<uint32_t> &_indices);
+
+    // Bump whenever the output of ProcessPrimitive changes, the processed
+    // geometry cached by previous runs is ignored then
+    constexpr uint32_t MESH_PROCESSING_VERSION = 2U;
+
+    // Generates the tangents a primitive with normals and UVs lacks then
+    // optimizes indexed triangle lists for the vertex cache and fetch
+    void ProcessPrimitive(const GLTFPrimitive &_primitive,
+                          std::vector<Vertex> &_vertices,
+                          std::vector<uint32_t> &_indices,
+                          std::vector<SkinVertex> *_skinVertices = nullptr);
+} // namespace DadEngine
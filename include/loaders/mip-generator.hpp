@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+#include <vector>
+
+#include "helpers/byte-buffer.hpp"
+#include "model/model.hpp"
+#include "texture-compressor.hpp"
+
+namespace DadEngine
+{
+    struct MipSettings
+    {
+        TextureUsage usage = TextureUsage::Color;
+
+        // Alpha test threshold of a cutout material, every mip then keeps
+        // the share of texels passing the test of the source. 0 disables it
+        float alphaCutoff = 0.f;
+    };
+
+    // Levels laid out one after the other in pixels, from the source image
+    // down to 1x1. The levels point inside pixels
+    struct MipChain
+    {
+        ByteBuffer pixels;
+        std::vector<TextureLevel> levels;
+        int32_t channels = 0;
+    };
+
+    uint32_t GetMipLevelCount(int32_t _width, int32_t _height);
+
+    // Bytes taken by the whole chain
+    size_t GetMipChainSize(int32_t _width, int32_t _height, int32_t _channels);
+
+    // Sizes pixels for the whole chain and points the levels inside it
+    void LayoutMipChain(MipChain &_chain, int32_t _width, int32_t _height, int32_t _channels);
+
+    // Builds the chain of 8 bits pixels with 1 to 4 channels, the output
+    // has 4 channels with alpha and 3 otherwise. Each level is box filtered
+    // from the previous one with 3 taps along odd sizes so no texel is
+    // dropped. Color images are filtered in linear space and normal maps
+    // renormalized. The rows of a level are filtered in parallel on the
+    // thread pool
+    MipChain GenerateMips(const uint8_t *_pixels, int32_t _width, int32_t _height, int32_t _channels,
+                          bool _hasAlpha, const MipSettings &_settings);
+} // namespace DadEngine
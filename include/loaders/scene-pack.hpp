@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+
+#include <filesystem>
+#include <type_traits>
+#include <vector>
+
+namespace DadEngine
+{
+    class Mesh;
+    class GeometryPool;
+    class SceneGraph;
+
+    // Binary scene written by dadengine-cook. Every table and blob is
+    // addressed by its byte offset from the start of the file and blobs are
+    // aligned so they are read in place from the mapping. Vertices and
+    // indices are copied once into the CPU buffers of the meshes, texture
+    // levels are uploaded straight from the mapping. Bump the version with
+    // any layout change
+    constexpr uint32_t SCENE_PACK_MAGIC         = 0x4B415044U; // "DPAK"
+    constexpr uint32_t SCENE_PACK_VERSION       = 4U;
+    constexpr uint64_t SCENE_PACK_ALIGNMENT     = 64U;
+    constexpr uint32_t SCENE_PACK_INVALID       = ~0U;
+    constexpr uint32_t SCENE_PACK_TEXTURE_SLOTS = 5U; // Same order as PBRMaterial
+
+    struct ScenePackHeader
+    {
+        uint32_t magic   = SCENE_PACK_MAGIC;
+        uint32_t version = SCENE_PACK_VERSION;
+
+        // sizeof(Vertex) of the cooking build, the layout differs per API
+        uint32_t vertexSize = 0;
+
+        uint32_t meshCount      = 0;
+        uint32_t primitiveCount = 0;
+        uint32_t materialCount  = 0;
+        uint32_t textureCount   = 0;
+        uint32_t levelCount     = 0;
+        uint32_t nodeCount      = 0;
+        uint32_t reserved       = 0; // Keeps the offsets aligned
+
+        uint64_t meshesOffset     = 0;
+        uint64_t primitivesOffset = 0;
+        uint64_t materialsOffset  = 0;
+        uint64_t texturesOffset   = 0;
+        uint64_t levelsOffset     = 0;
+        uint64_t nodesOffset      = 0;
+    };
+
+    struct PackedMesh
+    {
+        uint32_t firstPrimitive;
+        uint32_t primitiveCount;
+    };
+
+    struct PackedPrimitive
+    {
+        uint64_t verticesOffset;
+        uint64_t indicesOffset; // 32 bits indices
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t drawMode;
+        uint32_t material;
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+
+    struct PackedMaterial
+    {
+        float baseColorFactor[4];
+        float emissiveFactor[3];
+        float metallicFactor;
+        float roughnessFactor;
+        float normalScale;
+        float occlusionStrength;
+        uint32_t textures[SCENE_PACK_TEXTURE_SLOTS];
+        uint32_t hasTransparency;
+
+        // Index of the material in the source asset, kept for batching
+        uint32_t id;
+    };
+
+    // Sampler values are the OpenGL enums glTF uses
+    struct PackedTexture
+    {
+        uint32_t format; // TextureFormat
+        uint32_t firstLevel;
+        uint32_t levelCount;
+        uint32_t hasAlpha;
+        int32_t magFilter;
+        int32_t minFilter;
+        int32_t wrapS;
+        int32_t wrapT;
+    };
+
+    struct PackedTextureLevel
+    {
+        uint64_t offset;
+        uint64_t size;
+        int32_t width;
+        int32_t height;
+    };
+
+    // Scene graph nodes in their depth first order
+    struct PackedNode
+    {
+        uint32_t parent; // SCENE_PACK_INVALID for the roots
+        uint32_t mesh;
+        float translation[3];
+        float rotation[4]; // x, y, z, w like glTF
+        float scale[3];
+    };
+
+    static_assert(std::is_trivially_copyable_v<PackedPrimitive>
+                  && std::is_trivially_copyable_v<PackedMaterial>
+                  && std::is_trivially_copyable_v<PackedTexture>
+                  && std::is_trivially_copyable_v<PackedTextureLevel>
+                  && std::is_trivially_copyable_v<PackedNode>);
+
+    // Maps a pack written by dadengine-cook and creates its meshes without
+    // any parsing or decoding, primitives are suballocated from the pool
+    // when one is given. The scene nodes are appended to the graph when one
+    // is given
+    std::vector<Mesh> LoadCookedScene(const std::filesystem::path &_path, GeometryPool *_pool = nullptr,
+                                      SceneGraph *_sceneGraph = nullptr);
+} // namespace DadEngine
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+#include <vector>
+
+#include "model/model.hpp"
+
+namespace DadEngine
+{
+    // Role of an image in the materials, picks its compressed format and
+    // how its mips are filtered. An image with several roles takes the
+    // first one in this order
+    enum class TextureUsage : uint8_t
+    {
+        Color, // sRGB base color or emissive
+        Data,  // Linear metallic roughness or occlusion
+        Normal // Only x and y are kept, the shaders rebuild z
+    };
+
+    struct TextureCompressionSettings
+    {
+        // Off by default, the mips are then uploaded uncompressed
+        bool enabled = false;
+
+        // BC7 instead of BC1 and BC3 for the color images, sharper but
+        // several times slower to encode
+        bool useBC7 = false;
+
+        // Endpoint refinement passes of BC7, 0 only fits the principal axis
+        // and 2 or more also searches every p-bit pair
+        uint32_t bc7Quality = 1U;
+    };
+
+    // BC5 for normal maps, BC7 or BC3 with alpha, BC7 or BC1 otherwise
+    TextureFormat ChooseCompressedFormat(TextureUsage _usage, bool _hasAlpha,
+                                         const TextureCompressionSettings &_settings);
+
+    // Encodes 8 bits pixels of 1 to 4 channels, grey, grey alpha, RGB or
+    // RGBA, into BC1, BC3, BC4, BC5 or BC7 blocks. _destination holds
+    // GetTextureLevelSize(_format, _width, _height) bytes. Partial blocks
+    // on the right and bottom edges repeat the last pixels. Rows of blocks
+    // are encoded in parallel on the thread pool
+    void CompressTexture(const uint8_t *_pixels, int32_t _width, int32_t _height, int32_t _channels,
+                         TextureFormat _format, uint32_t _bc7Quality, uint8_t *_destination);
+
+    // Compresses the levels of a mip chain one after the other into
+    // _blocks, the returned levels point inside it
+    std::vector<TextureLevel> CompressLevels(const std::vector<TextureLevel> &_levels, int32_t _channels,
+                                             TextureFormat _format, uint32_t _bc7Quality,
+                                             std::vector<uint8_t> &_blocks);
+} // namespace DadEngine
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+#include <span>
+#include <vector>
+
+#include "model/model.hpp"
+
+namespace DadEngine
+{
+    // Block compressed image of a DDS or KTX2 file with its prebuilt mips,
+    // the levels point inside the file bytes
+    struct CompressedImage
+    {
+        TextureFormat format = TextureFormat::BC7;
+        bool hasAlpha        = false;
+        std::vector<TextureLevel> levels;
+    };
+
+    // Checks the DDS or KTX2 magic
+    bool IsTextureContainer(std::span<const uint8_t> _file);
+
+    // Only 2D images with BC1, BC3, BC4, BC5 or BC7 texels are supported,
+    // KTX2 supercompression (Basis Universal or Zstandard) is rejected
+    bool ParseDDS(std::span<const uint8_t> _file, CompressedImage &_image);
+
+    bool ParseKTX2(std::span<const uint8_t> _file, CompressedImage &_image);
+
+    bool ParseTextureContainer(std::span<const uint8_t> _file, CompressedImage &_image);
+} // namespace DadEngine
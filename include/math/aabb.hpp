@@ -1,12 +1,48 @@
 #ifndef __AABB_HPP_
 #define __AABB_HPP_
 
+#include <cstdint>
+
+#include "vector/vector3.hpp"
+
 namespace DadEngine
 {
     class AABB
     {
+
+        public:
+        AABB() = default;
+
+        AABB(Vector3 _min, Vector3 _max);
+
+
+        // Standard bounding box functions
+        void Grow(const Vector3 &_point);
+
+        void Grow(const AABB &_box);
+
+        bool IsValid() const;
+
+        bool Contains(const Vector3 &_point) const;
+
+        bool Overlaps(const AABB &_box) const;
+
+        Vector3 Center() const;
+
+        Vector3 Extent() const;
+
+        float SurfaceArea() const;
+
+        // Returns the index of the largest axis (0 = x, 1 = y, 2 = z)
+        uint32_t LargestAxis() const;
+
+        // Inverted box, growing it with any point makes it valid
+        static AABB Empty();
+
+
+        Vector3 m_min = Vector3::Zero();
+        Vector3 m_max = Vector3::Zero();
     };
 } // namespace DadEngine
 
 #endif //__AABB_HPP_
-
@@ -0,0 +1,69 @@
+#ifndef __MATRIX3X4_HPP_
+#define __MATRIX3X4_HPP_
+
+
+namespace DadEngine
+{
+    class Vector3;
+    class Quaternion;
+    class Matrix4x4;
+
+    // Affine transform stored as three rows of four, the last column being
+    // the translation. Vectors are transformed as columns, unlike Matrix4x4,
+    // so the rows pack into three vec4 and the implicit fourth row is never
+    // stored nor computed
+    class Matrix3x4
+    {
+
+        public:
+        Matrix3x4() = default;
+
+        Matrix3x4(float _11,
+                  float _12,
+                  float _13,
+                  float _14,
+                  float _21,
+                  float _22,
+                  float _23,
+                  float _24,
+                  float _31,
+                  float _32,
+                  float _33,
+                  float _34);
+
+        // Takes the transform of a row vector Matrix4x4, its projective
+        // column is dropped
+        explicit Matrix3x4(const Matrix4x4 &_matrix);
+
+
+        // Standard matrix functions
+        void SetIdentity();
+
+        // Scales, then rotates, then translates. The rotation is expected
+        // to be normalized
+        void SetTRS(const Vector3 &_translation, const Quaternion &_rotation, const Vector3 &_scale);
+
+        // Inverse of SetTRS, any shear is lost
+        void Decompose(Vector3 &_translation, Quaternion &_rotation, Vector3 &_scale) const;
+
+        Vector3 TransformPoint(const Vector3 &_point) const;
+
+        // Leaves the translation out
+        Vector3 TransformVector(const Vector3 &_vector) const;
+
+        // Same transform in the row vector convention of the uniforms
+        Matrix4x4 GetMatrix4x4() const;
+
+
+        // Binary math operators
+        // _matrix is applied first, e.g. parentWorld * local
+        Matrix3x4 operator*(const Matrix3x4 &_matrix) const;
+
+
+        float m_11 = 1.f, m_12 = 0.f, m_13 = 0.f, m_14 = 0.f;
+        float m_21 = 0.f, m_22 = 1.f, m_23 = 0.f, m_24 = 0.f;
+        float m_31 = 0.f, m_32 = 0.f, m_33 = 1.f, m_34 = 0.f;
+    };
+} // namespace DadEngine
+
+#endif //__MATRIX3X4_HPP_
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#if defined(OPENGL)
+#include "renderer/opengl-loader.hpp"
+#elif defined(VULKAN)
+#include "renderer/vulkan-loader.hpp"
+#endif
+
+namespace DadEngine
+{
+    struct Vertex;
+
+    // Offset and size are expressed in elements, not bytes
+    struct GeometryRange
+    {
+        uint32_t offset = 0;
+        uint32_t size   = 0;
+
+        bool IsValid() const
+        {
+            return size != 0;
+        }
+    };
+
+    // Best fit free list over a linear range, neighbouring free ranges are
+    // merged back together when released
+    class RangeAllocator
+    {
+        public:
+        RangeAllocator(uint32_t _capacity);
+
+        GeometryRange Allocate(uint32_t _size);
+
+        void Free(GeometryRange _range);
+
+        // Appends free space at the end of the managed range
+        void Grow(uint32_t _capacity);
+
+        uint32_t GetCapacity() const
+        {
+            return m_capacity;
+        }
+
+        uint32_t GetFreeSize() const;
+
+        private:
+        uint32_t m_capacity = 0;
+        std::vector<GeometryRange> m_freeRanges; // Sorted by offset
+    };
+
+    // Owns one large vertex buffer and index buffer shared by many
+    // primitives through a single vertex array. Primitives draw with base
+    // vertex and first index offsets into it. The range allocation is API
+    // agnostic so a Vulkan backend can suballocate a VMA buffer the same way
+    class GeometryPool
+    {
+        public:
+        GeometryPool(uint32_t _vertexCapacity, uint32_t _indexCapacity);
+
+        GeometryPool(const GeometryPool &) = delete;
+
+        GeometryPool &operator=(const GeometryPool &) = delete;
+
+        ~GeometryPool();
+
+        GeometryRange AllocateVertices(const std::vector<Vertex> &_vertices);
+
+        GeometryRange AllocateIndices(const std::vector<uint32_t> &_indices);
+
+        void FreeVertices(GeometryRange _range);
+
+        void FreeIndices(GeometryRange _range);
+
+#if defined(OPENGL)
+        GLuint vertexArrayID   = 0;
+        GLuint vertexBufferID  = 0;
+        GLuint elementBufferID = 0;
+#elif defined(VULKAN)
+#endif
+
+        private:
+        void growVertices(uint32_t _minimumCapacity);
+
+        void growIndices(uint32_t _minimumCapacity);
+
+        RangeAllocator m_vertices;
+        RangeAllocator m_indices;
+    };
+} // namespace DadEngine
@@ -2,12 +2,17 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include "math/aabb.hpp"
 #include "math/vector/vector2.hpp"
 #include "math/vector/vector3.hpp"
 #include "math/vector/vector4.hpp"
 
+#include "geometry-pool.hpp"
+
 #if defined(OPENGL)
 #include "renderer/opengl-loader.hpp"
 #elif defined(VULKAN)
@@ -28,27 +33,110 @@ namespace DadEngine
         Vector2 uv0;
     };
 
+    // Up to four joints of the node skin and their weights, as unsigned
+    // normalized integers summing to one. Stored in a stream of their own
+    // that only the skinned primitives allocate
+    struct SkinVertex
+    {
+        uint16_t joints[4]  = {};
+        uint16_t weights[4] = {};
+    };
+
+    // Owns its buffers, or its range of the pool, until destroyed or moved
+    // from. The vertices stay on the CPU for the passes reading them back,
+    // e.g. batching or the BVH build, until ReleaseCPUData
     struct VertexBuffer
     {
-        VertexBuffer(std::vector<Vertex> &&_vertices);
+        // A dynamic buffer is rewritten from the vertices by Upload, e.g.
+        // every frame by CPU skinning
+        VertexBuffer(std::vector<Vertex> &&_vertices, bool _dynamic = false);
+
+        VertexBuffer(std::vector<Vertex> &&_vertices, GeometryPool &_pool);
+
+        VertexBuffer(const VertexBuffer &) = delete;
+
+        VertexBuffer(VertexBuffer &&_vertexBuffer) noexcept;
+
+        VertexBuffer &operator=(const VertexBuffer &) = delete;
+
+        VertexBuffer &operator=(VertexBuffer &&_vertexBuffer) noexcept;
+
+        ~VertexBuffer();
+
+        void Release();
+
+        // Frees the CPU copy, the buffer still draws
+        void ReleaseCPUData();
+
+        // Sends the vertices to the GPU buffer again, only for the buffers
+        // outside of a pool
+        void Upload();
+
+        // Adds the joints and weights of a skinned primitive as a second
+        // stream, one per vertex. Only for the buffers outside of a pool,
+        // whose vertex array is shared
+        void SetSkin(std::vector<SkinVertex> &&_skinVertices);
+
+        bool HasCPUData() const
+        {
+            return vertices.size() == vertexCount;
+        }
+
+        // Describes the Vertex attributes for the bound vertex array and array buffer
+        static void SetupVertexLayout();
 
 #if defined(OPENGL)
-        GLuint vertexArrayID;
-        GLuint vertexBufferID;
+        GLuint vertexArrayID  = 0;
+        GLuint vertexBufferID = 0;
+        GLuint skinBufferID   = 0;
 #elif defined(VULKAN)
 #endif
         std::vector<Vertex> vertices;
+        std::vector<SkinVertex> skinVertices; // Empty for static geometry
+        uint32_t vertexCount = 0;
+
+        // Set when the vertices live inside a shared pool
+        GeometryPool *pool = nullptr;
+        GeometryRange range;
     };
 
     struct IndexBuffer
     {
+        // No indices, the primitive draws its vertices in order
+        IndexBuffer() = default;
+
         IndexBuffer(std::vector<uint32_t> &&_indices);
 
+        IndexBuffer(std::vector<uint32_t> &&_indices, GeometryPool &_pool);
+
+        IndexBuffer(const IndexBuffer &) = delete;
+
+        IndexBuffer(IndexBuffer &&_indexBuffer) noexcept;
+
+        IndexBuffer &operator=(const IndexBuffer &) = delete;
+
+        IndexBuffer &operator=(IndexBuffer &&_indexBuffer) noexcept;
+
+        ~IndexBuffer();
+
+        void Release();
+
+        void ReleaseCPUData();
+
+        bool HasCPUData() const
+        {
+            return indices.size() == indexCount;
+        }
+
 #if defined(OPENGL)
-        GLuint elementBufferID;
+        GLuint elementBufferID = 0;
 #elif defined(VULKAN)
 #endif
         std::vector<uint32_t> indices;
+        uint32_t indexCount = 0;
+
+        GeometryPool *pool = nullptr;
+        GeometryRange range;
     };
 
     struct Sampler
@@ -62,10 +150,63 @@ namespace DadEngine
 #endif
     };
 
+    // Texel layouts a Texture can hold, the BC formats are stored in blocks
+    // of 4x4 texels and uploaded as they are
+    enum class TextureFormat : uint8_t
+    {
+        RGB8,
+        RGBA8,
+        BC1, // RGB, 8 bytes per block
+        BC3, // RGBA, 16 bytes per block
+        BC4, // R, 8 bytes per block
+        BC5, // RG, 16 bytes per block
+        BC7  // RGBA, 16 bytes per block
+    };
+
+    bool IsBlockCompressed(TextureFormat _format);
+
+    // Bytes taken by a level of the given size
+    size_t GetTextureLevelSize(TextureFormat _format, int32_t _width, int32_t _height);
+
+    // Mip level of a prebuilt chain, the data is not owned
+    struct TextureLevel
+    {
+        const uint8_t *data;
+        size_t size;
+        int32_t width;
+        int32_t height;
+    };
+
+    // Materials share textures through std::shared_ptr, the GPU texture is
+    // deleted with the last material referencing it
     struct Texture
     {
-        Texture() = default;
-        Texture(uint8_t *_data, int32_t _width, int32_t _height, int32_t _channels, Sampler _sampler, bool _hasAlpha);
+        // Uploads the RGB or RGBA pixels and generates their mips, the
+        // caller keeps owning them
+        Texture(const uint8_t *_data, int32_t _width, int32_t _height, int32_t _channels, Sampler _sampler, bool _hasAlpha);
+
+        // Uploads a prebuilt mip chain, the first level being the largest.
+        // Levels before _firstLevel are left out for UploadLevel to stream
+        // them in later
+        Texture(TextureFormat _format, const std::vector<TextureLevel> &_levels, Sampler _sampler, bool _hasAlpha,
+                uint32_t _firstLevel = 0U);
+
+        Texture(const Texture &) = delete;
+
+        Texture &operator=(const Texture &) = delete;
+
+        ~Texture();
+
+        // Uploads the level right before residentLevel, which then samples
+        // from it
+        void UploadLevel(const TextureLevel &_level);
+
+        // Stops sampling from residentLevel and frees it, the last level
+        // always stays
+        void ReleaseLevel();
+
+        // Bytes taken by the levels from residentLevel on
+        size_t GetResidentSize() const;
 
 #if defined(OPENGL)
         GLuint textureID;
@@ -73,58 +214,90 @@ namespace DadEngine
 #endif
         Sampler sampler;
 
-        uint8_t *data = nullptr;
         int32_t width;
         int32_t height;
         int32_t channels;
         bool hasAlpha;
+
+        TextureFormat format   = TextureFormat::RGB8;
+        uint32_t levelCount    = 1;
+        uint32_t residentLevel = 0;
     };
 
     // PBR metallic roughness
     struct PBRMaterial
     {
         Vector4 baseColorFactor = { 1.f, 1.f, 1.f, 1.f };
-        Texture baseColorTexture;
+        std::shared_ptr<Texture> baseColorTexture;
 
         float metallicFactor  = 1.f;
         float roughnessFactor = 1.f;
-        Texture metallicRoughnessTexture;
+        std::shared_ptr<Texture> metallicRoughnessTexture;
 
         float normalScale = 1.f;
-        Texture normalTexture;
+        std::shared_ptr<Texture> normalTexture;
 
         float occlusionStrength = 1.f;
-        Texture occlusionTexture;
+        std::shared_ptr<Texture> occlusionTexture;
 
         Vector3 emissiveFactor = { 1.f, 1.f, 1.f };
-        Texture emissiveTexture;
+        std::shared_ptr<Texture> emissiveTexture;
 
-        bool hasTransparency;
+        bool hasTransparency = false;
+
+        // Index of the material inside the asset it was loaded from, primitives
+        // sharing it can be batched together
+        uint32_t id = ~0U;
     };
 
+    AABB ComputeBounds(const std::vector<Vertex> &_vertices);
+
     struct Primitive
     {
         Primitive(VertexBuffer &&_vertexBuffer, uint32_t _drawMode, PBRMaterial _material)
-            : vertices(_vertexBuffer), indices({}), drawMode(_drawMode), material(_material)
-        {}
+            : vertices(std::move(_vertexBuffer)), drawMode(_drawMode), material(std::move(_material))
+        {
+            bounds = ComputeBounds(vertices.vertices);
+        }
 
         Primitive(VertexBuffer &&_vertexBuffer, IndexBuffer &&_indexBuffer, uint32_t _drawMode, PBRMaterial _material)
-            : vertices(_vertexBuffer),
-              indices(_indexBuffer),
+            : vertices(std::move(_vertexBuffer)),
+              indices(std::move(_indexBuffer)),
               drawMode(_drawMode),
-              material(_material)
-        {}
+              material(std::move(_material))
+        {
+            bounds = ComputeBounds(vertices.vertices);
+        }
+
+        // Bounds computed offline, e.g. by the cooker
+        Primitive(VertexBuffer &&_vertexBuffer, IndexBuffer &&_indexBuffer, uint32_t _drawMode, PBRMaterial _material, AABB _bounds)
+            : vertices(std::move(_vertexBuffer)),
+              indices(std::move(_indexBuffer)),
+              drawMode(_drawMode),
+              material(std::move(_material)),
+              bounds(_bounds)
+        {
+        }
 
         void Render();
 
+        // Issues the draw without binding the vertex array
+        void Draw();
+
         VertexBuffer vertices;
         IndexBuffer indices;
 #if defined(OPENGL)
         uint32_t drawMode = GL_TRIANGLES;
 #elif defined(VULKAN)
         uint32_t drawMode = 0;
+#else
+        // Headless builds keep the glTF mode, which matches the OpenGL one
+        uint32_t drawMode = 4U;
 #endif
         PBRMaterial material;
+
+        // Object space bounds of the vertices
+        AABB bounds;
     };
 
     class Mesh
@@ -132,6 +305,20 @@ namespace DadEngine
         public:
         void Render();
 
+        // Only renders the listed primitives, e.g. the ones surviving culling
+        void Render(const std::vector<uint32_t> &_primitiveIndices);
+
+        // Merges the triangle list primitives sharing the same material and
+        // the same cell of a _cellsPerAxis wide grid over the mesh bounds into
+        // a single vertex and index range, allocated from the pool if any.
+        // The cells keep the merged bounds small enough to be culled
+        void Batch(GeometryPool *_pool = nullptr, uint32_t _cellsPerAxis = 2U);
+
+        // Frees the CPU copy of the geometry once nothing reads it anymore,
+        // batching then leaves the primitives as they are and the CPU passes
+        // see them empty
+        void ReleaseCPUData();
+
         std::vector<Primitive> m_primitives;
     };
 
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "model.hpp"
+
+namespace DadEngine
+{
+    class Camera;
+    class Matrix4x4;
+
+    struct TextureStreamingSettings
+    {
+        // Bytes the levels of the streamed textures may take on the GPU, 0
+        // disables streaming and textures upload their whole chain
+        size_t budget = 0U;
+
+        // Bytes uploaded per frame at most, at least one level goes through
+        // so a level larger than it still streams in
+        size_t uploadBytesPerFrame = 8U << 20U;
+
+        // Textures start with their levels up to this size, the larger ones
+        // are streamed in once the camera needs them
+        int32_t initialSize = 64;
+
+        // Added to the level computed from the texel density, positive
+        // values trade sharpness for memory
+        float mipBias = 0.f;
+    };
+
+    // World units per UV unit of each primitive of the mesh, averaged over
+    // its triangles. 0 for the primitives without any UV area
+    std::vector<float> ComputeUVDensities(const Mesh &_mesh);
+
+    // Keeps the textures under a GPU memory budget. They start with their
+    // smallest levels, then the larger ones are uploaded as the camera gets
+    // close enough to need them, at most a few per frame. Over the budget
+    // the levels of the textures used the longest time ago are released
+    // first. Only used from the thread owning the rendering context
+    class TextureStreamer
+    {
+        public:
+        TextureStreamer() = default;
+
+        TextureStreamer(const TextureStreamer &) = delete;
+
+        TextureStreamer &operator=(const TextureStreamer &) = delete;
+
+        const TextureStreamingSettings &GetSettings() const
+        {
+            return m_settings;
+        }
+
+        // Releases levels right away when the budget shrinks
+        void SetSettings(const TextureStreamingSettings &_settings);
+
+        bool IsEnabled() const
+        {
+            return m_settings.budget != 0U;
+        }
+
+        // Drop in for the Texture level constructor. With streaming enabled
+        // the texture only gets its small levels and the chain is kept to
+        // stream the others. _owner keeps the level bytes alive meanwhile,
+        // without one they are copied
+        std::shared_ptr<Texture> CreateTexture(TextureFormat _format, const std::vector<TextureLevel> &_levels,
+                                               Sampler _sampler, bool _hasAlpha,
+                                               std::shared_ptr<const void> _owner = nullptr);
+
+        // Every texture only needs its tail until the primitives drawn with
+        // it are added for the frame
+        void BeginFrame();
+
+        // Computes the level each texture of the visible primitives needs
+        // from its texel density on screen. _uvDensities comes from
+        // ComputeUVDensities for the mesh, every mesh drawn in the frame is
+        // added with its own transform
+        void AddVisiblePrimitives(const Camera &_camera, int32_t _viewportHeight, const Mesh &_mesh,
+                                  const std::vector<float> &_uvDensities, const Matrix4x4 &_model,
+                                  const std::vector<uint32_t> &_visiblePrimitives);
+
+        // Same for a primitive already placed in the world, e.g. posed by
+        // skinning. _unitsPerUV is its UV density in world units
+        void AddVisiblePrimitive(const Camera &_camera, int32_t _viewportHeight, const Primitive &_primitive,
+                                 float _unitsPerUV, const AABB &_worldBounds);
+
+        // Streams in the levels the added primitives need and out the ones
+        // over the budget
+        void EndFrame();
+
+        // Bytes the streamed textures take on the GPU
+        size_t GetResidentSize() const
+        {
+            return m_residentSize;
+        }
+
+        size_t GetTextureCount() const
+        {
+            return m_textures.size();
+        }
+
+        // Textures which have every level they need
+        size_t GetCompleteTextureCount() const;
+
+        static TextureStreamer &Get();
+
+        private:
+        struct StreamedTexture
+        {
+            std::weak_ptr<Texture> texture;
+
+            // The levels before the tail, which always stays on the GPU
+            std::vector<TextureLevel> levels;
+            std::shared_ptr<const void> owner;
+            uint32_t tailLevel = 0U;
+
+            // Largest level the camera needed this frame
+            uint32_t wantedLevel   = 0U;
+            uint64_t lastUsedFrame = 0U;
+            size_t residentSize    = 0U;
+        };
+
+        // Forgets the textures deleted with their last material
+        void removeExpiredTextures();
+
+        void requestLevel(const Texture &_texture, float _uvPerPixel);
+
+        void streamLevels();
+
+        // Releases the levels nobody needs, least recently used textures
+        // first, until _size more bytes fit the budget
+        bool makeRoom(size_t _size);
+
+        TextureStreamingSettings m_settings;
+        std::vector<StreamedTexture> m_textures;
+        std::unordered_map<const Texture *, uint32_t> m_indices;
+        size_t m_residentSize = 0U;
+        uint64_t m_frame      = 0U;
+    };
+} // namespace DadEngine
@@ -22,8 +22,11 @@
 
 #define OPENGL_FUNCTIONS                                           \
     X(PFNGLGENBUFFERSPROC, glGenBuffers)                           \
+    X(PFNGLDELETEBUFFERSPROC, glDeleteBuffers)                     \
     X(PFNGLBINDBUFFERPROC, glBindBuffer)                           \
     X(PFNGLBUFFERDATAPROC, glBufferData)                           \
+    X(PFNGLBUFFERSUBDATAPROC, glBufferSubData)                     \
+    X(PFNGLCOPYBUFFERSUBDATAPROC, glCopyBufferSubData)             \
     X(PFNGLCREATESHADERPROC, glCreateShader)                       \
     X(PFNGLSHADERSOURCEPROC, glShaderSource)                       \
     X(PFNGLCOMPILESHADERPROC, glCompileShader)                     \
@@ -36,9 +39,12 @@
     X(PFNGLGETPROGRAMINFOLOGPROC, glGetProgramInfoLog)             \
     X(PFNGLUSEPROGRAMPROC, glUseProgram)                           \
     X(PFNGLVERTEXATTRIBPOINTERPROC, glVertexAttribPointer)         \
+    X(PFNGLVERTEXATTRIBIPOINTERPROC, glVertexAttribIPointer)       \
     X(PFNGLENABLEVERTEXATTRIBARRAYPROC, glEnableVertexAttribArray) \
     X(PFNGLGENVERTEXARRAYSPROC, glGenVertexArrays)                 \
+    X(PFNGLDELETEVERTEXARRAYSPROC, glDeleteVertexArrays)           \
     X(PFNGLBINDVERTEXARRAYPROC, glBindVertexArray)                 \
+    X(PFNGLDRAWELEMENTSBASEVERTEXPROC, glDrawElementsBaseVertex)   \
     X(PFNGLGETUNIFORMLOCATIONPROC, glGetUniformLocation)           \
     X(PFNGLUNIFORMMATRIX2FVPROC, glUniformMatrix2fv)               \
     X(PFNGLUNIFORMMATRIX3FVPROC, glUniformMatrix3fv)               \
@@ -70,7 +76,8 @@
     X(PFNGLDEBUGMESSAGECALLBACKPROC, glDebugMessageCallback)       \
     X(PFNGLDEBUGMESSAGECONTROLPROC, glDebugMessageControl)         \
     X(PFNGLACTIVETEXTUREPROC, glActiveTexture)                     \
-    X(PFNGLGENERATEMIPMAPPROC, glGenerateMipmap)
+    X(PFNGLGENERATEMIPMAPPROC, glGenerateMipmap)                   \
+    X(PFNGLCOMPRESSEDTEXIMAGE2DPROC, glCompressedTexImage2D)
 
 #define X(type, name) inline type name;
 OPENGL_FUNCTIONS
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstdint>
+
+#include <utility>
+#include <vector>
+
+#include "math/matrix/matrix3x4.hpp"
+#include "math/quaternion/quaternion.hpp"
+#include "math/vector/vector3.hpp"
+
+namespace DadEngine
+{
+    class ThreadPool;
+
+    constexpr uint32_t INVALID_NODE = ~0U;
+
+    // Node transforms stored as parallel arrays and flattened depth first,
+    // so a parent always comes before its children and every subtree is a
+    // contiguous range. Only the nodes whose local transform changed, and
+    // their descendants, get their world matrix recomputed
+    class SceneGraph
+    {
+        public:
+        // The parent must be the last added node or one of its ancestors to
+        // keep the depth first order, INVALID_NODE is returned otherwise
+        uint32_t AddNode(uint32_t _parent,
+                         const Vector3 &_translation,
+                         const Quaternion &_rotation,
+                         const Vector3 &_scale,
+                         uint32_t _mesh = INVALID_NODE,
+                         uint32_t _skin = INVALID_NODE);
+
+        void Clear();
+
+        uint32_t GetNodeCount() const
+        {
+            return static_cast<uint32_t>(m_parents.size());
+        }
+
+        uint32_t GetParent(uint32_t _node) const
+        {
+            return m_parents[_node];
+        }
+
+        // Nodes of the subtree are [_node, _node + GetSubtreeSize(_node))
+        uint32_t GetSubtreeSize(uint32_t _node) const
+        {
+            return m_subtreeSizes[_node];
+        }
+
+        // Index in the meshes loaded with the graph, INVALID_NODE for none
+        uint32_t GetMesh(uint32_t _node) const
+        {
+            return m_meshes[_node];
+        }
+
+        // Index in the skins loaded with the graph, INVALID_NODE for none
+        uint32_t GetSkin(uint32_t _node) const
+        {
+            return m_skins[_node];
+        }
+
+        const Vector3 &GetTranslation(uint32_t _node) const
+        {
+            return m_translations[_node];
+        }
+
+        const Quaternion &GetRotation(uint32_t _node) const
+        {
+            return m_rotations[_node];
+        }
+
+        const Vector3 &GetScale(uint32_t _node) const
+        {
+            return m_scales[_node];
+        }
+
+        void SetTranslation(uint32_t _node, const Vector3 &_translation)
+        {
+            m_translations[_node] = _translation;
+            MarkDirty(_node);
+        }
+
+        void SetRotation(uint32_t _node, const Quaternion &_rotation)
+        {
+            m_rotations[_node] = _rotation;
+            MarkDirty(_node);
+        }
+
+        void SetScale(uint32_t _node, const Vector3 &_scale)
+        {
+            m_scales[_node] = _scale;
+            MarkDirty(_node);
+        }
+
+        // Local transforms for the systems writing many nodes at once, they
+        // call MarkDirty on the nodes they change
+        Vector3 *GetTranslations()
+        {
+            return m_translations.data();
+        }
+
+        Quaternion *GetRotations()
+        {
+            return m_rotations.data();
+        }
+
+        Vector3 *GetScales()
+        {
+            return m_scales.data();
+        }
+
+        // Safe to call from several threads for different nodes
+        void MarkDirty(uint32_t _node)
+        {
+            m_dirty[_node] = 1U;
+        }
+
+        // Recomputes the world matrices of the dirty nodes and their
+        // descendants in a single pass over the arrays. With a pool the
+        // independent subtrees are updated in parallel
+        void UpdateWorldMatrices(ThreadPool *_threadPool = nullptr);
+
+        const Matrix3x4 &GetWorldMatrix(uint32_t _node) const
+        {
+            return m_worldMatrices[_node];
+        }
+
+        const std::vector<Matrix3x4> &GetWorldMatrices() const
+        {
+            return m_worldMatrices;
+        }
+
+        // Whether the last update changed the world matrix of the node
+        bool HasWorldChanged(uint32_t _node) const
+        {
+            return m_worldChanged[_node] != 0U;
+        }
+
+        private:
+        // Splits the graph into subtrees of a bounded size, updated in
+        // parallel once their ancestors are
+        void buildJobs();
+
+        void updateRange(uint32_t _begin, uint32_t _end);
+
+        std::vector<uint32_t> m_parents;
+        std::vector<uint32_t> m_subtreeSizes;
+        std::vector<uint32_t> m_meshes;
+        std::vector<uint32_t> m_skins;
+
+        std::vector<Vector3> m_translations;
+        std::vector<Quaternion> m_rotations;
+        std::vector<Vector3> m_scales;
+        std::vector<Matrix3x4> m_worldMatrices;
+
+        // Bytes rather than std::vector<bool> so threads write them freely
+        std::vector<uint8_t> m_dirty;
+        std::vector<uint8_t> m_worldChanged;
+
+        // Ancestors of the subtrees too large for a single job, in order
+        std::vector<uint32_t> m_spineNodes;
+        std::vector<std::pair<uint32_t, uint32_t>> m_jobs; // [begin, end)
+        bool m_jobsValid = false;
+    };
+} // namespace DadEngine
@@ -0,0 +1,545 @@
+#include "animation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "helpers/simd.hpp"
+#include "helpers/thread-pool.hpp"
+#include "scene/scene-graph.hpp"
+#include "quaternion/quaternion.hpp"
+#include "vector/vector3.hpp"
+
+namespace DadEngine
+{
+    namespace
+    {
+        // Keys walked from the cursor before falling back to a binary search,
+        // playing forward at a normal rate moves by one key at most
+        constexpr uint32_t LINEAR_SEARCH_KEYS = 4U;
+
+        // Below this many instances per job the threading costs more than
+        // the sampling
+        constexpr uint32_t INSTANCES_PER_JOB = 8U;
+
+        // Values around the sampled time, the tangents are only set for
+        // cubic splines
+        struct ChannelKeys
+        {
+            const float *from       = nullptr;
+            const float *to         = nullptr;
+            const float *outTangent = nullptr; // Of the from key
+            const float *inTangent  = nullptr; // Of the to key
+            float t                 = 0.f;
+            float duration          = 0.f; // Between the two keys
+        };
+
+        // Last key at or before _time, searched from the cached one
+        uint32_t FindKey(const float *_times, uint32_t _keyCount, float _time, uint32_t &_cursor)
+        {
+            uint32_t key = _cursor < _keyCount ? _cursor : 0U;
+
+            if (_times[key] > _time)
+            {
+                // Looped or seeked backward
+                key = static_cast<uint32_t>(std::upper_bound(_times, _times + key, _time) - _times);
+                key = key > 0U ? key - 1U : 0U;
+            }
+            else
+            {
+                for (uint32_t step = 0U; key + 1U < _keyCount && _times[key + 1U] <= _time; step++)
+                {
+                    if (step == LINEAR_SEARCH_KEYS)
+                    {
+                        key = static_cast<uint32_t>(
+                                  std::upper_bound(_times + key + 1U, _times + _keyCount, _time) - _times)
+                              - 1U;
+                        break;
+                    }
+
+                    key++;
+                }
+            }
+
+            _cursor = key;
+
+            return key;
+        }
+
+        // Fixes the nlerp factor so the rotation speed is close to the slerp
+        // one, from the angle cosine. Fitted by Arseny Kapoulkine in
+        // "Approximating slerp"
+        float CorrectNlerpFactor(float _t, float _cosAngle)
+        {
+            float a = 1.0904f + _cosAngle * (-3.2452f + _cosAngle * (3.55645f - _cosAngle * 1.43519f));
+            float b = 0.848013f + _cosAngle * (-1.06021f + _cosAngle * 0.215638f);
+            float k = a * (_t - 0.5f) * (_t - 0.5f) + b;
+
+            return _t + _t * (_t - 0.5f) * (_t - 1.f) * k;
+        }
+
+        void Lerp(const ChannelKeys &_keys, uint32_t _count, float *_result)
+        {
+            for (uint32_t component = 0U; component < _count; component++)
+            {
+                _result[component]
+                    = _keys.from[component] + (_keys.to[component] - _keys.from[component]) * _keys.t;
+            }
+        }
+
+        void Normalize(float *_quaternion)
+        {
+            float length = std::sqrt(_quaternion[0] * _quaternion[0] + _quaternion[1] * _quaternion[1]
+                                     + _quaternion[2] * _quaternion[2] + _quaternion[3] * _quaternion[3]);
+
+            for (uint32_t component = 0U; component < 4U; component++)
+            {
+                _quaternion[component] /= length;
+            }
+        }
+
+        // Along the shortest path
+        void Nlerp(const ChannelKeys &_keys, float *_result)
+        {
+            float cosAngle = _keys.from[0] * _keys.to[0] + _keys.from[1] * _keys.to[1]
+                             + _keys.from[2] * _keys.to[2] + _keys.from[3] * _keys.to[3];
+            float sign = cosAngle < 0.f ? -1.f : 1.f;
+            float t    = CorrectNlerpFactor(_keys.t, cosAngle * sign);
+
+            for (uint32_t component = 0U; component < 4U; component++)
+            {
+                _result[component] = _keys.from[component] + (_keys.to[component] * sign - _keys.from[component]) * t;
+            }
+
+            Normalize(_result);
+        }
+
+        // The tangents are scaled by the key interval, as glTF requires
+        void Hermite(const ChannelKeys &_keys, uint32_t _count, float *_result)
+        {
+            float t  = _keys.t;
+            float t2 = t * t;
+            float t3 = t2 * t;
+
+            float fromWeight       = 2.f * t3 - 3.f * t2 + 1.f;
+            float outTangentWeight = (t3 - 2.f * t2 + t) * _keys.duration;
+            float toWeight         = 3.f * t2 - 2.f * t3;
+            float inTangentWeight  = (t3 - t2) * _keys.duration;
+
+            for (uint32_t component = 0U; component < _count; component++)
+            {
+                _result[component] = fromWeight * _keys.from[component]
+                                     + outTangentWeight * _keys.outTangent[component]
+                                     + toWeight * _keys.to[component]
+                                     + inTangentWeight * _keys.inTangent[component];
+            }
+        }
+
+#if defined(DADENGINE_SSE2)
+        // The keys of four channels become a register per component, one
+        // channel per lane. Keys are padded to four floats
+        void LoadKeys(const float *const *_keys, __m128 *_components)
+        {
+            _components[0] = _mm_loadu_ps(_keys[0]);
+            _components[1] = _mm_loadu_ps(_keys[1]);
+            _components[2] = _mm_loadu_ps(_keys[2]);
+            _components[3] = _mm_loadu_ps(_keys[3]);
+            _MM_TRANSPOSE4_PS(_components[0], _components[1], _components[2], _components[3]);
+        }
+
+        void StoreResults(__m128 *_components, float (*_results)[4])
+        {
+            _MM_TRANSPOSE4_PS(_components[0], _components[1], _components[2], _components[3]);
+            _mm_storeu_ps(_results[0], _components[0]);
+            _mm_storeu_ps(_results[1], _components[1]);
+            _mm_storeu_ps(_results[2], _components[2]);
+            _mm_storeu_ps(_results[3], _components[3]);
+        }
+
+        __m128 Dot4(const __m128 *_a, const __m128 *_b)
+        {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_a[0], _b[0]), _mm_mul_ps(_a[1], _b[1])),
+                              _mm_add_ps(_mm_mul_ps(_a[2], _b[2]), _mm_mul_ps(_a[3], _b[3])));
+        }
+
+        void Normalize4(__m128 *_quaternions)
+        {
+            __m128 inverseLength = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(Dot4(_quaternions, _quaternions)));
+
+            for (uint32_t component = 0U; component < 4U; component++)
+            {
+                _quaternions[component] = _mm_mul_ps(_quaternions[component], inverseLength);
+            }
+        }
+
+        // Four channels of one kernel at once, the lane order follows _keys
+        void Sample4(const ChannelKeys *_keys, bool _rotation, bool _cubic, float (*_results)[4])
+        {
+            const float *from[4] = { _keys[0].from, _keys[1].from, _keys[2].from, _keys[3].from };
+            const float *to[4]   = { _keys[0].to, _keys[1].to, _keys[2].to, _keys[3].to };
+
+            __m128 t = _mm_setr_ps(_keys[0].t, _keys[1].t, _keys[2].t, _keys[3].t);
+            __m128 a[4], b[4], result[4];
+            LoadKeys(from, a);
+            LoadKeys(to, b);
+
+            if (_cubic)
+            {
+                const float *outTangents[4]
+                    = { _keys[0].outTangent, _keys[1].outTangent, _keys[2].outTangent, _keys[3].outTangent };
+                const float *inTangents[4]
+                    = { _keys[0].inTangent, _keys[1].inTangent, _keys[2].inTangent, _keys[3].inTangent };
+
+                __m128 outTangent[4], inTangent[4];
+                LoadKeys(outTangents, outTangent);
+                LoadKeys(inTangents, inTangent);
+
+                __m128 duration = _mm_setr_ps(_keys[0].duration, _keys[1].duration, _keys[2].duration,
+                                              _keys[3].duration);
+                __m128 t2       = _mm_mul_ps(t, t);
+                __m128 t3       = _mm_mul_ps(t2, t);
+                __m128 two      = _mm_set1_ps(2.f);
+                __m128 three    = _mm_set1_ps(3.f);
+
+                __m128 fromWeight = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(two, t3), _mm_mul_ps(three, t2)),
+                                               _mm_set1_ps(1.f));
+                __m128 outTangentWeight
+                    = _mm_mul_ps(_mm_add_ps(_mm_sub_ps(t3, _mm_mul_ps(two, t2)), t), duration);
+                __m128 toWeight        = _mm_sub_ps(_mm_mul_ps(three, t2), _mm_mul_ps(two, t3));
+                __m128 inTangentWeight = _mm_mul_ps(_mm_sub_ps(t3, t2), duration);
+
+                for (uint32_t component = 0U; component < 4U; component++)
+                {
+                    result[component] = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(fromWeight, a[component]),
+                                   _mm_mul_ps(outTangentWeight, outTangent[component])),
+                        _mm_add_ps(_mm_mul_ps(toWeight, b[component]),
+                                   _mm_mul_ps(inTangentWeight, inTangent[component])));
+                }
+            }
+            else
+            {
+                if (_rotation)
+                {
+                    // Shortest path, the sign bit of the cosine flips the
+                    // second rotation and makes the cosine positive
+                    __m128 cosAngle = Dot4(a, b);
+                    __m128 sign     = _mm_and_ps(cosAngle, _mm_set1_ps(-0.f));
+                    cosAngle        = _mm_xor_ps(cosAngle, sign);
+
+                    for (uint32_t component = 0U; component < 4U; component++)
+                    {
+                        b[component] = _mm_xor_ps(b[component], sign);
+                    }
+
+                    // Same polynomials as CorrectNlerpFactor
+                    __m128 fitA = _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(cosAngle, _mm_set1_ps(1.43519f)));
+                    fitA        = _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(cosAngle, fitA));
+                    fitA        = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(cosAngle, fitA));
+
+                    __m128 fitB = _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(cosAngle, _mm_set1_ps(0.215638f)));
+                    fitB        = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(cosAngle, fitB));
+
+                    __m128 half = _mm_sub_ps(t, _mm_set1_ps(0.5f));
+                    __m128 k    = _mm_add_ps(_mm_mul_ps(fitA, _mm_mul_ps(half, half)), fitB);
+
+                    t = _mm_add_ps(t, _mm_mul_ps(_mm_mul_ps(t, half), _mm_mul_ps(_mm_sub_ps(t, _mm_set1_ps(1.f)), k)));
+                }
+
+                for (uint32_t component = 0U; component < 4U; component++)
+                {
+                    result[component] = _mm_add_ps(a[component], _mm_mul_ps(_mm_sub_ps(b[component], a[component]), t));
+                }
+            }
+
+            if (_rotation)
+            {
+                Normalize4(result);
+            }
+
+            StoreResults(result, _results);
+        }
+#endif
+    } // namespace
+
+    uint32_t AnimationClip::AddSampler(std::span<const float> _times,
+                                       std::span<const float> _values,
+                                       uint32_t _componentCount,
+                                       AnimationInterpolation _interpolation)
+    {
+        size_t valuesPerKey = _componentCount * (_interpolation == AnimationInterpolation::CubicSpline ? 3U : 1U);
+
+        if (_times.empty() || _componentCount == 0U || _values.size() != _times.size() * valuesPerKey)
+        {
+            return ~0U;
+        }
+
+        SamplerData sampler;
+        sampler.timesOffset    = static_cast<uint32_t>(m_times.size());
+        sampler.keyCount       = static_cast<uint32_t>(_times.size());
+        sampler.valuesOffset   = static_cast<uint32_t>(m_values.size());
+        sampler.valueStride    = std::max(_componentCount, 4U);
+        sampler.componentCount = _componentCount;
+        sampler.interpolation  = _interpolation;
+
+        m_times.insert(m_times.end(), _times.begin(), _times.end());
+
+        // Vectors get a zero fourth component to be loaded as a register
+        size_t valueCount = _values.size() / _componentCount;
+        m_values.resize(m_values.size() + valueCount * sampler.valueStride, 0.f);
+        for (size_t value = 0U; value < valueCount; value++)
+        {
+            std::copy_n(&_values[value * _componentCount], _componentCount,
+                        &m_values[sampler.valuesOffset + value * sampler.valueStride]);
+        }
+
+        m_duration = std::max(m_duration, _times.back());
+
+        m_samplers.push_back(sampler);
+
+        return static_cast<uint32_t>(m_samplers.size() - 1U);
+    }
+
+    bool AnimationClip::AddChannel(uint32_t _sampler, uint32_t _node, AnimationPath _path)
+    {
+        if (_sampler >= m_samplers.size())
+        {
+            return false;
+        }
+
+        const SamplerData &sampler = m_samplers[_sampler];
+        if (_path != AnimationPath::Weights
+            && sampler.componentCount != (_path == AnimationPath::Rotation ? 4U : 3U))
+        {
+            return false;
+        }
+
+        AnimationChannel channel { _sampler, _node, _path };
+        if (_path == AnimationPath::Weights)
+        {
+            channel.weightsOffset = m_weightCount;
+            m_weightCount += sampler.componentCount;
+        }
+
+        auto kernel = static_cast<uint32_t>(getKernel(sampler, _path));
+        m_channels.insert(m_channels.begin() + m_kernelEnds[kernel], channel);
+
+        for (; kernel < KERNEL_COUNT; kernel++)
+        {
+            m_kernelEnds[kernel]++;
+        }
+
+        return true;
+    }
+
+    void AnimationClip::Sample(float _time,
+                               uint32_t _nodeOffset,
+                               uint32_t *_cursors,
+                               float *_weights,
+                               SceneGraph &_graph) const
+    {
+        Vector3 *translations = _graph.GetTranslations();
+        Quaternion *rotations = _graph.GetRotations();
+        Vector3 *scales       = _graph.GetScales();
+
+        auto findKeys = [&](uint32_t _channel) {
+            const SamplerData &sampler = m_samplers[m_channels[_channel].sampler];
+            const float *times         = &m_times[sampler.timesOffset];
+            bool cubic                 = sampler.interpolation == AnimationInterpolation::CubicSpline;
+
+            uint32_t key     = FindKey(times, sampler.keyCount, _time, _cursors[_channel]);
+            uint32_t nextKey = key;
+
+            ChannelKeys keys;
+
+            // The first and last values are held outside of the keys
+            if (key + 1U < sampler.keyCount && _time > times[key])
+            {
+                nextKey       = key + 1U;
+                keys.duration = times[nextKey] - times[key];
+
+                if (sampler.interpolation != AnimationInterpolation::Step && keys.duration > 0.f)
+                {
+                    keys.t = (_time - times[key]) / keys.duration;
+                }
+            }
+
+            // Cubic spline keys are the in tangent, the value and the out one
+            uint32_t keyStride = sampler.valueStride * (cubic ? 3U : 1U);
+            const float *value = &m_values[sampler.valuesOffset + (cubic ? sampler.valueStride : 0U)];
+
+            keys.from = value + key * keyStride;
+            keys.to   = value + nextKey * keyStride;
+
+            if (cubic)
+            {
+                keys.outTangent = keys.from + sampler.valueStride;
+                keys.inTangent  = keys.to - sampler.valueStride;
+            }
+
+            return keys;
+        };
+
+        auto store = [&](const AnimationChannel &_channel, const float *_value) {
+            uint32_t node = _channel.node + _nodeOffset;
+
+            switch (_channel.path)
+            {
+            case AnimationPath::Translation:
+                translations[node] = Vector3(_value[0], _value[1], _value[2]);
+                break;
+            case AnimationPath::Rotation:
+                rotations[node] = Quaternion(_value[3], _value[0], _value[1], _value[2]);
+                break;
+            case AnimationPath::Scale:
+                scales[node] = Vector3(_value[0], _value[1], _value[2]);
+                break;
+            default:
+                return;
+            }
+
+            _graph.MarkDirty(node);
+        };
+
+        uint32_t channel = 0U;
+        for (uint32_t kernelIndex = 0U; kernelIndex < KERNEL_COUNT; kernelIndex++)
+        {
+            auto kernel   = static_cast<Kernel>(kernelIndex);
+            bool rotation = kernel == Kernel::LinearRotation || kernel == Kernel::CubicRotation;
+            bool cubic    = kernel == Kernel::CubicVector || kernel == Kernel::CubicRotation;
+            uint32_t end  = m_kernelEnds[kernelIndex];
+
+            // Morph target weights have any number of components and are
+            // sampled one channel at a time
+            if (kernel == Kernel::Weights)
+            {
+                for (; channel < end; channel++)
+                {
+                    const AnimationChannel &weights = m_channels[channel];
+                    const SamplerData &sampler      = m_samplers[weights.sampler];
+                    ChannelKeys keys                = findKeys(channel);
+
+                    if (sampler.interpolation == AnimationInterpolation::CubicSpline)
+                    {
+                        Hermite(keys, sampler.componentCount, _weights + weights.weightsOffset);
+                    }
+                    else
+                    {
+                        Lerp(keys, sampler.componentCount, _weights + weights.weightsOffset);
+                    }
+                }
+
+                continue;
+            }
+
+#if defined(DADENGINE_SSE2)
+            for (; channel + 4U <= end; channel += 4U)
+            {
+                ChannelKeys keys[4] = { findKeys(channel), findKeys(channel + 1U), findKeys(channel + 2U),
+                                        findKeys(channel + 3U) };
+
+                float results[4][4];
+                Sample4(keys, rotation, cubic, results);
+
+                for (uint32_t lane = 0U; lane < 4U; lane++)
+                {
+                    store(m_channels[channel + lane], results[lane]);
+                }
+            }
+#endif
+
+            for (; channel < end; channel++)
+            {
+                ChannelKeys keys = findKeys(channel);
+                float result[4];
+
+                if (cubic)
+                {
+                    Hermite(keys, 4U, result);
+                    if (rotation)
+                    {
+                        Normalize(result);
+                    }
+                }
+                else if (rotation)
+                {
+                    Nlerp(keys, result);
+                }
+                else
+                {
+                    Lerp(keys, 4U, result);
+                }
+
+                store(m_channels[channel], result);
+            }
+        }
+    }
+
+    AnimationClip::Kernel AnimationClip::getKernel(const SamplerData &_sampler, AnimationPath _path)
+    {
+        bool cubic = _sampler.interpolation == AnimationInterpolation::CubicSpline;
+
+        switch (_path)
+        {
+        case AnimationPath::Rotation:
+            return cubic ? Kernel::CubicRotation : Kernel::LinearRotation;
+        case AnimationPath::Weights:
+            return Kernel::Weights;
+        default:
+            return cubic ? Kernel::CubicVector : Kernel::LinearVector;
+        }
+    }
+
+    AnimationInstance::AnimationInstance(const AnimationClip &_clip, uint32_t _nodeOffset)
+        : m_clip(&_clip), m_nodeOffset(_nodeOffset), m_cursors(_clip.GetChannelCount(), 0U),
+          m_weights(_clip.GetWeightCount(), 0.f)
+    {
+    }
+
+    void AnimationInstance::Advance(float _deltaTime)
+    {
+        float duration = m_clip->GetDuration();
+
+        m_time += _deltaTime;
+
+        if (m_looping && duration > 0.f)
+        {
+            m_time = std::fmod(m_time, duration);
+            if (m_time < 0.f)
+            {
+                m_time += duration;
+            }
+        }
+        else
+        {
+            m_time = std::clamp(m_time, 0.f, duration);
+        }
+    }
+
+    void AnimationInstance::Evaluate(SceneGraph &_graph)
+    {
+        m_clip->Sample(m_time, m_nodeOffset, m_cursors.data(), m_weights.data(), _graph);
+    }
+
+    void EvaluateAnimations(std::span<AnimationInstance> _instances,
+                            SceneGraph &_graph,
+                            ThreadPool *_threadPool)
+    {
+        auto count = static_cast<uint32_t>(_instances.size());
+
+        if (!_threadPool || count <= INSTANCES_PER_JOB)
+        {
+            for (AnimationInstance &instance : _instances)
+            {
+                instance.Evaluate(_graph);
+            }
+            return;
+        }
+
+        _threadPool->ParallelFor(count, INSTANCES_PER_JOB, [&](uint32_t _begin, uint32_t _end) {
+            for (uint32_t instance = _begin; instance < _end; instance++)
+            {
+                _instances[instance].Evaluate(_graph);
+            }
+        });
+    }
+} // namespace DadEngine
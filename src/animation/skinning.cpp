@@ -0,0 +1,576 @@
+#include "skinning.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "helpers/simd.hpp"
+#include "helpers/thread-pool.hpp"
+#include "scene/scene-graph.hpp"
+#include "quaternion/quaternion.hpp"
+#include "vector/vector3.hpp"
+
+namespace DadEngine
+{
+    namespace
+    {
+        // Below this many vertices per job the threading costs more than
+        // the skinning
+        constexpr uint32_t VERTICES_PER_JOB = 1024U;
+
+        constexpr uint32_t LINEAR_BLEND_STRIDE    = 16U;
+        constexpr uint32_t DUAL_QUATERNION_STRIDE = 8U;
+
+        constexpr float WEIGHT_SCALE = 1.f / 65535.f;
+
+        // Keeps the normals missing from the bind pose at zero
+        constexpr float MIN_SQUARED_LENGTH = 1e-30f;
+
+        void Cross(const float *_a, const float *_b, float *_result)
+        {
+            _result[0] = _a[1] * _b[2] - _a[2] * _b[1];
+            _result[1] = _a[2] * _b[0] - _a[0] * _b[2];
+            _result[2] = _a[0] * _b[1] - _a[1] * _b[0];
+        }
+
+#if !defined(DADENGINE_SSE2)
+        void Normalize3(float *_vector)
+        {
+            float squaredLength = _vector[0] * _vector[0] + _vector[1] * _vector[1] + _vector[2] * _vector[2];
+            float inverseLength = 1.f / std::sqrt(std::max(squaredLength, MIN_SQUARED_LENGTH));
+
+            _vector[0] *= inverseLength;
+            _vector[1] *= inverseLength;
+            _vector[2] *= inverseLength;
+        }
+#endif
+
+        // v + 2 * r x (r x v + w * v), for a unit quaternion stored x, y, z, w
+        void Rotate(const float *_rotation, const float *_vector, float *_result)
+        {
+            float inner[3];
+            Cross(_rotation, _vector, inner);
+            inner[0] += _rotation[3] * _vector[0];
+            inner[1] += _rotation[3] * _vector[1];
+            inner[2] += _rotation[3] * _vector[2];
+
+            float outer[3];
+            Cross(_rotation, inner, outer);
+            _result[0] = _vector[0] + 2.f * outer[0];
+            _result[1] = _vector[1] + 2.f * outer[1];
+            _result[2] = _vector[2] + 2.f * outer[2];
+        }
+
+        void LinearBlend(const Vertex &_source, const SkinVertex &_skin, Vertex &_output, const float *_palette)
+        {
+#if defined(DADENGINE_SSE2)
+            // One vertex at a time, the lanes holding the matrix rows
+            __m128 columns[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+
+            for (uint32_t influence = 0U; influence < 4U; influence++)
+            {
+                if (_skin.weights[influence] == 0U)
+                {
+                    continue;
+                }
+
+                __m128 weight      = _mm_set1_ps(static_cast<float>(_skin.weights[influence]) * WEIGHT_SCALE);
+                const float *joint = _palette + _skin.joints[influence] * LINEAR_BLEND_STRIDE;
+
+                for (uint32_t column = 0U; column < 4U; column++)
+                {
+                    __m128 jointColumn = _mm_loadu_ps(joint + column * 4U);
+                    columns[column]    = _mm_add_ps(columns[column], _mm_mul_ps(weight, jointColumn));
+                }
+            }
+
+            auto transform = [&](const float *_vector) {
+                return _mm_add_ps(_mm_add_ps(_mm_mul_ps(columns[0], _mm_set1_ps(_vector[0])),
+                                             _mm_mul_ps(columns[1], _mm_set1_ps(_vector[1]))),
+                                  _mm_mul_ps(columns[2], _mm_set1_ps(_vector[2])));
+            };
+
+            // The fourth lane of the columns is zero, it does not weigh in
+            auto normalize = [](__m128 _vector) {
+                __m128 squared = _mm_mul_ps(_vector, _vector);
+                __m128 sum     = _mm_add_ps(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 3, 0, 1)));
+                sum            = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+                sum            = _mm_max_ps(sum, _mm_set1_ps(MIN_SQUARED_LENGTH));
+
+                return _mm_div_ps(_vector, _mm_sqrt_ps(sum));
+            };
+
+            float position[4], normal[4], tangent[4];
+            _mm_storeu_ps(position, _mm_add_ps(transform(&_source.position.x), columns[3]));
+            _mm_storeu_ps(normal, normalize(transform(&_source.normal.x)));
+            _mm_storeu_ps(tangent, normalize(transform(&_source.tangent.x)));
+#else
+            float columns[LINEAR_BLEND_STRIDE] = {};
+
+            for (uint32_t influence = 0U; influence < 4U; influence++)
+            {
+                if (_skin.weights[influence] == 0U)
+                {
+                    continue;
+                }
+
+                float weight       = static_cast<float>(_skin.weights[influence]) * WEIGHT_SCALE;
+                const float *joint = _palette + _skin.joints[influence] * LINEAR_BLEND_STRIDE;
+
+                for (uint32_t component = 0U; component < LINEAR_BLEND_STRIDE; component++)
+                {
+                    columns[component] += weight * joint[component];
+                }
+            }
+
+            auto transform = [&](const float *_vector, float *_result) {
+                for (uint32_t row = 0U; row < 3U; row++)
+                {
+                    _result[row]
+                        = columns[row] * _vector[0] + columns[4U + row] * _vector[1] + columns[8U + row] * _vector[2];
+                }
+            };
+
+            float position[3], normal[3], tangent[3];
+            transform(&_source.position.x, position);
+            position[0] += columns[12];
+            position[1] += columns[13];
+            position[2] += columns[14];
+
+            transform(&_source.normal.x, normal);
+            Normalize3(normal);
+            transform(&_source.tangent.x, tangent);
+            Normalize3(tangent);
+#endif
+
+            _output.position = Vector3(position[0], position[1], position[2]);
+            _output.normal   = Vector3(normal[0], normal[1], normal[2]);
+            _output.tangent  = Vector4(tangent[0], tangent[1], tangent[2], _source.tangent.w);
+        }
+
+        void DualQuaternion(const Vertex &_source, const SkinVertex &_skin, Vertex &_output, const float *_palette)
+        {
+            float real[4] = {}, dual[4] = {};
+            const float *first = _palette + _skin.joints[0] * DUAL_QUATERNION_STRIDE;
+
+            for (uint32_t influence = 0U; influence < 4U; influence++)
+            {
+                if (_skin.weights[influence] == 0U)
+                {
+                    continue;
+                }
+
+                float weight       = static_cast<float>(_skin.weights[influence]) * WEIGHT_SCALE;
+                const float *joint = _palette + _skin.joints[influence] * DUAL_QUATERNION_STRIDE;
+
+                // q and -q are the same transform, blending the opposite
+                // ones would take the long way around
+                if (joint[0] * first[0] + joint[1] * first[1] + joint[2] * first[2] + joint[3] * first[3] < 0.f)
+                {
+                    weight = -weight;
+                }
+
+                for (uint32_t component = 0U; component < 4U; component++)
+                {
+                    real[component] += weight * joint[component];
+                    dual[component] += weight * joint[4U + component];
+                }
+            }
+
+            float inverseLength
+                = 1.f / std::sqrt(real[0] * real[0] + real[1] * real[1] + real[2] * real[2] + real[3] * real[3]);
+            for (uint32_t component = 0U; component < 4U; component++)
+            {
+                real[component] *= inverseLength;
+                dual[component] *= inverseLength;
+            }
+
+            // Translation 2 * dual * conjugate(real)
+            float translation[3];
+            Cross(real, dual, translation);
+            for (uint32_t component = 0U; component < 3U; component++)
+            {
+                translation[component]
+                    = 2.f * (translation[component] + real[3] * dual[component] - dual[3] * real[component]);
+            }
+
+            float position[3], normal[3], tangent[3];
+            Rotate(real, &_source.position.x, position);
+            Rotate(real, &_source.normal.x, normal);
+            Rotate(real, &_source.tangent.x, tangent);
+
+            _output.position = Vector3(position[0] + translation[0], position[1] + translation[1],
+                                       position[2] + translation[2]);
+            _output.normal   = Vector3(normal[0], normal[1], normal[2]);
+            _output.tangent  = Vector4(tangent[0], tangent[1], tangent[2], _source.tangent.w);
+        }
+
+#if defined(DADENGINE_SSE2)
+        // Four floats from each pointer become a register per component,
+        // one pointer per lane
+        void LoadColumns(const float *const *_sources, __m128 *_components)
+        {
+            _components[0] = _mm_loadu_ps(_sources[0]);
+            _components[1] = _mm_loadu_ps(_sources[1]);
+            _components[2] = _mm_loadu_ps(_sources[2]);
+            _components[3] = _mm_loadu_ps(_sources[3]);
+            _MM_TRANSPOSE4_PS(_components[0], _components[1], _components[2], _components[3]);
+        }
+
+        void Cross4(const __m128 *_a, const __m128 *_b, __m128 *_result)
+        {
+            _result[0] = _mm_sub_ps(_mm_mul_ps(_a[1], _b[2]), _mm_mul_ps(_a[2], _b[1]));
+            _result[1] = _mm_sub_ps(_mm_mul_ps(_a[2], _b[0]), _mm_mul_ps(_a[0], _b[2]));
+            _result[2] = _mm_sub_ps(_mm_mul_ps(_a[0], _b[1]), _mm_mul_ps(_a[1], _b[0]));
+        }
+
+        void Rotate4(const __m128 *_rotation, const __m128 *_vector, __m128 *_result)
+        {
+            __m128 inner[3], outer[3];
+            Cross4(_rotation, _vector, inner);
+            for (uint32_t component = 0U; component < 3U; component++)
+            {
+                inner[component] = _mm_add_ps(inner[component], _mm_mul_ps(_rotation[3], _vector[component]));
+            }
+
+            Cross4(_rotation, inner, outer);
+            for (uint32_t component = 0U; component < 3U; component++)
+            {
+                _result[component] = _mm_add_ps(_vector[component], _mm_add_ps(outer[component], outer[component]));
+            }
+        }
+
+        // Four vertices at once, one per lane
+        void DualQuaternion4(const Vertex *_source, const SkinVertex *_skin, Vertex *_output, const float *_palette)
+        {
+            __m128 real[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+            __m128 dual[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+            __m128 first[4];
+            __m128 signMask = _mm_set1_ps(-0.f);
+
+            for (uint32_t influence = 0U; influence < 4U; influence++)
+            {
+                const float *reals[4], *duals[4];
+                for (uint32_t lane = 0U; lane < 4U; lane++)
+                {
+                    reals[lane] = _palette + _skin[lane].joints[influence] * DUAL_QUATERNION_STRIDE;
+                    duals[lane] = reals[lane] + 4U;
+                }
+
+                __m128 jointReal[4], jointDual[4];
+                LoadColumns(reals, jointReal);
+                LoadColumns(duals, jointDual);
+
+                if (influence == 0U)
+                {
+                    std::copy(jointReal, jointReal + 4, first);
+                }
+
+                __m128 weight = _mm_mul_ps(_mm_setr_ps(static_cast<float>(_skin[0].weights[influence]),
+                                                       static_cast<float>(_skin[1].weights[influence]),
+                                                       static_cast<float>(_skin[2].weights[influence]),
+                                                       static_cast<float>(_skin[3].weights[influence])),
+                                           _mm_set1_ps(WEIGHT_SCALE));
+
+                // Takes the sign of the dot product with the first joint
+                __m128 dot = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(jointReal[0], first[0]), _mm_mul_ps(jointReal[1], first[1])),
+                    _mm_add_ps(_mm_mul_ps(jointReal[2], first[2]), _mm_mul_ps(jointReal[3], first[3])));
+                weight = _mm_xor_ps(weight, _mm_and_ps(dot, signMask));
+
+                for (uint32_t component = 0U; component < 4U; component++)
+                {
+                    real[component] = _mm_add_ps(real[component], _mm_mul_ps(weight, jointReal[component]));
+                    dual[component] = _mm_add_ps(dual[component], _mm_mul_ps(weight, jointDual[component]));
+                }
+            }
+
+            __m128 squaredLength = _mm_add_ps(_mm_add_ps(_mm_mul_ps(real[0], real[0]), _mm_mul_ps(real[1], real[1])),
+                                              _mm_add_ps(_mm_mul_ps(real[2], real[2]), _mm_mul_ps(real[3], real[3])));
+            __m128 inverseLength = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(squaredLength));
+            for (uint32_t component = 0U; component < 4U; component++)
+            {
+                real[component] = _mm_mul_ps(real[component], inverseLength);
+                dual[component] = _mm_mul_ps(dual[component], inverseLength);
+            }
+
+            __m128 translation[3];
+            Cross4(real, dual, translation);
+            for (uint32_t component = 0U; component < 3U; component++)
+            {
+                __m128 sum = _mm_add_ps(translation[component],
+                                        _mm_sub_ps(_mm_mul_ps(real[3], dual[component]),
+                                                   _mm_mul_ps(dual[3], real[component])));
+                translation[component] = _mm_add_ps(sum, sum);
+            }
+
+            // The fourth component loaded after each vector is not used
+            const float *positions[4] = { &_source[0].position.x, &_source[1].position.x, &_source[2].position.x,
+                                          &_source[3].position.x };
+            const float *normals[4]   = { &_source[0].normal.x, &_source[1].normal.x, &_source[2].normal.x,
+                                          &_source[3].normal.x };
+            const float *tangents[4]  = { &_source[0].tangent.x, &_source[1].tangent.x, &_source[2].tangent.x,
+                                          &_source[3].tangent.x };
+
+            __m128 position[4], normal[4], tangent[4];
+            LoadColumns(positions, position);
+            LoadColumns(normals, normal);
+            LoadColumns(tangents, tangent);
+
+            Rotate4(real, position, position);
+            Rotate4(real, normal, normal);
+            Rotate4(real, tangent, tangent);
+
+            for (uint32_t component = 0U; component < 3U; component++)
+            {
+                position[component] = _mm_add_ps(position[component], translation[component]);
+            }
+
+            _MM_TRANSPOSE4_PS(position[0], position[1], position[2], position[3]);
+            _MM_TRANSPOSE4_PS(normal[0], normal[1], normal[2], normal[3]);
+            _MM_TRANSPOSE4_PS(tangent[0], tangent[1], tangent[2], tangent[3]);
+
+            for (uint32_t lane = 0U; lane < 4U; lane++)
+            {
+                float values[3][4];
+                _mm_storeu_ps(values[0], position[lane]);
+                _mm_storeu_ps(values[1], normal[lane]);
+                _mm_storeu_ps(values[2], tangent[lane]);
+
+                _output[lane].position = Vector3(values[0][0], values[0][1], values[0][2]);
+                _output[lane].normal   = Vector3(values[1][0], values[1][1], values[1][2]);
+                _output[lane].tangent  = Vector4(values[2][0], values[2][1], values[2][2], _source[lane].tangent.w);
+            }
+        }
+#endif
+    } // namespace
+
+    void ComputeJointMatrices(const Skin &_skin,
+                              const SceneGraph &_graph,
+                              uint32_t _nodeOffset,
+                              std::vector<Matrix3x4> &_jointMatrices)
+    {
+        _jointMatrices.resize(_skin.joints.size());
+
+        for (size_t joint = 0; joint < _skin.joints.size(); joint++)
+        {
+            uint32_t node = _skin.joints[joint];
+
+            // Joints outside of the graph stay at their bind pose
+            Matrix3x4 world;
+            if (node != INVALID_NODE && node + _nodeOffset < _graph.GetNodeCount())
+            {
+                world = _graph.GetWorldMatrix(node + _nodeOffset);
+            }
+
+            _jointMatrices[joint]
+                = joint < _skin.inverseBindMatrices.size() ? world * _skin.inverseBindMatrices[joint] : world;
+        }
+    }
+
+    AABB ComputeSkinnedBounds(const AABB &_bindBounds, std::span<const Matrix3x4> _jointMatrices)
+    {
+        if (_jointMatrices.empty())
+        {
+            return _bindBounds;
+        }
+
+        AABB bounds = AABB::Empty();
+        for (const Matrix3x4 &joint : _jointMatrices)
+        {
+            for (uint32_t corner = 0U; corner < 8U; corner++)
+            {
+                Vector3 point((corner & 1U) ? _bindBounds.m_max.x : _bindBounds.m_min.x,
+                              (corner & 2U) ? _bindBounds.m_max.y : _bindBounds.m_min.y,
+                              (corner & 4U) ? _bindBounds.m_max.z : _bindBounds.m_min.z);
+
+                bounds.Grow(joint.TransformPoint(point));
+            }
+        }
+
+        return bounds;
+    }
+
+    void SkinningPalette::Set(std::span<const Matrix3x4> _jointMatrices, SkinningMethod _method)
+    {
+        m_method     = _method;
+        m_jointCount = static_cast<uint32_t>(_jointMatrices.size());
+
+        if (_method == SkinningMethod::LinearBlend)
+        {
+            m_data.assign(_jointMatrices.size() * LINEAR_BLEND_STRIDE, 0.f);
+
+            for (size_t joint = 0; joint < _jointMatrices.size(); joint++)
+            {
+                const Matrix3x4 &matrix = _jointMatrices[joint];
+                float *columns          = m_data.data() + joint * LINEAR_BLEND_STRIDE;
+
+                columns[0]  = matrix.m_11;
+                columns[1]  = matrix.m_21;
+                columns[2]  = matrix.m_31;
+                columns[4]  = matrix.m_12;
+                columns[5]  = matrix.m_22;
+                columns[6]  = matrix.m_32;
+                columns[8]  = matrix.m_13;
+                columns[9]  = matrix.m_23;
+                columns[10] = matrix.m_33;
+                columns[12] = matrix.m_14;
+                columns[13] = matrix.m_24;
+                columns[14] = matrix.m_34;
+            }
+
+            return;
+        }
+
+        m_data.resize(_jointMatrices.size() * DUAL_QUATERNION_STRIDE);
+
+        for (size_t joint = 0; joint < _jointMatrices.size(); joint++)
+        {
+            Vector3 translation, scale;
+            Quaternion rotation;
+            _jointMatrices[joint].Decompose(translation, rotation, scale);
+
+            float *dualQuaternion = m_data.data() + joint * DUAL_QUATERNION_STRIDE;
+
+            dualQuaternion[0] = rotation.x;
+            dualQuaternion[1] = rotation.y;
+            dualQuaternion[2] = rotation.z;
+            dualQuaternion[3] = rotation.w;
+
+            // Dual part 0.5 * translation * rotation
+            const Vector3 &t = translation;
+            dualQuaternion[4] = 0.5f * (t.x * rotation.w + t.y * rotation.z - t.z * rotation.y);
+            dualQuaternion[5] = 0.5f * (-t.x * rotation.z + t.y * rotation.w + t.z * rotation.x);
+            dualQuaternion[6] = 0.5f * (t.x * rotation.y - t.y * rotation.x + t.z * rotation.w);
+            dualQuaternion[7] = -0.5f * (t.x * rotation.x + t.y * rotation.y + t.z * rotation.z);
+        }
+    }
+
+    void SkinVertices(const Vertex *_bindPose,
+                      const SkinVertex *_skin,
+                      Vertex *_output,
+                      uint32_t _begin,
+                      uint32_t _end,
+                      const SkinningPalette &_palette)
+    {
+        const float *palette = _palette.GetData();
+
+        if (_palette.GetMethod() == SkinningMethod::LinearBlend)
+        {
+            for (uint32_t vertex = _begin; vertex < _end; vertex++)
+            {
+                LinearBlend(_bindPose[vertex], _skin[vertex], _output[vertex], palette);
+            }
+
+            return;
+        }
+
+        uint32_t vertex = _begin;
+
+#if defined(DADENGINE_SSE2)
+        for (; vertex + 4U <= _end; vertex += 4U)
+        {
+            DualQuaternion4(_bindPose + vertex, _skin + vertex, _output + vertex, palette);
+        }
+#endif
+
+        for (; vertex < _end; vertex++)
+        {
+            DualQuaternion(_bindPose[vertex], _skin[vertex], _output[vertex], palette);
+        }
+    }
+
+    CPUSkinnedMesh::CPUSkinnedMesh(const Mesh &_bindPose)
+    {
+        for (uint32_t primitiveIndex = 0U; primitiveIndex < _bindPose.m_primitives.size(); primitiveIndex++)
+        {
+            const Primitive &primitive = _bindPose.m_primitives[primitiveIndex];
+
+            if (!primitive.vertices.HasCPUData() || !primitive.indices.HasCPUData())
+            {
+                std::cout << "Skinned primitive without CPU data\n";
+                continue;
+            }
+
+            const std::vector<SkinVertex> &skinVertices = primitive.vertices.skinVertices;
+            if (skinVertices.size() != primitive.vertices.vertexCount)
+            {
+                std::cout << "Skinned primitive without joints and weights\n";
+                continue;
+            }
+
+            for (const SkinVertex &skinVertex : skinVertices)
+            {
+                for (uint16_t joint : skinVertex.joints)
+                {
+                    m_jointCount = std::max(m_jointCount, joint + 1U);
+                }
+            }
+
+            // Pool ranges are written once, the skinned primitives get
+            // buffers of their own
+            IndexBuffer indices = primitive.indices.indexCount != 0U
+                                      ? IndexBuffer(std::vector<uint32_t>(primitive.indices.indices))
+                                      : IndexBuffer();
+
+            // The posed copies only need the interleaved vertices
+            m_bindPoses.push_back(primitive.vertices.vertices);
+            m_skins.push_back(skinVertices);
+            m_mesh.m_primitives.emplace_back(VertexBuffer(std::vector<Vertex>(primitive.vertices.vertices), true),
+                                             std::move(indices), primitive.drawMode, primitive.material,
+                                             primitive.bounds);
+            m_vertexCount += primitive.vertices.vertexCount;
+        }
+    }
+
+    void CPUSkinnedMesh::Update(const SkinningPalette &_palette, ThreadPool *_threadPool)
+    {
+        if (_palette.GetJointCount() < m_jointCount)
+        {
+            std::cout << "Skinning palette without every joint of the mesh\n";
+            return;
+        }
+
+        for (size_t primitive = 0; primitive < m_mesh.m_primitives.size(); primitive++)
+        {
+            const Vertex *bindPose         = m_bindPoses[primitive].data();
+            const SkinVertex *skinVertices = m_skins[primitive].data();
+            VertexBuffer &vertices         = m_mesh.m_primitives[primitive].vertices;
+
+            auto skin = [&](uint32_t _begin, uint32_t _end) {
+                SkinVertices(bindPose, skinVertices, vertices.vertices.data(), _begin, _end, _palette);
+            };
+
+            if (_threadPool && vertices.vertexCount > VERTICES_PER_JOB)
+            {
+                _threadPool->ParallelFor(vertices.vertexCount, VERTICES_PER_JOB, skin);
+            }
+            else
+            {
+                skin(0U, vertices.vertexCount);
+            }
+
+            vertices.Upload();
+        }
+    }
+
+    bool UploadJointMatrices([[maybe_unused]] int32_t _location, std::span<const Matrix3x4> _jointMatrices)
+    {
+        if (_jointMatrices.size() > MAX_GPU_JOINTS)
+        {
+            std::cout << "Too many joints for GPU skinning\n";
+            return false;
+        }
+
+#if defined(OPENGL)
+        // Each matrix is three rows of four floats, the layout of three vec4
+        if (!_jointMatrices.empty())
+        {
+            glUniform4fv(_location, static_cast<GLsizei>(_jointMatrices.size() * 3U), &_jointMatrices[0].m_11);
+        }
+#elif defined(_VULKAN)
+#endif
+
+        return true;
+    }
+} // namespace DadEngine
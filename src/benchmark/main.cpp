@@ -0,0 +1,641 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#if defined(WINDOWS)
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "animation/animation.hpp"
+#include "animation/skinning.hpp"
+#include "bvh/bvh.hpp"
+#include "helpers/derived-data-cache.hpp"
+#include "helpers/load-profiler.hpp"
+#include "helpers/thread-pool.hpp"
+#include "loaders/gltf-loader.hpp"
+#include "loaders/scene-pack.hpp"
+#include "model/geometry-pool.hpp"
+#include "model/model.hpp"
+#include "scene/scene-graph.hpp"
+
+using namespace DadEngine;
+
+// Every operator new of the process is counted, stb_image and the other C
+// libraries allocate through malloc and are left out
+namespace
+{
+    std::atomic<uint64_t> allocationCount = 0;
+    std::atomic<uint64_t> allocatedBytes  = 0;
+
+    void *Allocate(size_t _size)
+    {
+        allocationCount.fetch_add(1U, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(_size, std::memory_order_relaxed);
+
+        void *pointer = std::malloc(_size != 0U ? _size : 1U);
+        if (!pointer) {
+            throw std::bad_alloc();
+        }
+
+        return pointer;
+    }
+
+    void *AllocateAligned(size_t _size, std::align_val_t _alignment)
+    {
+        allocationCount.fetch_add(1U, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(_size, std::memory_order_relaxed);
+
+        auto alignment = static_cast<size_t>(_alignment);
+        size_t size    = (std::max<size_t>(_size, 1U) + alignment - 1U) / alignment * alignment;
+
+#if defined(WINDOWS)
+        void *pointer = _aligned_malloc(size, alignment);
+#else
+        void *pointer = std::aligned_alloc(alignment, size);
+#endif
+        if (!pointer) {
+            throw std::bad_alloc();
+        }
+
+        return pointer;
+    }
+
+    void FreeAligned(void *_pointer)
+    {
+#if defined(WINDOWS)
+        _aligned_free(_pointer);
+#else
+        std::free(_pointer);
+#endif
+    }
+} // namespace
+
+void *operator new(size_t _size)
+{
+    return Allocate(_size);
+}
+
+void *operator new[](size_t _size)
+{
+    return Allocate(_size);
+}
+
+void *operator new(size_t _size, std::align_val_t _alignment)
+{
+    return AllocateAligned(_size, _alignment);
+}
+
+void *operator new[](size_t _size, std::align_val_t _alignment)
+{
+    return AllocateAligned(_size, _alignment);
+}
+
+void operator delete(void *_pointer) noexcept
+{
+    std::free(_pointer);
+}
+
+void operator delete[](void *_pointer) noexcept
+{
+    std::free(_pointer);
+}
+
+void operator delete(void *_pointer, size_t) noexcept
+{
+    std::free(_pointer);
+}
+
+void operator delete[](void *_pointer, size_t) noexcept
+{
+    std::free(_pointer);
+}
+
+void operator delete(void *_pointer, std::align_val_t) noexcept
+{
+    FreeAligned(_pointer);
+}
+
+void operator delete[](void *_pointer, std::align_val_t) noexcept
+{
+    FreeAligned(_pointer);
+}
+
+void operator delete(void *_pointer, size_t, std::align_val_t) noexcept
+{
+    FreeAligned(_pointer);
+}
+
+void operator delete[](void *_pointer, size_t, std::align_val_t) noexcept
+{
+    FreeAligned(_pointer);
+}
+
+namespace
+{
+    // Frames played by the animation benchmark, at 60 Hz
+    constexpr uint32_t ANIMATION_FRAMES = 240U;
+
+    // Largest resident set of the process so far, in bytes
+    size_t GetPeakRSS()
+    {
+#if defined(WINDOWS)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return counters.PeakWorkingSetSize;
+        }
+
+        return 0;
+#else
+        rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+
+#if defined(__APPLE__)
+        return static_cast<size_t>(usage.ru_maxrss);
+#else
+        return static_cast<size_t>(usage.ru_maxrss) * 1024U;
+#endif
+#endif
+    }
+
+    struct LoadRun
+    {
+        double loadTime  = 0.0; // Milliseconds
+        double batchTime = 0.0;
+        double graphTime = 0.0; // First world matrices update of the scene graph
+        double bvhTime   = 0.0; // BVH then BVH8 over every triangle of the scene
+        double stageTimes[static_cast<size_t>(LoadStage::Count)] {};
+        uint64_t stageCounts[static_cast<size_t>(LoadStage::Count)] {};
+
+        uint64_t allocationCount = 0;
+        uint64_t allocatedBytes  = 0;
+        uint64_t cacheHits       = 0;
+        uint64_t cacheMisses     = 0;
+        size_t peakRSS           = 0;
+
+        size_t meshCount      = 0;
+        size_t primitiveCount = 0;
+        size_t vertexCount    = 0;
+        size_t indexCount     = 0;
+        size_t textureCount   = 0;
+        size_t nodeCount      = 0;
+
+        size_t bvhNodeCount     = 0;
+        size_t bvhTriangleCount = 0;
+
+        // Average frame of the animated crowd, sampling and world matrices
+        double animationTime          = 0.0;
+        size_t animationInstanceCount = 0;
+        size_t animationChannelCount  = 0;
+
+        // Average frame of CPU skinning the crowd, out of the animation one
+        double skinningTime       = 0.0;
+        size_t skinnedVertexCount = 0; // Per frame
+
+        // Bytes of geometry still held on the CPU once the scene is ready
+        size_t cpuGeometrySize = 0;
+    };
+
+    struct SceneReport
+    {
+        std::filesystem::path path;
+        bool cooked = false;
+        std::vector<LoadRun> runs;
+    };
+
+    // Appends copies of the graph nodes, one per character of a crowd
+    // playing the clips of the scene, and returns the node offset of each
+    std::vector<uint32_t> CopyNodes(SceneGraph &_graph, uint32_t _copyCount)
+    {
+        uint32_t nodeCount = _graph.GetNodeCount();
+        std::vector<uint32_t> offsets { 0U };
+
+        for (uint32_t copy = 1; copy < _copyCount; copy++) {
+            uint32_t offset = copy * nodeCount;
+            offsets.push_back(offset);
+
+            for (uint32_t node = 0; node < nodeCount; node++) {
+                uint32_t parent = _graph.GetParent(node);
+                _graph.AddNode(parent != INVALID_NODE ? parent + offset : INVALID_NODE, _graph.GetTranslation(node),
+                               _graph.GetRotation(node), _graph.GetScale(node), _graph.GetMesh(node),
+                               _graph.GetSkin(node));
+            }
+        }
+
+        return offsets;
+    }
+
+    // Loads the scene like the viewer does, with a pool of the same size,
+    // then batches it and builds its BVH. Nothing is uploaded, the loaders
+    // are built without a rendering backend. The animations of the scene
+    // are then played on _crowdSize copies of its nodes, and their skinned
+    // meshes posed on the CPU with _skinningMethod
+    LoadRun LoadScene(std::filesystem::path _path, bool _cooked, const TextureCompressionSettings &_compression,
+                      bool _releaseCPUData, uint32_t _crowdSize, SkinningMethod _skinningMethod)
+    {
+        LoadRun run;
+
+        LoadProfiler::Get().Reset();
+        DerivedDataCache::Get().ResetCounters();
+        uint64_t firstAllocation = allocationCount;
+        uint64_t firstByte       = allocatedBytes;
+
+        GeometryPool geometryPool { 1U << 18U, 1U << 20U };
+        SceneGraph sceneGraph;
+        std::vector<AnimationClip> animations;
+        std::vector<Skin> skins;
+        ThreadPool &threadPool = ThreadPool::Get();
+
+        auto loadStart           = std::chrono::steady_clock::now();
+        std::vector<Mesh> meshes = _cooked ? LoadCookedScene(_path, &geometryPool, &sceneGraph)
+                                           : LoadGLTF(_path, &geometryPool, _compression, &sceneGraph, &animations,
+                                                      &skins);
+        auto batchStart          = std::chrono::steady_clock::now();
+
+        // The CPU skinned copies of the meshes take their bind pose before
+        // it is released, one per mesh shared by every character
+        std::vector<uint32_t> skinnedNodes;
+        std::vector<uint32_t> skinnedMeshIndices(meshes.size(), INVALID_NODE);
+        for (uint32_t node = 0; node < sceneGraph.GetNodeCount(); node++) {
+            if (sceneGraph.GetMesh(node) < meshes.size() && sceneGraph.GetSkin(node) < skins.size()) {
+                skinnedNodes.push_back(node);
+                skinnedMeshIndices[sceneGraph.GetMesh(node)] = 0U;
+            }
+        }
+
+        std::vector<CPUSkinnedMesh> skinnedMeshes;
+        for (size_t mesh = 0; mesh < meshes.size(); mesh++) {
+            meshes[mesh].Batch(&geometryPool);
+
+            if (skinnedMeshIndices[mesh] != INVALID_NODE) {
+                skinnedMeshIndices[mesh] = static_cast<uint32_t>(skinnedMeshes.size());
+                skinnedMeshes.emplace_back(meshes[mesh]);
+            }
+        }
+
+        auto batchEnd = std::chrono::steady_clock::now();
+
+        sceneGraph.UpdateWorldMatrices(&threadPool);
+
+        auto graphEnd = std::chrono::steady_clock::now();
+
+        // The BVH is built in mesh space over the triangles of every mesh,
+        // gathered from the CPU data before it is released
+        std::vector<BVHTriangle> triangles;
+        for (const Mesh &mesh : meshes) {
+            std::vector<BVHTriangle> meshTriangles = GatherTriangles(mesh);
+            triangles.insert(triangles.end(), meshTriangles.begin(), meshTriangles.end());
+        }
+
+        BVH sceneBVH;
+        sceneBVH.Build(std::move(triangles));
+        BVH8 sceneWideBVH;
+        sceneWideBVH.Build(sceneBVH);
+
+        auto bvhEnd = std::chrono::steady_clock::now();
+
+        if (_releaseCPUData) {
+            for (Mesh &mesh : meshes) {
+                mesh.ReleaseCPUData();
+            }
+        }
+
+        run.loadTime         = std::chrono::duration<double, std::milli>(batchStart - loadStart).count();
+        run.batchTime        = std::chrono::duration<double, std::milli>(batchEnd - batchStart).count();
+        run.graphTime        = std::chrono::duration<double, std::milli>(graphEnd - batchEnd).count();
+        run.bvhTime          = std::chrono::duration<double, std::milli>(bvhEnd - graphEnd).count();
+        run.bvhNodeCount     = sceneBVH.GetNodes().size();
+        run.bvhTriangleCount = sceneBVH.GetTriangles().size();
+
+        if (!animations.empty() || !skinnedNodes.empty()) {
+            std::vector<uint32_t> offsets = CopyNodes(sceneGraph, _crowdSize);
+            // Each character plays one clip, instances must not share their
+            // target nodes. The clips of the scene are spread over the crowd
+            std::vector<AnimationInstance> instances;
+            for (size_t character = 0; character < offsets.size() && !animations.empty(); character++) {
+                const AnimationClip &clip = animations[character % animations.size()];
+                instances.emplace_back(clip, offsets[character]);
+                run.animationChannelCount += clip.GetChannelCount();
+            }
+
+            // Characters start at different times so their keys differ
+            for (size_t instance = 0; instance < instances.size(); instance++) {
+                instances[instance].Advance(static_cast<float>(instance) * 0.37f);
+            }
+
+            sceneGraph.UpdateWorldMatrices(&threadPool);
+
+            std::vector<Matrix3x4> jointMatrices;
+            SkinningPalette skinningPalette;
+            std::chrono::duration<double, std::milli> animationTime {};
+            std::chrono::duration<double, std::milli> skinningTime {};
+
+            for (uint32_t frame = 0; frame < ANIMATION_FRAMES; frame++) {
+                auto animationStart = std::chrono::steady_clock::now();
+
+                for (AnimationInstance &instance : instances) {
+                    instance.Advance(1.f / 60.f);
+                }
+
+                EvaluateAnimations(instances, sceneGraph, &threadPool);
+                sceneGraph.UpdateWorldMatrices(&threadPool);
+
+                auto skinningStart = std::chrono::steady_clock::now();
+
+                for (uint32_t offset : offsets) {
+                    for (uint32_t node : skinnedNodes) {
+                        ComputeJointMatrices(skins[sceneGraph.GetSkin(node)], sceneGraph, offset, jointMatrices);
+                        skinningPalette.Set(jointMatrices, _skinningMethod);
+                        skinnedMeshes[skinnedMeshIndices[sceneGraph.GetMesh(node)]].Update(skinningPalette,
+                                                                                           &threadPool);
+                    }
+                }
+
+                auto skinningEnd = std::chrono::steady_clock::now();
+                animationTime += skinningStart - animationStart;
+                skinningTime += skinningEnd - skinningStart;
+            }
+
+            run.animationTime          = animationTime.count() / ANIMATION_FRAMES;
+            run.skinningTime           = skinningTime.count() / ANIMATION_FRAMES;
+            run.animationInstanceCount = instances.size();
+
+            for (uint32_t node : skinnedNodes) {
+                run.skinnedVertexCount
+                    += skinnedMeshes[skinnedMeshIndices[sceneGraph.GetMesh(node)]].GetVertexCount() * offsets.size();
+            }
+        }
+
+        for (size_t stage = 0; stage < static_cast<size_t>(LoadStage::Count); stage++) {
+            run.stageTimes[stage] = std::chrono::duration<double, std::milli>(
+                                        LoadProfiler::Get().GetTime(static_cast<LoadStage>(stage)))
+                                        .count();
+            run.stageCounts[stage] = LoadProfiler::Get().GetCount(static_cast<LoadStage>(stage));
+        }
+
+        run.allocationCount = allocationCount - firstAllocation;
+        run.allocatedBytes  = allocatedBytes - firstByte;
+        run.cacheHits       = DerivedDataCache::Get().GetHitCount();
+        run.cacheMisses     = DerivedDataCache::Get().GetMissCount();
+
+        std::unordered_set<const Texture *> textures;
+        run.meshCount = meshes.size();
+        for (const Mesh &mesh : meshes) {
+            run.primitiveCount += mesh.m_primitives.size();
+
+            for (const Primitive &primitive : mesh.m_primitives) {
+                run.vertexCount += primitive.vertices.vertexCount;
+                run.indexCount += primitive.indices.indexCount;
+                run.cpuGeometrySize += primitive.vertices.vertices.capacity() * sizeof(Vertex)
+                                       + primitive.indices.indices.capacity() * sizeof(uint32_t);
+
+                const PBRMaterial &material = primitive.material;
+                for (const auto *slot : { &material.baseColorTexture, &material.metallicRoughnessTexture,
+                                          &material.normalTexture, &material.occlusionTexture,
+                                          &material.emissiveTexture }) {
+                    if (*slot) {
+                        textures.insert(slot->get());
+                    }
+                }
+            }
+        }
+
+        run.textureCount = textures.size();
+        run.nodeCount    = sceneGraph.GetNodeCount();
+        run.peakRSS      = GetPeakRSS();
+
+        return run;
+    }
+
+    std::string EscapeJSON(const std::string &_string)
+    {
+        std::string escaped;
+        for (char character : _string) {
+            if (character == '"' || character == '\\') {
+                escaped += '\\';
+            }
+            else if (static_cast<unsigned char>(character) < 0x20U) {
+                escaped += ' ';
+                continue;
+            }
+
+            escaped += character;
+        }
+
+        return escaped;
+    }
+
+    void WriteJSON(std::ostream &_stream, const std::vector<SceneReport> &_reports)
+    {
+        _stream << "{\n  \"scenes\": [";
+
+        for (size_t s = 0; s < _reports.size(); s++) {
+            const SceneReport &report = _reports[s];
+
+            _stream << (s ? "," : "") << "\n    {\n"
+                    << "      \"path\": \"" << EscapeJSON(report.path.generic_string()) << "\",\n"
+                    << "      \"cooked\": " << (report.cooked ? "true" : "false") << ",\n"
+                    << "      \"runs\": [";
+
+            for (size_t r = 0; r < report.runs.size(); r++) {
+                const LoadRun &run = report.runs[r];
+
+                _stream << (r ? "," : "") << "\n        {\n"
+                        << "          \"loadMs\": " << run.loadTime << ",\n"
+                        << "          \"batchMs\": " << run.batchTime << ",\n"
+                        << "          \"sceneGraphMs\": " << run.graphTime << ",\n"
+                        << "          \"bvhBuildMs\": " << run.bvhTime << ",\n"
+                        << "          \"bvhNodes\": " << run.bvhNodeCount << ",\n"
+                        << "          \"bvhTriangles\": " << run.bvhTriangleCount << ",\n"
+                        << "          \"stages\": {";
+
+                for (size_t stage = 0; stage < static_cast<size_t>(LoadStage::Count); stage++) {
+                    _stream << (stage ? "," : "") << "\n            \""
+                            << GetLoadStageName(static_cast<LoadStage>(stage)) << "\": { \"ms\": "
+                            << run.stageTimes[stage] << ", \"count\": " << run.stageCounts[stage] << " }";
+                }
+
+                _stream << "\n          },\n"
+                        << "          \"allocations\": " << run.allocationCount << ",\n"
+                        << "          \"allocatedBytes\": " << run.allocatedBytes << ",\n"
+                        << "          \"cacheHits\": " << run.cacheHits << ",\n"
+                        << "          \"cacheMisses\": " << run.cacheMisses << ",\n"
+                        << "          \"peakRSSBytes\": " << run.peakRSS << ",\n"
+                        << "          \"meshes\": " << run.meshCount << ",\n"
+                        << "          \"primitives\": " << run.primitiveCount << ",\n"
+                        << "          \"vertices\": " << run.vertexCount << ",\n"
+                        << "          \"indices\": " << run.indexCount << ",\n"
+                        << "          \"cpuGeometryBytes\": " << run.cpuGeometrySize << ",\n"
+                        << "          \"textures\": " << run.textureCount << ",\n"
+                        << "          \"nodes\": " << run.nodeCount << ",\n"
+                        << "          \"animationFrameMs\": " << run.animationTime << ",\n"
+                        << "          \"animationInstances\": " << run.animationInstanceCount << ",\n"
+                        << "          \"animationChannels\": " << run.animationChannelCount << ",\n"
+                        << "          \"skinningFrameMs\": " << run.skinningTime << ",\n"
+                        << "          \"skinnedVertices\": " << run.skinnedVertexCount << "\n"
+                        << "        }";
+            }
+
+            _stream << "\n      ]\n    }";
+        }
+
+        _stream << "\n  ]\n}\n";
+    }
+
+    void PrintRun(const LoadRun &_run, size_t _index)
+    {
+        printf("  run %zu : load %.2f ms, batch %.2f ms, scene graph %.3f ms (%zu nodes), %llu allocations (%.2f MB), "
+               "peak RSS %.2f MB, CPU geometry %.2f MB, cache %llu hits %llu misses\n",
+               _index, _run.loadTime, _run.batchTime, _run.graphTime, _run.nodeCount,
+               static_cast<unsigned long long>(_run.allocationCount),
+               static_cast<double>(_run.allocatedBytes) / (1024.0 * 1024.0),
+               static_cast<double>(_run.peakRSS) / (1024.0 * 1024.0),
+               static_cast<double>(_run.cpuGeometrySize) / (1024.0 * 1024.0),
+               static_cast<unsigned long long>(_run.cacheHits),
+               static_cast<unsigned long long>(_run.cacheMisses));
+
+        printf("    BVH build %.2f ms, %zu triangles, %zu nodes\n", _run.bvhTime, _run.bvhTriangleCount,
+               _run.bvhNodeCount);
+
+        if (_run.animationInstanceCount != 0U) {
+            printf("    animation %.3f ms per frame, %zu instances, %zu channels\n", _run.animationTime,
+                   _run.animationInstanceCount, _run.animationChannelCount);
+        }
+
+        if (_run.skinnedVertexCount != 0U) {
+            printf("    skinning %.3f ms per frame, %zu vertices\n", _run.skinningTime, _run.skinnedVertexCount);
+        }
+
+        for (size_t stage = 0; stage < static_cast<size_t>(LoadStage::Count); stage++) {
+            if (_run.stageCounts[stage] != 0U) {
+                printf("    %-20s %10.2f ms %8llu\n", GetLoadStageName(static_cast<LoadStage>(stage)),
+                       _run.stageTimes[stage], static_cast<unsigned long long>(_run.stageCounts[stage]));
+            }
+        }
+    }
+} // namespace
+
+// dadengine-bench [--runs count] [--json report.json] [--no-cache] [--compress] [--bc7 [quality]]
+//                 [--release-cpu-data] [--crowd count] [--skinning lbs|dq] <scene.gltf|scene.glb|scene.dpak>...
+int main(int argc, char **argv)
+{
+    TextureCompressionSettings compression;
+    std::vector<std::filesystem::path> paths;
+    std::string jsonPath;
+    uint32_t runCount   = 3U;
+    uint32_t crowdSize  = 1U;
+    bool releaseCPUData = false;
+
+    SkinningMethod skinningMethod = SkinningMethod::LinearBlend;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runCount = std::max(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)), 1U);
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--crowd") == 0 && i + 1 < argc) {
+            crowdSize = std::max(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)), 1U);
+        }
+        else if (std::strcmp(argv[i], "--skinning") == 0 && i + 1 < argc) {
+            skinningMethod = std::strcmp(argv[++i], "dq") == 0 ? SkinningMethod::DualQuaternion
+                                                                : SkinningMethod::LinearBlend;
+        }
+        else if (std::strcmp(argv[i], "--no-cache") == 0) {
+            DerivedDataCache::Get().SetEnabled(false);
+        }
+        else if (std::strcmp(argv[i], "--release-cpu-data") == 0) {
+            releaseCPUData = true;
+        }
+        else if (std::strcmp(argv[i], "--compress") == 0) {
+            compression.enabled = true;
+        }
+        else if (std::strcmp(argv[i], "--bc7") == 0) {
+            compression.enabled = true;
+            compression.useBC7  = true;
+
+            if (i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9') {
+                compression.bc7Quality = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+        }
+        else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+
+    if (paths.empty()) {
+        std::cout << "Usage : dadengine-bench [--runs count] [--json report.json|-] [--no-cache] [--compress] "
+                     "[--bc7 [quality]] [--release-cpu-data] [--crowd count] [--skinning lbs|dq] "
+                     "<scene.gltf|scene.glb|scene.dpak>...\n";
+        return 1;
+    }
+
+    // Only the JSON goes to the standard output when asked for, the
+    // messages of the loaders, cache and cooker are sent to the error one
+    std::streambuf *standardOutput = std::cout.rdbuf();
+    if (jsonPath == "-") {
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    LoadProfiler::Get().SetEnabled(true);
+
+    std::vector<SceneReport> reports;
+    bool failed = false;
+
+    for (const auto &path : paths) {
+        SceneReport &report = reports.emplace_back();
+        report.path         = path;
+        report.cooked       = path.extension() == ".dpak";
+
+        bool printRuns = jsonPath != "-";
+        if (printRuns) {
+            printf("%s\n", path.string().c_str());
+        }
+
+        for (uint32_t run = 0; run < runCount; run++) {
+            report.runs.push_back(
+                LoadScene(path, report.cooked, compression, releaseCPUData, crowdSize, skinningMethod));
+
+            if (printRuns) {
+                PrintRun(report.runs.back(), run);
+            }
+        }
+
+        if (report.runs.front().meshCount == 0U) {
+            std::cout << "Failed to load " << path.string() << "\n";
+            failed = true;
+        }
+    }
+
+    if (jsonPath == "-") {
+        std::ostream stream(standardOutput);
+        WriteJSON(stream, reports);
+        std::cout.rdbuf(standardOutput);
+    }
+    else if (!jsonPath.empty()) {
+        std::ofstream file(jsonPath);
+        WriteJSON(file, reports);
+
+        if (!file) {
+            std::cout << "Failed to write " << jsonPath << "\n";
+            failed = true;
+        }
+    }
+
+    return failed ? 1 : 0;
+}
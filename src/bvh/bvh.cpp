@@ -0,0 +1,788 @@
+#include "bvh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <future>
+#include <limits>
+
+#include "model/model.hpp"
+
+namespace DadEngine
+{
+    constexpr uint32_t MAX_BIN_COUNT  = 32U;
+    constexpr uint32_t MAX_SAH_DEPTH  = 64U;
+    // Median splits halve the range, so at most 32 more levels below the SAH ones
+    constexpr uint32_t MAX_TREE_DEPTH = MAX_SAH_DEPTH + 32U;
+    // Each level pushes at most one node, Overlap pushes the root first
+    constexpr uint32_t STACK_SIZE = MAX_TREE_DEPTH + 1U;
+    // A wide node pushes up to Width children and pops itself, every wide
+    // level being at least one level deeper in the source BVH
+    template <uint32_t Width>
+    constexpr uint32_t WIDE_STACK_SIZE = (Width - 1U) * MAX_TREE_DEPTH + 1U;
+    constexpr float MISS              = std::numeric_limits<float>::max();
+    constexpr uint32_t TRIANGLES_MODE = 4U; // Same value for glTF and OpenGL
+
+    inline float Axis(const Vector3 &_vector, uint32_t _axis)
+    {
+        return _axis == 0U ? _vector.x : (_axis == 1U ? _vector.y : _vector.z);
+    }
+
+    struct BuildContext
+    {
+        const BVHBuildSettings &settings;
+        const std::vector<AABB> &triangleBounds;
+        const std::vector<Vector3> &centroids;
+        std::vector<uint32_t> &indices;
+    };
+
+    struct Bin
+    {
+        AABB bounds    = AABB::Empty();
+        uint32_t count = 0U;
+    };
+
+    // Computes the bounds of the range and partitions it along the best SAH
+    // plane, or at its median past the max depth, returns false when the
+    // range should become a leaf
+    inline bool SplitRange(const BuildContext &_context,
+                           uint32_t _begin,
+                           uint32_t _end,
+                           uint32_t _depth,
+                           AABB &_bounds,
+                           uint32_t &_middle)
+    {
+        const BVHBuildSettings &settings = _context.settings;
+        const uint32_t count             = _end - _begin;
+
+        _bounds             = AABB::Empty();
+        AABB centroidBounds = AABB::Empty();
+        for (uint32_t i = _begin; i < _end; i++)
+        {
+            uint32_t triangle = _context.indices[i];
+            _bounds.Grow(_context.triangleBounds[triangle]);
+            centroidBounds.Grow(_context.centroids[triangle]);
+        }
+
+        if (count <= 1U)
+        {
+            return false;
+        }
+
+        if (_depth >= std::min(settings.maxDepth, MAX_SAH_DEPTH))
+        {
+            if (count <= settings.maxLeafSize)
+            {
+                return false;
+            }
+
+            _middle = _begin + count / 2U;
+            return true;
+        }
+
+        const uint32_t binCount = std::clamp(settings.binCount, 2U, MAX_BIN_COUNT);
+
+        float bestCost     = MISS;
+        uint32_t bestAxis  = 0U;
+        uint32_t bestSplit = 0U;
+
+        for (uint32_t axis = 0U; axis < 3U; axis++)
+        {
+            float centroidMin = Axis(centroidBounds.m_min, axis);
+            float centroidMax = Axis(centroidBounds.m_max, axis);
+
+            if (centroidMax - centroidMin <= 0.f)
+            {
+                continue;
+            }
+
+            float scale = static_cast<float>(binCount) / (centroidMax - centroidMin);
+
+            std::array<Bin, MAX_BIN_COUNT> bins {};
+            for (uint32_t i = _begin; i < _end; i++)
+            {
+                uint32_t triangle = _context.indices[i];
+                uint32_t bin      = std::min(
+                    binCount - 1U,
+                    static_cast<uint32_t>(
+                        (Axis(_context.centroids[triangle], axis) - centroidMin) * scale));
+
+                bins[bin].count++;
+                bins[bin].bounds.Grow(_context.triangleBounds[triangle]);
+            }
+
+            // Sweep from both sides to evaluate every plane between bins
+            std::array<float, MAX_BIN_COUNT> leftArea {};
+            std::array<uint32_t, MAX_BIN_COUNT> leftCount {};
+            AABB leftBounds    = AABB::Empty();
+            uint32_t leftTotal = 0U;
+            for (uint32_t i = 0U; i < binCount - 1U; i++)
+            {
+                leftBounds.Grow(bins[i].bounds);
+                leftTotal += bins[i].count;
+                leftArea[i]  = leftBounds.SurfaceArea();
+                leftCount[i] = leftTotal;
+            }
+
+            AABB rightBounds    = AABB::Empty();
+            uint32_t rightTotal = 0U;
+            for (uint32_t i = binCount - 1U; i > 0U; i--)
+            {
+                rightBounds.Grow(bins[i].bounds);
+                rightTotal += bins[i].count;
+
+                float cost = leftArea[i - 1U] * static_cast<float>(leftCount[i - 1U])
+                             + rightBounds.SurfaceArea() * static_cast<float>(rightTotal);
+
+                if (leftCount[i - 1U] != 0U && rightTotal != 0U && cost < bestCost)
+                {
+                    bestCost  = cost;
+                    bestAxis  = axis;
+                    bestSplit = i;
+                }
+            }
+        }
+
+        uint32_t *first = _context.indices.data() + _begin;
+        uint32_t *last  = _context.indices.data() + _end;
+
+        // All centroids are at the same place, only a median split can help
+        if (bestCost == MISS)
+        {
+            if (count <= settings.maxLeafSize)
+            {
+                return false;
+            }
+
+            _middle = _begin + count / 2U;
+            return true;
+        }
+
+        float parentArea = _bounds.SurfaceArea();
+        float splitCost  = settings.traversalCost
+                          + settings.intersectionCost * bestCost / std::max(parentArea, 1e-30f);
+        float leafCost = settings.intersectionCost * static_cast<float>(count);
+
+        if (splitCost >= leafCost && count <= settings.maxLeafSize)
+        {
+            return false;
+        }
+
+        float centroidMin = Axis(centroidBounds.m_min, bestAxis);
+        float scale       = static_cast<float>(binCount)
+                      / (Axis(centroidBounds.m_max, bestAxis) - centroidMin);
+
+        uint32_t *split = std::partition(first, last, [&](uint32_t _triangle) {
+            uint32_t bin = std::min(
+                binCount - 1U,
+                static_cast<uint32_t>(
+                    (Axis(_context.centroids[_triangle], bestAxis) - centroidMin) * scale));
+            return bin < bestSplit;
+        });
+
+        _middle = _begin + static_cast<uint32_t>(split - first);
+
+        if (_middle == _begin || _middle == _end)
+        {
+            _middle = _begin + count / 2U;
+        }
+
+        return true;
+    }
+
+    inline void SetNodeBounds(BVHNode &_node, const AABB &_bounds)
+    {
+        _node.boundsMin = _bounds.m_min;
+        _node.boundsMax = _bounds.m_max;
+    }
+
+    void BuildSequential(const BuildContext &_context,
+                         uint32_t _begin,
+                         uint32_t _end,
+                         uint32_t _depth,
+                         std::vector<BVHNode> &_nodes)
+    {
+        auto nodeIndex = static_cast<uint32_t>(_nodes.size());
+        _nodes.emplace_back();
+
+        AABB bounds;
+        uint32_t middle = 0U;
+        bool split      = SplitRange(_context, _begin, _end, _depth, bounds, middle);
+
+        SetNodeBounds(_nodes[nodeIndex], bounds);
+
+        if (!split)
+        {
+            _nodes[nodeIndex].rightOrFirst = _begin;
+            _nodes[nodeIndex].count        = _end - _begin;
+            return;
+        }
+
+        // Left child directly follows its parent
+        BuildSequential(_context, _begin, middle, _depth + 1U, _nodes);
+
+        _nodes[nodeIndex].rightOrFirst = static_cast<uint32_t>(_nodes.size());
+        _nodes[nodeIndex].count        = 0U;
+
+        BuildSequential(_context, middle, _end, _depth + 1U, _nodes);
+    }
+
+    // Top levels build each side of a split as an independent subtree, they
+    // are then concatenated with their child indices relocated
+    std::vector<BVHNode>
+    BuildParallel(const BuildContext &_context, uint32_t _begin, uint32_t _end, uint32_t _depth)
+    {
+        std::vector<BVHNode> nodes;
+
+        if (_depth >= _context.settings.parallelDepth
+            || _end - _begin < _context.settings.parallelThreshold)
+        {
+            nodes.reserve(2U * (_end - _begin));
+            BuildSequential(_context, _begin, _end, _depth, nodes);
+            return nodes;
+        }
+
+        AABB bounds;
+        uint32_t middle = 0U;
+        bool split      = SplitRange(_context, _begin, _end, _depth, bounds, middle);
+
+        BVHNode root {};
+        SetNodeBounds(root, bounds);
+
+        if (!split)
+        {
+            root.rightOrFirst = _begin;
+            root.count        = _end - _begin;
+            nodes.push_back(root);
+            return nodes;
+        }
+
+        auto leftTask = std::async(std::launch::async, BuildParallel, std::cref(_context),
+                                   _begin, middle, _depth + 1U);
+        std::vector<BVHNode> right = BuildParallel(_context, middle, _end, _depth + 1U);
+        std::vector<BVHNode> left  = leftTask.get();
+
+        auto leftOffset   = 1U;
+        auto rightOffset  = static_cast<uint32_t>(1U + left.size());
+        root.rightOrFirst = rightOffset;
+        root.count        = 0U;
+
+        nodes.reserve(1U + left.size() + right.size());
+        nodes.push_back(root);
+
+        for (auto &node : left)
+        {
+            node.rightOrFirst += node.IsLeaf() ? 0U : leftOffset;
+            nodes.push_back(node);
+        }
+
+        for (auto &node : right)
+        {
+            node.rightOrFirst += node.IsLeaf() ? 0U : rightOffset;
+            nodes.push_back(node);
+        }
+
+        return nodes;
+    }
+
+    inline float IntersectBox(const Vector3 &_min, const Vector3 &_max, const Vector3 &_origin, const Vector3 &_inverseDirection, float _tMax)
+    {
+        float tx1 = (_min.x - _origin.x) * _inverseDirection.x;
+        float tx2 = (_max.x - _origin.x) * _inverseDirection.x;
+        float ty1 = (_min.y - _origin.y) * _inverseDirection.y;
+        float ty2 = (_max.y - _origin.y) * _inverseDirection.y;
+        float tz1 = (_min.z - _origin.z) * _inverseDirection.z;
+        float tz2 = (_max.z - _origin.z) * _inverseDirection.z;
+
+        float tNear = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)),
+                               std::min(tz1, tz2));
+        float tFar = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)),
+                              std::max(tz1, tz2));
+
+        return tFar >= tNear && tFar > 0.f && tNear < _tMax ? tNear : MISS;
+    }
+
+    // Möller-Trumbore
+    inline bool IntersectTriangle(const Ray &_ray, const BVHTriangle &_triangle, uint32_t _index, RayHit &_hit)
+    {
+        Vector3 edge1(_triangle.v1.x - _triangle.v0.x, _triangle.v1.y - _triangle.v0.y,
+                      _triangle.v1.z - _triangle.v0.z);
+        Vector3 edge2(_triangle.v2.x - _triangle.v0.x, _triangle.v2.y - _triangle.v0.y,
+                      _triangle.v2.z - _triangle.v0.z);
+        Vector3 direction = _ray.direction;
+
+        Vector3 h           = direction ^ edge2;
+        float determinant   = edge1.Dot(h);
+        if (std::abs(determinant) < 1e-12f)
+        {
+            return false;
+        }
+
+        float inverseDeterminant = 1.f / determinant;
+        Vector3 s(_ray.origin.x - _triangle.v0.x, _ray.origin.y - _triangle.v0.y,
+                  _ray.origin.z - _triangle.v0.z);
+
+        float u = s.Dot(h) * inverseDeterminant;
+        if (u < 0.f || u > 1.f)
+        {
+            return false;
+        }
+
+        Vector3 q = s ^ edge1;
+        float v   = direction.Dot(q) * inverseDeterminant;
+        if (v < 0.f || u + v > 1.f)
+        {
+            return false;
+        }
+
+        float t = edge2.Dot(q) * inverseDeterminant;
+        if (t <= 1e-6f || t >= _hit.t || t >= _ray.tMax)
+        {
+            return false;
+        }
+
+        _hit = RayHit { t, u, v, _index };
+        return true;
+    }
+
+    inline AABB TriangleBounds(const BVHTriangle &_triangle)
+    {
+        AABB bounds = AABB::Empty();
+        bounds.Grow(_triangle.v0);
+        bounds.Grow(_triangle.v1);
+        bounds.Grow(_triangle.v2);
+
+        return bounds;
+    }
+
+    inline Vector3 InverseDirection(const Vector3 &_direction)
+    {
+        return Vector3(1.f / _direction.x, 1.f / _direction.y, 1.f / _direction.z);
+    }
+
+
+    void BVH::Build(std::vector<BVHTriangle> &&_triangles, const BVHBuildSettings &_settings)
+    {
+        m_nodes.clear();
+        m_triangles.clear();
+
+        if (_triangles.empty())
+        {
+            return;
+        }
+
+        std::vector<AABB> triangleBounds(_triangles.size());
+        std::vector<Vector3> centroids(_triangles.size());
+        std::vector<uint32_t> indices(_triangles.size());
+
+        for (size_t i = 0U; i < _triangles.size(); i++)
+        {
+            triangleBounds[i] = TriangleBounds(_triangles[i]);
+            centroids[i]      = triangleBounds[i].Center();
+            indices[i]        = static_cast<uint32_t>(i);
+        }
+
+        BuildContext context { _settings, triangleBounds, centroids, indices };
+        m_nodes = BuildParallel(context, 0U, static_cast<uint32_t>(indices.size()), 0U);
+
+        // Leaves reference contiguous ranges so reorder triangles to match
+        m_triangles.reserve(_triangles.size());
+        for (uint32_t index : indices)
+        {
+            m_triangles.push_back(_triangles[index]);
+        }
+    }
+
+    bool BVH::Intersect(const Ray &_ray, RayHit &_hit) const
+    {
+        if (m_nodes.empty())
+        {
+            return false;
+        }
+
+        Vector3 inverseDirection = InverseDirection(_ray.direction);
+        bool hasHit              = false;
+
+        if (IntersectBox(m_nodes[0U].boundsMin, m_nodes[0U].boundsMax, _ray.origin,
+                         inverseDirection, std::min(_ray.tMax, _hit.t))
+            == MISS)
+        {
+            return false;
+        }
+
+        std::array<uint32_t, STACK_SIZE> stack {};
+        uint32_t stackSize = 0U;
+        uint32_t nodeIndex = 0U;
+
+        while (true)
+        {
+            const BVHNode &node = m_nodes[nodeIndex];
+
+            if (node.IsLeaf())
+            {
+                for (uint32_t i = node.rightOrFirst; i < node.rightOrFirst + node.count; i++)
+                {
+                    hasHit |= IntersectTriangle(_ray, m_triangles[i], i, _hit);
+                }
+
+                if (stackSize == 0U)
+                {
+                    break;
+                }
+
+                nodeIndex = stack[--stackSize];
+                continue;
+            }
+
+            uint32_t nearIndex = nodeIndex + 1U;
+            uint32_t farIndex  = node.rightOrFirst;
+            float tMax         = std::min(_ray.tMax, _hit.t);
+            float nearDistance
+                = IntersectBox(m_nodes[nearIndex].boundsMin, m_nodes[nearIndex].boundsMax,
+                               _ray.origin, inverseDirection, tMax);
+            float farDistance
+                = IntersectBox(m_nodes[farIndex].boundsMin, m_nodes[farIndex].boundsMax,
+                               _ray.origin, inverseDirection, tMax);
+
+            if (nearDistance > farDistance)
+            {
+                std::swap(nearIndex, farIndex);
+                std::swap(nearDistance, farDistance);
+            }
+
+            if (nearDistance == MISS)
+            {
+                if (stackSize == 0U)
+                {
+                    break;
+                }
+
+                nodeIndex = stack[--stackSize];
+                continue;
+            }
+
+            nodeIndex = nearIndex;
+
+            if (farDistance != MISS)
+            {
+                stack[stackSize++] = farIndex;
+            }
+        }
+
+        return hasHit;
+    }
+
+    void BVH::Overlap(const AABB &_box, std::vector<uint32_t> &_triangles) const
+    {
+        if (m_nodes.empty())
+        {
+            return;
+        }
+
+        std::array<uint32_t, STACK_SIZE> stack {};
+        uint32_t stackSize = 0U;
+        stack[stackSize++] = 0U;
+
+        while (stackSize != 0U)
+        {
+            const BVHNode &node = m_nodes[stack[--stackSize]];
+
+            if (!_box.Overlaps(AABB(node.boundsMin, node.boundsMax)))
+            {
+                continue;
+            }
+
+            if (node.IsLeaf())
+            {
+                for (uint32_t i = node.rightOrFirst; i < node.rightOrFirst + node.count; i++)
+                {
+                    if (_box.Overlaps(TriangleBounds(m_triangles[i])))
+                    {
+                        _triangles.push_back(i);
+                    }
+                }
+
+                continue;
+            }
+
+            stack[stackSize++] = node.rightOrFirst;
+            stack[stackSize++] = static_cast<uint32_t>(&node - m_nodes.data()) + 1U;
+        }
+    }
+
+
+    template <uint32_t Width>
+    void WideBVH<Width>::Build(const BVH &_bvh)
+    {
+        m_nodes.clear();
+        m_triangles = &_bvh.GetTriangles();
+
+        const std::vector<BVHNode> &nodes = _bvh.GetNodes();
+        if (nodes.empty())
+        {
+            return;
+        }
+
+        if (!nodes[0U].IsLeaf())
+        {
+            collapse(_bvh, 0U);
+            return;
+        }
+
+        // Single leaf tree, wrap it into a root with only one valid child
+        WideBVHNode<Width> root {};
+        for (uint32_t i = 0U; i < Width; i++)
+        {
+            root.minX[i] = root.minY[i] = root.minZ[i] = MISS;
+            root.maxX[i] = root.maxY[i] = root.maxZ[i] = -MISS;
+            root.child[i] = WideBVHNode<Width>::INVALID_CHILD;
+            root.count[i] = 0U;
+        }
+
+        root.minX[0U]  = nodes[0U].boundsMin.x;
+        root.minY[0U]  = nodes[0U].boundsMin.y;
+        root.minZ[0U]  = nodes[0U].boundsMin.z;
+        root.maxX[0U]  = nodes[0U].boundsMax.x;
+        root.maxY[0U]  = nodes[0U].boundsMax.y;
+        root.maxZ[0U]  = nodes[0U].boundsMax.z;
+        root.child[0U] = nodes[0U].rightOrFirst;
+        root.count[0U] = nodes[0U].count;
+
+        m_nodes.push_back(root);
+    }
+
+    template <uint32_t Width>
+    uint32_t WideBVH<Width>::collapse(const BVH &_bvh, uint32_t _nodeIndex)
+    {
+        const std::vector<BVHNode> &nodes = _bvh.GetNodes();
+
+        auto wideIndex = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+
+        // Keep opening the largest inner child until the node is full
+        std::array<uint32_t, Width> children {};
+        uint32_t childCount = 2U;
+        children[0U]        = _nodeIndex + 1U;
+        children[1U]        = nodes[_nodeIndex].rightOrFirst;
+
+        while (childCount < Width)
+        {
+            float largestArea = -1.f;
+            uint32_t largest  = Width;
+
+            for (uint32_t i = 0U; i < childCount; i++)
+            {
+                const BVHNode &child = nodes[children[i]];
+                if (child.IsLeaf())
+                {
+                    continue;
+                }
+
+                float area = AABB(child.boundsMin, child.boundsMax).SurfaceArea();
+                if (area > largestArea)
+                {
+                    largestArea = area;
+                    largest     = i;
+                }
+            }
+
+            if (largest == Width)
+            {
+                break;
+            }
+
+            uint32_t opened         = children[largest];
+            children[largest]       = opened + 1U;
+            children[childCount++]  = nodes[opened].rightOrFirst;
+        }
+
+        WideBVHNode<Width> wideNode {};
+        for (uint32_t i = 0U; i < Width; i++)
+        {
+            if (i >= childCount)
+            {
+                wideNode.minX[i] = wideNode.minY[i] = wideNode.minZ[i] = MISS;
+                wideNode.maxX[i] = wideNode.maxY[i] = wideNode.maxZ[i] = -MISS;
+                wideNode.child[i] = WideBVHNode<Width>::INVALID_CHILD;
+                wideNode.count[i] = 0U;
+                continue;
+            }
+
+            const BVHNode &child = nodes[children[i]];
+
+            wideNode.minX[i] = child.boundsMin.x;
+            wideNode.minY[i] = child.boundsMin.y;
+            wideNode.minZ[i] = child.boundsMin.z;
+            wideNode.maxX[i] = child.boundsMax.x;
+            wideNode.maxY[i] = child.boundsMax.y;
+            wideNode.maxZ[i] = child.boundsMax.z;
+
+            wideNode.child[i] = child.IsLeaf() ? child.rightOrFirst : collapse(_bvh, children[i]);
+            wideNode.count[i] = child.count;
+        }
+
+        m_nodes[wideIndex] = wideNode;
+
+        return wideIndex;
+    }
+
+    template <uint32_t Width>
+    bool WideBVH<Width>::Intersect(const Ray &_ray, RayHit &_hit) const
+    {
+        if (m_nodes.empty())
+        {
+            return false;
+        }
+
+        Vector3 inverseDirection = InverseDirection(_ray.direction);
+        bool hasHit              = false;
+
+        std::array<uint32_t, WIDE_STACK_SIZE<Width>> stack {};
+        uint32_t stackSize = 0U;
+        stack[stackSize++] = 0U;
+
+        while (stackSize != 0U)
+        {
+            const WideBVHNode<Width> &node = m_nodes[stack[--stackSize]];
+            float tMax                     = std::min(_ray.tMax, _hit.t);
+
+            // Slab test against every child, written to let the compiler
+            // vectorize over the SoA bounds
+            std::array<float, Width> distances {};
+            for (uint32_t i = 0U; i < Width; i++)
+            {
+                float tx1 = (node.minX[i] - _ray.origin.x) * inverseDirection.x;
+                float tx2 = (node.maxX[i] - _ray.origin.x) * inverseDirection.x;
+                float ty1 = (node.minY[i] - _ray.origin.y) * inverseDirection.y;
+                float ty2 = (node.maxY[i] - _ray.origin.y) * inverseDirection.y;
+                float tz1 = (node.minZ[i] - _ray.origin.z) * inverseDirection.z;
+                float tz2 = (node.maxZ[i] - _ray.origin.z) * inverseDirection.z;
+
+                float tNear = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)),
+                                       std::min(tz1, tz2));
+                float tFar = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)),
+                                      std::max(tz1, tz2));
+
+                distances[i] = tFar >= tNear && tFar > 0.f && tNear < tMax ? tNear : MISS;
+            }
+
+            // Sort hit children front to back
+            std::array<uint32_t, Width> order {};
+            uint32_t hitCount = 0U;
+            for (uint32_t i = 0U; i < Width; i++)
+            {
+                if (distances[i] == MISS || node.child[i] == WideBVHNode<Width>::INVALID_CHILD)
+                {
+                    continue;
+                }
+
+                uint32_t slot = hitCount++;
+                while (slot > 0U && distances[order[slot - 1U]] > distances[i])
+                {
+                    order[slot] = order[slot - 1U];
+                    slot--;
+                }
+                order[slot] = i;
+            }
+
+            // Push far children first so the nearest one is popped next
+            for (uint32_t i = hitCount; i > 0U; i--)
+            {
+                uint32_t child = order[i - 1U];
+
+                if (node.count[child] == 0U)
+                {
+                    stack[stackSize++] = node.child[child];
+                    continue;
+                }
+
+                for (uint32_t j = node.child[child]; j < node.child[child] + node.count[child]; j++)
+                {
+                    hasHit |= IntersectTriangle(_ray, (*m_triangles)[j], j, _hit);
+                }
+            }
+        }
+
+        return hasHit;
+    }
+
+    template <uint32_t Width>
+    void WideBVH<Width>::Overlap(const AABB &_box, std::vector<uint32_t> &_triangles) const
+    {
+        if (m_nodes.empty())
+        {
+            return;
+        }
+
+        std::array<uint32_t, WIDE_STACK_SIZE<Width>> stack {};
+        uint32_t stackSize = 0U;
+        stack[stackSize++] = 0U;
+
+        while (stackSize != 0U)
+        {
+            const WideBVHNode<Width> &node = m_nodes[stack[--stackSize]];
+
+            for (uint32_t i = 0U; i < Width; i++)
+            {
+                bool overlaps = node.minX[i] <= _box.m_max.x && node.maxX[i] >= _box.m_min.x
+                                && node.minY[i] <= _box.m_max.y && node.maxY[i] >= _box.m_min.y
+                                && node.minZ[i] <= _box.m_max.z && node.maxZ[i] >= _box.m_min.z;
+
+                if (!overlaps || node.child[i] == WideBVHNode<Width>::INVALID_CHILD)
+                {
+                    continue;
+                }
+
+                if (node.count[i] == 0U)
+                {
+                    stack[stackSize++] = node.child[i];
+                    continue;
+                }
+
+                for (uint32_t j = node.child[i]; j < node.child[i] + node.count[i]; j++)
+                {
+                    if (_box.Overlaps(TriangleBounds((*m_triangles)[j])))
+                    {
+                        _triangles.push_back(j);
+                    }
+                }
+            }
+        }
+    }
+
+    template class WideBVH<4U>;
+    template class WideBVH<8U>;
+
+
+    std::vector<BVHTriangle> GatherTriangles(const Mesh &_mesh)
+    {
+        std::vector<BVHTriangle> triangles;
+
+        for (size_t p = 0U; p < _mesh.m_primitives.size(); p++)
+        {
+            const Primitive &primitive = _mesh.m_primitives[p];
+
+            if (primitive.drawMode != TRIANGLES_MODE)
+            {
+                continue;
+            }
+
+            const std::vector<Vertex> &vertices  = primitive.vertices.vertices;
+            const std::vector<uint32_t> &indices = primitive.indices.indices;
+            size_t indexCount = indices.empty() ? vertices.size() : indices.size();
+
+            for (size_t i = 0U; i + 2U < indexCount; i += 3U)
+            {
+                uint32_t i0 = indices.empty() ? static_cast<uint32_t>(i) : indices[i];
+                uint32_t i1 = indices.empty() ? static_cast<uint32_t>(i + 1U) : indices[i + 1U];
+                uint32_t i2 = indices.empty() ? static_cast<uint32_t>(i + 2U) : indices[i + 2U];
+
+                triangles.push_back({ vertices[i0].position, vertices[i1].position,
+                                      vertices[i2].position, static_cast<uint32_t>(p),
+                                      static_cast<uint32_t>(i / 3U) });
+            }
+        }
+
+        return triangles;
+    }
+} // namespace DadEngine
@@ -0,0 +1,44 @@
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#include "cooker/scene-cooker.hpp"
+
+using namespace DadEngine;
+
+// dadengine-cook [--compress] [--bc7 [quality]] <scene.gltf> [scene.dpak]
+int main(int argc, char **argv)
+{
+    TextureCompressionSettings compression;
+    std::vector<std::filesystem::path> paths;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--compress") == 0) {
+            compression.enabled = true;
+        }
+        else if (std::strcmp(argv[i], "--bc7") == 0) {
+            compression.enabled = true;
+            compression.useBC7  = true;
+
+            if (i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9') {
+                compression.bc7Quality = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+        }
+        else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+
+    if (paths.empty() || paths.size() > 2) {
+        std::cout << "Usage : dadengine-cook [--compress] [--bc7 [quality]] <scene.gltf|scene.glb> "
+                     "[output.dpak]\n";
+        return 1;
+    }
+
+    std::filesystem::path output = paths.size() > 1 ? paths[1]
+                                                    : std::filesystem::path(paths[0]).replace_extension(".dpak");
+
+    return CookScene(paths[0], output, compression) ? 0 : 1;
+}
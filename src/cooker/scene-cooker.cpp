@@ -0,0 +1,370 @@
+#include "scene-cooker.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <stb_image.h>
+
+#include "helpers/derived-data-cache.hpp"
+#include "helpers/thread-pool.hpp"
+#include "loaders/gltf-asset.hpp"
+#include "loaders/gltf-loader.hpp"
+#include "loaders/mip-generator.hpp"
+#include "loaders/scene-pack.hpp"
+#include "loaders/texture-container.hpp"
+#include "scene/scene-graph.hpp"
+
+namespace DadEngine
+{
+    struct CookedLevel
+    {
+        std::vector<uint8_t> data;
+        int32_t width  = 0;
+        int32_t height = 0;
+    };
+
+    // Image in the format it is uploaded with
+    struct CookedImage
+    {
+        TextureFormat format = TextureFormat::RGB8;
+        bool hasAlpha        = false;
+        std::vector<CookedLevel> levels;
+    };
+
+    struct CookedPrimitive
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        PackedPrimitive packed {};
+    };
+
+    // KTX2 and DDS levels are kept as they are, the other images get the
+    // mip chain and the compression of the runtime loader
+    inline bool CookImage(const GLTFAsset &_asset, uint32_t _imageIndex,
+                          const TextureCompressionSettings &_compression, CookedImage &_image)
+    {
+        ByteBuffer storage;
+        std::span<const uint8_t> encodedImage = _asset.ReadImage(_imageIndex, storage);
+        if (encodedImage.empty()) {
+            return false;
+        }
+
+        _image = {};
+
+        if (IsTextureContainer(encodedImage)) {
+            CompressedImage compressed;
+            if (!ParseTextureContainer(encodedImage, compressed)) {
+                return false;
+            }
+
+            _image.format   = compressed.format;
+            _image.hasAlpha = compressed.hasAlpha;
+            for (const auto &level : compressed.levels) {
+                _image.levels.push_back(
+                    { { level.data, level.data + level.size }, level.width, level.height });
+            }
+
+            return true;
+        }
+
+        _image.hasAlpha = _asset.HasAlpha(_imageIndex);
+
+        int32_t width    = 0;
+        int32_t height   = 0;
+        int32_t channels = 0;
+
+        uint8_t *pixels = stbi_load_from_memory(encodedImage.data(),
+                                                static_cast<int>(encodedImage.size()), &width,
+                                                &height, &channels, 0);
+        if (!pixels) {
+            return false;
+        }
+
+        const MipSettings &mipSettings = _asset.GetMipSettings(_imageIndex);
+        MipChain mips = GenerateMips(pixels, width, height, channels, _image.hasAlpha, mipSettings);
+        stbi_image_free(pixels);
+
+        _image.format = mips.channels == 4 ? TextureFormat::RGBA8 : TextureFormat::RGB8;
+        std::vector<TextureLevel> levels = mips.levels;
+        std::vector<uint8_t> blocks;
+
+        if (_compression.enabled) {
+            _image.format = ChooseCompressedFormat(mipSettings.usage, _image.hasAlpha, _compression);
+            levels = CompressLevels(mips.levels, mips.channels, _image.format, _compression.bc7Quality,
+                                    blocks);
+        }
+
+        for (const auto &level : levels) {
+            _image.levels.push_back({ { level.data, level.data + level.size }, level.width, level.height });
+        }
+
+        return true;
+    }
+
+    // Processed like the runtime loader does, through the derived data cache
+    inline CookedPrimitive CookPrimitive(const GLTFAsset &_asset, uint32_t _meshIndex, uint32_t _primitiveIndex)
+    {
+        const GLTFPrimitive &gltfPrimitive
+            = _asset.GetDocument().meshes[_meshIndex].primitives[_primitiveIndex];
+
+        CookedPrimitive primitive;
+        _asset.ReadProcessedPrimitive(_meshIndex, _primitiveIndex, primitive.vertices,
+                                      primitive.indices);
+
+        AABB bounds = ComputeBounds(primitive.vertices);
+
+        PackedPrimitive &packed = primitive.packed;
+        packed.vertexCount      = static_cast<uint32_t>(primitive.vertices.size());
+        packed.indexCount       = static_cast<uint32_t>(primitive.indices.size());
+        packed.drawMode         = gltfPrimitive.mode;
+        packed.material         = gltfPrimitive.material;
+        packed.boundsMin[0]     = bounds.m_min.x;
+        packed.boundsMin[1]     = bounds.m_min.y;
+        packed.boundsMin[2]     = bounds.m_min.z;
+        packed.boundsMax[0]     = bounds.m_max.x;
+        packed.boundsMax[1]     = bounds.m_max.y;
+        packed.boundsMax[2]     = bounds.m_max.z;
+
+        return primitive;
+    }
+
+    bool CookScene(const std::filesystem::path &_input, const std::filesystem::path &_output,
+                   const TextureCompressionSettings &_compression)
+    {
+        GLTFAsset asset;
+        if (!asset.Load(_input)) {
+            return false;
+        }
+
+        const GLTFDocument &document = asset.GetDocument();
+
+        // One texture per image and sampler pair, its image is decoded once
+        // whatever the number of samplers
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> textureIndices;
+        std::unordered_map<uint32_t, uint32_t> imageIndices;
+        std::vector<PackedTexture> textures;
+        std::vector<uint32_t> textureImages;
+        std::vector<uint32_t> imageSources; // glTF texture decoding each image
+
+        auto getTexture = [&](const GLTFTextureInfo &_textureInfo) {
+            if (_textureInfo.index == GLTF_INVALID_INDEX) {
+                return SCENE_PACK_INVALID;
+            }
+
+            const GLTFTexture &texture = document.textures[_textureInfo.index];
+            uint32_t imageIndex        = GetTextureImage(texture);
+
+            auto [entry, inserted] = textureIndices.try_emplace({ imageIndex, texture.sampler },
+                                                                static_cast<uint32_t>(textures.size()));
+            if (inserted) {
+                auto [image, newImage] = imageIndices.try_emplace(
+                    imageIndex, static_cast<uint32_t>(imageSources.size()));
+                if (newImage) {
+                    imageSources.push_back(_textureInfo.index);
+                }
+
+                GLTFSampler sampler = texture.sampler != GLTF_INVALID_INDEX
+                                          ? document.samplers[texture.sampler]
+                                          : GLTFSampler {};
+
+                PackedTexture &packed = textures.emplace_back();
+                packed.magFilter      = sampler.magFilter;
+                packed.minFilter      = sampler.minFilter;
+                packed.wrapS          = sampler.wrapS;
+                packed.wrapT          = sampler.wrapT;
+                textureImages.push_back(image->second);
+            }
+
+            return entry->second;
+        };
+
+        std::vector<PackedMaterial> materials;
+        for (size_t i = 0; i < document.materials.size(); i++) {
+            const GLTFMaterial &gltfMaterial = document.materials[i];
+            PackedMaterial &material         = materials.emplace_back();
+
+            std::memcpy(material.baseColorFactor, gltfMaterial.baseColorFactor,
+                        sizeof(material.baseColorFactor));
+            std::memcpy(material.emissiveFactor, gltfMaterial.emissiveFactor,
+                        sizeof(material.emissiveFactor));
+            material.metallicFactor    = gltfMaterial.metallicFactor;
+            material.roughnessFactor   = gltfMaterial.roughnessFactor;
+            material.normalScale       = gltfMaterial.normalTexture.scale;
+            material.occlusionStrength = gltfMaterial.occlusionTexture.scale;
+            material.id                = static_cast<uint32_t>(i);
+
+            material.textures[0] = getTexture(gltfMaterial.baseColorTexture);
+            material.textures[1] = getTexture(gltfMaterial.metallicRoughnessTexture);
+            material.textures[2] = getTexture(gltfMaterial.normalTexture);
+            material.textures[3] = getTexture(gltfMaterial.occlusionTexture);
+            material.textures[4] = getTexture(gltfMaterial.emissiveTexture);
+        }
+
+        // Images decode in parallel, a compressed image that can not be used
+        // falls back to the regular source like the runtime loader
+        std::vector<CookedImage> images(imageSources.size());
+        std::atomic<uint32_t> failedImages = 0;
+
+        ThreadPool::Get().ParallelFor(static_cast<uint32_t>(images.size()), 1U,
+                                      [&](uint32_t _begin, uint32_t _end) {
+                                          for (uint32_t i = _begin; i < _end; i++) {
+                                              const GLTFTexture &texture
+                                                  = document.textures[imageSources[i]];
+                                              uint32_t imageIndex = GetTextureImage(texture);
+
+                                              if (CookImage(asset, imageIndex, _compression, images[i])) {
+                                                  continue;
+                                              }
+
+                                              if (texture.source == imageIndex
+                                                  || texture.source == GLTF_INVALID_INDEX
+                                                  || !CookImage(asset, texture.source, _compression, images[i])) {
+                                                  images[i] = {};
+                                                  failedImages++;
+                                              }
+                                          }
+                                      });
+
+        for (size_t i = 0; i < images.size(); i++) {
+            if (images[i].levels.empty()) {
+                std::cout << "Failed to load image : "
+                          << asset.GetImageName(GetTextureImage(document.textures[imageSources[i]]))
+                          << "\n";
+            }
+        }
+
+        // Transparency follows the base color image like the runtime loader
+        for (auto &material : materials) {
+            uint32_t baseColor = material.textures[0];
+            material.hasTransparency
+                = baseColor != SCENE_PACK_INVALID && images[textureImages[baseColor]].hasAlpha;
+        }
+
+        std::vector<PackedMesh> meshes;
+        std::vector<CookedPrimitive> primitives;
+        for (uint32_t meshIndex = 0; meshIndex < document.meshes.size(); meshIndex++) {
+            uint32_t primitiveCount = static_cast<uint32_t>(document.meshes[meshIndex].primitives.size());
+            meshes.push_back({ static_cast<uint32_t>(primitives.size()), primitiveCount });
+
+            for (uint32_t primitiveIndex = 0; primitiveIndex < primitiveCount; primitiveIndex++) {
+                primitives.push_back(CookPrimitive(asset, meshIndex, primitiveIndex));
+            }
+        }
+
+        // The graph flattens the hierarchy in the order it is loaded back
+        SceneGraph graph;
+        BuildSceneGraph(document, graph);
+
+        std::vector<PackedNode> nodes(graph.GetNodeCount());
+        for (uint32_t i = 0; i < graph.GetNodeCount(); i++) {
+            const Vector3 &translation = graph.GetTranslation(i);
+            const Quaternion &rotation = graph.GetRotation(i);
+            const Vector3 &scale       = graph.GetScale(i);
+
+            nodes[i] = { graph.GetParent(i) != INVALID_NODE ? graph.GetParent(i) : SCENE_PACK_INVALID,
+                         graph.GetMesh(i) != INVALID_NODE ? graph.GetMesh(i) : SCENE_PACK_INVALID,
+                         { translation.x, translation.y, translation.z },
+                         { rotation.x, rotation.y, rotation.z, rotation.w },
+                         { scale.x, scale.y, scale.z } };
+        }
+
+        std::ofstream file(_output, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cout << "Failed to open " << _output.string() << " for writing\n";
+            return false;
+        }
+
+        uint64_t offset = 0;
+
+        auto write = [&](const void *_data, size_t _size) {
+            file.write(reinterpret_cast<const char *>(_data), static_cast<std::streamsize>(_size));
+            offset += _size;
+        };
+
+        // Every blob and table starts on the pack alignment
+        auto align = [&]() {
+            static const uint8_t padding[SCENE_PACK_ALIGNMENT] = {};
+            write(padding, (SCENE_PACK_ALIGNMENT - offset % SCENE_PACK_ALIGNMENT) % SCENE_PACK_ALIGNMENT);
+            return offset;
+        };
+
+        auto writeTable = [&](const auto &_table) {
+            uint64_t tableOffset = align();
+            write(_table.data(), _table.size() * sizeof(_table[0]));
+            return tableOffset;
+        };
+
+        // Written again once the offsets are known
+        ScenePackHeader header;
+        write(&header, sizeof(header));
+
+        std::vector<PackedPrimitive> packedPrimitives;
+        for (auto &primitive : primitives) {
+            primitive.packed.verticesOffset = writeTable(primitive.vertices);
+            primitive.packed.indicesOffset  = writeTable(primitive.indices);
+            packedPrimitives.push_back(primitive.packed);
+        }
+
+        // Textures sharing an image share its levels
+        std::vector<PackedTextureLevel> levels;
+        std::vector<uint32_t> firstLevels;
+        for (const auto &image : images) {
+            firstLevels.push_back(static_cast<uint32_t>(levels.size()));
+
+            for (const auto &level : image.levels) {
+                uint64_t levelOffset = writeTable(level.data);
+                levels.push_back({ levelOffset, level.data.size(), level.width, level.height });
+            }
+        }
+
+        for (size_t i = 0; i < textures.size(); i++) {
+            const CookedImage &image = images[textureImages[i]];
+
+            textures[i].format     = static_cast<uint32_t>(image.format);
+            textures[i].firstLevel = firstLevels[textureImages[i]];
+            textures[i].levelCount = static_cast<uint32_t>(image.levels.size());
+            textures[i].hasAlpha   = image.hasAlpha;
+        }
+
+        header.vertexSize       = sizeof(Vertex);
+        header.meshCount        = static_cast<uint32_t>(meshes.size());
+        header.primitiveCount   = static_cast<uint32_t>(packedPrimitives.size());
+        header.materialCount    = static_cast<uint32_t>(materials.size());
+        header.textureCount     = static_cast<uint32_t>(textures.size());
+        header.levelCount       = static_cast<uint32_t>(levels.size());
+        header.nodeCount        = static_cast<uint32_t>(nodes.size());
+        header.meshesOffset     = writeTable(meshes);
+        header.primitivesOffset = writeTable(packedPrimitives);
+        header.materialsOffset  = writeTable(materials);
+        header.texturesOffset   = writeTable(textures);
+        header.levelsOffset     = writeTable(levels);
+        header.nodesOffset      = writeTable(nodes);
+
+        file.seekp(0);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        if (!file) {
+            std::cout << "Failed to write " << _output.string() << "\n";
+            return false;
+        }
+
+        std::cout << "Cooked " << meshes.size() << " meshes, " << packedPrimitives.size()
+                  << " primitives, " << nodes.size() << " nodes and " << textures.size() << " textures into "
+                  << _output.string() << " (" << offset << " bytes)\n";
+
+        DerivedDataCache &cache = DerivedDataCache::Get();
+        std::cout << "Derived data cache : " << cache.GetHitCount() << " hits, "
+                  << cache.GetMissCount() << " misses\n";
+
+        return failedImages == 0;
+    }
+} // namespace DadEngine
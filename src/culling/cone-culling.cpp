@@ -0,0 +1,206 @@
+#include "cone-culling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "helpers/simd.hpp"
+#include "math/aabb.hpp"
+#include "model/model.hpp"
+
+namespace DadEngine
+{
+    // Below this the triangles normals spread too much for the cone to cull
+    constexpr float MINIMUM_NORMAL_SPREAD = 0.1f;
+
+    void ClusterConeSet::Add(const ClusterCone &_cone)
+    {
+        m_apexX.push_back(_cone.apex.x);
+        m_apexY.push_back(_cone.apex.y);
+        m_apexZ.push_back(_cone.apex.z);
+        m_axisX.push_back(_cone.axis.x);
+        m_axisY.push_back(_cone.axis.y);
+        m_axisZ.push_back(_cone.axis.z);
+        m_cutoff.push_back(_cone.cutoff);
+    }
+
+    void ClusterConeSet::Clear()
+    {
+        m_apexX.clear();
+        m_apexY.clear();
+        m_apexZ.clear();
+        m_axisX.clear();
+        m_axisY.clear();
+        m_axisZ.clear();
+        m_cutoff.clear();
+    }
+
+    uint32_t ClusterConeSet::Cull(const Vector3 &_eyePosition, std::vector<uint32_t> &_visibleClusters) const
+    {
+        const uint32_t count = GetCount();
+
+        // Every lane is written and the cursor only advances on survivors,
+        // keep room for a full group past the end
+        _visibleClusters.resize(count + 4);
+        uint32_t *output = _visibleClusters.data();
+        uint32_t visible = 0;
+        uint32_t cluster = 0;
+
+#if defined(DADENGINE_SSE2)
+        __m128 eyeX = _mm_set1_ps(_eyePosition.x);
+        __m128 eyeY = _mm_set1_ps(_eyePosition.y);
+        __m128 eyeZ = _mm_set1_ps(_eyePosition.z);
+
+        for (; cluster + 4 <= count; cluster += 4)
+        {
+            __m128 directionX = _mm_sub_ps(_mm_loadu_ps(&m_apexX[cluster]), eyeX);
+            __m128 directionY = _mm_sub_ps(_mm_loadu_ps(&m_apexY[cluster]), eyeY);
+            __m128 directionZ = _mm_sub_ps(_mm_loadu_ps(&m_apexZ[cluster]), eyeZ);
+
+            __m128 dot = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(directionX, _mm_loadu_ps(&m_axisX[cluster])),
+                           _mm_mul_ps(directionY, _mm_loadu_ps(&m_axisY[cluster]))),
+                _mm_mul_ps(directionZ, _mm_loadu_ps(&m_axisZ[cluster])));
+
+            __m128 length = _mm_sqrt_ps(
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, directionX),
+                                      _mm_mul_ps(directionY, directionY)),
+                           _mm_mul_ps(directionZ, directionZ)));
+
+            // Compare against the cutoff scaled by the distance instead of
+            // normalizing the direction
+            __m128 backfacing
+                = _mm_cmpge_ps(dot, _mm_mul_ps(_mm_loadu_ps(&m_cutoff[cluster]), length));
+            auto visibleMask = static_cast<uint32_t>(~_mm_movemask_ps(backfacing) & 0xF);
+
+            for (uint32_t lane = 0; lane < 4; lane++)
+            {
+                output[visible] = cluster + lane;
+                visible += (visibleMask >> lane) & 1U;
+            }
+        }
+#endif
+
+        for (; cluster < count; cluster++)
+        {
+            float directionX = m_apexX[cluster] - _eyePosition.x;
+            float directionY = m_apexY[cluster] - _eyePosition.y;
+            float directionZ = m_apexZ[cluster] - _eyePosition.z;
+
+            float dot = directionX * m_axisX[cluster] + directionY * m_axisY[cluster]
+                        + directionZ * m_axisZ[cluster];
+            float length = std::sqrt(directionX * directionX + directionY * directionY
+                                     + directionZ * directionZ);
+
+            output[visible] = cluster;
+            visible += dot >= m_cutoff[cluster] * length ? 0U : 1U;
+        }
+
+        _visibleClusters.resize(visible);
+
+        return visible;
+    }
+
+    ClusterCone ComputeClusterCone(const Vector3 *_positions, const uint32_t *_indices, uint32_t _triangleCount)
+    {
+        ClusterCone cone;
+
+        std::vector<Vector3> normals;
+        normals.reserve(_triangleCount);
+
+        AABB bounds     = AABB::Empty();
+        Vector3 average = Vector3::Zero();
+
+        for (uint32_t t = 0; t < _triangleCount; t++)
+        {
+            Vector3 p0 = _positions[_indices[t * 3]];
+            Vector3 p1 = _positions[_indices[t * 3 + 1]];
+            Vector3 p2 = _positions[_indices[t * 3 + 2]];
+
+            bounds.Grow(p0);
+            bounds.Grow(p1);
+            bounds.Grow(p2);
+
+            Vector3 edge1  = p1 - p0;
+            Vector3 edge2  = p2 - p0;
+            Vector3 normal = edge1 ^ edge2;
+
+            // Area weighted average before normalizing
+            average += normal;
+
+            float length = normal.Length();
+            normals.push_back(length > 0.f ? normal / length : Vector3::Zero());
+        }
+
+        float averageLength = average.Length();
+        if (averageLength == 0.f)
+        {
+            return cone;
+        }
+
+        Vector3 axis = average / averageLength;
+
+        float minimumDot = 1.f;
+        for (auto &normal : normals)
+        {
+            minimumDot = std::min(minimumDot, normal.Dot(axis));
+        }
+
+        if (minimumDot <= MINIMUM_NORMAL_SPREAD)
+        {
+            return cone;
+        }
+
+        // Move the apex back along the axis until it lies behind every
+        // triangle plane so the test holds for the whole cluster
+        Vector3 center = bounds.Center();
+        float maximumT = 0.f;
+
+        for (uint32_t t = 0; t < _triangleCount; t++)
+        {
+            Vector3 &normal = normals[t];
+            Vector3 p0      = _positions[_indices[t * 3]];
+            Vector3 offset  = center - p0;
+
+            float distance  = offset.Dot(normal);
+            float alignment = axis.Dot(normal);
+
+            if (alignment > 0.f)
+            {
+                maximumT = std::max(maximumT, distance / alignment);
+            }
+        }
+
+        Vector3 apexOffset = axis * maximumT;
+
+        cone.apex   = center - apexOffset;
+        cone.axis   = axis;
+        cone.cutoff = std::sqrt(1.f - minimumDot * minimumDot);
+
+        return cone;
+    }
+
+    void BuildClusterCones(const Primitive &_primitive, uint32_t _trianglesPerCluster, ClusterConeSet &_cones)
+    {
+        const std::vector<Vertex> &vertices = _primitive.vertices.vertices;
+        std::vector<Vector3> positions(vertices.size());
+        std::transform(vertices.begin(), vertices.end(), positions.begin(),
+                       [](const Vertex &_vertex) { return _vertex.position; });
+
+        std::vector<uint32_t> indices = _primitive.indices.indices;
+        if (indices.empty())
+        {
+            indices.resize(vertices.size());
+            std::iota(indices.begin(), indices.end(), 0U);
+        }
+
+        auto triangleCount   = static_cast<uint32_t>(indices.size() / 3);
+        _trianglesPerCluster = std::max(_trianglesPerCluster, 1U);
+
+        for (uint32_t first = 0; first < triangleCount; first += _trianglesPerCluster)
+        {
+            uint32_t count = std::min(_trianglesPerCluster, triangleCount - first);
+            _cones.Add(ComputeClusterCone(positions.data(), indices.data() + first * 3, count));
+        }
+    }
+} // namespace DadEngine
@@ -0,0 +1,498 @@
+#include "masked-occlusion.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "helpers/simd.hpp"
+#include "helpers/thread-pool.hpp"
+#include "model/model.hpp"
+
+namespace DadEngine
+{
+    constexpr uint32_t FULL_MASK      = ~0U;
+    constexpr uint32_t TRIANGLES_MODE = 4U; // Same value for glTF and OpenGL
+    constexpr uint32_t TRIANGLE_GRAIN = 1024U;
+
+    struct ClipVertex
+    {
+        float x;
+        float y;
+        float z;
+        float w;
+    };
+
+    inline ClipVertex Transform(const Matrix4x4 &_matrix, const Vector3 &_point)
+    {
+        return { _matrix.m_11 * _point.x + _matrix.m_21 * _point.y + _matrix.m_31 * _point.z + _matrix.m_41,
+                 _matrix.m_12 * _point.x + _matrix.m_22 * _point.y + _matrix.m_32 * _point.z + _matrix.m_42,
+                 _matrix.m_13 * _point.x + _matrix.m_23 * _point.y + _matrix.m_33 * _point.z + _matrix.m_43,
+                 _matrix.m_14 * _point.x + _matrix.m_24 * _point.y + _matrix.m_34 * _point.z + _matrix.m_44 };
+    }
+
+    inline ClipVertex Lerp(const ClipVertex &_from, const ClipVertex &_to, float _factor)
+    {
+        return { _from.x + (_to.x - _from.x) * _factor, _from.y + (_to.y - _from.y) * _factor,
+                 _from.z + (_to.z - _from.z) * _factor, _from.w + (_to.w - _from.w) * _factor };
+    }
+
+    // Sutherland-Hodgman against the near plane (z >= -w), a triangle turns
+    // into at most a quad
+    inline uint32_t ClipNear(const std::array<ClipVertex, 3> &_triangle, std::array<ClipVertex, 4> &_polygon)
+    {
+        uint32_t count = 0;
+
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            const ClipVertex &current = _triangle[i];
+            const ClipVertex &next    = _triangle[(i + 1) % 3];
+            float currentDistance     = current.z + current.w;
+            float nextDistance        = next.z + next.w;
+
+            if (currentDistance >= 0.f)
+            {
+                _polygon[count++] = current;
+            }
+
+            if ((currentDistance >= 0.f) != (nextDistance >= 0.f))
+            {
+                _polygon[count++] = Lerp(current, next,
+                                         currentDistance / (currentDistance - nextDistance));
+            }
+        }
+
+        return count;
+    }
+
+
+    MaskedOcclusionCulling::MaskedOcclusionCulling(uint32_t _width, uint32_t _height)
+    {
+        m_tilesPerRow  = (_width + TILE_WIDTH - 1) / TILE_WIDTH;
+        m_tileRowCount = (_height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+        m_width        = m_tilesPerRow * TILE_WIDTH;
+        m_height       = m_tileRowCount * TILE_HEIGHT;
+
+        m_zMax0.resize(m_tilesPerRow * m_tileRowCount);
+        m_zMax1.resize(m_tilesPerRow * m_tileRowCount);
+        m_masks.resize(m_tilesPerRow * m_tileRowCount);
+
+        Clear();
+    }
+
+    void MaskedOcclusionCulling::Clear()
+    {
+        std::fill(m_zMax0.begin(), m_zMax0.end(), 1.f);
+        std::fill(m_zMax1.begin(), m_zMax1.end(), 0.f);
+        std::fill(m_masks.begin(), m_masks.end(), 0U);
+    }
+
+    void MaskedOcclusionCulling::SetTransform(const Matrix4x4 &_modelViewProjection)
+    {
+        m_transform = _modelViewProjection;
+    }
+
+    void MaskedOcclusionCulling::RenderTriangles(const Vector3 *_positions,
+                                                 const uint32_t *_indices,
+                                                 uint32_t _triangleCount,
+                                                 ThreadPool *_pool)
+    {
+        // Transform, clip and project into per chunk lists
+        uint32_t chunkCount = (_triangleCount + TRIANGLE_GRAIN - 1) / TRIANGLE_GRAIN;
+        std::vector<std::vector<ScreenTriangle>> chunks(chunkCount);
+
+        auto setupTriangles = [&](uint32_t _begin, uint32_t _end) {
+            std::vector<ScreenTriangle> &screenTriangles = chunks[_begin / TRIANGLE_GRAIN];
+            auto width                                   = static_cast<float>(m_width);
+            auto height                                  = static_cast<float>(m_height);
+
+            for (uint32_t t = _begin; t < _end; t++)
+            {
+                std::array<ClipVertex, 3> triangle {
+                    Transform(m_transform, _positions[_indices[t * 3]]),
+                    Transform(m_transform, _positions[_indices[t * 3 + 1]]),
+                    Transform(m_transform, _positions[_indices[t * 3 + 2]])
+                };
+
+                std::array<ClipVertex, 4> polygon {};
+                uint32_t vertexCount = ClipNear(triangle, polygon);
+
+                for (uint32_t v = 2; v < vertexCount; v++)
+                {
+                    ScreenTriangle screenTriangle {};
+                    std::array<uint32_t, 3> fan { 0, v - 1, v };
+
+                    for (uint32_t k = 0; k < 3; k++)
+                    {
+                        const ClipVertex &vertex = polygon[fan[k]];
+                        float inverseW           = 1.f / vertex.w;
+
+                        screenTriangle.x[k] = (vertex.x * inverseW * 0.5f + 0.5f) * width;
+                        screenTriangle.y[k] = (vertex.y * inverseW * 0.5f + 0.5f) * height;
+                        screenTriangle.z[k]
+                            = std::clamp(vertex.z * inverseW * 0.5f + 0.5f, 0.f, 1.f);
+                    }
+
+                    screenTriangles.push_back(screenTriangle);
+                }
+            }
+        };
+
+        // Every row band owns its tiles so they can be rasterized without locks
+        auto rasterizeBands = [&](uint32_t _firstRow, uint32_t _lastRow) {
+            for (const auto &screenTriangles : chunks)
+            {
+                for (const auto &screenTriangle : screenTriangles)
+                {
+                    rasterizeTriangle(screenTriangle, _firstRow, _lastRow);
+                }
+            }
+        };
+
+        if (_pool)
+        {
+            _pool->ParallelFor(_triangleCount, TRIANGLE_GRAIN, setupTriangles);
+            _pool->ParallelFor(m_tileRowCount,
+                               std::max(m_tileRowCount / (2 * _pool->GetThreadCount()), 1U),
+                               rasterizeBands);
+        }
+        else
+        {
+            for (uint32_t begin = 0; begin < _triangleCount; begin += TRIANGLE_GRAIN)
+            {
+                setupTriangles(begin, std::min(begin + TRIANGLE_GRAIN, _triangleCount));
+            }
+
+            rasterizeBands(0, m_tileRowCount);
+        }
+    }
+
+    void MaskedOcclusionCulling::rasterizeTriangle(const ScreenTriangle &_triangle,
+                                                   uint32_t _firstTileRow,
+                                                   uint32_t _lastTileRow)
+    {
+        float x0 = _triangle.x[0], y0 = _triangle.y[0], z0 = _triangle.z[0];
+        float x1 = _triangle.x[1], y1 = _triangle.y[1], z1 = _triangle.z[1];
+        float x2 = _triangle.x[2], y2 = _triangle.y[2], z2 = _triangle.z[2];
+
+        float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+        if (area == 0.f || std::isnan(area))
+        {
+            return;
+        }
+
+        // Occluders are rendered double sided, make the winding counter clockwise
+        if (area < 0.f)
+        {
+            std::swap(x1, x2);
+            std::swap(y1, y2);
+            std::swap(z1, z2);
+            area = -area;
+        }
+
+        float minX = std::min({ x0, x1, x2 });
+        float maxX = std::max({ x0, x1, x2 });
+        float minY = std::min({ y0, y1, y2 });
+        float maxY = std::max({ y0, y1, y2 });
+
+        if (maxX < 0.f || maxY < 0.f || minX >= static_cast<float>(m_width)
+            || minY >= static_cast<float>(m_height))
+        {
+            return;
+        }
+
+        maxX = std::min(maxX, static_cast<float>(m_width - 1));
+        maxY = std::min(maxY, static_cast<float>(m_height - 1));
+
+        uint32_t firstTileX = static_cast<uint32_t>(std::max(minX, 0.f)) / TILE_WIDTH;
+        uint32_t lastTileX  = static_cast<uint32_t>(maxX) / TILE_WIDTH;
+        uint32_t firstTileY = std::max(static_cast<uint32_t>(std::max(minY, 0.f)) / TILE_HEIGHT,
+                                       _firstTileRow);
+        uint32_t lastTileY = std::min(static_cast<uint32_t>(maxY) / TILE_HEIGHT, _lastTileRow - 1);
+
+        if (firstTileY > lastTileY || _firstTileRow >= _lastTileRow)
+        {
+            return;
+        }
+
+        // Edge functions e(x, y) = a * x + b * y + c, positive inside
+        std::array<float, 3> edgeA { y0 - y1, y1 - y2, y2 - y0 };
+        std::array<float, 3> edgeB { x1 - x0, x2 - x1, x0 - x2 };
+        std::array<float, 3> edgeC { -(edgeA[0] * x0 + edgeB[0] * y0),
+                                     -(edgeA[1] * x1 + edgeB[1] * y1),
+                                     -(edgeA[2] * x2 + edgeB[2] * y2) };
+
+        // Depth plane z(x, y) = zA * x + zB * y + zC
+        float zA = ((z1 - z0) * (y2 - y0) - (z2 - z0) * (y1 - y0)) / area;
+        float zB = ((z2 - z0) * (x1 - x0) - (z1 - z0) * (x2 - x0)) / area;
+        float zC = z0 - zA * x0 - zB * y0;
+
+        float triangleZMin = std::min({ z0, z1, z2 });
+        float triangleZMax = std::max({ z0, z1, z2 });
+
+        for (uint32_t tileY = firstTileY; tileY <= lastTileY; tileY++)
+        {
+            auto tileY0 = static_cast<float>(tileY * TILE_HEIGHT);
+
+            for (uint32_t tileX = firstTileX; tileX <= lastTileX; tileX++)
+            {
+                auto tileX0 = static_cast<float>(tileX * TILE_WIDTH);
+                uint32_t coverage = 0;
+
+#if defined(DADENGINE_SSE2)
+                // Eight pixel centers per row, four per register
+                __m128 pixelX0 = _mm_add_ps(_mm_set1_ps(tileX0), _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f));
+                __m128 pixelX1 = _mm_add_ps(pixelX0, _mm_set1_ps(4.f));
+
+                for (uint32_t row = 0; row < TILE_HEIGHT; row++)
+                {
+                    float pixelY   = tileY0 + static_cast<float>(row) + 0.5f;
+                    __m128 inside0 = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                    __m128 inside1 = inside0;
+
+                    for (uint32_t e = 0; e < 3; e++)
+                    {
+                        __m128 a      = _mm_set1_ps(edgeA[e]);
+                        __m128 offset = _mm_set1_ps(edgeB[e] * pixelY + edgeC[e]);
+                        __m128 zero   = _mm_setzero_ps();
+
+                        inside0 = _mm_and_ps(
+                            inside0, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a, pixelX0), offset), zero));
+                        inside1 = _mm_and_ps(
+                            inside1, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a, pixelX1), offset), zero));
+                    }
+
+                    auto rowMask = static_cast<uint32_t>(_mm_movemask_ps(inside0)
+                                                         | (_mm_movemask_ps(inside1) << 4));
+                    coverage |= rowMask << (row * TILE_WIDTH);
+                }
+#else
+                for (uint32_t row = 0; row < TILE_HEIGHT; row++)
+                {
+                    float pixelY = tileY0 + static_cast<float>(row) + 0.5f;
+
+                    for (uint32_t column = 0; column < TILE_WIDTH; column++)
+                    {
+                        float pixelX = tileX0 + static_cast<float>(column) + 0.5f;
+                        bool inside  = true;
+
+                        for (uint32_t e = 0; e < 3; e++)
+                        {
+                            inside &= edgeA[e] * pixelX + edgeB[e] * pixelY + edgeC[e] >= 0.f;
+                        }
+
+                        coverage |= static_cast<uint32_t>(inside) << (row * TILE_WIDTH + column);
+                    }
+                }
+#endif
+
+                if (coverage == 0)
+                {
+                    continue;
+                }
+
+                // Conservative triangle depth range over the tile
+                float tileX1  = tileX0 + static_cast<float>(TILE_WIDTH);
+                float tileY1  = tileY0 + static_cast<float>(TILE_HEIGHT);
+                float corner0 = zA * tileX0 + zB * tileY0 + zC;
+                float corner1 = zA * tileX1 + zB * tileY0 + zC;
+                float corner2 = zA * tileX0 + zB * tileY1 + zC;
+                float corner3 = zA * tileX1 + zB * tileY1 + zC;
+
+                float zMin = std::max(std::min({ corner0, corner1, corner2, corner3 }), triangleZMin);
+                float zMax = std::min(std::max({ corner0, corner1, corner2, corner3 }), triangleZMax);
+
+                updateTile(tileY * m_tilesPerRow + tileX, coverage, zMin, zMax);
+            }
+        }
+    }
+
+    void MaskedOcclusionCulling::updateTile(uint32_t _tileIndex, uint32_t _coverage, float _zMin, float _zMax)
+    {
+        float &zMax0   = m_zMax0[_tileIndex];
+        float &zMax1   = m_zMax1[_tileIndex];
+        uint32_t &mask = m_masks[_tileIndex];
+
+        // Entirely behind what already covers the tile
+        if (_zMin >= zMax0)
+        {
+            return;
+        }
+
+        // Discard the working layer when the triangle is much closer than it
+        float distance1t = zMax1 - _zMax;
+        float distance01 = zMax0 - zMax1;
+        if (distance1t > distance01)
+        {
+            zMax1 = 0.f;
+            mask  = 0;
+        }
+
+        zMax1 = std::max(zMax1, _zMax);
+        mask |= _coverage;
+
+        // A fully covered working layer becomes the reference layer
+        if (mask == FULL_MASK)
+        {
+            zMax0 = std::min(zMax0, zMax1);
+            zMax1 = 0.f;
+            mask  = 0;
+        }
+    }
+
+    bool MaskedOcclusionCulling::TestAABB(const AABB &_box) const
+    {
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = std::numeric_limits<float>::lowest();
+        float maxY = std::numeric_limits<float>::lowest();
+        float zMin = 1.f;
+
+        uint32_t cornersBehind = 0;
+
+        for (uint32_t corner = 0; corner < 8; corner++)
+        {
+            Vector3 point((corner & 1U) ? _box.m_max.x : _box.m_min.x,
+                          (corner & 2U) ? _box.m_max.y : _box.m_min.y,
+                          (corner & 4U) ? _box.m_max.z : _box.m_min.z);
+            ClipVertex vertex = Transform(m_transform, point);
+
+            if (vertex.z + vertex.w < 0.f || vertex.w <= 0.f)
+            {
+                cornersBehind++;
+                continue;
+            }
+
+            float inverseW = 1.f / vertex.w;
+            float x        = (vertex.x * inverseW * 0.5f + 0.5f) * static_cast<float>(m_width);
+            float y        = (vertex.y * inverseW * 0.5f + 0.5f) * static_cast<float>(m_height);
+
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            zMin = std::min(zMin, vertex.z * inverseW * 0.5f + 0.5f);
+        }
+
+        // Entirely behind the camera, or crossing the near plane which is
+        // assumed visible
+        if (cornersBehind != 0)
+        {
+            return cornersBehind != 8;
+        }
+
+        if (maxX < 0.f || maxY < 0.f || minX >= static_cast<float>(m_width)
+            || minY >= static_cast<float>(m_height) || zMin > 1.f)
+        {
+            return false;
+        }
+
+        maxX = std::min(maxX, static_cast<float>(m_width - 1));
+        maxY = std::min(maxY, static_cast<float>(m_height - 1));
+
+        uint32_t firstTileX = static_cast<uint32_t>(std::max(minX, 0.f)) / TILE_WIDTH;
+        uint32_t lastTileX  = static_cast<uint32_t>(maxX) / TILE_WIDTH;
+        uint32_t firstTileY = static_cast<uint32_t>(std::max(minY, 0.f)) / TILE_HEIGHT;
+        uint32_t lastTileY  = static_cast<uint32_t>(maxY) / TILE_HEIGHT;
+
+        for (uint32_t tileY = firstTileY; tileY <= lastTileY; tileY++)
+        {
+            const float *rowDepths = m_zMax0.data() + tileY * m_tilesPerRow;
+            uint32_t tileX         = firstTileX;
+
+#if defined(DADENGINE_SSE2)
+            __m128 boxDepth = _mm_set1_ps(zMin);
+            for (; tileX + 4 <= lastTileX + 1; tileX += 4)
+            {
+                if (_mm_movemask_ps(_mm_cmplt_ps(boxDepth, _mm_loadu_ps(rowDepths + tileX))) != 0)
+                {
+                    return true;
+                }
+            }
+#endif
+
+            for (; tileX <= lastTileX; tileX++)
+            {
+                if (zMin < rowDepths[tileX])
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+
+    OccluderMesh BuildOccluderMesh(const Mesh &_mesh, float _minimumAreaRatio)
+    {
+        AABB meshBounds = AABB::Empty();
+        for (const auto &primitive : _mesh.m_primitives)
+        {
+            meshBounds.Grow(primitive.bounds);
+        }
+
+        float minimumArea = _minimumAreaRatio * meshBounds.SurfaceArea();
+        OccluderMesh occluders;
+
+        for (const auto &primitive : _mesh.m_primitives)
+        {
+            if (primitive.drawMode != TRIANGLES_MODE || primitive.material.hasTransparency)
+            {
+                continue;
+            }
+
+            const std::vector<Vertex> &vertices  = primitive.vertices.vertices;
+            const std::vector<uint32_t> &indices = primitive.indices.indices;
+            size_t indexCount = indices.empty() ? vertices.size() : indices.size();
+
+            for (size_t i = 0; i + 2 < indexCount; i += 3)
+            {
+                Vector3 v0 = vertices[indices.empty() ? i : indices[i]].position;
+                Vector3 v1 = vertices[indices.empty() ? i + 1 : indices[i + 1]].position;
+                Vector3 v2 = vertices[indices.empty() ? i + 2 : indices[i + 2]].position;
+
+                Vector3 edge1 = v1 - v0;
+                Vector3 edge2 = v2 - v0;
+                float area    = (edge1 ^ edge2).Length() * 0.5f;
+
+                if (area < minimumArea)
+                {
+                    continue;
+                }
+
+                auto base = static_cast<uint32_t>(occluders.positions.size());
+                occluders.positions.push_back(v0);
+                occluders.positions.push_back(v1);
+                occluders.positions.push_back(v2);
+                occluders.indices.push_back(base);
+                occluders.indices.push_back(base + 1);
+                occluders.indices.push_back(base + 2);
+            }
+        }
+
+        return occluders;
+    }
+
+    void RenderOccluders(MaskedOcclusionCulling &_culling, const OccluderMesh &_occluders, ThreadPool *_pool)
+    {
+        _culling.RenderTriangles(_occluders.positions.data(), _occluders.indices.data(),
+                                 static_cast<uint32_t>(_occluders.indices.size() / 3), _pool);
+    }
+
+    std::vector<uint32_t> CullPrimitives(const Mesh &_mesh, const MaskedOcclusionCulling &_culling)
+    {
+        std::vector<uint32_t> visiblePrimitives;
+        visiblePrimitives.reserve(_mesh.m_primitives.size());
+
+        for (size_t i = 0; i < _mesh.m_primitives.size(); i++)
+        {
+            if (_culling.TestAABB(_mesh.m_primitives[i].bounds))
+            {
+                visiblePrimitives.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        return visiblePrimitives;
+    }
+} // namespace DadEngine
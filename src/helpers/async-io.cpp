@@ -0,0 +1,428 @@
+#include "async-io.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+#include "file.hpp"
+#include "thread-pool.hpp"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define DADENGINE_IO_URING
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace DadEngine
+{
+    struct AsyncIO::Request
+    {
+        int fd = -1;
+        std::filesystem::path path;
+        ByteBuffer data;
+        size_t size   = 0;
+        size_t offset = 0;
+        std::promise<ByteBuffer> promise;
+    };
+
+#if defined(DADENGINE_IO_URING)
+    // Raw io_uring rings, set up through the syscalls to avoid a liburing
+    // dependency. Only the completion thread consumes the completion queue,
+    // the submission queue is guarded by the AsyncIO mutex
+    struct AsyncIO::Ring
+    {
+        // Reads larger than this are split, the kernel caps a read anyway
+        static constexpr size_t MAX_READ_SIZE = 1ULL << 30U;
+
+        // Marks the wake up request sent on shutdown
+        static constexpr uint64_t WAKE_UP = 0ULL;
+
+        ~Ring()
+        {
+            if (submissionQueueEntries) {
+                munmap(submissionQueueEntries, entryCount * sizeof(io_uring_sqe));
+            }
+            if (completionRing && completionRing != submissionRing) {
+                munmap(completionRing, completionRingSize);
+            }
+            if (submissionRing) {
+                munmap(submissionRing, submissionRingSize);
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+
+        bool Setup(uint32_t _entryCount)
+        {
+            io_uring_params params {};
+
+            fd = static_cast<int>(syscall(__NR_io_uring_setup, _entryCount, &params));
+            if (fd < 0) {
+                return false;
+            }
+
+            submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+            completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+            bool singleMapping = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (singleMapping) {
+                submissionRingSize = std::max(submissionRingSize, completionRingSize);
+            }
+
+            submissionRing = mapRing(submissionRingSize, IORING_OFF_SQ_RING);
+            completionRing = singleMapping ? submissionRing
+                                           : mapRing(completionRingSize, IORING_OFF_CQ_RING);
+
+            void *entries = mapRing(params.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES);
+            if (!submissionRing || !completionRing || !entries) {
+                return false;
+            }
+
+            entryCount             = params.sq_entries;
+            completionCapacity     = params.cq_entries;
+            submissionQueueEntries = static_cast<io_uring_sqe *>(entries);
+
+            auto *submission = static_cast<uint8_t *>(submissionRing);
+            submissionHead   = reinterpret_cast<uint32_t *>(submission + params.sq_off.head);
+            submissionTail   = reinterpret_cast<uint32_t *>(submission + params.sq_off.tail);
+            submissionMask   = *reinterpret_cast<uint32_t *>(submission + params.sq_off.ring_mask);
+            submissionArray  = reinterpret_cast<uint32_t *>(submission + params.sq_off.array);
+
+            auto *completion = static_cast<uint8_t *>(completionRing);
+            completionHead   = reinterpret_cast<uint32_t *>(completion + params.cq_off.head);
+            completionTail   = reinterpret_cast<uint32_t *>(completion + params.cq_off.tail);
+            completionMask   = *reinterpret_cast<uint32_t *>(completion + params.cq_off.ring_mask);
+            completions      = reinterpret_cast<io_uring_cqe *>(completion + params.cq_off.cqes);
+
+            return supportsRead();
+        }
+
+        bool HasRoom() const
+        {
+            uint32_t head = std::atomic_ref<uint32_t>(*submissionHead).load(std::memory_order_acquire);
+
+            return *submissionTail - head < entryCount;
+        }
+
+        void QueueRead(Request *_request)
+        {
+            io_uring_sqe &entry = nextEntry();
+            entry.opcode        = IORING_OP_READ;
+            entry.flags         = IOSQE_ASYNC; // Cached reads would copy inline in the submitter otherwise
+            entry.fd            = _request->fd;
+            entry.off           = _request->offset;
+            entry.addr          = reinterpret_cast<uint64_t>(_request->data.data() + _request->offset);
+            entry.len = static_cast<uint32_t>(
+                std::min(_request->size - _request->offset, MAX_READ_SIZE));
+            entry.user_data = reinterpret_cast<uint64_t>(_request);
+
+            publishEntry();
+        }
+
+        void QueueWakeUp()
+        {
+            io_uring_sqe &entry = nextEntry();
+            entry.opcode        = IORING_OP_NOP;
+            entry.user_data     = WAKE_UP;
+
+            publishEntry();
+        }
+
+        int Enter(uint32_t _submitCount, uint32_t _waitCount)
+        {
+            uint32_t flags = _waitCount ? IORING_ENTER_GETEVENTS : 0U;
+
+            return static_cast<int>(syscall(__NR_io_uring_enter, fd, _submitCount,
+                                            _waitCount, flags, nullptr, 0));
+        }
+
+        int fd                      = -1;
+        uint32_t entryCount         = 0;
+        uint32_t completionCapacity = 0;
+
+        void *submissionRing                 = nullptr;
+        size_t submissionRingSize            = 0;
+        uint32_t *submissionHead             = nullptr;
+        uint32_t *submissionTail             = nullptr;
+        uint32_t submissionMask              = 0;
+        uint32_t *submissionArray            = nullptr;
+        io_uring_sqe *submissionQueueEntries = nullptr;
+
+        void *completionRing      = nullptr;
+        size_t completionRingSize = 0;
+        uint32_t *completionHead  = nullptr;
+        uint32_t *completionTail  = nullptr;
+        uint32_t completionMask   = 0;
+        io_uring_cqe *completions = nullptr;
+
+        private:
+        // io_uring_setup works from Linux 5.1 but IORING_OP_READ came with
+        // 5.6, along with the probe, older kernels fail every read with
+        // -EINVAL. Failing the probe keeps the thread pool path instead
+        bool supportsRead() const
+        {
+            std::vector<uint8_t> storage(sizeof(io_uring_probe) + IORING_OP_LAST * sizeof(io_uring_probe_op));
+            auto *probe = reinterpret_cast<io_uring_probe *>(storage.data());
+
+            if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) < 0) {
+                return false;
+            }
+
+            return probe->last_op >= IORING_OP_READ
+                   && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) != 0U;
+        }
+
+        void *mapRing(size_t _size, uint64_t _offset) const
+        {
+            void *ring = mmap(nullptr, _size, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, fd, static_cast<off_t>(_offset));
+
+            return ring == MAP_FAILED ? nullptr : ring;
+        }
+
+        io_uring_sqe &nextEntry()
+        {
+            uint32_t tail  = *submissionTail;
+            uint32_t index = tail & submissionMask;
+
+            io_uring_sqe &entry = submissionQueueEntries[index];
+            std::memset(&entry, 0, sizeof(entry));
+            submissionArray[index] = index;
+
+            return entry;
+        }
+
+        // Makes the entry filled after nextEntry visible to the kernel
+        void publishEntry()
+        {
+            std::atomic_ref<uint32_t>(*submissionTail).fetch_add(1U, std::memory_order_release);
+        }
+    };
+#else
+    struct AsyncIO::Ring
+    {
+    };
+#endif
+
+    AsyncIO::AsyncIO([[maybe_unused]] uint32_t _queueDepth)
+    {
+#if defined(DADENGINE_IO_URING)
+        auto ring = std::make_unique<Ring>();
+
+        if (ring->Setup(_queueDepth)) {
+            m_ring             = std::move(ring);
+            m_completionThread = std::thread(&AsyncIO::completionLoop, this);
+        }
+#endif
+    }
+
+    AsyncIO::~AsyncIO()
+    {
+#if defined(DADENGINE_IO_URING)
+        if (m_ring) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+
+                // Room is always left for it, the completion loop only
+                // needs one event to notice the shutdown
+                m_ring->QueueWakeUp();
+                m_inFlight++;
+                m_ring->Enter(1U, 0U);
+            }
+
+            m_completionThread.join();
+        }
+#endif
+    }
+
+    std::future<ByteBuffer> AsyncIO::Read(const std::filesystem::path &_filePath)
+    {
+        return std::move(Read(std::vector<std::filesystem::path> { _filePath })[0]);
+    }
+
+    std::vector<std::future<ByteBuffer>>
+    AsyncIO::Read(const std::vector<std::filesystem::path> &_filePaths)
+    {
+        std::vector<std::future<ByteBuffer>> futures;
+        futures.reserve(_filePaths.size());
+
+        if (!m_ring) {
+            for (const auto &filePath : _filePaths) {
+                futures.push_back(
+                    ThreadPool::Get().Submit([filePath]() { return ReadFile(filePath); }));
+            }
+
+            return futures;
+        }
+
+        std::vector<Request *> requests;
+        for (const auto &filePath : _filePaths) {
+            std::unique_ptr<Request> request = openRequest(filePath);
+            futures.push_back(request->promise.get_future());
+
+            // Failed opens and empty files are resolved right away
+            if (request->fd < 0 || request->size == 0) {
+                completeRequest(request.release());
+            }
+            else {
+                requests.push_back(request.release());
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.insert(m_pending.end(), requests.begin(), requests.end());
+        }
+
+        submitPending();
+
+        return futures;
+    }
+
+    AsyncIO &AsyncIO::Get()
+    {
+        static AsyncIO asyncIO;
+
+        return asyncIO;
+    }
+
+    std::unique_ptr<AsyncIO::Request> AsyncIO::openRequest(const std::filesystem::path &_filePath)
+    {
+        auto request  = std::make_unique<Request>();
+        request->path = _filePath;
+
+#if defined(DADENGINE_IO_URING)
+        request->fd = open(_filePath.c_str(), O_RDONLY | O_CLOEXEC);
+
+        struct stat status;
+        if (request->fd < 0 || fstat(request->fd, &status) != 0) {
+            std::cout << "File : " << _filePath.string() << " failed to open !\n";
+            return request;
+        }
+
+        request->size = static_cast<size_t>(status.st_size);
+
+        // Same layout as ReadFile, allocated once with the terminator
+        request->data.resize(request->size + 1);
+        request->data[request->size] = '\0';
+#endif
+
+        return request;
+    }
+
+    void AsyncIO::submitPending()
+    {
+#if defined(DADENGINE_IO_URING)
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // One slot is kept for the shutdown wake up, and the in flight count
+        // stays below the completion queue size so it never overflows
+        uint32_t queued = 0;
+        while (!m_pending.empty() && m_inFlight + 1 < m_ring->completionCapacity
+               && queued + 1 < m_ring->entryCount && m_ring->HasRoom()) {
+            m_ring->QueueRead(m_pending.front());
+            m_pending.pop_front();
+            m_inFlight++;
+            queued++;
+        }
+
+        if (queued) {
+            m_ring->Enter(queued, 0U);
+        }
+#endif
+    }
+
+    void AsyncIO::completionLoop()
+    {
+#if defined(DADENGINE_IO_URING)
+        for (;;) {
+            int result = m_ring->Enter(0U, 1U);
+            if (result < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                std::cout << "io_uring wait failed : " << std::strerror(errno) << "\n";
+            }
+
+            uint32_t head = *m_ring->completionHead;
+            uint32_t tail = std::atomic_ref<uint32_t>(*m_ring->completionTail)
+                                .load(std::memory_order_acquire);
+
+            std::vector<Request *> finished;
+            std::vector<Request *> resubmitted;
+
+            for (; head != tail; head++) {
+                const io_uring_cqe &completion = m_ring->completions[head & m_ring->completionMask];
+                auto *request = reinterpret_cast<Request *>(completion.user_data);
+
+                if (!request) {
+                    continue;
+                }
+
+                if (completion.res == -EINTR || completion.res == -EAGAIN) {
+                    resubmitted.push_back(request);
+                    continue;
+                }
+
+                if (completion.res <= 0) {
+                    std::cout << "File : " << request->path.string() << " failed to read !\n";
+                    request->data.clear();
+                    finished.push_back(request);
+                    continue;
+                }
+
+                // Short reads carry on from where they stopped
+                request->offset += static_cast<size_t>(completion.res);
+                if (request->offset < request->size) {
+                    resubmitted.push_back(request);
+                }
+                else {
+                    finished.push_back(request);
+                }
+            }
+
+            uint32_t completedCount = head - *m_ring->completionHead;
+            std::atomic_ref<uint32_t>(*m_ring->completionHead).store(head, std::memory_order_release);
+
+            bool done = false;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_inFlight -= completedCount;
+                m_pending.insert(m_pending.begin(), resubmitted.begin(), resubmitted.end());
+
+                done = m_stopping && m_inFlight == 0 && m_pending.empty();
+            }
+
+            for (Request *request : finished) {
+                completeRequest(request);
+            }
+
+            if (done) {
+                return;
+            }
+
+            submitPending();
+        }
+#endif
+    }
+
+    void AsyncIO::completeRequest(Request *_request)
+    {
+        std::unique_ptr<Request> request(_request);
+
+#if defined(DADENGINE_IO_URING)
+        if (request->fd >= 0) {
+            close(request->fd);
+        }
+#endif
+
+        request->promise.set_value(std::move(request->data));
+    }
+} // namespace DadEngine
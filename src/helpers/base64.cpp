@@ -0,0 +1,268 @@
+#include "base64.hpp"
+
+#include <array>
+
+#include "simd.hpp"
+
+namespace DadEngine
+{
+    namespace
+    {
+        constexpr uint8_t INVALID_BASE64_VALUE = 0xFFU;
+
+        constexpr std::array<uint8_t, 256> BASE64_VALUES = []() {
+            std::array<uint8_t, 256> values {};
+            values.fill(INVALID_BASE64_VALUE);
+
+            for (uint8_t i = 0; i < 26U; i++) {
+                values['A' + i] = i;
+                values['a' + i] = 26U + i;
+            }
+
+            for (uint8_t i = 0; i < 10U; i++) {
+                values['0' + i] = 52U + i;
+            }
+
+            values['+'] = 62U;
+            values['/'] = 63U;
+
+            return values;
+        }();
+
+        std::string_view StripPadding(std::string_view _encoded)
+        {
+            for (uint32_t i = 0; i < 2U && !_encoded.empty() && _encoded.back() == '='; i++) {
+                _encoded.remove_suffix(1U);
+            }
+
+            return _encoded;
+        }
+
+#if defined(DADENGINE_SSSE3)
+        // Translates 16 characters to their 6 bit values with nibble lookups,
+        // the classification tables flag every byte outside the alphabet
+        DADENGINE_TARGET("ssse3") bool TranslateCharacters(__m128i _characters, __m128i &_values)
+        {
+            const __m128i lowNibbleClasses = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                                           0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B,
+                                                           0x1B, 0x1A);
+            const __m128i highNibbleClasses = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04,
+                                                            0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                                            0x10, 0x10);
+            const __m128i offsets = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0,
+                                                  0, 0, 0);
+            const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+
+            __m128i highNibbles = _mm_and_si128(_mm_srli_epi32(_characters, 4), nibbleMask);
+            __m128i lowNibbles  = _mm_and_si128(_characters, nibbleMask);
+            __m128i classes = _mm_and_si128(_mm_shuffle_epi8(lowNibbleClasses, lowNibbles),
+                                            _mm_shuffle_epi8(highNibbleClasses, highNibbles));
+
+            if (_mm_movemask_epi8(_mm_cmpgt_epi8(classes, _mm_setzero_si128())) != 0) {
+                return false;
+            }
+
+            // '/' shares its high nibble with '+', it gets its own offset
+            __m128i isSlash = _mm_cmpeq_epi8(_characters, _mm_set1_epi8('/'));
+            _values = _mm_add_epi8(_characters,
+                                   _mm_shuffle_epi8(offsets, _mm_add_epi8(isSlash, highNibbles)));
+
+            return true;
+        }
+
+        // Merges the 6 bit values in 12 bytes at the front of the register
+        DADENGINE_TARGET("ssse3") __m128i PackValues(__m128i _values)
+        {
+            __m128i pairs   = _mm_maddubs_epi16(_values, _mm_set1_epi32(0x01400140));
+            __m128i triples = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+
+            return _mm_shuffle_epi8(triples, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                                           -1, -1, -1, -1));
+        }
+
+        // The vector stores write a few bytes past each block, they only run
+        // while the destination has room for the whole register. A block
+        // with an invalid character is left to the scalar loop to report
+        DADENGINE_TARGET("ssse3") void DecodeBlocks16(const uint8_t *&_source,
+                                                      const uint8_t *_end,
+                                                      uint8_t *&_destination,
+                                                      const uint8_t *_destinationEnd)
+        {
+            while (_end - _source >= 16 && _destinationEnd - _destination >= 16) {
+                __m128i values;
+                if (!TranslateCharacters(_mm_loadu_si128(reinterpret_cast<const __m128i *>(_source)),
+                                         values)) {
+                    break;
+                }
+
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(_destination), PackValues(values));
+                _source += 16;
+                _destination += 12;
+            }
+        }
+#endif
+
+#if defined(DADENGINE_AVX2)
+        // Same as the 16 characters version on both lanes
+        DADENGINE_TARGET("avx2") bool TranslateCharacters(__m256i _characters, __m256i &_values)
+        {
+            const __m256i lowNibbleClasses = _mm256_setr_epi8(
+                0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B,
+                0x1B, 0x1A, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A,
+                0x1B, 0x1B, 0x1B, 0x1A);
+            const __m256i highNibbleClasses = _mm256_setr_epi8(
+                0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x10, 0x10, 0x10);
+            const __m256i offsets = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0,
+                                                     0, 0, 0, 0, 0, 16, 19, 4, -65, -65, -71, -71,
+                                                     0, 0, 0, 0, 0, 0, 0, 0);
+            const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+
+            __m256i highNibbles = _mm256_and_si256(_mm256_srli_epi32(_characters, 4), nibbleMask);
+            __m256i lowNibbles  = _mm256_and_si256(_characters, nibbleMask);
+            __m256i classes = _mm256_and_si256(_mm256_shuffle_epi8(lowNibbleClasses, lowNibbles),
+                                               _mm256_shuffle_epi8(highNibbleClasses, highNibbles));
+
+            if (_mm256_movemask_epi8(_mm256_cmpgt_epi8(classes, _mm256_setzero_si256())) != 0) {
+                return false;
+            }
+
+            __m256i isSlash = _mm256_cmpeq_epi8(_characters, _mm256_set1_epi8('/'));
+            _values = _mm256_add_epi8(_characters,
+                                      _mm256_shuffle_epi8(offsets,
+                                                          _mm256_add_epi8(isSlash, highNibbles)));
+
+            return true;
+        }
+
+        // 12 bytes per lane, then the lanes are joined in the first 24 bytes
+        DADENGINE_TARGET("avx2") __m256i PackValues(__m256i _values)
+        {
+            __m256i pairs   = _mm256_maddubs_epi16(_values, _mm256_set1_epi32(0x01400140));
+            __m256i triples = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+            __m256i packed  = _mm256_shuffle_epi8(
+                triples, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+            return _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        }
+
+        // Same as DecodeBlocks16 on 32 characters
+        DADENGINE_TARGET("avx2") void DecodeBlocks32(const uint8_t *&_source,
+                                                     const uint8_t *_end,
+                                                     uint8_t *&_destination,
+                                                     const uint8_t *_destinationEnd)
+        {
+            while (_end - _source >= 32 && _destinationEnd - _destination >= 32) {
+                __m256i values;
+                if (!TranslateCharacters(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(_source)),
+                                         values)) {
+                    break;
+                }
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(_destination), PackValues(values));
+                _source += 32;
+                _destination += 24;
+            }
+        }
+#endif
+    } // namespace
+
+    size_t GetBase64DecodedSize(std::string_view _encoded)
+    {
+        size_t length = StripPadding(_encoded).size();
+
+        return length / 4U * 3U + (length % 4U == 0 ? 0 : length % 4U - 1U);
+    }
+
+    bool DecodeBase64(std::string_view _encoded, uint8_t *_destination)
+    {
+        std::string_view characters = StripPadding(_encoded);
+        if (characters.size() % 4U == 1U) {
+            return false;
+        }
+
+        const auto *source                       = reinterpret_cast<const uint8_t *>(characters.data());
+        const uint8_t *end                       = source + characters.size();
+        uint8_t *destination                     = _destination;
+        [[maybe_unused]] uint8_t *destinationEnd = _destination + GetBase64DecodedSize(characters);
+
+        // Blocks of 32 then 16 characters are decoded with the widest
+        // kernels the CPU runs, the scalar loop finishes the text
+#if defined(DADENGINE_AVX2)
+        if (CPUHasAVX2()) {
+            DecodeBlocks32(source, end, destination, destinationEnd);
+        }
+#endif
+
+#if defined(DADENGINE_SSSE3)
+        if (CPUHasSSSE3()) {
+            DecodeBlocks16(source, end, destination, destinationEnd);
+        }
+#endif
+
+        while (end - source >= 4) {
+            uint32_t a = BASE64_VALUES[source[0]];
+            uint32_t b = BASE64_VALUES[source[1]];
+            uint32_t c = BASE64_VALUES[source[2]];
+            uint32_t d = BASE64_VALUES[source[3]];
+
+            // Every valid value fits in 6 bits
+            if ((a | b | c | d) > 63U) {
+                return false;
+            }
+
+            uint32_t triple = (a << 18U) | (b << 12U) | (c << 6U) | d;
+            destination[0]  = static_cast<uint8_t>(triple >> 16U);
+            destination[1]  = static_cast<uint8_t>(triple >> 8U);
+            destination[2]  = static_cast<uint8_t>(triple);
+
+            source += 4;
+            destination += 3;
+        }
+
+        // Last two or three characters of unpadded or padded text
+        if (source != end) {
+            uint32_t triple = 0;
+
+            for (uint32_t i = 0; source + i != end; i++) {
+                uint32_t value = BASE64_VALUES[source[i]];
+                if (value == INVALID_BASE64_VALUE) {
+                    return false;
+                }
+
+                triple |= value << (18U - 6U * i);
+            }
+
+            destination[0] = static_cast<uint8_t>(triple >> 16U);
+            if (end - source == 3) {
+                destination[1] = static_cast<uint8_t>(triple >> 8U);
+            }
+        }
+
+        return true;
+    }
+
+    bool ParseBase64DataURI(std::string_view _uri, std::string_view &_mimeType, std::string_view &_payload)
+    {
+        constexpr std::string_view SCHEME   = "data:";
+        constexpr std::string_view ENCODING = ";base64";
+
+        size_t comma = _uri.find(',');
+        if (!_uri.starts_with(SCHEME) || comma == std::string_view::npos) {
+            return false;
+        }
+
+        std::string_view header = _uri.substr(SCHEME.size(), comma - SCHEME.size());
+        if (!header.ends_with(ENCODING)) {
+            return false;
+        }
+
+        // Parameters such as a charset are ignored
+        _mimeType = header.substr(0, header.find(';'));
+        _payload  = _uri.substr(comma + 1U);
+
+        return true;
+    }
+} // namespace DadEngine
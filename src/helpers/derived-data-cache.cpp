@@ -0,0 +1,172 @@
+#include "derived-data-cache.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+#include "file.hpp"
+#include "hash.hpp"
+
+namespace DadEngine
+{
+    namespace
+    {
+        constexpr uint32_t ENTRY_MAGIC   = 0x31434444U; // "DDC1"
+        constexpr uint32_t ENTRY_VERSION = 1U;
+
+        struct EntryHeader
+        {
+            uint32_t magic   = ENTRY_MAGIC;
+            uint32_t version = ENTRY_VERSION;
+            uint64_t key     = 0;
+            uint64_t size    = 0;
+            uint64_t hash    = 0;
+        };
+
+        std::string ToHex(uint64_t _value)
+        {
+            char hex[17];
+            std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(_value));
+            return hex;
+        }
+    } // namespace
+
+    DerivedDataCache::DerivedDataCache(const std::filesystem::path &_directory)
+        : m_directory(_directory)
+    {
+        if (m_directory.empty()) {
+            return;
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(m_directory, error);
+
+        if (error) {
+            std::cout << "Derived data cache disabled, can not create " << m_directory.string()
+                      << " : " << error.message() << "\n";
+            return;
+        }
+
+        m_enabled = true;
+    }
+
+    ByteBuffer DerivedDataCache::Load(uint64_t _key)
+    {
+        if (!m_enabled) {
+            return {};
+        }
+
+        std::filesystem::path entryPath = getEntryPath(_key);
+        std::error_code error;
+
+        if (!std::filesystem::exists(entryPath, error)) {
+            m_misses++;
+            return {};
+        }
+
+        // ReadFile appends a terminator
+        ByteBuffer entry = ReadFile(entryPath);
+        EntryHeader header;
+
+        if (entry.size() > sizeof(header)) {
+            std::memcpy(&header, entry.data(), sizeof(header));
+            entry.pop_back();
+        }
+
+        bool isValid = entry.size() >= sizeof(header) && header.magic == ENTRY_MAGIC
+                       && header.version == ENTRY_VERSION && header.key == _key
+                       && header.size == entry.size() - sizeof(header)
+                       && header.hash == HashXXH3(entry.data() + sizeof(header), header.size);
+
+        if (!isValid) {
+            m_misses++;
+            return {};
+        }
+
+        m_hits++;
+        entry.erase(entry.begin(), entry.begin() + sizeof(header));
+
+        return entry;
+    }
+
+    void DerivedDataCache::Store(uint64_t _key, std::span<const uint8_t> _data)
+    {
+        if (!m_enabled) {
+            return;
+        }
+
+        EntryHeader header;
+        header.key  = _key;
+        header.size = _data.size();
+        header.hash = HashXXH3(_data);
+
+        std::filesystem::path entryPath     = getEntryPath(_key);
+        std::filesystem::path temporaryPath = entryPath;
+        temporaryPath += "." + ToHex(std::hash<std::thread::id> {}(std::this_thread::get_id())) + ".tmp";
+
+        std::error_code error;
+        std::filesystem::create_directories(entryPath.parent_path(), error);
+
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char *>(_data.data()),
+                       static_cast<std::streamsize>(_data.size()));
+
+            if (!file) {
+                file.close();
+                std::filesystem::remove(temporaryPath, error);
+                return;
+            }
+        }
+
+        std::filesystem::rename(temporaryPath, entryPath, error);
+        if (error) {
+            std::filesystem::remove(temporaryPath, error);
+        }
+    }
+
+    std::filesystem::path DerivedDataCache::GetDefaultDirectory()
+    {
+        if (const char *directory = std::getenv("DADENGINE_CACHE_DIR")) {
+            return directory;
+        }
+
+#if defined(WINDOWS)
+        if (const char *localAppData = std::getenv("LOCALAPPDATA")) {
+            return std::filesystem::path(localAppData) / "dadengine";
+        }
+#else
+        if (const char *cacheHome = std::getenv("XDG_CACHE_HOME")) {
+            return std::filesystem::path(cacheHome) / "dadengine";
+        }
+
+        if (const char *home = std::getenv("HOME")) {
+            return std::filesystem::path(home) / ".cache" / "dadengine";
+        }
+#endif
+
+        return std::filesystem::temp_directory_path() / "dadengine";
+    }
+
+    DerivedDataCache &DerivedDataCache::Get()
+    {
+        static DerivedDataCache cache(std::getenv("DADENGINE_NO_CACHE") ? std::filesystem::path()
+                                                                        : GetDefaultDirectory());
+
+        return cache;
+    }
+
+    // Entries are spread over 256 directories named after the first key byte
+    std::filesystem::path DerivedDataCache::getEntryPath(uint64_t _key) const
+    {
+        std::string name = ToHex(_key);
+
+        return m_directory / name.substr(0, 2) / name;
+    }
+} // namespace DadEngine
@@ -2,10 +2,151 @@
 
 #include <fstream>
 #include <iostream>
+#include <utility>
+
+#if defined(WINDOWS)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace DadEngine {
-    std::vector<uint8_t> ReadFile(std::filesystem::path _filePath) {
-        std::fstream fs(_filePath, std::ios::in | std::ios::binary);
+    MappedFile::MappedFile(const std::filesystem::path &_filePath, FileAccess _access)
+    {
+#if defined(WINDOWS)
+        DWORD flags = _access == FileAccess::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN
+                                                        : FILE_FLAG_RANDOM_ACCESS;
+        HANDLE file = CreateFileW(_filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, flags, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            std::cout << "File : " << _filePath.string() << " failed to open !\n";
+            return;
+        }
+
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        {
+            m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+            if (m_mapping)
+            {
+                m_data = static_cast<const uint8_t *>(
+                    MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+                m_size = m_data ? static_cast<size_t>(size.QuadPart) : 0;
+            }
+        }
+
+        // The mapping keeps its own reference on the file
+        CloseHandle(file);
+#else
+        int file = open(_filePath.c_str(), O_RDONLY);
+
+        if (file < 0)
+        {
+            std::cout << "File : " << _filePath.string() << " failed to open !\n";
+            return;
+        }
+
+        struct stat status;
+        if (fstat(file, &status) == 0 && status.st_size > 0)
+        {
+            int flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+            // Sequential readers touch every page, fault them in one go
+            if (_access == FileAccess::Sequential)
+            {
+                flags |= MAP_POPULATE;
+            }
+#endif
+
+            void *data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ,
+                              flags, file, 0);
+
+            if (data != MAP_FAILED)
+            {
+                m_data = static_cast<const uint8_t *>(data);
+                m_size = static_cast<size_t>(status.st_size);
+
+                if (_access == FileAccess::Sequential)
+                {
+                    madvise(data, m_size, MADV_SEQUENTIAL);
+                    madvise(data, m_size, MADV_WILLNEED);
+                }
+                else
+                {
+                    madvise(data, m_size, MADV_RANDOM);
+                }
+            }
+        }
+
+        // The mapping keeps its own reference on the file
+        close(file);
+#endif
+
+        if (!m_data)
+        {
+            std::cout << "File : " << _filePath.string() << " failed to map !\n";
+        }
+    }
+
+    MappedFile::MappedFile(MappedFile &&_other) noexcept
+    {
+        *this = std::move(_other);
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&_other) noexcept
+    {
+        if (this != &_other)
+        {
+            release();
+
+            m_data = std::exchange(_other.m_data, nullptr);
+            m_size = std::exchange(_other.m_size, 0);
+#if defined(WINDOWS)
+            m_mapping = std::exchange(_other.m_mapping, nullptr);
+#endif
+        }
+
+        return *this;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        release();
+    }
+
+    void MappedFile::release()
+    {
+#if defined(WINDOWS)
+        if (m_data)
+        {
+            UnmapViewOfFile(m_data);
+        }
+
+        if (m_mapping)
+        {
+            CloseHandle(m_mapping);
+        }
+
+        m_mapping = nullptr;
+#else
+        if (m_data)
+        {
+            munmap(const_cast<uint8_t *>(m_data), m_size);
+        }
+#endif
+
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    ByteBuffer ReadFile(const std::filesystem::path &_filePath) {
+        std::ifstream fs(_filePath, std::ios::in | std::ios::binary | std::ios::ate);
 
         if (!fs.good())
         {
@@ -13,19 +154,21 @@ namespace DadEngine {
             return {};
         }
 
-        std::streampos begin = fs.tellg();
-
-        fs.seekg(0, std::ios::end);
-        std::streampos end = fs.tellg();
+        auto size = static_cast<size_t>(fs.tellg());
 
-        std::vector<uint8_t> buffer(static_cast<size_t>(end - begin));
+        // Room for the terminator up front so it never reallocates
+        ByteBuffer buffer(size + 1);
 
         fs.seekg(0, std::ios::beg);
-        fs.read(reinterpret_cast<char*>(buffer.data()), end - begin);
+        fs.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size));
 
-        fs.close();
+        if (fs.gcount() != static_cast<std::streamsize>(size))
+        {
+            std::cout << "File : " << _filePath.string() << " failed to read !\n";
+            return {};
+        }
 
-        buffer.push_back('\0');
+        buffer[size] = '\0';
 
         return buffer;
     }
@@ -0,0 +1,381 @@
+#include "hash.hpp"
+
+#include <cstring>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#include "simd.hpp"
+
+namespace DadEngine
+{
+    namespace
+    {
+        constexpr uint32_t PRIME32_1 = 0x9E3779B1U;
+        constexpr uint32_t PRIME32_2 = 0x85EBCA77U;
+        constexpr uint32_t PRIME32_3 = 0xC2B2AE3DU;
+
+        constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+        constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+        constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+        constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+        constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+        constexpr uint64_t PRIME_MX1 = 0x165667919E3779F9ULL;
+        constexpr uint64_t PRIME_MX2 = 0x9FB21C651E98DF25ULL;
+
+        constexpr size_t SECRET_SIZE        = 192U;
+        constexpr size_t STRIPE_SIZE        = 64U;
+        constexpr size_t SECRET_CONSUME     = 8U;
+        constexpr size_t STRIPES_PER_BLOCK  = (SECRET_SIZE - STRIPE_SIZE) / SECRET_CONSUME;
+        constexpr size_t BLOCK_SIZE         = STRIPE_SIZE * STRIPES_PER_BLOCK;
+        constexpr size_t MIDSIZE_MAX        = 240U;
+        constexpr size_t MIDSIZE_START      = 3U;
+        constexpr size_t MIDSIZE_LAST       = 136U - 17U;
+        constexpr size_t LAST_STRIPE_SECRET = SECRET_SIZE - STRIPE_SIZE - 7U;
+        constexpr size_t MERGE_SECRET       = 11U;
+
+        alignas(64) constexpr uint8_t SECRET[SECRET_SIZE] = {
+            0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21,
+            0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4,
+            0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a,
+            0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21, 0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e,
+            0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3,
+            0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97,
+            0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8, 0xa8, 0xfa,
+            0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+            0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78,
+            0x73, 0x64, 0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff,
+            0xfa, 0x13, 0x63, 0xeb, 0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16,
+            0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+            0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16,
+            0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+        };
+
+        // Little endian reads, every supported target is little endian
+        inline uint32_t Read32(const uint8_t *_data)
+        {
+            uint32_t value;
+            std::memcpy(&value, _data, sizeof(value));
+            return value;
+        }
+
+        inline uint64_t Read64(const uint8_t *_data)
+        {
+            uint64_t value;
+            std::memcpy(&value, _data, sizeof(value));
+            return value;
+        }
+
+        inline uint64_t RotateLeft(uint64_t _value, uint32_t _bits)
+        {
+            return (_value << _bits) | (_value >> (64U - _bits));
+        }
+
+        inline uint64_t Swap64(uint64_t _value)
+        {
+            return ((_value << 56U) & 0xFF00000000000000ULL) | ((_value << 40U) & 0x00FF000000000000ULL)
+                   | ((_value << 24U) & 0x0000FF0000000000ULL) | ((_value << 8U) & 0x000000FF00000000ULL)
+                   | ((_value >> 8U) & 0x00000000FF000000ULL) | ((_value >> 24U) & 0x0000000000FF0000ULL)
+                   | ((_value >> 40U) & 0x000000000000FF00ULL) | ((_value >> 56U) & 0x00000000000000FFULL);
+        }
+
+        // 128 bits product folded to 64 bits
+        inline uint64_t MultiplyFold(uint64_t _left, uint64_t _right)
+        {
+#if defined(__SIZEOF_INT128__)
+            unsigned __int128 product = static_cast<unsigned __int128>(_left) * _right;
+            return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64U);
+#elif defined(_MSC_VER) && defined(_M_X64)
+            uint64_t high = 0;
+            uint64_t low  = _umul128(_left, _right, &high);
+            return low ^ high;
+#else
+            uint64_t leftLow   = _left & 0xFFFFFFFFULL;
+            uint64_t leftHigh  = _left >> 32U;
+            uint64_t rightLow  = _right & 0xFFFFFFFFULL;
+            uint64_t rightHigh = _right >> 32U;
+
+            uint64_t lowLow   = leftLow * rightLow;
+            uint64_t highLow  = leftHigh * rightLow;
+            uint64_t lowHigh  = leftLow * rightHigh;
+            uint64_t highHigh = leftHigh * rightHigh;
+
+            uint64_t cross = (lowLow >> 32U) + (highLow & 0xFFFFFFFFULL) + lowHigh;
+            uint64_t high  = (highLow >> 32U) + (cross >> 32U) + highHigh;
+            uint64_t low   = (cross << 32U) | (lowLow & 0xFFFFFFFFULL);
+            return low ^ high;
+#endif
+        }
+
+        inline uint64_t Avalanche(uint64_t _hash)
+        {
+            _hash ^= _hash >> 37U;
+            _hash *= PRIME_MX1;
+            return _hash ^ (_hash >> 32U);
+        }
+
+        inline uint64_t AvalancheXXH64(uint64_t _hash)
+        {
+            _hash ^= _hash >> 33U;
+            _hash *= PRIME64_2;
+            _hash ^= _hash >> 29U;
+            _hash *= PRIME64_3;
+            return _hash ^ (_hash >> 32U);
+        }
+
+        inline uint64_t Mix16(const uint8_t *_data, const uint8_t *_secret)
+        {
+            return MultiplyFold(Read64(_data) ^ Read64(_secret), Read64(_data + 8) ^ Read64(_secret + 8));
+        }
+
+        uint64_t HashUpTo16(const uint8_t *_data, size_t _size)
+        {
+            if (_size > 8U) {
+                uint64_t low  = Read64(_data) ^ (Read64(SECRET + 24) ^ Read64(SECRET + 32));
+                uint64_t high = Read64(_data + _size - 8) ^ (Read64(SECRET + 40) ^ Read64(SECRET + 48));
+                return Avalanche(_size + Swap64(low) + high + MultiplyFold(low, high));
+            }
+
+            if (_size >= 4U) {
+                uint64_t input = Read32(_data + _size - 4)
+                                 + (static_cast<uint64_t>(Read32(_data)) << 32U);
+                uint64_t hash = input ^ (Read64(SECRET + 8) ^ Read64(SECRET + 16));
+
+                hash ^= RotateLeft(hash, 49U) ^ RotateLeft(hash, 24U);
+                hash *= PRIME_MX2;
+                hash ^= (hash >> 35U) + _size;
+                hash *= PRIME_MX2;
+                return hash ^ (hash >> 28U);
+            }
+
+            if (_size > 0U) {
+                uint32_t combined = (static_cast<uint32_t>(_data[0]) << 16U)
+                                    | (static_cast<uint32_t>(_data[_size >> 1U]) << 24U)
+                                    | static_cast<uint32_t>(_data[_size - 1])
+                                    | (static_cast<uint32_t>(_size) << 8U);
+                uint64_t flip = Read32(SECRET) ^ Read32(SECRET + 4);
+                return AvalancheXXH64(combined ^ flip);
+            }
+
+            return AvalancheXXH64(Read64(SECRET + 56) ^ Read64(SECRET + 64));
+        }
+
+        uint64_t HashUpTo128(const uint8_t *_data, size_t _size)
+        {
+            uint64_t hash = _size * PRIME64_1;
+
+            if (_size > 32U) {
+                if (_size > 64U) {
+                    if (_size > 96U) {
+                        hash += Mix16(_data + 48, SECRET + 96);
+                        hash += Mix16(_data + _size - 64, SECRET + 112);
+                    }
+
+                    hash += Mix16(_data + 32, SECRET + 64);
+                    hash += Mix16(_data + _size - 48, SECRET + 80);
+                }
+
+                hash += Mix16(_data + 16, SECRET + 32);
+                hash += Mix16(_data + _size - 32, SECRET + 48);
+            }
+
+            hash += Mix16(_data, SECRET);
+            hash += Mix16(_data + _size - 16, SECRET + 16);
+
+            return Avalanche(hash);
+        }
+
+        uint64_t HashUpTo240(const uint8_t *_data, size_t _size)
+        {
+            uint64_t hash = _size * PRIME64_1;
+            size_t rounds = _size / 16U;
+
+            for (size_t i = 0; i < 8U; i++) {
+                hash += Mix16(_data + 16U * i, SECRET + 16U * i);
+            }
+
+            hash = Avalanche(hash);
+
+            for (size_t i = 8U; i < rounds; i++) {
+                hash += Mix16(_data + 16U * i, SECRET + 16U * (i - 8U) + MIDSIZE_START);
+            }
+
+            hash += Mix16(_data + _size - 16, SECRET + MIDSIZE_LAST);
+
+            return Avalanche(hash);
+        }
+
+        // One 64 bytes stripe into the 8 accumulators
+        inline void AccumulateStripe(uint64_t *_accumulators, const uint8_t *_data, const uint8_t *_secret)
+        {
+#if defined(DADENGINE_SSE2)
+            for (size_t i = 0; i < 4U; i++) {
+                auto *accumulator = reinterpret_cast<__m128i *>(_accumulators) + i;
+                __m128i data      = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_data) + i);
+                __m128i key       = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_secret) + i);
+                __m128i dataKey   = _mm_xor_si128(data, key);
+                __m128i product   = _mm_mul_epu32(dataKey, _mm_shuffle_epi32(dataKey, 0x31));
+                __m128i sum = _mm_add_epi64(_mm_load_si128(accumulator), _mm_shuffle_epi32(data, 0x4E));
+
+                _mm_store_si128(accumulator, _mm_add_epi64(product, sum));
+            }
+#else
+            for (size_t i = 0; i < 8U; i++) {
+                uint64_t data    = Read64(_data + 8U * i);
+                uint64_t dataKey = data ^ Read64(_secret + 8U * i);
+
+                _accumulators[i ^ 1U] += data;
+                _accumulators[i] += (dataKey & 0xFFFFFFFFULL) * (dataKey >> 32U);
+            }
+#endif
+        }
+
+        inline void ScrambleAccumulators(uint64_t *_accumulators, const uint8_t *_secret)
+        {
+#if defined(DADENGINE_SSE2)
+            const __m128i prime = _mm_set1_epi32(static_cast<int>(PRIME32_1));
+
+            for (size_t i = 0; i < 4U; i++) {
+                auto *accumulator = reinterpret_cast<__m128i *>(_accumulators) + i;
+                __m128i value     = _mm_load_si128(accumulator);
+                __m128i key       = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_secret) + i);
+
+                value = _mm_xor_si128(_mm_xor_si128(value, _mm_srli_epi64(value, 47)), key);
+
+                __m128i low  = _mm_mul_epu32(value, prime);
+                __m128i high = _mm_mul_epu32(_mm_shuffle_epi32(value, 0x31), prime);
+                _mm_store_si128(accumulator, _mm_add_epi64(low, _mm_slli_epi64(high, 32)));
+            }
+#else
+            for (size_t i = 0; i < 8U; i++) {
+                uint64_t value = _accumulators[i];
+                value ^= value >> 47U;
+                value ^= Read64(_secret + 8U * i);
+                _accumulators[i] = value * PRIME32_1;
+            }
+#endif
+        }
+
+#if defined(DADENGINE_AVX2)
+        DADENGINE_TARGET("avx2") inline void AccumulateStripeAVX2(uint64_t *_accumulators,
+                                                                  const uint8_t *_data,
+                                                                  const uint8_t *_secret)
+        {
+            for (size_t i = 0; i < 2U; i++) {
+                auto *accumulator = reinterpret_cast<__m256i *>(_accumulators) + i;
+                __m256i data      = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(_data) + i);
+                __m256i key       = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(_secret) + i);
+                __m256i dataKey   = _mm256_xor_si256(data, key);
+                __m256i product   = _mm256_mul_epu32(dataKey, _mm256_shuffle_epi32(dataKey, 0x31));
+                __m256i sum = _mm256_add_epi64(_mm256_load_si256(accumulator),
+                                               _mm256_shuffle_epi32(data, 0x4E));
+
+                _mm256_store_si256(accumulator, _mm256_add_epi64(product, sum));
+            }
+        }
+
+        DADENGINE_TARGET("avx2") inline void ScrambleAccumulatorsAVX2(uint64_t *_accumulators,
+                                                                      const uint8_t *_secret)
+        {
+            const __m256i prime = _mm256_set1_epi32(static_cast<int>(PRIME32_1));
+
+            for (size_t i = 0; i < 2U; i++) {
+                auto *accumulator = reinterpret_cast<__m256i *>(_accumulators) + i;
+                __m256i value     = _mm256_load_si256(accumulator);
+                __m256i key       = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(_secret) + i);
+
+                value = _mm256_xor_si256(_mm256_xor_si256(value, _mm256_srli_epi64(value, 47)), key);
+
+                __m256i low  = _mm256_mul_epu32(value, prime);
+                __m256i high = _mm256_mul_epu32(_mm256_shuffle_epi32(value, 0x31), prime);
+                _mm256_store_si256(accumulator, _mm256_add_epi64(low, _mm256_slli_epi64(high, 32)));
+            }
+        }
+#endif
+
+        // Every stripe of the input through the accumulators, with the
+        // kernels of one instruction set
+        template <void (*Accumulate)(uint64_t *, const uint8_t *, const uint8_t *),
+                  void (*Scramble)(uint64_t *, const uint8_t *)>
+        inline void AccumulateLong(uint64_t *_accumulators, const uint8_t *_data, size_t _size)
+        {
+            size_t blockCount = (_size - 1U) / BLOCK_SIZE;
+
+            for (size_t block = 0; block < blockCount; block++) {
+                const uint8_t *blockData = _data + block * BLOCK_SIZE;
+
+                for (size_t stripe = 0; stripe < STRIPES_PER_BLOCK; stripe++) {
+                    Accumulate(_accumulators, blockData + stripe * STRIPE_SIZE, SECRET + stripe * SECRET_CONSUME);
+                }
+
+                Scramble(_accumulators, SECRET + SECRET_SIZE - STRIPE_SIZE);
+            }
+
+            // Partial last block then the last stripe, which may overlap it
+            size_t stripeCount = ((_size - 1U) - BLOCK_SIZE * blockCount) / STRIPE_SIZE;
+            const uint8_t *lastBlock = _data + blockCount * BLOCK_SIZE;
+
+            for (size_t stripe = 0; stripe < stripeCount; stripe++) {
+                Accumulate(_accumulators, lastBlock + stripe * STRIPE_SIZE, SECRET + stripe * SECRET_CONSUME);
+            }
+
+            Accumulate(_accumulators, _data + _size - STRIPE_SIZE, SECRET + LAST_STRIPE_SECRET);
+        }
+
+#if defined(DADENGINE_AVX2)
+        // The whole loop is built for AVX2 so the kernels inline into it
+        DADENGINE_TARGET("avx2") void AccumulateLongAVX2(uint64_t *_accumulators,
+                                                         const uint8_t *_data,
+                                                         size_t _size)
+        {
+            AccumulateLong<AccumulateStripeAVX2, ScrambleAccumulatorsAVX2>(_accumulators, _data, _size);
+        }
+#endif
+
+        uint64_t HashLong(const uint8_t *_data, size_t _size)
+        {
+            alignas(32) uint64_t accumulators[8] = { PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+                                                     PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1 };
+
+#if defined(DADENGINE_AVX2)
+            if (CPUHasAVX2()) {
+                AccumulateLongAVX2(accumulators, _data, _size);
+            }
+            else
+#endif
+            {
+                AccumulateLong<AccumulateStripe, ScrambleAccumulators>(accumulators, _data, _size);
+            }
+
+            uint64_t hash = _size * PRIME64_1;
+            for (size_t i = 0; i < 4U; i++) {
+                hash += MultiplyFold(accumulators[2U * i] ^ Read64(SECRET + MERGE_SECRET + 16U * i),
+                                     accumulators[2U * i + 1U]
+                                         ^ Read64(SECRET + MERGE_SECRET + 16U * i + 8U));
+            }
+
+            return Avalanche(hash);
+        }
+    } // namespace
+
+    uint64_t HashXXH3(const void *_data, size_t _size)
+    {
+        const auto *data = static_cast<const uint8_t *>(_data);
+
+        if (_size <= 16U) {
+            return HashUpTo16(data, _size);
+        }
+
+        if (_size <= 128U) {
+            return HashUpTo128(data, _size);
+        }
+
+        if (_size <= MIDSIZE_MAX) {
+            return HashUpTo240(data, _size);
+        }
+
+        return HashLong(data, _size);
+    }
+} // namespace DadEngine
@@ -0,0 +1,43 @@
+#include "load-profiler.hpp"
+
+namespace DadEngine
+{
+    const char *GetLoadStageName(LoadStage _stage)
+    {
+        switch (_stage) {
+        case LoadStage::JSONParse:
+            return "jsonParse";
+        case LoadStage::BufferRead:
+            return "bufferRead";
+        case LoadStage::AttributeCopy:
+            return "attributeCopy";
+        case LoadStage::IndexConversion:
+            return "indexConversion";
+        case LoadStage::MeshProcessing:
+            return "meshProcessing";
+        case LoadStage::ImageDecode:
+            return "imageDecode";
+        case LoadStage::TextureCompression:
+            return "textureCompression";
+        case LoadStage::MaterialBuild:
+            return "materialBuild";
+        default:
+            return "unknown";
+        }
+    }
+
+    void LoadProfiler::Reset()
+    {
+        for (size_t stage = 0; stage < STAGE_COUNT; stage++) {
+            m_times[stage]  = 0;
+            m_counts[stage] = 0;
+        }
+    }
+
+    LoadProfiler &LoadProfiler::Get()
+    {
+        static LoadProfiler profiler;
+
+        return profiler;
+    }
+} // namespace DadEngine
@@ -0,0 +1,125 @@
+#include "thread-pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+namespace DadEngine
+{
+    ThreadPool::ThreadPool(uint32_t _threadCount)
+    {
+        _threadCount = std::max(_threadCount, 1U);
+
+        for (uint32_t i = 0; i < _threadCount; i++)
+        {
+            m_workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_condition.notify_all();
+
+        for (auto &worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::ParallelFor(uint32_t _count,
+                                 uint32_t _grainSize,
+                                 const std::function<void(uint32_t _begin, uint32_t _end)> &_function)
+    {
+        if (_count == 0)
+        {
+            return;
+        }
+
+        _grainSize          = std::max(_grainSize, 1U);
+        uint32_t chunkCount = (_count + _grainSize - 1) / _grainSize;
+
+        struct ParallelForState
+        {
+            std::atomic<uint32_t> nextChunk { 0 };
+            std::atomic<uint32_t> completedChunks { 0 };
+            std::mutex mutex;
+            std::condition_variable completed;
+        };
+
+        // Helpers may start after the caller returned, they share ownership
+        auto state    = std::make_shared<ParallelForState>();
+        auto function = std::make_shared<std::function<void(uint32_t, uint32_t)>>(_function);
+
+        auto processChunks = [state, function, chunkCount, _count, _grainSize]() {
+            uint32_t chunk = state->nextChunk++;
+
+            while (chunk < chunkCount)
+            {
+                uint32_t begin = chunk * _grainSize;
+                (*function)(begin, std::min(begin + _grainSize, _count));
+
+                if (++state->completedChunks == chunkCount)
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->completed.notify_all();
+                }
+
+                chunk = state->nextChunk++;
+            }
+        };
+
+        uint32_t helperCount = std::min(chunkCount - 1, GetThreadCount());
+        if (helperCount != 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (uint32_t i = 0; i < helperCount; i++)
+                {
+                    m_tasks.emplace(processChunks);
+                }
+            }
+
+            m_condition.notify_all();
+        }
+
+        processChunks();
+
+        // Only wait for chunks other threads already started
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->completed.wait(lock, [&]() { return state->completedChunks == chunkCount; });
+    }
+
+    ThreadPool &ThreadPool::Get()
+    {
+        static ThreadPool pool;
+
+        return pool;
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+
+                if (m_stopping && m_tasks.empty())
+                {
+                    return;
+                }
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop();
+            }
+
+            task();
+        }
+    }
+} // namespace DadEngine
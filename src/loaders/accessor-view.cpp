@@ -0,0 +1,450 @@
+#include "accessor-view.hpp"
+
+#include <algorithm>
+
+#include "helpers/simd.hpp"
+
+namespace DadEngine
+{
+    namespace
+    {
+        float HalfToFloat(uint16_t _half)
+        {
+            uint32_t sign     = static_cast<uint32_t>(_half & 0x8000U) << 16U;
+            uint32_t exponent = (_half >> 10U) & 0x1FU;
+            uint32_t mantissa = _half & 0x3FFU;
+            uint32_t bits     = 0;
+
+            if (exponent == 0x1FU) { // Infinity or NaN
+                bits = sign | 0x7F800000U | (mantissa << 13U);
+            }
+            else if (exponent != 0) {
+                bits = sign | ((exponent + 112U) << 23U) | (mantissa << 13U);
+            }
+            else if (mantissa != 0) { // Denormal, renormalize it
+                exponent = 113U;
+                while ((mantissa & 0x400U) == 0) {
+                    mantissa <<= 1U;
+                    exponent--;
+                }
+                bits = sign | (exponent << 23U) | ((mantissa & 0x3FFU) << 13U);
+            }
+            else {
+                bits = sign;
+            }
+
+            float value;
+            std::memcpy(&value, &bits, sizeof(float));
+            return value;
+        }
+
+        // Normalized integers map to [0, 1] or [-1, 1] as the glTF spec says
+        float GetNormalizationScale(uint32_t _componentType)
+        {
+            switch (_componentType) {
+            case GLTF_BYTE:
+                return 1.f / 127.f;
+            case GLTF_UNSIGNED_BYTE:
+                return 1.f / 255.f;
+            case GLTF_SHORT:
+                return 1.f / 32767.f;
+            case GLTF_UNSIGNED_SHORT:
+                return 1.f / 65535.f;
+            default:
+                return 1.f;
+            }
+        }
+
+        float LoadComponent(const uint8_t *_component, uint32_t _componentType)
+        {
+            switch (_componentType) {
+            case GLTF_BYTE:
+                return static_cast<float>(static_cast<int8_t>(*_component));
+            case GLTF_UNSIGNED_BYTE:
+                return static_cast<float>(*_component);
+            case GLTF_SHORT: {
+                int16_t value;
+                std::memcpy(&value, _component, sizeof(value));
+                return static_cast<float>(value);
+            }
+            case GLTF_UNSIGNED_SHORT: {
+                uint16_t value;
+                std::memcpy(&value, _component, sizeof(value));
+                return static_cast<float>(value);
+            }
+            case GLTF_HALF_FLOAT: {
+                uint16_t value;
+                std::memcpy(&value, _component, sizeof(value));
+                return HalfToFloat(value);
+            }
+            case GLTF_UNSIGNED_INT: {
+                uint32_t value;
+                std::memcpy(&value, _component, sizeof(value));
+                return static_cast<float>(value);
+            }
+            default: {
+                float value;
+                std::memcpy(&value, _component, sizeof(value));
+                return value;
+            }
+            }
+        }
+
+#if defined(DADENGINE_SSE2)
+        void StoreComponents(__m128 _values, float *_destination, uint32_t _componentCount)
+        {
+            switch (_componentCount) {
+            case 4:
+                _mm_storeu_ps(_destination, _values);
+                break;
+            case 3:
+                _mm_storel_pi(reinterpret_cast<__m64 *>(_destination), _values);
+                _mm_store_ss(_destination + 2, _mm_movehl_ps(_values, _values));
+                break;
+            case 2:
+                _mm_storel_pi(reinterpret_cast<__m64 *>(_destination), _values);
+                break;
+            default:
+                _mm_store_ss(_destination, _values);
+                break;
+            }
+        }
+
+        // Widens up to four 8 or 16 bit components to 32 bit integers
+        __m128i WidenComponents(__m128i _components, uint32_t _componentType)
+        {
+            switch (_componentType) {
+            case GLTF_BYTE:
+                _components = _mm_unpacklo_epi8(_components, _components);
+                return _mm_srai_epi32(_mm_unpacklo_epi16(_components, _components), 24);
+            case GLTF_UNSIGNED_BYTE:
+                _components = _mm_unpacklo_epi8(_components, _mm_setzero_si128());
+                return _mm_unpacklo_epi16(_components, _mm_setzero_si128());
+            case GLTF_SHORT:
+                return _mm_srai_epi32(_mm_unpacklo_epi16(_components, _components), 16);
+            default:
+                return _mm_unpacklo_epi16(_components, _mm_setzero_si128());
+            }
+        }
+#endif
+
+#if defined(DADENGINE_F16C)
+        // Elements are copied to a zeroed block first so a load never reads
+        // past the accessor end. Matrices are converted four components at a
+        // time
+        DADENGINE_TARGET("f16c") void ConvertHalfFloats(const uint8_t *_source,
+                                                        size_t _sourceStride,
+                                                        uint32_t _componentCount,
+                                                        size_t _count,
+                                                        uint8_t *_destination,
+                                                        size_t _destinationStride)
+        {
+            alignas(16) uint8_t element[16] = {};
+
+            for (size_t i = 0; i < _count; i++) {
+                const uint8_t *sourceElement = _source + i * _sourceStride;
+                auto *destinationElement     = reinterpret_cast<float *>(_destination + i * _destinationStride);
+
+                for (uint32_t c = 0; c < _componentCount; c += 4U) {
+                    uint32_t chunkCount = std::min(_componentCount - c, 4U);
+
+                    std::memcpy(element, sourceElement + c * sizeof(uint16_t), chunkCount * sizeof(uint16_t));
+                    __m128 values = _mm_cvtph_ps(_mm_load_si128(reinterpret_cast<__m128i *>(element)));
+
+                    StoreComponents(values, destinationElement + c, chunkCount);
+                }
+            }
+        }
+#endif
+    } // namespace
+
+    AccessorLayout ResolveAccessor(const GLTFDocument &_document,
+                                   const std::vector<std::span<const uint8_t>> &_buffers,
+                                   const GLTFAccessor &_accessor)
+    {
+        AccessorLayout layout;
+
+        if (_accessor.bufferView >= _document.bufferViews.size()) {
+            return layout;
+        }
+
+        const GLTFBufferView &bufferView = _document.bufferViews[_accessor.bufferView];
+        if (bufferView.buffer >= _buffers.size() || !_buffers[bufferView.buffer].data()) {
+            return layout;
+        }
+
+        std::span<const uint8_t> buffer = _buffers[bufferView.buffer];
+        if (bufferView.byteOffset > buffer.size() || bufferView.byteLength > buffer.size() - bufferView.byteOffset) {
+            return layout;
+        }
+
+        size_t elementSize = GetComponentSize(_accessor.componentType) * _accessor.componentCount;
+        size_t stride = bufferView.byteStride ? bufferView.byteStride : elementSize;
+
+        if (elementSize == 0) {
+            return layout;
+        }
+
+        // Written so that no term can overflow
+        if (_accessor.count > 0
+            && (elementSize > bufferView.byteLength || _accessor.byteOffset > bufferView.byteLength - elementSize
+                || _accessor.count - 1 > (bufferView.byteLength - elementSize - _accessor.byteOffset) / stride)) {
+            return layout;
+        }
+
+        layout.data = buffer.data() + bufferView.byteOffset + _accessor.byteOffset;
+        layout.stride      = stride;
+        layout.elementSize = elementSize;
+        layout.count       = _accessor.count;
+
+        return layout;
+    }
+
+    bool ReadAccessor(const GLTFDocument &_document,
+                      const std::vector<std::span<const uint8_t>> &_buffers,
+                      const GLTFAccessor &_accessor,
+                      uint32_t _componentCount,
+                      float *_destination,
+                      size_t _destinationStride)
+    {
+        AccessorLayout layout = ResolveAccessor(_document, _buffers, _accessor);
+
+        if (!layout.data) {
+            return false;
+        }
+
+        ConvertToFloat(layout.data, layout.stride, _accessor.componentType,
+                       _accessor.normalized,
+                       std::min(_componentCount, _accessor.componentCount),
+                       layout.count, _destination, _destinationStride);
+
+        return true;
+    }
+
+    bool ReadAccessor(const GLTFDocument &_document,
+                      const std::vector<std::span<const uint8_t>> &_buffers,
+                      const GLTFAccessor &_accessor,
+                      uint32_t _componentCount,
+                      uint32_t *_destination,
+                      size_t _destinationStride)
+    {
+        AccessorLayout layout = ResolveAccessor(_document, _buffers, _accessor);
+
+        if (!layout.data) {
+            return false;
+        }
+
+        ConvertToUint32(layout.data, layout.stride, _accessor.componentType,
+                        std::min(_componentCount, _accessor.componentCount),
+                        layout.count, _destination, _destinationStride);
+
+        return true;
+    }
+
+    bool ReadFloatAccessor(const GLTFDocument &_document,
+                           const std::vector<std::span<const uint8_t>> &_buffers,
+                           const GLTFAccessor &_accessor,
+                           std::vector<float> &_storage,
+                           std::span<const float> &_floats)
+    {
+        AccessorLayout layout = ResolveAccessor(_document, _buffers, _accessor);
+
+        if (!layout.data) {
+            return false;
+        }
+
+        size_t componentTotal = layout.count * _accessor.componentCount;
+
+        // Packed elements are one run of components
+        if (_accessor.componentType == GLTF_FLOAT && layout.stride == layout.elementSize) {
+            AccessorView<float> components(layout.data, componentTotal, sizeof(float));
+
+            if (components.IsContiguous()) {
+                _floats = { components.Data(), components.Size() };
+                return true;
+            }
+        }
+
+        _storage.resize(componentTotal);
+        ConvertToFloat(layout.data, layout.stride, _accessor.componentType, _accessor.normalized,
+                       _accessor.componentCount, layout.count, _storage.data(),
+                       _accessor.componentCount * sizeof(float));
+
+        _floats = _storage;
+        return true;
+    }
+
+    void ConvertToFloat(const uint8_t *_source,
+                        size_t _sourceStride,
+                        uint32_t _componentType,
+                        bool _normalized,
+                        uint32_t _componentCount,
+                        size_t _count,
+                        float *_destination,
+                        size_t _destinationStride)
+    {
+        auto *destination    = reinterpret_cast<uint8_t *>(_destination);
+        size_t componentSize = GetComponentSize(_componentType);
+        size_t elementSize   = componentSize * _componentCount;
+
+        if (_componentType == GLTF_FLOAT) {
+            if (_sourceStride == elementSize && _destinationStride == elementSize) {
+                std::memcpy(destination, _source, elementSize * _count);
+                return;
+            }
+
+            for (size_t i = 0; i < _count; i++) {
+                std::memcpy(destination + i * _destinationStride,
+                            _source + i * _sourceStride, elementSize);
+            }
+            return;
+        }
+
+        float scale = _normalized ? GetNormalizationScale(_componentType) : 1.f;
+        bool isSignedNormalized
+            = _normalized && (_componentType == GLTF_BYTE || _componentType == GLTF_SHORT);
+
+#if defined(DADENGINE_SSE2)
+        // Elements are copied to a zeroed block first so a load never reads
+        // past the accessor end. Matrices are converted four components at a
+        // time
+        alignas(16) uint8_t element[16] = {};
+
+        if (_componentType == GLTF_HALF_FLOAT) {
+#if defined(DADENGINE_F16C)
+            if (CPUHasF16C()) {
+                ConvertHalfFloats(_source, _sourceStride, _componentCount, _count, destination,
+                                  _destinationStride);
+                return;
+            }
+#endif
+        }
+        else if (_componentType != GLTF_UNSIGNED_INT) {
+            __m128 scaleFactor = _mm_set1_ps(scale);
+            __m128 minimum     = _mm_set1_ps(isSignedNormalized ? -1.f : -3.4e38f);
+
+            for (size_t i = 0; i < _count; i++) {
+                const uint8_t *sourceElement = _source + i * _sourceStride;
+                auto *destinationElement
+                    = reinterpret_cast<float *>(destination + i * _destinationStride);
+
+                for (uint32_t c = 0; c < _componentCount; c += 4U) {
+                    uint32_t chunkCount = std::min(_componentCount - c, 4U);
+
+                    std::memcpy(element, sourceElement + c * componentSize, chunkCount * componentSize);
+                    __m128i integers = WidenComponents(
+                        _mm_load_si128(reinterpret_cast<__m128i *>(element)), _componentType);
+                    __m128 values
+                        = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(integers), scaleFactor), minimum);
+
+                    StoreComponents(values, destinationElement + c, chunkCount);
+                }
+            }
+            return;
+        }
+#endif
+
+        for (size_t i = 0; i < _count; i++) {
+            const uint8_t *sourceElement = _source + i * _sourceStride;
+            auto *destinationElement
+                = reinterpret_cast<float *>(destination + i * _destinationStride);
+
+            for (uint32_t c = 0; c < _componentCount; c++) {
+                float value = LoadComponent(sourceElement + c * componentSize, _componentType) * scale;
+                destinationElement[c] = isSignedNormalized ? std::max(value, -1.f) : value;
+            }
+        }
+    }
+
+    void ConvertToUint32(const uint8_t *_source,
+                         size_t _sourceStride,
+                         uint32_t _componentType,
+                         uint32_t _componentCount,
+                         size_t _count,
+                         uint32_t *_destination,
+                         size_t _destinationStride)
+    {
+        auto *destination    = reinterpret_cast<uint8_t *>(_destination);
+        size_t componentSize = GetComponentSize(_componentType);
+        size_t elementSize   = componentSize * _componentCount;
+
+        bool isPacked = _sourceStride == elementSize
+                        && _destinationStride == _componentCount * sizeof(uint32_t);
+
+        if (isPacked && _componentType == GLTF_UNSIGNED_INT) {
+            std::memcpy(destination, _source, elementSize * _count);
+            return;
+        }
+
+#if defined(DADENGINE_SSE2)
+        // Packed data converts as a flat array of components, 8 at a time
+        if (isPacked && _componentType == GLTF_UNSIGNED_SHORT) {
+            size_t componentTotal = _count * _componentCount;
+            size_t c              = 0;
+
+            for (; c + 8 <= componentTotal; c += 8) {
+                __m128i values
+                    = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_source + c * 2));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(_destination + c),
+                                 _mm_unpacklo_epi16(values, _mm_setzero_si128()));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(_destination + c + 4),
+                                 _mm_unpackhi_epi16(values, _mm_setzero_si128()));
+            }
+
+            for (; c < componentTotal; c++) {
+                uint16_t value;
+                std::memcpy(&value, _source + c * 2, sizeof(value));
+                _destination[c] = value;
+            }
+            return;
+        }
+
+        if (isPacked && _componentType == GLTF_UNSIGNED_BYTE) {
+            size_t componentTotal = _count * _componentCount;
+            size_t c              = 0;
+
+            for (; c + 16 <= componentTotal; c += 16) {
+                __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_source + c));
+                __m128i low    = _mm_unpacklo_epi8(values, _mm_setzero_si128());
+                __m128i high   = _mm_unpackhi_epi8(values, _mm_setzero_si128());
+
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(_destination + c),
+                                 _mm_unpacklo_epi16(low, _mm_setzero_si128()));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(_destination + c + 4),
+                                 _mm_unpackhi_epi16(low, _mm_setzero_si128()));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(_destination + c + 8),
+                                 _mm_unpacklo_epi16(high, _mm_setzero_si128()));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(_destination + c + 12),
+                                 _mm_unpackhi_epi16(high, _mm_setzero_si128()));
+            }
+
+            for (; c < componentTotal; c++) {
+                _destination[c] = _source[c];
+            }
+            return;
+        }
+#endif
+
+        for (size_t i = 0; i < _count; i++) {
+            const uint8_t *sourceElement = _source + i * _sourceStride;
+            auto *destinationElement
+                = reinterpret_cast<uint32_t *>(destination + i * _destinationStride);
+
+            for (uint32_t c = 0; c < _componentCount; c++) {
+                const uint8_t *component = sourceElement + c * componentSize;
+
+                if (_componentType == GLTF_UNSIGNED_BYTE) {
+                    destinationElement[c] = *component;
+                }
+                else if (_componentType == GLTF_UNSIGNED_SHORT) {
+                    uint16_t value;
+                    std::memcpy(&value, component, sizeof(value));
+                    destinationElement[c] = value;
+                }
+                else {
+                    std::memcpy(&destinationElement[c], component, sizeof(uint32_t));
+                }
+            }
+        }
+    }
+} // namespace DadEngine
@@ -0,0 +1,451 @@
+#include "gltf-asset.hpp"
+
+#include <cstring>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string_view>
+
+#include "accessor-view.hpp"
+#include "helpers/base64.hpp"
+#include "helpers/derived-data-cache.hpp"
+#include "helpers/hash.hpp"
+#include "helpers/load-profiler.hpp"
+#include "mesh-processing.hpp"
+
+namespace DadEngine
+{
+    namespace
+    {
+        constexpr int32_t MAX_WEIGHT = 0xFFFF;
+
+        // Weights are quantized to 16 bits then fixed to sum to one exactly,
+        // the rounding error going to the largest one. Vertices without
+        // weights follow their first joint
+        void PackSkinAttributes(const uint32_t *_joints, const float *_weights, SkinVertex &_vertex)
+        {
+            float sum = 0.f;
+            for (uint32_t influence = 0; influence < 4U; influence++) {
+                _vertex.joints[influence] = static_cast<uint16_t>(std::min(_joints[influence], 0xFFFFU));
+                sum += std::max(_weights[influence], 0.f);
+            }
+
+            if (sum <= 0.f) {
+                _vertex.weights[0] = static_cast<uint16_t>(MAX_WEIGHT);
+                return;
+            }
+
+            int32_t total    = 0;
+            uint32_t largest = 0;
+            for (uint32_t influence = 0; influence < 4U; influence++) {
+                auto weight = static_cast<int32_t>(std::lround(std::max(_weights[influence], 0.f) / sum * MAX_WEIGHT));
+
+                _vertex.weights[influence] = static_cast<uint16_t>(weight);
+                total += weight;
+
+                if (weight > _vertex.weights[largest]) {
+                    largest = influence;
+                }
+            }
+
+            _vertex.weights[largest] = static_cast<uint16_t>(_vertex.weights[largest] + MAX_WEIGHT - total);
+        }
+    } // namespace
+
+    bool GLTFAsset::Load(const std::filesystem::path &_path)
+    {
+        m_path = _path;
+        m_file = MappedFile(_path);
+        if (!m_file.IsValid()) {
+            return false;
+        }
+
+        std::span<const uint8_t> json = m_file.GetData();
+        GLBChunks chunks;
+
+        {
+            ScopedLoadTimer timer(LoadStage::JSONParse);
+
+            // Binary glTF, the JSON and the first buffer are chunks of the file
+            if (_path.extension() == ".glb") {
+                if (!ParseGLBContainer(json.data(), json.size(), chunks)) {
+                    std::cout << "Invalid GLB container : " << _path.string() << "\n";
+                    return false;
+                }
+
+                json = { chunks.json, chunks.jsonSize };
+            }
+
+            if (!ParseGLTFDocument(json.data(), json.size(), m_document)) {
+                std::cout << "Failed to parse glTF : " << _path.string() << "\n";
+                return false;
+            }
+        }
+
+        ScopedLoadTimer bufferTimer(LoadStage::BufferRead);
+
+        for (const auto &buffer : m_document.buffers) {
+            const uint8_t *data = nullptr;
+            size_t size         = 0;
+            std::string_view mimeType;
+            std::string_view payload;
+
+            if (buffer.uri.empty() && m_buffers.empty() && chunks.bin) {
+                data = chunks.bin;
+                size = chunks.binSize;
+            }
+            else if (ParseBase64DataURI(buffer.uri, mimeType, payload)) {
+                std::vector<uint8_t> &embeddedBuffer
+                    = m_embeddedBuffers.emplace_back(GetBase64DecodedSize(payload));
+
+                if (DecodeBase64(payload, embeddedBuffer.data())) {
+                    data = embeddedBuffer.data();
+                    size = embeddedBuffer.size();
+                }
+                else {
+                    std::cout << "Invalid base64 data in buffer " << m_buffers.size() << "\n";
+                }
+            }
+            else if (!buffer.uri.empty()) {
+                auto pathCopy = _path;
+                auto filepath = pathCopy.replace_filename(buffer.uri);
+
+                m_externalBuffers.emplace_back(filepath);
+                data = m_externalBuffers.back().GetData().data();
+                size = m_externalBuffers.back().GetData().size();
+            }
+
+            if (size < buffer.byteLength) {
+                std::cout << "Buffer " << m_buffers.size() << " is smaller than its byteLength\n";
+                data = nullptr;
+                size = 0;
+            }
+
+            m_buffers.emplace_back(data, size);
+        }
+
+        // Data URIs are part of the file, the other buffers are hashed apart
+        if (DerivedDataCache::Get().IsEnabled()) {
+            std::vector<uint64_t> hashes { HashXXH3(m_file.GetData()) };
+            for (const auto &externalBuffer : m_externalBuffers) {
+                hashes.push_back(HashXXH3(externalBuffer.GetData()));
+            }
+
+            m_contentHash = HashXXH3(hashes.data(), hashes.size() * sizeof(uint64_t));
+        }
+
+        resolveMipSettings();
+
+        return true;
+    }
+
+    void GLTFAsset::ReadPrimitive(const GLTFPrimitive &_primitive,
+                                  std::vector<Vertex> &_vertices,
+                                  std::vector<uint32_t> &_indices,
+                                  std::vector<SkinVertex> *_skinVertices) const
+    {
+        if (_skinVertices) {
+            _skinVertices->clear();
+        }
+
+        _indices.clear();
+        if (_primitive.indices != GLTF_INVALID_INDEX) {
+            ScopedLoadTimer timer(LoadStage::IndexConversion);
+
+            const GLTFAccessor &accessor = m_document.accessors[_primitive.indices];
+
+            _indices.resize(accessor.count);
+            if (!ReadAccessor(m_document, m_buffers, accessor, 1U, _indices.data(),
+                              sizeof(uint32_t))) {
+                std::cout << "Invalid indices accessor : " << _primitive.indices << "\n";
+                _indices.clear();
+            }
+        }
+
+        _vertices.clear();
+        if (_primitive.position != GLTF_INVALID_INDEX) {
+            _vertices.resize(m_document.accessors[_primitive.position].count);
+        }
+
+        // Reads each attribute in place inside the interleaved vertices
+        auto readAttribute = [&](uint32_t _accessorIndex, uint32_t _componentCount,
+                                 float *_firstComponent) {
+            if (_accessorIndex == GLTF_INVALID_INDEX) {
+                return;
+            }
+
+            const GLTFAccessor &accessor = m_document.accessors[_accessorIndex];
+            if (accessor.count != _vertices.size()
+                || !ReadAccessor(m_document, m_buffers, accessor, _componentCount,
+                                 _firstComponent, sizeof(Vertex))) {
+                std::cout << "Invalid attribute accessor : " << _accessorIndex << "\n";
+            }
+        };
+
+        if (!_vertices.empty()) {
+            ScopedLoadTimer timer(LoadStage::AttributeCopy);
+
+            readAttribute(_primitive.position, 3U, &_vertices[0].position.x);
+            readAttribute(_primitive.normal, 3U, &_vertices[0].normal.x);
+            readAttribute(_primitive.tangent, 4U, &_vertices[0].tangent.x);
+            readAttribute(_primitive.texCoord0, 2U, &_vertices[0].uv0.x);
+
+            if (_skinVertices && _primitive.joints0 != GLTF_INVALID_INDEX
+                && _primitive.weights0 != GLTF_INVALID_INDEX) {
+                const GLTFAccessor &jointsAccessor  = m_document.accessors[_primitive.joints0];
+                const GLTFAccessor &weightsAccessor = m_document.accessors[_primitive.weights0];
+
+                std::vector<uint32_t> joints(_vertices.size() * 4U, 0U);
+                std::vector<float> weights(_vertices.size() * 4U, 0.f);
+
+                if (jointsAccessor.count != _vertices.size() || weightsAccessor.count != _vertices.size()
+                    || !ReadAccessor(m_document, m_buffers, jointsAccessor, 4U, joints.data(),
+                                     4U * sizeof(uint32_t))
+                    || !ReadAccessor(m_document, m_buffers, weightsAccessor, 4U, weights.data(),
+                                     4U * sizeof(float))) {
+                    std::cout << "Invalid skin accessors : " << _primitive.joints0 << ", "
+                              << _primitive.weights0 << "\n";
+                }
+                else {
+                    _skinVertices->resize(_vertices.size());
+                    for (size_t vertex = 0; vertex < _vertices.size(); vertex++) {
+                        PackSkinAttributes(&joints[vertex * 4U], &weights[vertex * 4U], (*_skinVertices)[vertex]);
+                    }
+                }
+            }
+        }
+
+        // Every pass after this one indexes the vertices with them
+        for (uint32_t index : _indices) {
+            if (index >= _vertices.size()) {
+                std::cout << "Index out of range in accessor : " << _primitive.indices << "\n";
+                _vertices.clear();
+                _indices.clear();
+
+                if (_skinVertices) {
+                    _skinVertices->clear();
+                }
+                return;
+            }
+        }
+    }
+
+    void GLTFAsset::ReadProcessedPrimitive(uint32_t _meshIndex,
+                                           uint32_t _primitiveIndex,
+                                           std::vector<Vertex> &_vertices,
+                                           std::vector<uint32_t> &_indices,
+                                           std::vector<SkinVertex> *_skinVertices) const
+    {
+        const GLTFPrimitive &primitive = m_document.meshes[_meshIndex].primitives[_primitiveIndex];
+        DerivedDataCache &cache        = DerivedDataCache::Get();
+
+        uint64_t key = CombineHashes({ m_contentHash, _meshIndex, _primitiveIndex,
+                                       MESH_PROCESSING_VERSION, sizeof(Vertex) });
+
+        // The skin stream is always read so one entry serves every caller
+        std::vector<SkinVertex> skinVertices;
+
+        // Vertex, index and skin vertex counts, then the vertices, indices
+        // and skin vertices
+        if (cache.IsEnabled()) {
+            ScopedLoadTimer timer(LoadStage::BufferRead);
+
+            ByteBuffer entry = cache.Load(key);
+            uint32_t counts[3];
+
+            if (entry.size() >= sizeof(counts)) {
+                std::memcpy(counts, entry.data(), sizeof(counts));
+
+                size_t verticesSize     = counts[0] * sizeof(Vertex);
+                size_t indicesSize      = counts[1] * sizeof(uint32_t);
+                size_t skinVerticesSize = counts[2] * sizeof(SkinVertex);
+
+                if (entry.size() == sizeof(counts) + verticesSize + indicesSize + skinVerticesSize) {
+                    const uint8_t *data = entry.data() + sizeof(counts);
+
+                    _vertices.resize(counts[0]);
+                    _indices.resize(counts[1]);
+                    std::memcpy(_vertices.data(), data, verticesSize);
+                    std::memcpy(_indices.data(), data + verticesSize, indicesSize);
+
+                    if (_skinVertices) {
+                        _skinVertices->resize(counts[2]);
+                        std::memcpy(_skinVertices->data(), data + verticesSize + indicesSize, skinVerticesSize);
+                    }
+                    return;
+                }
+            }
+        }
+
+        ReadPrimitive(primitive, _vertices, _indices, &skinVertices);
+
+        {
+            ScopedLoadTimer timer(LoadStage::MeshProcessing);
+            ProcessPrimitive(primitive, _vertices, _indices, &skinVertices);
+        }
+
+        if (cache.IsEnabled()) {
+            uint32_t counts[3]      = { static_cast<uint32_t>(_vertices.size()),
+                                        static_cast<uint32_t>(_indices.size()),
+                                        static_cast<uint32_t>(skinVertices.size()) };
+            size_t verticesSize     = _vertices.size() * sizeof(Vertex);
+            size_t indicesSize      = _indices.size() * sizeof(uint32_t);
+            size_t skinVerticesSize = skinVertices.size() * sizeof(SkinVertex);
+
+            std::vector<uint8_t> entry(sizeof(counts) + verticesSize + indicesSize + skinVerticesSize);
+            uint8_t *data = entry.data() + sizeof(counts);
+
+            std::memcpy(entry.data(), counts, sizeof(counts));
+            std::memcpy(data, _vertices.data(), verticesSize);
+            std::memcpy(data + verticesSize, _indices.data(), indicesSize);
+            std::memcpy(data + verticesSize + indicesSize, skinVertices.data(), skinVerticesSize);
+
+            cache.Store(key, entry);
+        }
+
+        if (_skinVertices) {
+            *_skinVertices = std::move(skinVertices);
+        }
+    }
+
+    Sampler GLTFAsset::GetSampler(const GLTFTexture &_texture) const
+    {
+        [[maybe_unused]] GLTFSampler gltfSampler = _texture.sampler != GLTF_INVALID_INDEX
+                                                       ? m_document.samplers[_texture.sampler]
+                                                       : GLTFSampler {};
+
+#if defined(OPENGL)
+        return { gltfSampler.magFilter, gltfSampler.minFilter, gltfSampler.wrapS,
+                 gltfSampler.wrapT };
+#else
+        return {};
+#endif
+    }
+
+    bool GLTFAsset::IsExternalImage(uint32_t _imageIndex) const
+    {
+        const GLTFImage &image = m_document.images[_imageIndex];
+        std::string_view mimeType;
+        std::string_view payload;
+
+        return image.bufferView == GLTF_INVALID_INDEX && !image.uri.empty()
+               && !ParseBase64DataURI(image.uri, mimeType, payload);
+    }
+
+    std::filesystem::path GLTFAsset::GetImagePath(uint32_t _imageIndex) const
+    {
+        return m_path.parent_path() / m_document.images[_imageIndex].uri;
+    }
+
+    std::span<const uint8_t> GLTFAsset::ReadImage(uint32_t _imageIndex,
+                                                  ByteBuffer &_storage) const
+    {
+        const GLTFImage &image = m_document.images[_imageIndex];
+
+        if (image.bufferView != GLTF_INVALID_INDEX) {
+            const GLTFBufferView &bufferView = m_document.bufferViews[image.bufferView];
+
+            if (bufferView.buffer >= m_buffers.size() || !m_buffers[bufferView.buffer].data()) {
+                return {};
+            }
+
+            std::span<const uint8_t> buffer = m_buffers[bufferView.buffer];
+            if (bufferView.byteOffset > buffer.size() || bufferView.byteLength > buffer.size() - bufferView.byteOffset) {
+                return {};
+            }
+
+            return buffer.subspan(bufferView.byteOffset, bufferView.byteLength);
+        }
+
+        std::string_view mimeType;
+        std::string_view payload;
+        if (ParseBase64DataURI(image.uri, mimeType, payload)) {
+            _storage.resize(GetBase64DecodedSize(payload));
+
+            if (!DecodeBase64(payload, _storage.data())) {
+                _storage.clear();
+            }
+
+            return _storage;
+        }
+
+        if (image.uri.empty()) {
+            return {};
+        }
+
+        _storage = ReadFile(GetImagePath(_imageIndex));
+
+        // Drop the terminator ReadFile conventions add
+        return { _storage.data(), _storage.empty() ? 0 : _storage.size() - 1 };
+    }
+
+    std::string GLTFAsset::GetImageName(uint32_t _imageIndex) const
+    {
+        const GLTFImage &image = m_document.images[_imageIndex];
+        std::string_view mimeType;
+        std::string_view payload;
+
+        if (image.uri.empty()) {
+            return "bufferView " + std::to_string(image.bufferView);
+        }
+
+        if (ParseBase64DataURI(image.uri, mimeType, payload)) {
+            return "data URI " + std::to_string(_imageIndex);
+        }
+
+        return image.uri;
+    }
+
+    // Both the compressed image of a texture and its fallback get the usage
+    void GLTFAsset::resolveMipSettings()
+    {
+        m_mipSettings.assign(m_document.images.size(), {});
+        std::vector<bool> isUsed(m_document.images.size(), false);
+
+        auto addUsage = [&](const GLTFTextureInfo &_textureInfo, TextureUsage _usage, float _alphaCutoff) {
+            if (_textureInfo.index >= m_document.textures.size()) {
+                return;
+            }
+
+            const GLTFTexture &texture = m_document.textures[_textureInfo.index];
+            for (uint32_t imageIndex : { texture.compressedSource, texture.source }) {
+                if (imageIndex >= m_mipSettings.size()) {
+                    continue;
+                }
+
+                MipSettings &settings = m_mipSettings[imageIndex];
+                if (!isUsed[imageIndex] || _usage < settings.usage) {
+                    settings.usage = _usage;
+                }
+
+                settings.alphaCutoff = std::max(settings.alphaCutoff, _alphaCutoff);
+                isUsed[imageIndex]   = true;
+            }
+        };
+
+        for (const auto &material : m_document.materials) {
+            float alphaCutoff = material.alphaMode == GLTFAlphaMode::Mask ? material.alphaCutoff : 0.f;
+
+            addUsage(material.baseColorTexture, TextureUsage::Color, alphaCutoff);
+            addUsage(material.emissiveTexture, TextureUsage::Color, 0.f);
+            addUsage(material.metallicRoughnessTexture, TextureUsage::Data, 0.f);
+            addUsage(material.occlusionTexture, TextureUsage::Data, 0.f);
+            addUsage(material.normalTexture, TextureUsage::Normal, 0.f);
+        }
+    }
+
+    bool GLTFAsset::HasAlpha(uint32_t _imageIndex) const
+    {
+        const GLTFImage &image = m_document.images[_imageIndex];
+        std::string_view mimeType;
+        std::string_view payload;
+
+        if (ParseBase64DataURI(image.uri, mimeType, payload)) {
+            return mimeType == "image/png";
+        }
+
+        return image.mimeType == "image/png"
+               || std::filesystem::path(image.uri).extension().string() == ".png";
+    }
+} // namespace DadEngine
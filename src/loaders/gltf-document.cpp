@@ -0,0 +1,905 @@
+#include "gltf-document.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <iostream>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace DadEngine
+{
+    namespace
+    {
+        // What the JSON container being read maps to in the document
+        enum class Context : uint8_t
+        {
+            Root,
+            Skip,
+            Buffers,
+            Buffer,
+            BufferViews,
+            BufferView,
+            Accessors,
+            Accessor,
+            Samplers,
+            Sampler,
+            Images,
+            Image,
+            Textures,
+            Texture,
+            TextureExtensions,
+            CompressedTexture,
+            Materials,
+            Material,
+            PBRMaterial,
+            TextureInfo,
+            Meshes,
+            Mesh,
+            Primitives,
+            Primitive,
+            Attributes,
+            Nodes,
+            Node,
+            Skins,
+            Skin,
+            Scenes,
+            Scene,
+            Animations,
+            Animation,
+            AnimationChannels,
+            AnimationChannel,
+            AnimationTarget,
+            AnimationSamplers,
+            AnimationSampler,
+            FloatArray,
+            IndexArray,
+        };
+
+        struct Frame
+        {
+            Context context;
+
+            // Destination of the container values, depending on the context
+            float *floats                  = nullptr;
+            uint32_t floatCount            = 0;
+            std::vector<uint32_t> *indices = nullptr;
+            GLTFTextureInfo *textureInfo   = nullptr;
+
+            uint32_t elementIndex = 0;
+        };
+
+        constexpr uint32_t GLB_MAGIC      = 0x46546C67U; // "glTF"
+        constexpr uint32_t GLB_VERSION    = 2U;
+        constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534AU; // "JSON"
+        constexpr uint32_t GLB_CHUNK_BIN  = 0x004E4942U; // "BIN"
+
+        uint32_t ReadUint32(const uint8_t *_data)
+        {
+            uint32_t value;
+            std::memcpy(&value, _data, sizeof(value));
+            return value;
+        }
+
+        uint32_t GetComponentCount(const std::string &_type)
+        {
+            if (_type == "SCALAR") {
+                return 1U;
+            }
+            if (_type == "VEC2") {
+                return 2U;
+            }
+            if (_type == "VEC3") {
+                return 3U;
+            }
+            if (_type == "VEC4" || _type == "MAT2") {
+                return 4U;
+            }
+            if (_type == "MAT3") {
+                return 9U;
+            }
+            return 16U;
+        }
+
+        // Every record being filled is the last one of its array, the parent
+        // frames only keep pointers inside the current record
+        class GLTFSaxHandler
+        {
+            public:
+            GLTFSaxHandler(GLTFDocument &_document) : m_document(_document)
+            {
+                m_stack.reserve(16);
+            }
+
+            bool null()
+            {
+                return true;
+            }
+
+            bool boolean(bool _value)
+            {
+                if (top().context == Context::Accessor && isKey("normalized")) {
+                    m_document.accessors.back().normalized = _value;
+                }
+
+                return true;
+            }
+
+            bool number_integer(json::number_integer_t _value)
+            {
+                return number(static_cast<double>(_value));
+            }
+
+            bool number_unsigned(json::number_unsigned_t _value)
+            {
+                return number(static_cast<double>(_value));
+            }
+
+            bool number_float(json::number_float_t _value, const json::string_t &)
+            {
+                return number(_value);
+            }
+
+            bool string(json::string_t &_value)
+            {
+                switch (top().context) {
+                case Context::Buffer:
+                    if (isKey("uri")) {
+                        m_document.buffers.back().uri = std::move(_value);
+                    }
+                    break;
+                case Context::Accessor:
+                    if (isKey("type")) {
+                        m_document.accessors.back().componentCount = GetComponentCount(_value);
+                    }
+                    break;
+                case Context::Image:
+                    if (isKey("uri")) {
+                        m_document.images.back().uri = std::move(_value);
+                    }
+                    else if (isKey("mimeType")) {
+                        m_document.images.back().mimeType = std::move(_value);
+                    }
+                    break;
+                case Context::Material:
+                    if (isKey("alphaMode")) {
+                        m_document.materials.back().alphaMode
+                            = _value == "MASK"    ? GLTFAlphaMode::Mask
+                              : _value == "BLEND" ? GLTFAlphaMode::Blend
+                                                  : GLTFAlphaMode::Opaque;
+                    }
+                    break;
+                case Context::AnimationTarget:
+                    if (isKey("path")) {
+                        GLTFAnimationChannel &channel = m_document.animations.back().channels.back();
+                        if (_value == "translation") {
+                            channel.path = GLTFAnimationPath::Translation;
+                        }
+                        else if (_value == "rotation") {
+                            channel.path = GLTFAnimationPath::Rotation;
+                        }
+                        else if (_value == "scale") {
+                            channel.path = GLTFAnimationPath::Scale;
+                        }
+                        else if (_value == "weights") {
+                            channel.path = GLTFAnimationPath::Weights;
+                        }
+                        else {
+                            m_unknownPath = true;
+                            channel.node  = GLTF_INVALID_INDEX;
+                        }
+                    }
+                    break;
+                case Context::AnimationSampler:
+                    if (isKey("interpolation")) {
+                        m_document.animations.back().samplers.back().interpolation
+                            = _value == "STEP"          ? GLTFInterpolation::Step
+                              : _value == "CUBICSPLINE" ? GLTFInterpolation::CubicSpline
+                                                        : GLTFInterpolation::Linear;
+                    }
+                    break;
+                default:
+                    break;
+                }
+
+                return true;
+            }
+
+            bool binary(json::binary_t &)
+            {
+                return true;
+            }
+
+            bool start_object(std::size_t)
+            {
+                if (m_stack.empty()) {
+                    m_stack.push_back({ Context::Root });
+                    return true;
+                }
+
+                Frame frame { Context::Skip };
+
+                switch (top().context) {
+                case Context::Buffers:
+                    m_document.buffers.emplace_back();
+                    frame.context = Context::Buffer;
+                    break;
+                case Context::BufferViews:
+                    m_document.bufferViews.emplace_back();
+                    frame.context = Context::BufferView;
+                    break;
+                case Context::Accessors:
+                    m_document.accessors.emplace_back();
+                    frame.context = Context::Accessor;
+                    break;
+                case Context::Samplers:
+                    m_document.samplers.emplace_back();
+                    frame.context = Context::Sampler;
+                    break;
+                case Context::Images:
+                    m_document.images.emplace_back();
+                    frame.context = Context::Image;
+                    break;
+                case Context::Textures:
+                    m_document.textures.emplace_back();
+                    frame.context = Context::Texture;
+                    break;
+                case Context::Texture:
+                    if (isKey("extensions")) {
+                        frame.context = Context::TextureExtensions;
+                    }
+                    break;
+                case Context::TextureExtensions:
+                    if (isKey("KHR_texture_basisu") || isKey("MSFT_texture_dds")) {
+                        frame.context = Context::CompressedTexture;
+                    }
+                    break;
+                case Context::Materials:
+                    m_document.materials.emplace_back();
+                    frame.context = Context::Material;
+                    break;
+                case Context::Material: {
+                    GLTFMaterial &material = m_document.materials.back();
+                    if (isKey("pbrMetallicRoughness")) {
+                        frame.context = Context::PBRMaterial;
+                    }
+                    else if (isKey("normalTexture")) {
+                        frame = textureInfoFrame(material.normalTexture);
+                    }
+                    else if (isKey("occlusionTexture")) {
+                        frame = textureInfoFrame(material.occlusionTexture);
+                    }
+                    else if (isKey("emissiveTexture")) {
+                        frame = textureInfoFrame(material.emissiveTexture);
+                    }
+                    break;
+                }
+                case Context::PBRMaterial: {
+                    GLTFMaterial &material = m_document.materials.back();
+                    if (isKey("baseColorTexture")) {
+                        frame = textureInfoFrame(material.baseColorTexture);
+                    }
+                    else if (isKey("metallicRoughnessTexture")) {
+                        frame = textureInfoFrame(material.metallicRoughnessTexture);
+                    }
+                    break;
+                }
+                case Context::Meshes:
+                    m_document.meshes.emplace_back();
+                    frame.context = Context::Mesh;
+                    break;
+                case Context::Primitives:
+                    m_document.meshes.back().primitives.emplace_back();
+                    frame.context = Context::Primitive;
+                    break;
+                case Context::Primitive:
+                    if (isKey("attributes")) {
+                        frame.context = Context::Attributes;
+                    }
+                    break;
+                case Context::Nodes:
+                    m_document.nodes.emplace_back();
+                    frame.context = Context::Node;
+                    break;
+                case Context::Skins:
+                    m_document.skins.emplace_back();
+                    frame.context = Context::Skin;
+                    break;
+                case Context::Scenes:
+                    m_document.scenes.emplace_back();
+                    frame.context = Context::Scene;
+                    break;
+                case Context::Animations:
+                    m_document.animations.emplace_back();
+                    frame.context = Context::Animation;
+                    break;
+                case Context::AnimationChannels:
+                    m_document.animations.back().channels.emplace_back();
+                    frame.context = Context::AnimationChannel;
+                    m_unknownPath = false;
+                    break;
+                case Context::AnimationChannel:
+                    if (isKey("target")) {
+                        frame.context = Context::AnimationTarget;
+                    }
+                    break;
+                case Context::AnimationSamplers:
+                    m_document.animations.back().samplers.emplace_back();
+                    frame.context = Context::AnimationSampler;
+                    break;
+                default:
+                    break;
+                }
+
+                m_stack.push_back(frame);
+
+                return true;
+            }
+
+            bool end_object()
+            {
+                m_stack.pop_back();
+
+                return true;
+            }
+
+            bool start_array(std::size_t)
+            {
+                Frame frame { Context::Skip };
+
+                switch (top().context) {
+                case Context::Root:
+                    frame.context = getRootArrayContext();
+                    break;
+                case Context::Material:
+                    if (isKey("emissiveFactor")) {
+                        frame = floatArrayFrame(m_document.materials.back().emissiveFactor, 3U);
+                    }
+                    break;
+                case Context::PBRMaterial:
+                    if (isKey("baseColorFactor")) {
+                        frame = floatArrayFrame(m_document.materials.back().baseColorFactor, 4U);
+                    }
+                    break;
+                case Context::Mesh:
+                    if (isKey("primitives")) {
+                        frame.context = Context::Primitives;
+                    }
+                    break;
+                case Context::Node: {
+                    GLTFNode &node = m_document.nodes.back();
+                    if (isKey("children")) {
+                        frame.context = Context::IndexArray;
+                        frame.indices = &node.children;
+                    }
+                    else if (isKey("matrix")) {
+                        node.hasMatrix = true;
+                        frame          = floatArrayFrame(node.matrix, 16U);
+                    }
+                    else if (isKey("translation")) {
+                        frame = floatArrayFrame(node.translation, 3U);
+                    }
+                    else if (isKey("rotation")) {
+                        frame = floatArrayFrame(node.rotation, 4U);
+                    }
+                    else if (isKey("scale")) {
+                        frame = floatArrayFrame(node.scale, 3U);
+                    }
+                    break;
+                }
+                case Context::Skin:
+                    if (isKey("joints")) {
+                        frame.context = Context::IndexArray;
+                        frame.indices = &m_document.skins.back().joints;
+                    }
+                    break;
+                case Context::Scene:
+                    if (isKey("nodes")) {
+                        frame.context = Context::IndexArray;
+                        frame.indices = &m_document.scenes.back().nodes;
+                    }
+                    break;
+                case Context::Animation:
+                    if (isKey("channels")) {
+                        frame.context = Context::AnimationChannels;
+                    }
+                    else if (isKey("samplers")) {
+                        frame.context = Context::AnimationSamplers;
+                    }
+                    break;
+                default:
+                    break;
+                }
+
+                m_stack.push_back(frame);
+
+                return true;
+            }
+
+            bool end_array()
+            {
+                m_stack.pop_back();
+
+                return true;
+            }
+
+            bool key(json::string_t &_key)
+            {
+                m_key.swap(_key);
+
+                return true;
+            }
+
+            bool parse_error(std::size_t _position, const std::string &, const json::exception &_exception)
+            {
+                std::cout << "glTF parse error at byte " << _position << " : "
+                          << _exception.what() << "\n";
+
+                return false;
+            }
+
+            private:
+            Frame &top()
+            {
+                return m_stack.back();
+            }
+
+            bool isKey(const char *_name) const
+            {
+                return std::strcmp(m_key.c_str(), _name) == 0;
+            }
+
+            // Integer properties must hold a non negative integral value
+            // their type can store, GLTF_INVALID_INDEX excluded, anything
+            // else fails the parse
+            template <typename T>
+            bool setInteger(T &_destination, double _value) const
+            {
+                // Doubles are only exact up to 2^53
+                double maximum = std::min(static_cast<double>(std::numeric_limits<T>::max()), 9007199254740992.0);
+
+                if (!(_value >= 0.0 && _value < maximum) || std::trunc(_value) != _value) {
+                    std::cout << "Invalid integer for " << m_key << " : " << _value << "\n";
+                    return false;
+                }
+
+                _destination = static_cast<T>(_value);
+                return true;
+            }
+
+            static Frame floatArrayFrame(float *_floats, uint32_t _count)
+            {
+                Frame frame { Context::FloatArray };
+                frame.floats     = _floats;
+                frame.floatCount = _count;
+
+                return frame;
+            }
+
+            static Frame textureInfoFrame(GLTFTextureInfo &_textureInfo)
+            {
+                Frame frame { Context::TextureInfo };
+                frame.textureInfo = &_textureInfo;
+
+                return frame;
+            }
+
+            Context getRootArrayContext() const
+            {
+                if (isKey("buffers")) {
+                    return Context::Buffers;
+                }
+                if (isKey("bufferViews")) {
+                    return Context::BufferViews;
+                }
+                if (isKey("accessors")) {
+                    return Context::Accessors;
+                }
+                if (isKey("samplers")) {
+                    return Context::Samplers;
+                }
+                if (isKey("images")) {
+                    return Context::Images;
+                }
+                if (isKey("textures")) {
+                    return Context::Textures;
+                }
+                if (isKey("materials")) {
+                    return Context::Materials;
+                }
+                if (isKey("meshes")) {
+                    return Context::Meshes;
+                }
+                if (isKey("nodes")) {
+                    return Context::Nodes;
+                }
+                if (isKey("skins")) {
+                    return Context::Skins;
+                }
+                if (isKey("scenes")) {
+                    return Context::Scenes;
+                }
+                if (isKey("animations")) {
+                    return Context::Animations;
+                }
+                return Context::Skip;
+            }
+
+            bool number(double _value)
+            {
+                auto value = static_cast<float>(_value);
+
+                Frame &frame = top();
+
+                switch (frame.context) {
+                case Context::Root:
+                    if (isKey("scene")) {
+                        return setInteger(m_document.scene, _value);
+                    }
+                    break;
+                case Context::Buffer:
+                    if (isKey("byteLength")) {
+                        return setInteger(m_document.buffers.back().byteLength, _value);
+                    }
+                    break;
+                case Context::BufferView: {
+                    GLTFBufferView &bufferView = m_document.bufferViews.back();
+                    if (isKey("buffer")) {
+                        return setInteger(bufferView.buffer, _value);
+                    }
+                    else if (isKey("byteOffset")) {
+                        return setInteger(bufferView.byteOffset, _value);
+                    }
+                    else if (isKey("byteLength")) {
+                        return setInteger(bufferView.byteLength, _value);
+                    }
+                    else if (isKey("byteStride")) {
+                        return setInteger(bufferView.byteStride, _value);
+                    }
+                    break;
+                }
+                case Context::Accessor: {
+                    GLTFAccessor &accessor = m_document.accessors.back();
+                    if (isKey("bufferView")) {
+                        return setInteger(accessor.bufferView, _value);
+                    }
+                    else if (isKey("byteOffset")) {
+                        return setInteger(accessor.byteOffset, _value);
+                    }
+                    else if (isKey("componentType")) {
+                        return setInteger(accessor.componentType, _value);
+                    }
+                    else if (isKey("count")) {
+                        return setInteger(accessor.count, _value);
+                    }
+                    break;
+                }
+                case Context::Sampler: {
+                    GLTFSampler &sampler = m_document.samplers.back();
+                    if (isKey("magFilter")) {
+                        return setInteger(sampler.magFilter, _value);
+                    }
+                    else if (isKey("minFilter")) {
+                        return setInteger(sampler.minFilter, _value);
+                    }
+                    else if (isKey("wrapS")) {
+                        return setInteger(sampler.wrapS, _value);
+                    }
+                    else if (isKey("wrapT")) {
+                        return setInteger(sampler.wrapT, _value);
+                    }
+                    break;
+                }
+                case Context::Image:
+                    if (isKey("bufferView")) {
+                        return setInteger(m_document.images.back().bufferView, _value);
+                    }
+                    break;
+                case Context::Texture:
+                    if (isKey("sampler")) {
+                        return setInteger(m_document.textures.back().sampler, _value);
+                    }
+                    else if (isKey("source")) {
+                        return setInteger(m_document.textures.back().source, _value);
+                    }
+                    break;
+                case Context::CompressedTexture:
+                    if (isKey("source")) {
+                        return setInteger(m_document.textures.back().compressedSource, _value);
+                    }
+                    break;
+                case Context::Material:
+                    if (isKey("alphaCutoff")) {
+                        m_document.materials.back().alphaCutoff = value;
+                    }
+                    break;
+                case Context::PBRMaterial: {
+                    GLTFMaterial &material = m_document.materials.back();
+                    if (isKey("metallicFactor")) {
+                        material.metallicFactor = value;
+                    }
+                    else if (isKey("roughnessFactor")) {
+                        material.roughnessFactor = value;
+                    }
+                    break;
+                }
+                case Context::TextureInfo:
+                    if (isKey("index")) {
+                        return setInteger(frame.textureInfo->index, _value);
+                    }
+                    else if (isKey("texCoord")) {
+                        return setInteger(frame.textureInfo->texCoord, _value);
+                    }
+                    else if (isKey("scale") || isKey("strength")) {
+                        frame.textureInfo->scale = value;
+                    }
+                    break;
+                case Context::Primitive: {
+                    GLTFPrimitive &primitive = m_document.meshes.back().primitives.back();
+                    if (isKey("indices")) {
+                        return setInteger(primitive.indices, _value);
+                    }
+                    else if (isKey("material")) {
+                        return setInteger(primitive.material, _value);
+                    }
+                    else if (isKey("mode")) {
+                        return setInteger(primitive.mode, _value);
+                    }
+                    break;
+                }
+                case Context::Attributes: {
+                    GLTFPrimitive &primitive = m_document.meshes.back().primitives.back();
+                    if (isKey("POSITION")) {
+                        return setInteger(primitive.position, _value);
+                    }
+                    else if (isKey("NORMAL")) {
+                        return setInteger(primitive.normal, _value);
+                    }
+                    else if (isKey("TANGENT")) {
+                        return setInteger(primitive.tangent, _value);
+                    }
+                    else if (isKey("TEXCOORD_0")) {
+                        return setInteger(primitive.texCoord0, _value);
+                    }
+                    else if (isKey("JOINTS_0")) {
+                        return setInteger(primitive.joints0, _value);
+                    }
+                    else if (isKey("WEIGHTS_0")) {
+                        return setInteger(primitive.weights0, _value);
+                    }
+                    break;
+                }
+                case Context::Node: {
+                    GLTFNode &node = m_document.nodes.back();
+                    if (isKey("mesh")) {
+                        return setInteger(node.mesh, _value);
+                    }
+                    else if (isKey("skin")) {
+                        return setInteger(node.skin, _value);
+                    }
+                    break;
+                }
+                case Context::Skin:
+                    if (isKey("inverseBindMatrices")) {
+                        return setInteger(m_document.skins.back().inverseBindMatrices, _value);
+                    }
+                    break;
+                case Context::AnimationChannel:
+                    if (isKey("sampler")) {
+                        return setInteger(m_document.animations.back().channels.back().sampler, _value);
+                    }
+                    break;
+                case Context::AnimationTarget:
+                    // The node may come after an unknown path
+                    if (isKey("node") && !m_unknownPath) {
+                        return setInteger(m_document.animations.back().channels.back().node, _value);
+                    }
+                    break;
+                case Context::AnimationSampler: {
+                    GLTFAnimationSampler &sampler = m_document.animations.back().samplers.back();
+                    if (isKey("input")) {
+                        return setInteger(sampler.input, _value);
+                    }
+                    else if (isKey("output")) {
+                        return setInteger(sampler.output, _value);
+                    }
+                    break;
+                }
+                case Context::FloatArray:
+                    if (frame.elementIndex < frame.floatCount) {
+                        frame.floats[frame.elementIndex] = value;
+                    }
+                    frame.elementIndex++;
+                    break;
+                case Context::IndexArray: {
+                    uint32_t index = 0U;
+                    if (!setInteger(index, _value)) {
+                        return false;
+                    }
+
+                    frame.indices->push_back(index);
+                    break;
+                }
+                default:
+                    break;
+                }
+
+                return true;
+            }
+
+            GLTFDocument &m_document;
+            std::vector<Frame> m_stack;
+            std::string m_key;
+
+            // Channels targeting an extension path are ignored
+            bool m_unknownPath = false;
+        };
+
+        // Resets the index when it is past the records it refers to, so the
+        // loaders only have to test GLTF_INVALID_INDEX
+        bool CheckReference(uint32_t &_index, size_t _count, const char *_kind)
+        {
+            if (_index == GLTF_INVALID_INDEX || _index < _count) {
+                return true;
+            }
+
+            std::cout << "Invalid " << _kind << " reference : " << _index << "\n";
+            _index = GLTF_INVALID_INDEX;
+
+            return false;
+        }
+
+        void CheckReferences(std::vector<uint32_t> &_indices, size_t _count, const char *_kind)
+        {
+            std::erase_if(_indices, [&](uint32_t _index) {
+                uint32_t index = _index;
+                CheckReference(index, _count, _kind);
+
+                return index == GLTF_INVALID_INDEX;
+            });
+        }
+
+        // Every cross reference of the document is checked once here rather
+        // than at each use. Textures without any usable image are dropped
+        // from the materials
+        void ValidateReferences(GLTFDocument &_document)
+        {
+            for (GLTFBufferView &bufferView : _document.bufferViews) {
+                CheckReference(bufferView.buffer, _document.buffers.size(), "buffer");
+            }
+
+            for (GLTFAccessor &accessor : _document.accessors) {
+                CheckReference(accessor.bufferView, _document.bufferViews.size(), "bufferView");
+            }
+
+            for (GLTFImage &image : _document.images) {
+                CheckReference(image.bufferView, _document.bufferViews.size(), "bufferView");
+            }
+
+            for (GLTFTexture &texture : _document.textures) {
+                CheckReference(texture.sampler, _document.samplers.size(), "sampler");
+                CheckReference(texture.source, _document.images.size(), "image");
+                CheckReference(texture.compressedSource, _document.images.size(), "image");
+            }
+
+            for (GLTFMaterial &material : _document.materials) {
+                for (GLTFTextureInfo *textureInfo :
+                     { &material.baseColorTexture, &material.metallicRoughnessTexture, &material.normalTexture,
+                       &material.occlusionTexture, &material.emissiveTexture }) {
+                    if (CheckReference(textureInfo->index, _document.textures.size(), "texture")
+                        && textureInfo->index != GLTF_INVALID_INDEX) {
+                        const GLTFTexture &texture = _document.textures[textureInfo->index];
+
+                        if (texture.source == GLTF_INVALID_INDEX && texture.compressedSource == GLTF_INVALID_INDEX) {
+                            std::cout << "Texture without image : " << textureInfo->index << "\n";
+                            textureInfo->index = GLTF_INVALID_INDEX;
+                        }
+                    }
+                }
+            }
+
+            size_t accessorCount = _document.accessors.size();
+            for (GLTFMesh &mesh : _document.meshes) {
+                for (GLTFPrimitive &primitive : mesh.primitives) {
+                    for (uint32_t *accessor : { &primitive.position, &primitive.normal, &primitive.tangent,
+                                                &primitive.texCoord0, &primitive.joints0, &primitive.weights0,
+                                                &primitive.indices }) {
+                        CheckReference(*accessor, accessorCount, "accessor");
+                    }
+
+                    CheckReference(primitive.material, _document.materials.size(), "material");
+                }
+            }
+
+            for (GLTFNode &node : _document.nodes) {
+                CheckReference(node.mesh, _document.meshes.size(), "mesh");
+                CheckReference(node.skin, _document.skins.size(), "skin");
+                CheckReferences(node.children, _document.nodes.size(), "node");
+            }
+
+            // Joints keep their position, JOINTS_0 indexes them
+            for (GLTFSkin &skin : _document.skins) {
+                CheckReference(skin.inverseBindMatrices, accessorCount, "accessor");
+
+                for (uint32_t &joint : skin.joints) {
+                    CheckReference(joint, _document.nodes.size(), "node");
+                }
+            }
+
+            for (GLTFScene &scene : _document.scenes) {
+                CheckReferences(scene.nodes, _document.nodes.size(), "node");
+            }
+
+            for (GLTFAnimation &animation : _document.animations) {
+                for (GLTFAnimationChannel &channel : animation.channels) {
+                    CheckReference(channel.sampler, animation.samplers.size(), "animation sampler");
+                    CheckReference(channel.node, _document.nodes.size(), "node");
+                }
+
+                for (GLTFAnimationSampler &sampler : animation.samplers) {
+                    CheckReference(sampler.input, accessorCount, "accessor");
+                    CheckReference(sampler.output, accessorCount, "accessor");
+                }
+            }
+        }
+    } // namespace
+
+    bool ParseGLBContainer(const uint8_t *_data, size_t _size, GLBChunks &_chunks)
+    {
+        constexpr size_t HEADER_SIZE       = 12U;
+        constexpr size_t CHUNK_HEADER_SIZE = 8U;
+
+        if (_size < HEADER_SIZE || ReadUint32(_data) != GLB_MAGIC
+            || ReadUint32(_data + 4) != GLB_VERSION) {
+            return false;
+        }
+
+        // The declared length may be shorter than the file, never longer
+        size_t length = ReadUint32(_data + 8);
+        if (length > _size) {
+            return false;
+        }
+
+        size_t offset = HEADER_SIZE;
+        while (offset + CHUNK_HEADER_SIZE <= length) {
+            size_t chunkLength = ReadUint32(_data + offset);
+            uint32_t chunkType = ReadUint32(_data + offset + 4);
+            offset += CHUNK_HEADER_SIZE;
+
+            if (chunkLength > length - offset) {
+                return false;
+            }
+
+            if (chunkType == GLB_CHUNK_JSON && !_chunks.json) {
+                _chunks.json     = _data + offset;
+                _chunks.jsonSize = chunkLength;
+            }
+            else if (chunkType == GLB_CHUNK_BIN && !_chunks.bin) {
+                _chunks.bin     = _data + offset;
+                _chunks.binSize = chunkLength;
+            }
+
+            // Chunks are 4 bytes aligned
+            offset += (chunkLength + 3U) & ~size_t { 3U };
+        }
+
+        return _chunks.json != nullptr;
+    }
+
+    bool ParseGLTFDocument(const uint8_t *_json, size_t _size, GLTFDocument &_document)
+    {
+        GLTFSaxHandler handler { _document };
+
+        if (!json::sax_parse(_json, _json + _size, &handler)) {
+            return false;
+        }
+
+        ValidateReferences(_document);
+
+        return true;
+    }
+} // namespace DadEngine
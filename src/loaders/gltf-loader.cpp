@@ -1,247 +1,742 @@
 #include "gltf-loader.hpp"
 
 #include <cstdint>
+#include <cstring>
 
-#include <fstream>
-#include <ios>
+#include <algorithm>
+#include <chrono>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
-#include <nlohmann/json.hpp>
-
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
-#include "helpers/file.hpp"
+#include "accessor-view.hpp"
+#include "animation/animation.hpp"
+#include "animation/skinning.hpp"
+#include "gltf-asset.hpp"
+#include "helpers/async-io.hpp"
+#include "helpers/derived-data-cache.hpp"
+#include "helpers/hash.hpp"
+#include "helpers/load-profiler.hpp"
+#include "helpers/thread-pool.hpp"
 #include "model/model.hpp"
+#include "model/texture-streamer.hpp"
+#include "scene/scene-graph.hpp"
+#include "texture-compressor.hpp"
+#include "texture-container.hpp"
+#include "matrix/matrix3x4.hpp"
+#include "quaternion/quaternion.hpp"
 #include "vector/vector3.hpp"
 
-using json = nlohmann::json;
-
 namespace DadEngine
 {
-    struct PrimitiveAttribute
+    // Either the mip chain built from the stb_image pixels or block
+    // compressed levels. Those point inside the encoded bytes of a KTX2 or
+    // DDS image, or in the blocks the loader compressed
+    struct DecodedImage
     {
-        uint8_t *data;
-        size_t count;
+        int32_t width  = 0;
+        int32_t height = 0;
+        bool hasAlpha  = false;
+
+        MipChain mips;
+        CompressedImage compressed;
+
+        // Blocks of the compressed levels, after a header of width, height
+        // and level count so they go to the derived data cache as they are
+        ByteBuffer compressedPixels;
     };
 
-    inline PrimitiveAttribute
-    GetPrimitiveAttribute(std::vector<std::vector<uint8_t>> &_buffers, json _gltf, uint32_t _attributeAccesorIndex)
-    {
-        json accessor            = _gltf["accessors"][_attributeAccesorIndex];
-        uint32_t bufferViewIndex = accessor["bufferView"];
-        json bufferView          = _gltf["bufferViews"][bufferViewIndex];
-        uint32_t bufferIndex     = bufferView["buffer"];
-        size_t bufferOffset      = bufferView["byteOffset"];
+    // Bump whenever the mip chain built from an image changes
+    constexpr uint64_t DECODED_IMAGE_VERSION = 2U;
 
-        return PrimitiveAttribute { &_buffers[bufferIndex][bufferOffset], accessor["count"] };
-    }
+    constexpr size_t DECODED_IMAGE_HEADER_SIZE = 3U * sizeof(int32_t);
 
-    inline Texture
-    GetTexture(std::filesystem::path _rootPath, const json &_materialTexture, json _gltf)
-    {
-        uint32_t textureIndex = _materialTexture["index"];
-        auto texture          = _gltf["textures"][textureIndex];
-        uint32_t samplerIndex = texture["sampler"];
-        auto gltfSampler      = _gltf["samplers"][samplerIndex];
-        uint32_t imageIndex   = texture["source"];
-
-        // Todo support bufferView images
-        std::string imageFilename = _gltf["images"][imageIndex]["uri"];
-        auto imagePath            = _rootPath.append(imageFilename);
-        auto imageExtension       = imagePath.extension();
-        bool hasAlpha             = imageExtension.string() == ".png";
-
-#if defined(OPENGL)
-        Sampler sampler { gltfSampler["magFilter"], gltfSampler["minFilter"],
-                          gltfSampler["wrapS"], gltfSampler["wrapT"] };
-#elif defined(VULKAN)
-        Sampler sampler;
-#endif
-
-        int32_t width;
-        int32_t height;
-        int32_t channels;
-        uint8_t *imageData
-            = stbi_load(imagePath.string().c_str(), &width, &height, &channels, 0);
-
-        if (!imageData) {
-            std::cout << "Failed to load image : " << imagePath.string() << "\n";
-        }
-
-        return { imageData, width, height, channels, sampler, hasAlpha };
-    }
+    // Bump whenever the texture compressor output changes
+    constexpr uint64_t COMPRESSED_IMAGE_VERSION = 2U;
+
+    constexpr size_t COMPRESSED_IMAGE_HEADER_SIZE = 3U * sizeof(int32_t);
 
-    std::vector<DadEngine::Mesh> LoadGLTF(std::filesystem::path &_path)
+    // Encoded bytes of the glTF images. External files are all requested
+    // up front and read in the background while the geometry loads, data
+    // URIs are decoded the first time they are requested
+    class ImageSources
     {
-        json gltf;
+        public:
+        ImageSources(const GLTFAsset &_asset, const TextureCompressionSettings &_compression)
+            : m_asset(_asset), m_compression(_compression)
+        {
+            size_t imageCount = _asset.GetDocument().images.size();
+
+            std::vector<std::filesystem::path> filePaths;
+            m_fileIndices.resize(imageCount, GLTF_INVALID_INDEX);
+            m_embeddedImages.resize(imageCount);
+
+            for (uint32_t i = 0; i < imageCount; i++) {
+                if (_asset.IsExternalImage(i)) {
+                    m_fileIndices[i] = static_cast<uint32_t>(filePaths.size());
+                    filePaths.push_back(_asset.GetImagePath(i));
+                }
+            }
+
+            m_fileReads = AsyncIO::Get().Read(filePaths);
+            m_files.resize(m_fileReads.size());
+            m_encodedImages.resize(imageCount);
+            m_fetched = std::make_unique<std::once_flag[]>(imageCount);
+            m_decodes.resize(imageCount);
+        }
 
-        std::fstream(_path.string()) >> gltf;
+        // Queues the decode of the texture image on the thread pool, once per
+        // image. The task waits for the file read itself so the caller never
+        // blocks. Reads were queued first, so with the pool fallback of
+        // AsyncIO the decodes can not starve them. A compressed image that
+        // can not be used falls back to the regular source
+        void Decode(const GLTFTexture &_texture)
+        {
+            uint32_t imageIndex = GetTextureImage(_texture);
+            if (m_decodes[imageIndex].valid()) {
+                return;
+            }
 
-        // Store buffers content
-        std::vector<std::vector<uint8_t>> buffers;
-        for (const auto &buffer : gltf["buffers"]) {
-            auto filename = buffer["uri"].get<std::string>();
-            auto pathCopy = _path;
-            auto filepath = pathCopy.replace_filename(filename);
+            m_decodes[imageIndex] = ThreadPool::Get().Submit([this, imageIndex, &_texture]() {
+                DecodedImage image;
 
-            auto rawBuffer = ReadFile(filepath);
+                if (!decode(imageIndex, image) && _texture.source != imageIndex
+                    && _texture.source != GLTF_INVALID_INDEX) {
+                    decode(_texture.source, image);
+                }
 
-            buffers.push_back(rawBuffer);
+                return image;
+            });
         }
 
-        // Loop through meshes
-        std::vector<DadEngine::Mesh> meshes;
-        for (const auto &gltfMesh : gltf["meshes"]) {
-            DadEngine::Mesh mesh;
+        bool IsDecoded(uint32_t _imageIndex) const
+        {
+            return m_decodes[_imageIndex].wait_for(std::chrono::seconds(0))
+                   == std::future_status::ready;
+        }
 
-            for (const auto &primitive : gltfMesh["primitives"]) {
-                uint32_t indicesAccessorIndex = primitive["indices"];
-                auto indicesAccessor = gltf["accessors"][indicesAccessorIndex];
-                size_t indicesCount  = indicesAccessor["count"];
-                uint32_t bufferViewIndex = indicesAccessor["bufferView"];
-                auto indicesBufferView   = gltf["bufferViews"][bufferViewIndex];
-                uint32_t indexBufferIndex  = indicesBufferView["buffer"];
-                uint32_t indexBufferOffset = indicesBufferView["byteOffset"];
-                uint8_t *rawIndices = &buffers[indexBufferIndex][indexBufferOffset];
-
-                std::vector<uint32_t> indicesBuffer(indicesCount);
-                if (indicesAccessor["componentType"] == 5123) { // 2 byte indices
-                    const uint16_t *indices = reinterpret_cast<uint16_t *>(rawIndices);
-
-                    for (size_t k = 0; k < indicesCount; k++) {
-                        indicesBuffer[k] = static_cast<uint32_t>(indices[k]);
-                    }
-                }
-                else {
-                    const uint32_t *indices = reinterpret_cast<uint32_t *>(rawIndices);
-                    indicesBuffer.assign(indices, indices + indicesCount * sizeof(uint32_t));
+        // Blocks until the image is decoded, Decode must have been called
+        DecodedImage GetDecodedImage(uint32_t _imageIndex)
+        {
+            return m_decodes[_imageIndex].get();
+        }
+
+        // Waits for the file read the first time an image is requested, safe
+        // to call from several threads
+        std::span<const uint8_t> GetEncodedImage(uint32_t _imageIndex)
+        {
+            std::call_once(m_fetched[_imageIndex], [this, _imageIndex]() {
+                m_encodedImages[_imageIndex] = fetch(_imageIndex);
+            });
+
+            return m_encodedImages[_imageIndex];
+        }
+
+        private:
+        // Buffer views and data URIs are resolved by the asset
+        std::span<const uint8_t> fetch(uint32_t _imageIndex)
+        {
+            uint32_t fileIndex = m_fileIndices[_imageIndex];
+            if (fileIndex == GLTF_INVALID_INDEX) {
+                return m_asset.ReadImage(_imageIndex, m_embeddedImages[_imageIndex]);
+            }
+
+            m_files[fileIndex] = m_fileReads[fileIndex].get();
+
+            // Drop the terminator ReadFile conventions add
+            const ByteBuffer &file = m_files[fileIndex];
+            return { file.data(), file.empty() ? 0 : file.size() - 1 };
+        }
+
+        // KTX2 and DDS images are used as they are, the others go through
+        // stb_image then the mip generator, and the texture compressor when
+        // it is enabled. The mip chain and the compressed levels are both
+        // kept in the derived data cache
+        bool decode(uint32_t _imageIndex, DecodedImage &_image)
+        {
+            // Stopped before the compression, profiled on its own
+            std::optional<ScopedLoadTimer> decodeTimer(std::in_place, LoadStage::ImageDecode);
+
+            std::span<const uint8_t> encodedImage = GetEncodedImage(_imageIndex);
+            if (encodedImage.empty()) {
+                return false;
+            }
+
+            if (IsTextureContainer(encodedImage)) {
+                if (!ParseTextureContainer(encodedImage, _image.compressed)) {
+                    _image.compressed = {};
+                    return false;
                 }
 
+                _image.width    = _image.compressed.levels[0].width;
+                _image.height   = _image.compressed.levels[0].height;
+                _image.hasAlpha = _image.compressed.hasAlpha;
+                return true;
+            }
 
-                const auto attributes = primitive["attributes"];
-                std::vector<DadEngine::Vertex> vertexBuffer;
+            _image.hasAlpha = m_asset.HasAlpha(_imageIndex);
 
-                if (attributes.count("POSITION")) {
-                    auto positionAttribute
-                        = GetPrimitiveAttribute(buffers, gltf, attributes["POSITION"]);
-                    const DadEngine::Vector3 *positionsArray
-                        = reinterpret_cast<DadEngine::Vector3 *>(
-                            positionAttribute.data);
+            const MipSettings &mipSettings = m_asset.GetMipSettings(_imageIndex);
+            DerivedDataCache &cache        = DerivedDataCache::Get();
+            uint64_t encodedHash           = cache.IsEnabled() ? HashXXH3(encodedImage) : 0U;
+            uint64_t mipKey                = 0;
+            uint64_t compressedKey         = 0;
 
-                    for (size_t i = 0; i < positionAttribute.count; i++) {
-                        DadEngine::Vertex vertex;
+            uint64_t cutoffBits = 0;
+            std::memcpy(&cutoffBits, &mipSettings.alphaCutoff, sizeof(mipSettings.alphaCutoff));
 
-                        vertex.position = positionsArray[i];
+            TextureFormat format = ChooseCompressedFormat(mipSettings.usage, _image.hasAlpha, m_compression);
 
-                        vertexBuffer.push_back(vertex);
-                    }
+            // A cached compressed image skips the decode altogether
+            if (m_compression.enabled && cache.IsEnabled()) {
+                uint64_t quality = format == TextureFormat::BC7 ? m_compression.bc7Quality : 0U;
+                compressedKey    = CombineHashes({ encodedHash, COMPRESSED_IMAGE_VERSION,
+                                                   static_cast<uint64_t>(mipSettings.usage), cutoffBits,
+                                                   static_cast<uint64_t>(format), quality });
+
+                if (readCompressedImage(cache.Load(compressedKey), format, _image)) {
+                    return true;
                 }
+            }
 
-                if (attributes.count("NORMAL")) {
-                    auto normalAttribute
-                        = GetPrimitiveAttribute(buffers, gltf, attributes["NORMAL"]);
-                    const DadEngine::Vector3 *normalsArray
-                        = reinterpret_cast<DadEngine::Vector3 *>(normalAttribute.data);
+            bool isCached = false;
 
-                    for (size_t i = 0; i < normalAttribute.count; i++) {
-                        vertexBuffer[i].normal = normalsArray[i];
-                    }
+            if (cache.IsEnabled()) {
+                mipKey   = CombineHashes({ encodedHash, DECODED_IMAGE_VERSION,
+                                           static_cast<uint64_t>(mipSettings.usage), cutoffBits });
+                isCached = readCachedMips(cache.Load(mipKey), _image);
+            }
+
+            if (!isCached) {
+                int32_t channels = 0;
+                uint8_t *pixels  = stbi_load_from_memory(encodedImage.data(),
+                                                         static_cast<int>(encodedImage.size()),
+                                                         &_image.width, &_image.height, &channels, 0);
+                if (!pixels) {
+                    return false;
                 }
 
-                if (attributes.count("TANGENT")) {
-                    auto tangentAttribute
-                        = GetPrimitiveAttribute(buffers, gltf, attributes["TANGENT"]);
-                    const DadEngine::Vector4 *tangentArray
-                        = reinterpret_cast<DadEngine::Vector4 *>(
-                            tangentAttribute.data);
+                _image.mips = GenerateMips(pixels, _image.width, _image.height, channels,
+                                           _image.hasAlpha, mipSettings);
+                stbi_image_free(pixels);
 
-                    for (size_t i = 0; i < tangentAttribute.count; i++) {
-                        vertexBuffer[i].tangent = tangentArray[i];
-                    }
+                if (cache.IsEnabled()) {
+                    int32_t header[3] = { _image.width, _image.height, _image.mips.channels };
+
+                    std::vector<uint8_t> entry(DECODED_IMAGE_HEADER_SIZE + _image.mips.pixels.size());
+                    std::memcpy(entry.data(), header, DECODED_IMAGE_HEADER_SIZE);
+                    std::memcpy(entry.data() + DECODED_IMAGE_HEADER_SIZE, _image.mips.pixels.data(),
+                                _image.mips.pixels.size());
+
+                    cache.Store(mipKey, entry);
                 }
+            }
 
-                if (attributes.count("TEXCOORD_0")) {
-                    auto texCoord0Attribute
-                        = GetPrimitiveAttribute(buffers, gltf, attributes["TEXCOORD_0"]);
-                    const Vector2 *texCoord0Array
-                        = reinterpret_cast<Vector2 *>(texCoord0Attribute.data);
+            if (m_compression.enabled) {
+                decodeTimer.reset();
+                compress(format, _image);
 
-                    for (size_t i = 0; i < texCoord0Attribute.count; i++) {
-                        vertexBuffer[i].uv0 = texCoord0Array[i];
-                    }
+                if (cache.IsEnabled()) {
+                    cache.Store(compressedKey, _image.compressedPixels);
                 }
+            }
 
-                VertexBuffer vb(std::move(vertexBuffer));
-                IndexBuffer ib(std::move(indicesBuffer));
+            return true;
+        }
 
-                uint32_t materialIndex = primitive["material"];
-                json gltfMaterial      = gltf["materials"][materialIndex];
-                json gltfPBRMaterial   = gltfMaterial["pbrMetallicRoughness"];
-                PBRMaterial material;
+        // Replaces the mip chain by its compressed levels
+        void compress(TextureFormat _format, DecodedImage &_image)
+        {
+            ScopedLoadTimer timer(LoadStage::TextureCompression);
+
+            std::vector<uint8_t> blocks;
+            std::vector<TextureLevel> levels = CompressLevels(_image.mips.levels, _image.mips.channels,
+                                                              _format, m_compression.bc7Quality, blocks);
+
+            int32_t header[3] = { _image.width, _image.height, static_cast<int32_t>(levels.size()) };
+
+            _image.compressedPixels.resize(COMPRESSED_IMAGE_HEADER_SIZE + blocks.size());
+            std::memcpy(_image.compressedPixels.data(), header, COMPRESSED_IMAGE_HEADER_SIZE);
+            std::memcpy(_image.compressedPixels.data() + COMPRESSED_IMAGE_HEADER_SIZE, blocks.data(),
+                        blocks.size());
+
+            _image.mips = {};
+            layoutCompressedLevels(_format, _image);
+        }
+
+        // Points the compressed levels inside the blocks, false when the
+        // header does not match their size
+        static bool layoutCompressedLevels(TextureFormat _format, DecodedImage &_image)
+        {
+            int32_t header[3];
+            if (_image.compressedPixels.size() < COMPRESSED_IMAGE_HEADER_SIZE) {
+                return false;
+            }
+
+            std::memcpy(header, _image.compressedPixels.data(), COMPRESSED_IMAGE_HEADER_SIZE);
+            if (header[0] <= 0 || header[1] <= 0 || header[2] <= 0
+                || static_cast<uint32_t>(header[2]) > GetMipLevelCount(header[0], header[1])) {
+                return false;
+            }
+
+            _image.width      = header[0];
+            _image.height     = header[1];
+            _image.compressed = { _format, _image.hasAlpha, {} };
+
+            size_t offset = COMPRESSED_IMAGE_HEADER_SIZE;
+            for (int32_t level = 0; level < header[2]; level++) {
+                int32_t width  = std::max(_image.width >> level, 1);
+                int32_t height = std::max(_image.height >> level, 1);
+                size_t size    = GetTextureLevelSize(_format, width, height);
+
+                _image.compressed.levels.push_back({ _image.compressedPixels.data() + offset, size, width, height });
+                offset += size;
+            }
+
+            return offset == _image.compressedPixels.size();
+        }
+
+        static bool readCompressedImage(ByteBuffer &&_entry, TextureFormat _format,
+                                        DecodedImage &_image)
+        {
+            _image.compressedPixels = std::move(_entry);
+
+            if (!layoutCompressedLevels(_format, _image)) {
+                _image.compressedPixels.clear();
+                _image.compressed = {};
+                return false;
+            }
+
+            return true;
+        }
+
+        static bool readCachedMips(ByteBuffer &&_entry, DecodedImage &_image)
+        {
+            int32_t header[3];
+            if (_entry.size() < DECODED_IMAGE_HEADER_SIZE) {
+                return false;
+            }
+
+            std::memcpy(header, _entry.data(), DECODED_IMAGE_HEADER_SIZE);
+
+            if (header[0] <= 0 || header[1] <= 0 || (header[2] != 3 && header[2] != 4)
+                || _entry.size() != DECODED_IMAGE_HEADER_SIZE + GetMipChainSize(header[0], header[1], header[2])) {
+                return false;
+            }
+
+            _image.width  = header[0];
+            _image.height = header[1];
+
+            _entry.erase(_entry.begin(), _entry.begin() + DECODED_IMAGE_HEADER_SIZE);
+            _image.mips.pixels = std::move(_entry);
+            LayoutMipChain(_image.mips, _image.width, _image.height, header[2]);
+
+            return true;
+        }
+
+        const GLTFAsset &m_asset;
+        TextureCompressionSettings m_compression;
+
+        std::vector<uint32_t> m_fileIndices;
+        std::vector<std::future<ByteBuffer>> m_fileReads;
+        std::vector<ByteBuffer> m_files;
+        std::vector<ByteBuffer> m_embeddedImages;
+        std::vector<std::span<const uint8_t>> m_encodedImages;
+        std::unique_ptr<std::once_flag[]> m_fetched;
+        std::vector<std::future<DecodedImage>> m_decodes;
+    };
+
+    // Texture slot of a loaded primitive waiting for its image
+    struct PendingTexture
+    {
+        size_t mesh;
+        size_t primitive;
+        std::shared_ptr<Texture> PBRMaterial::*slot;
+        uint32_t texture;
+    };
+
+    // Uploads from the thread that owns the rendering context. The decoded
+    // image is shared with the texture streamer, which keeps it while it
+    // streams the levels
+    inline std::shared_ptr<Texture> CreateTexture(const GLTFTexture &_texture,
+                                                  const GLTFAsset &_asset,
+                                                  const std::shared_ptr<const DecodedImage> &_image)
+    {
+        Sampler sampler           = _asset.GetSampler(_texture);
+        TextureStreamer &streamer = TextureStreamer::Get();
+
+        // Prebuilt or compressed mips, the ones of KTX2 and DDS images point
+        // in the encoded file and are copied by the streamer
+        if (!_image->compressed.levels.empty()) {
+            std::shared_ptr<const void> owner;
+            if (!_image->compressedPixels.empty()) {
+                owner = _image;
+            }
+
+            return streamer.CreateTexture(_image->compressed.format, _image->compressed.levels, sampler,
+                                          _image->hasAlpha, std::move(owner));
+        }
+
+        if (_image->mips.levels.empty()) {
+            std::cout << "Failed to load image : "
+                      << _asset.GetImageName(GetTextureImage(_texture)) << "\n";
+
+            return std::make_shared<Texture>(nullptr, 0, 0, 3, sampler, false);
+        }
+
+        TextureFormat format = _image->mips.channels == 4 ? TextureFormat::RGBA8 : TextureFormat::RGB8;
 
-                if (gltfPBRMaterial.count("baseColorFactor")) {
-                    auto baseColorFactor
-                        = gltfPBRMaterial["baseColorFactor"].get<std::vector<float>>();
-                    material.baseColorFactor = *reinterpret_cast<DadEngine::Vector4 *>(
-                        baseColorFactor.data());
+        return streamer.CreateTexture(format, _image->mips.levels, sampler, _image->hasAlpha, _image);
+    }
+
+    std::vector<uint32_t> BuildSceneGraph(const GLTFDocument &_document, SceneGraph &_graph)
+    {
+        std::vector<uint32_t> graphNodes(_document.nodes.size(), INVALID_NODE);
+        std::vector<uint32_t> roots;
+
+        if (_document.scene < _document.scenes.size()) {
+            roots = _document.scenes[_document.scene].nodes;
+        }
+        else {
+            std::vector<bool> isChild(_document.nodes.size(), false);
+            for (const GLTFNode &node : _document.nodes) {
+                for (uint32_t child : node.children) {
+                    if (child < isChild.size()) {
+                        isChild[child] = true;
+                    }
                 }
+            }
 
-                if (gltfPBRMaterial.count("baseColorTexture")) {
-                    material.baseColorTexture
-                        = GetTexture(_path.parent_path(),
-                                     gltfPBRMaterial["baseColorTexture"], gltf);
+            for (uint32_t node = 0; node < _document.nodes.size(); node++) {
+                if (!isChild[node]) {
+                    roots.push_back(node);
                 }
+            }
+        }
+
+        // Children are pushed in reverse so they keep their order, a node
+        // is always added right after its parent subtree so far
+        std::vector<std::pair<uint32_t, uint32_t>> stack; // glTF node, graph parent
+        for (auto root = roots.rbegin(); root != roots.rend(); root++) {
+            stack.emplace_back(*root, INVALID_NODE);
+        }
+
+        while (!stack.empty()) {
+            auto [nodeIndex, parent] = stack.back();
+            stack.pop_back();
 
-                if (gltfPBRMaterial.count("metallicFactor")) {
-                    auto metallicFactor     = gltfPBRMaterial["metallicFactor"];
-                    material.metallicFactor = metallicFactor;
+            // Also breaks the cycles of malformed assets
+            if (nodeIndex >= _document.nodes.size() || graphNodes[nodeIndex] != INVALID_NODE) {
+                std::cout << "Invalid or shared node " << nodeIndex << " in the scene\n";
+                continue;
+            }
+
+            const GLTFNode &node = _document.nodes[nodeIndex];
+            Vector3 translation(node.translation[0], node.translation[1], node.translation[2]);
+            Quaternion rotation(node.rotation[3], node.rotation[0], node.rotation[1], node.rotation[2]);
+            Vector3 scale(node.scale[0], node.scale[1], node.scale[2]);
+
+            // Column major
+            if (node.hasMatrix) {
+                const float *m = node.matrix;
+                Matrix3x4(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14])
+                    .Decompose(translation, rotation, scale);
+            }
+
+            uint32_t graphNode    = _graph.AddNode(parent, translation, rotation, scale, node.mesh, node.skin);
+            graphNodes[nodeIndex] = graphNode;
+
+            for (auto child = node.children.rbegin(); child != node.children.rend(); child++) {
+                stack.emplace_back(*child, graphNode);
+            }
+        }
+
+        return graphNodes;
+    }
+
+    std::vector<AnimationClip> LoadGLTFAnimations(const GLTFAsset &_asset, const std::vector<uint32_t> &_graphNodes)
+    {
+        const GLTFDocument &document = _asset.GetDocument();
+
+        std::vector<AnimationClip> clips;
+        std::vector<float> timesStorage;
+        std::vector<float> valuesStorage;
+
+        for (const GLTFAnimation &animation : document.animations) {
+            AnimationClip clip;
+
+            // Samplers are read once whatever the number of channels using them
+            std::vector<uint32_t> clipSamplers(animation.samplers.size(), GLTF_INVALID_INDEX);
+            std::vector<bool> readSamplers(animation.samplers.size(), false);
+
+            for (const GLTFAnimationChannel &channel : animation.channels) {
+                if (channel.node >= _graphNodes.size() || _graphNodes[channel.node] == INVALID_NODE
+                    || channel.sampler >= animation.samplers.size()) {
+                    continue;
                 }
 
-                if (gltfPBRMaterial.count("roughnessFactor")) {
-                    auto roughnessFactor = gltfPBRMaterial["roughnessFactor"];
-                    material.roughnessFactor = roughnessFactor;
+                if (!readSamplers[channel.sampler]) {
+                    readSamplers[channel.sampler] = true;
+
+                    const GLTFAnimationSampler &sampler = animation.samplers[channel.sampler];
+                    if (sampler.input >= document.accessors.size() || sampler.output >= document.accessors.size()) {
+                        std::cout << "Invalid animation sampler accessors\n";
+                        continue;
+                    }
+
+                    const GLTFAccessor &input  = document.accessors[sampler.input];
+                    const GLTFAccessor &output = document.accessors[sampler.output];
+
+                    // Weights outputs are scalars, as many per key as the
+                    // morph targets
+                    size_t valuesPerKey = sampler.interpolation == GLTFInterpolation::CubicSpline ? 3U : 1U;
+                    size_t valueCount   = output.count * output.componentCount;
+                    if (input.count == 0U || valueCount % (input.count * valuesPerKey) != 0U) {
+                        std::cout << "Animation sampler output does not match its keys\n";
+                        continue;
+                    }
+
+                    // Float keys are usually read in place from the buffer
+                    std::span<const float> times;
+                    std::span<const float> values;
+                    if (input.componentCount != 1U
+                        || !ReadFloatAccessor(document, _asset.GetBuffers(), input, timesStorage, times)
+                        || !ReadFloatAccessor(document, _asset.GetBuffers(), output, valuesStorage, values)) {
+                        std::cout << "Cannot read an animation sampler\n";
+                        continue;
+                    }
+
+                    // The glTF and engine enums share their order
+                    auto componentCount = static_cast<uint32_t>(valueCount / (input.count * valuesPerKey));
+                    clipSamplers[channel.sampler]
+                        = clip.AddSampler(times, values, componentCount,
+                                          static_cast<AnimationInterpolation>(sampler.interpolation));
                 }
 
-                if (gltfPBRMaterial.count("metallicRoughnessTexture")) {
-                    material.metallicRoughnessTexture
-                        = GetTexture(_path.parent_path(), gltfPBRMaterial["metallicRoughnessTexture"],
-                                     gltf);
+                if (clipSamplers[channel.sampler] != GLTF_INVALID_INDEX
+                    && !clip.AddChannel(clipSamplers[channel.sampler], _graphNodes[channel.node],
+                                        static_cast<AnimationPath>(channel.path))) {
+                    std::cout << "Animation channel does not match its sampler\n";
                 }
+            }
+
+            clips.push_back(std::move(clip));
+        }
+
+        return clips;
+    }
+
+    std::vector<Skin> LoadGLTFSkins(const GLTFAsset &_asset, const std::vector<uint32_t> &_graphNodes)
+    {
+        const GLTFDocument &document = _asset.GetDocument();
+
+        std::vector<Skin> skins;
+        std::vector<float> matricesStorage;
+
+        for (const GLTFSkin &gltfSkin : document.skins) {
+            Skin skin;
+
+            for (uint32_t joint : gltfSkin.joints) {
+                skin.joints.push_back(joint < _graphNodes.size() ? _graphNodes[joint] : INVALID_NODE);
+            }
 
-                if (gltfMaterial.count("normalTexture")) {
-                    material.normalTexture
-                        = GetTexture(_path.parent_path(),
-                                     gltfMaterial["normalTexture"], gltf);
+            skin.inverseBindMatrices.resize(skin.joints.size());
+
+            if (gltfSkin.inverseBindMatrices != GLTF_INVALID_INDEX) {
+                const GLTFAccessor *accessor = gltfSkin.inverseBindMatrices < document.accessors.size()
+                                                   ? &document.accessors[gltfSkin.inverseBindMatrices]
+                                                   : nullptr;
+
+                // The glTF spec only allows float matrices
+                std::span<const float> matrices;
+                if (!accessor || accessor->componentType != GLTF_FLOAT || accessor->componentCount != 16U
+                    || accessor->count < skin.joints.size()
+                    || !ReadFloatAccessor(document, _asset.GetBuffers(), *accessor, matricesStorage, matrices)) {
+                    std::cout << "Invalid inverse bind matrices\n";
+                }
+                else {
+                    // Column major
+                    for (size_t joint = 0; joint < skin.joints.size(); joint++) {
+                        const float *m = matrices.data() + joint * 16U;
+                        skin.inverseBindMatrices[joint]
+                            = Matrix3x4(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14]);
+                    }
                 }
+            }
+
+            skins.push_back(std::move(skin));
+        }
+
+        return skins;
+    }
+
+    std::vector<DadEngine::Mesh> LoadGLTF(std::filesystem::path &_path, GeometryPool *_pool,
+                                          const TextureCompressionSettings &_compression,
+                                          SceneGraph *_sceneGraph,
+                                          std::vector<AnimationClip> *_animations,
+                                          std::vector<Skin> *_skins)
+    {
+        GLTFAsset asset;
+        if (!asset.Load(_path)) {
+            return {};
+        }
+
+        const GLTFDocument &document = asset.GetDocument();
+
+        if (_sceneGraph) {
+            std::vector<uint32_t> graphNodes = BuildSceneGraph(document, *_sceneGraph);
+
+            if (_animations) {
+                *_animations = LoadGLTFAnimations(asset, graphNodes);
+            }
+
+            if (_skins) {
+                *_skins = LoadGLTFSkins(asset, graphNodes);
+            }
+        }
+        ImageSources images(asset, _compression);
+        const GLTFMaterial defaultMaterial;
+
+        auto getMaterial = [&](uint32_t _materialIndex) -> const GLTFMaterial & {
+            return _materialIndex != GLTF_INVALID_INDEX ? document.materials[_materialIndex]
+                                                        : defaultMaterial;
+        };
+
+        // Texture slots of PBRMaterial filled from the glTF material
+        auto forEachTexture = [](const GLTFMaterial &_material, auto &&_function) {
+            _function(_material.baseColorTexture, &PBRMaterial::baseColorTexture);
+            _function(_material.metallicRoughnessTexture, &PBRMaterial::metallicRoughnessTexture);
+            _function(_material.normalTexture, &PBRMaterial::normalTexture);
+            _function(_material.occlusionTexture, &PBRMaterial::occlusionTexture);
+            _function(_material.emissiveTexture, &PBRMaterial::emissiveTexture);
+        };
+
+        // Start decoding every used image so it overlaps the geometry
+        for (const auto &gltfMesh : document.meshes) {
+            for (const auto &primitive : gltfMesh.primitives) {
+                forEachTexture(getMaterial(primitive.material),
+                               [&](const GLTFTextureInfo &_textureInfo, std::shared_ptr<Texture> PBRMaterial::*) {
+                                   if (_textureInfo.index != GLTF_INVALID_INDEX) {
+                                       images.Decode(document.textures[_textureInfo.index]);
+                                   }
+                               });
+            }
+        }
+
+        std::vector<PendingTexture> pendingTextures;
 
-                if (gltfMaterial.count("occlusionTexture")) {
-                    material.occlusionTexture
-                        = GetTexture(_path.parent_path(),
-                                     gltfMaterial["occlusionTexture"], gltf);
+        // Loop through meshes
+        std::vector<DadEngine::Mesh> meshes;
+        for (uint32_t meshIndex = 0; meshIndex < document.meshes.size(); meshIndex++) {
+            const GLTFMesh &gltfMesh = document.meshes[meshIndex];
+            DadEngine::Mesh mesh;
+
+            for (uint32_t primitiveIndex = 0; primitiveIndex < gltfMesh.primitives.size(); primitiveIndex++) {
+                const GLTFPrimitive &primitive = gltfMesh.primitives[primitiveIndex];
+
+                std::vector<uint32_t> indicesBuffer;
+                std::vector<DadEngine::Vertex> vertexBuffer;
+                std::vector<SkinVertex> skinBuffer;
+                asset.ReadProcessedPrimitive(meshIndex, primitiveIndex, vertexBuffer, indicesBuffer, &skinBuffer);
+
+                // The skin stream needs a vertex array of its own, skinned
+                // primitives stay out of the pool
+                bool pooled     = _pool && skinBuffer.empty();
+                VertexBuffer vb = pooled ? VertexBuffer(std::move(vertexBuffer), *_pool)
+                                         : VertexBuffer(std::move(vertexBuffer));
+                IndexBuffer ib  = pooled ? IndexBuffer(std::move(indicesBuffer), *_pool)
+                                         : IndexBuffer(std::move(indicesBuffer));
+
+                if (!skinBuffer.empty()) {
+                    vb.SetSkin(std::move(skinBuffer));
                 }
 
-                if (gltfMaterial.count("emissiveFactor")) {
-                    auto emissiveFactor
-                        = gltfMaterial["emissiveFactor"].get<std::vector<float>>();
-                    material.emissiveFactor
-                        = *reinterpret_cast<DadEngine::Vector3 *>(emissiveFactor.data());
+                ScopedLoadTimer materialTimer(LoadStage::MaterialBuild);
+
+                const GLTFMaterial &gltfMaterial = getMaterial(primitive.material);
+                PBRMaterial material;
+                material.id = primitive.material;
+
+                material.baseColorFactor
+                    = *reinterpret_cast<const DadEngine::Vector4 *>(gltfMaterial.baseColorFactor);
+                material.metallicFactor  = gltfMaterial.metallicFactor;
+                material.roughnessFactor = gltfMaterial.roughnessFactor;
+                material.emissiveFactor
+                    = *reinterpret_cast<const DadEngine::Vector3 *>(gltfMaterial.emissiveFactor);
+                material.hasTransparency = false;
+
+                // Textures are attached once their image is decoded
+                forEachTexture(gltfMaterial, [&](const GLTFTextureInfo &_textureInfo,
+                                                 std::shared_ptr<Texture> PBRMaterial::*_slot) {
+                    if (_textureInfo.index != GLTF_INVALID_INDEX) {
+                        pendingTextures.push_back({ meshes.size(), mesh.m_primitives.size(),
+                                                    _slot, _textureInfo.index });
+                    }
+                });
+
+                mesh.m_primitives.emplace_back(
+                    Primitive(std::move(vb), std::move(ib), primitive.mode, material));
+            }
+
+            meshes.push_back(std::move(mesh));
+        }
+
+        // Upload the textures in the order their decodes complete, only
+        // block on a decode when none of the remaining ones is ready. Each
+        // image is decoded once whatever the number of slots using it
+        while (!pendingTextures.empty()) {
+            auto ready = std::find_if(pendingTextures.begin(), pendingTextures.end(),
+                                      [&](const PendingTexture &_pending) {
+                                          return images.IsDecoded(GetTextureImage(
+                                              document.textures[_pending.texture]));
+                                      });
+
+            if (ready == pendingTextures.end()) {
+                ready = pendingTextures.begin();
+            }
+
+            uint32_t imageIndex = GetTextureImage(document.textures[ready->texture]);
+            auto image          = std::make_shared<const DecodedImage>(images.GetDecodedImage(imageIndex));
+
+            ScopedLoadTimer materialTimer(LoadStage::MaterialBuild);
+
+            // One texture per image and sampler pair, shared by every slot
+            // using it. glTF textures differing only by name end up the same
+            std::unordered_map<uint32_t, std::shared_ptr<Texture>> samplerTextures;
+
+            auto sameImage = [&](const PendingTexture &_pending) {
+                return GetTextureImage(document.textures[_pending.texture]) == imageIndex;
+            };
+
+            for (const auto &pending : pendingTextures) {
+                if (!sameImage(pending)) {
+                    continue;
                 }
 
-                if (gltfMaterial.count("emissiveTexture")) {
-                    material.emissiveTexture
-                        = GetTexture(_path.parent_path(),
-                                     gltfMaterial["emissiveTexture"], gltf);
+                const GLTFTexture &texture       = document.textures[pending.texture];
+                std::shared_ptr<Texture> &shared = samplerTextures[texture.sampler];
+                if (!shared) {
+                    shared = CreateTexture(texture, asset, image);
                 }
 
-                material.hasTransparency = material.baseColorTexture.hasAlpha;
+                PBRMaterial &material = meshes[pending.mesh].m_primitives[pending.primitive].material;
+                material.*pending.slot = shared;
 
-                mesh.m_primitives.emplace_back(
-                    Primitive(std::move(vb), std::move(ib), primitive["mode"], material));
+                if (pending.slot == &PBRMaterial::baseColorTexture) {
+                    material.hasTransparency = shared->hasAlpha;
+                }
             }
 
-            meshes.push_back(mesh);
+            std::erase_if(pendingTextures, sameImage);
         }
 
         return meshes;
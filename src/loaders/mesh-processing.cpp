@@ -0,0 +1,263 @@
+#include "mesh-processing.hpp"
+
+#include <cmath>
+
+namespace DadEngine
+{
+    void OptimizeVertexCache(std::vector<uint32_t> &_indices, uint32_t _vertexCount, uint32_t _cacheSize)
+    {
+        size_t triangleCount = _indices.size() / 3U;
+        if (triangleCount == 0 || _vertexCount == 0) {
+            return;
+        }
+
+        // Triangles around each vertex, packed one vertex after the other
+        std::vector<uint32_t> adjacencyOffsets(_vertexCount + 1U, 0U);
+        std::vector<uint32_t> liveTriangles(_vertexCount, 0U);
+
+        // The order is left as it is rather than writing out of the arrays
+        for (size_t i = 0; i < triangleCount * 3U; i++) {
+            if (_indices[i] >= _vertexCount) {
+                return;
+            }
+        }
+
+        for (size_t i = 0; i < triangleCount * 3U; i++) {
+            liveTriangles[_indices[i]]++;
+        }
+
+        for (uint32_t v = 0; v < _vertexCount; v++) {
+            adjacencyOffsets[v + 1U] = adjacencyOffsets[v] + liveTriangles[v];
+        }
+
+        std::vector<uint32_t> adjacency(adjacencyOffsets[_vertexCount]);
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+        for (size_t t = 0; t < triangleCount; t++) {
+            for (size_t corner = 0; corner < 3U; corner++) {
+                adjacency[fill[_indices[t * 3U + corner]]++] = static_cast<uint32_t>(t);
+            }
+        }
+
+        std::vector<uint32_t> cacheTimes(_vertexCount, 0U);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> output;
+        output.reserve(triangleCount * 3U);
+
+        uint32_t time   = _cacheSize + 1U;
+        uint32_t cursor = 0;
+        int64_t fanning = 0;
+
+        while (fanning >= 0) {
+            uint32_t vertex = static_cast<uint32_t>(fanning);
+            candidates.clear();
+
+            // Emit every remaining triangle of the fanning vertex
+            for (uint32_t a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1U]; a++) {
+                uint32_t t = adjacency[a];
+                if (emitted[t]) {
+                    continue;
+                }
+
+                for (size_t corner = 0; corner < 3U; corner++) {
+                    uint32_t v = _indices[t * 3U + corner];
+
+                    output.push_back(v);
+                    deadEnds.push_back(v);
+                    candidates.push_back(v);
+                    liveTriangles[v]--;
+
+                    if (time - cacheTimes[v] > _cacheSize) {
+                        cacheTimes[v] = time++;
+                    }
+                }
+
+                emitted[t] = true;
+            }
+
+            // Next fanning vertex, the candidate staying the longest in the
+            // cache once its remaining triangles are emitted
+            fanning       = -1;
+            uint32_t best = 0;
+            for (uint32_t v : candidates) {
+                if (liveTriangles[v] == 0) {
+                    continue;
+                }
+
+                uint32_t priority = 0;
+                if (time - cacheTimes[v] + 2U * liveTriangles[v] <= _cacheSize) {
+                    priority = time - cacheTimes[v];
+                }
+
+                if (fanning < 0 || priority > best) {
+                    best    = priority;
+                    fanning = v;
+                }
+            }
+
+            // Dead end, restart from a recently used vertex or the first one
+            // with triangles left
+            while (fanning < 0 && !deadEnds.empty()) {
+                uint32_t v = deadEnds.back();
+                deadEnds.pop_back();
+
+                if (liveTriangles[v] > 0) {
+                    fanning = v;
+                }
+            }
+
+            while (fanning < 0 && cursor < _vertexCount) {
+                if (liveTriangles[cursor] > 0) {
+                    fanning = cursor;
+                }
+
+                cursor++;
+            }
+        }
+
+        // Keeps a trailing incomplete triangle, if any, at the end
+        output.insert(output.end(), _indices.begin() + static_cast<ptrdiff_t>(triangleCount * 3U),
+                      _indices.end());
+        _indices = std::move(output);
+    }
+
+    void OptimizeVertexFetch(std::vector<Vertex> &_vertices,
+                             std::vector<uint32_t> &_indices,
+                             std::vector<SkinVertex> *_skinVertices)
+    {
+        constexpr uint32_t UNUSED = ~0U;
+
+        bool hasSkin = _skinVertices && _skinVertices->size() == _vertices.size();
+
+        std::vector<uint32_t> remap(_vertices.size(), UNUSED);
+        std::vector<Vertex> vertices;
+        std::vector<SkinVertex> skinVertices;
+        vertices.reserve(_vertices.size());
+        skinVertices.reserve(hasSkin ? _vertices.size() : 0U);
+
+        for (uint32_t &index : _indices) {
+            if (index >= _vertices.size()) {
+                continue;
+            }
+
+            if (remap[index] == UNUSED) {
+                remap[index] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(_vertices[index]);
+
+                if (hasSkin) {
+                    skinVertices.push_back((*_skinVertices)[index]);
+                }
+            }
+
+            index = remap[index];
+        }
+
+        _vertices = std::move(vertices);
+
+        if (hasSkin) {
+            *_skinVertices = std::move(skinVertices);
+        }
+    }
+
+    void GenerateTangents(std::vector<Vertex> &_vertices, const std::vector<uint32_t> &_indices)
+    {
+        // U and V directions accumulated over the triangles of each vertex
+        std::vector<Vector3> uDirections(_vertices.size(), Vector3 { 0.f, 0.f, 0.f });
+        std::vector<Vector3> vDirections(_vertices.size(), Vector3 { 0.f, 0.f, 0.f });
+
+        for (size_t i = 0; i + 2U < _indices.size(); i += 3U) {
+            uint32_t i0 = _indices[i];
+            uint32_t i1 = _indices[i + 1U];
+            uint32_t i2 = _indices[i + 2U];
+
+            if (i0 >= _vertices.size() || i1 >= _vertices.size() || i2 >= _vertices.size()) {
+                continue;
+            }
+
+            const Vertex &v0 = _vertices[i0];
+            const Vertex &v1 = _vertices[i1];
+            const Vertex &v2 = _vertices[i2];
+
+            float x1 = v1.position.x - v0.position.x;
+            float y1 = v1.position.y - v0.position.y;
+            float z1 = v1.position.z - v0.position.z;
+            float x2 = v2.position.x - v0.position.x;
+            float y2 = v2.position.y - v0.position.y;
+            float z2 = v2.position.z - v0.position.z;
+
+            float s1 = v1.uv0.x - v0.uv0.x;
+            float t1 = v1.uv0.y - v0.uv0.y;
+            float s2 = v2.uv0.x - v0.uv0.x;
+            float t2 = v2.uv0.y - v0.uv0.y;
+
+            float determinant = s1 * t2 - s2 * t1;
+            if (std::fabs(determinant) < 1e-12f) {
+                continue;
+            }
+
+            float r = 1.f / determinant;
+            Vector3 uDirection { (t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r,
+                                 (t2 * z1 - t1 * z2) * r };
+            Vector3 vDirection { (s1 * x2 - s2 * x1) * r, (s1 * y2 - s2 * y1) * r,
+                                 (s1 * z2 - s2 * z1) * r };
+
+            for (uint32_t index : { i0, i1, i2 }) {
+                uDirections[index] += uDirection;
+                vDirections[index] += vDirection;
+            }
+        }
+
+        for (size_t i = 0; i < _vertices.size(); i++) {
+            Vertex &vertex   = _vertices[i];
+            const Vector3 &n = vertex.normal;
+            const Vector3 &u = uDirections[i];
+            const Vector3 &v = vDirections[i];
+
+            // Gram-Schmidt against the normal
+            float nDotU = n.x * u.x + n.y * u.y + n.z * u.z;
+            Vector3 t { u.x - n.x * nDotU, u.y - n.y * nDotU, u.z - n.z * nDotU };
+            float length = std::sqrt(t.x * t.x + t.y * t.y + t.z * t.z);
+
+            // No usable UV gradient, any direction orthogonal to the normal
+            if (length < 1e-6f) {
+                t      = std::fabs(n.x) < 0.9f ? Vector3 { 0.f, -n.z, n.y } : Vector3 { n.z, 0.f, -n.x };
+                length = std::sqrt(t.x * t.x + t.y * t.y + t.z * t.z);
+            }
+
+            if (length < 1e-6f) {
+                vertex.tangent = { 1.f, 0.f, 0.f, 1.f };
+                continue;
+            }
+
+            t /= length;
+
+            // (n x t) . v gives the handedness
+            float handedness = (n.y * t.z - n.z * t.y) * v.x + (n.z * t.x - n.x * t.z) * v.y
+                               + (n.x * t.y - n.y * t.x) * v.z;
+
+            vertex.tangent = { t.x, t.y, t.z, handedness < 0.f ? -1.f : 1.f };
+        }
+    }
+
+    void ProcessPrimitive(const GLTFPrimitive &_primitive,
+                          std::vector<Vertex> &_vertices,
+                          std::vector<uint32_t> &_indices,
+                          std::vector<SkinVertex> *_skinVertices)
+    {
+        constexpr uint32_t TRIANGLES = 4U;
+
+        if (_primitive.mode != TRIANGLES || _indices.empty()) {
+            return;
+        }
+
+        if (_primitive.tangent == GLTF_INVALID_INDEX && _primitive.normal != GLTF_INVALID_INDEX
+            && _primitive.texCoord0 != GLTF_INVALID_INDEX) {
+            GenerateTangents(_vertices, _indices);
+        }
+
+        OptimizeVertexCache(_indices, static_cast<uint32_t>(_vertices.size()));
+        OptimizeVertexFetch(_vertices, _indices, _skinVertices);
+    }
+} // namespace DadEngine
@@ -0,0 +1,355 @@
+#include "mip-generator.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+
+#include "helpers/simd.hpp"
+#include "helpers/thread-pool.hpp"
+
+namespace DadEngine
+{
+    namespace
+    {
+        constexpr uint32_t ROW_GRAIN = 16U;
+
+        // Linear values go back to sRGB through a 12 bits table, finer than
+        // the 8 bits steps near black
+        constexpr uint32_t LINEAR_STEPS = 4096U;
+
+        // Source texels of a destination texel along one axis
+        struct FilterTaps
+        {
+            int32_t first;
+            int32_t count;
+            float weights[3];
+        };
+
+        struct ColorTables
+        {
+            std::array<float, 256> toLinear;
+            std::array<uint8_t, LINEAR_STEPS> toSRGB;
+        };
+
+        const ColorTables &GetColorTables()
+        {
+            static const ColorTables tables = []() {
+                ColorTables result;
+
+                for (uint32_t value = 0; value < 256U; value++) {
+                    float color = static_cast<float>(value) / 255.f;
+                    result.toLinear[value]
+                        = color <= 0.04045f ? color / 12.92f : std::pow((color + 0.055f) / 1.055f, 2.4f);
+                }
+
+                for (uint32_t step = 0; step < LINEAR_STEPS; step++) {
+                    float linear = static_cast<float>(step) / static_cast<float>(LINEAR_STEPS - 1U);
+                    float color  = linear <= 0.0031308f ? linear * 12.92f
+                                                        : 1.055f * std::pow(linear, 1.f / 2.4f) - 0.055f;
+                    result.toSRGB[step] = static_cast<uint8_t>(std::lround(color * 255.f));
+                }
+
+                return result;
+            }();
+
+            return tables;
+        }
+
+        // Two equal taps for an even size, three for an odd one weighted by
+        // the share of each source texel the destination texel covers
+        std::vector<FilterTaps> ComputeTaps(int32_t _sourceSize, int32_t _destinationSize)
+        {
+            std::vector<FilterTaps> taps(static_cast<size_t>(_destinationSize));
+            float inverseSize = 1.f / static_cast<float>(_sourceSize);
+
+            for (int32_t i = 0; i < _destinationSize; i++) {
+                if (_sourceSize == 1) {
+                    taps[i] = { 0, 1, { 1.f, 0.f, 0.f } };
+                }
+                else if (_sourceSize % 2 == 0) {
+                    taps[i] = { 2 * i, 2, { 0.5f, 0.5f, 0.f } };
+                }
+                else {
+                    taps[i] = { 2 * i,
+                                3,
+                                { static_cast<float>(_destinationSize - i) * inverseSize,
+                                  static_cast<float>(_destinationSize) * inverseSize,
+                                  static_cast<float>(i + 1) * inverseSize } };
+                }
+            }
+
+            return taps;
+        }
+
+        // Grey images are spread over RGB, a missing alpha is opaque
+        void ReadTexel(const uint8_t *_pixel, int32_t _channels, uint8_t _values[4])
+        {
+            _values[0] = _pixel[0];
+            _values[1] = _channels >= 3 ? _pixel[1] : _pixel[0];
+            _values[2] = _channels >= 3 ? _pixel[2] : _pixel[0];
+            _values[3] = _channels == 2 || _channels == 4 ? _pixel[_channels - 1] : 255U;
+        }
+
+        // The source level keeps its exact texels, only its channels change
+        void CopyTexels(const uint8_t *_pixels, size_t _first, size_t _count, int32_t _channels,
+                        int32_t _outputChannels, uint8_t *_output)
+        {
+            for (size_t texel = _first; texel < _first + _count; texel++) {
+                uint8_t values[4];
+                ReadTexel(_pixels + texel * static_cast<size_t>(_channels), _channels, values);
+
+                std::memcpy(_output + texel * static_cast<size_t>(_outputChannels), values,
+                            static_cast<size_t>(_outputChannels));
+            }
+        }
+
+        // RGBA floats, linear for color images and in [-1, 1] for normals
+        void LoadTexels(const uint8_t *_pixels, size_t _first, size_t _count, int32_t _channels,
+                        TextureUsage _usage, float *_texels)
+        {
+            const ColorTables &tables = GetColorTables();
+
+            for (size_t texel = _first; texel < _first + _count; texel++) {
+                float *output = _texels + texel * 4U;
+
+                uint8_t values[4];
+                ReadTexel(_pixels + texel * static_cast<size_t>(_channels), _channels, values);
+
+                for (uint32_t channel = 0; channel < 3U; channel++) {
+                    float value = static_cast<float>(values[channel]) / 255.f;
+
+                    output[channel] = _usage == TextureUsage::Color    ? tables.toLinear[values[channel]]
+                                      : _usage == TextureUsage::Normal ? value * 2.f - 1.f
+                                                                       : value;
+                }
+
+                output[3] = static_cast<float>(values[3]) / 255.f;
+            }
+        }
+
+        void StoreTexels(const float *_texels, size_t _first, size_t _count, int32_t _channels,
+                         TextureUsage _usage, float _alphaScale, uint8_t *_pixels)
+        {
+            const ColorTables &tables = GetColorTables();
+
+            auto toByte = [](float _value) {
+                return static_cast<uint8_t>(std::lround(std::clamp(_value, 0.f, 1.f) * 255.f));
+            };
+
+            for (size_t texel = _first; texel < _first + _count; texel++) {
+                const float *input = _texels + texel * 4U;
+                uint8_t *pixel     = _pixels + texel * static_cast<size_t>(_channels);
+
+                if (_usage == TextureUsage::Color) {
+                    for (uint32_t channel = 0; channel < 3U; channel++) {
+                        float linear   = std::clamp(input[channel], 0.f, 1.f);
+                        pixel[channel] = tables.toSRGB[static_cast<size_t>(
+                            linear * static_cast<float>(LINEAR_STEPS - 1U) + 0.5f)];
+                    }
+                }
+                else if (_usage == TextureUsage::Normal) {
+                    float length = std::sqrt(input[0] * input[0] + input[1] * input[1] + input[2] * input[2]);
+                    float scale  = length > 0.f ? 0.5f / length : 0.f;
+
+                    for (uint32_t channel = 0; channel < 3U; channel++) {
+                        pixel[channel] = toByte(input[channel] * scale + 0.5f);
+                    }
+                }
+                else {
+                    for (uint32_t channel = 0; channel < 3U; channel++) {
+                        pixel[channel] = toByte(input[channel]);
+                    }
+                }
+
+                if (_channels == 4) {
+                    pixel[3] = toByte(input[3] * _alphaScale);
+                }
+            }
+        }
+
+        // Rows [_begin, _end) of the destination level
+        void FilterRows(const float *_source, int32_t _sourceWidth, float *_destination,
+                        int32_t _destinationWidth, const std::vector<FilterTaps> &_rowTaps,
+                        const std::vector<FilterTaps> &_columnTaps, uint32_t _begin, uint32_t _end)
+        {
+            for (uint32_t y = _begin; y < _end; y++) {
+                const FilterTaps &rowTaps = _rowTaps[y];
+                float *output = _destination + static_cast<size_t>(y) * static_cast<size_t>(_destinationWidth) * 4U;
+
+                for (int32_t x = 0; x < _destinationWidth; x++) {
+                    const FilterTaps &columnTaps = _columnTaps[static_cast<size_t>(x)];
+
+#if defined(DADENGINE_SSE2)
+                    __m128 sum = _mm_setzero_ps();
+#else
+                    float sum[4] = {};
+#endif
+
+                    for (int32_t row = 0; row < rowTaps.count; row++) {
+                        const float *sourceRow
+                            = _source
+                              + static_cast<size_t>(rowTaps.first + row) * static_cast<size_t>(_sourceWidth) * 4U;
+
+                        for (int32_t column = 0; column < columnTaps.count; column++) {
+                            float weight       = rowTaps.weights[row] * columnTaps.weights[column];
+                            const float *texel = sourceRow + static_cast<size_t>(columnTaps.first + column) * 4U;
+
+#if defined(DADENGINE_SSE2)
+                            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(texel), _mm_set1_ps(weight)));
+#else
+                            for (uint32_t channel = 0; channel < 4U; channel++) {
+                                sum[channel] += texel[channel] * weight;
+                            }
+#endif
+                        }
+                    }
+
+#if defined(DADENGINE_SSE2)
+                    _mm_storeu_ps(output + static_cast<size_t>(x) * 4U, sum);
+#else
+                    std::memcpy(output + static_cast<size_t>(x) * 4U, sum, sizeof(sum));
+#endif
+                }
+            }
+        }
+
+        // Share of the texels whose scaled alpha passes the test
+        float ComputeCoverage(const float *_texels, size_t _count, float _cutoff, float _scale)
+        {
+            size_t covered = 0;
+            for (size_t texel = 0; texel < _count; texel++) {
+                covered += _texels[texel * 4U + 3U] * _scale > _cutoff ? 1U : 0U;
+            }
+
+            return static_cast<float>(covered) / static_cast<float>(_count);
+        }
+
+        // Alpha scale giving a level the coverage closest to the source one,
+        // found by bisection as the coverage only grows with the scale
+        float FindAlphaScale(const float *_texels, size_t _count, float _cutoff, float _coverage)
+        {
+            float low  = 0.f;
+            float high = 1.f;
+
+            while (high < 256.f && ComputeCoverage(_texels, _count, _cutoff, high) < _coverage) {
+                low = high;
+                high *= 2.f;
+            }
+
+            for (uint32_t iteration = 0; iteration < 12U; iteration++) {
+                float middle = (low + high) * 0.5f;
+
+                if (ComputeCoverage(_texels, _count, _cutoff, middle) < _coverage) {
+                    low = middle;
+                }
+                else {
+                    high = middle;
+                }
+            }
+
+            float lowError  = _coverage - ComputeCoverage(_texels, _count, _cutoff, low);
+            float highError = ComputeCoverage(_texels, _count, _cutoff, high) - _coverage;
+
+            return lowError < highError ? low : high;
+        }
+    } // namespace
+
+    uint32_t GetMipLevelCount(int32_t _width, int32_t _height)
+    {
+        uint32_t levelCount = 1U;
+        for (int32_t size = std::max(_width, _height); size > 1; size /= 2) {
+            levelCount++;
+        }
+
+        return levelCount;
+    }
+
+    size_t GetMipChainSize(int32_t _width, int32_t _height, int32_t _channels)
+    {
+        size_t size = 0;
+        for (uint32_t level = 0; level < GetMipLevelCount(_width, _height); level++) {
+            size += static_cast<size_t>(std::max(_width >> level, 1))
+                    * static_cast<size_t>(std::max(_height >> level, 1)) * static_cast<size_t>(_channels);
+        }
+
+        return size;
+    }
+
+    void LayoutMipChain(MipChain &_chain, int32_t _width, int32_t _height, int32_t _channels)
+    {
+        _chain.channels = _channels;
+        _chain.pixels.resize(GetMipChainSize(_width, _height, _channels));
+        _chain.levels.clear();
+
+        size_t offset = 0;
+        for (uint32_t level = 0; level < GetMipLevelCount(_width, _height); level++) {
+            int32_t width  = std::max(_width >> level, 1);
+            int32_t height = std::max(_height >> level, 1);
+            size_t size    = static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(_channels);
+
+            _chain.levels.push_back({ _chain.pixels.data() + offset, size, width, height });
+            offset += size;
+        }
+    }
+
+    MipChain GenerateMips(const uint8_t *_pixels, int32_t _width, int32_t _height, int32_t _channels,
+                          bool _hasAlpha, const MipSettings &_settings)
+    {
+        MipChain chain;
+        LayoutMipChain(chain, _width, _height, _hasAlpha ? 4 : 3);
+
+        ThreadPool &pool  = ThreadPool::Get();
+        size_t texelCount = static_cast<size_t>(_width) * static_cast<size_t>(_height);
+        std::vector<float> source(texelCount * 4U);
+        std::vector<float> destination;
+
+        pool.ParallelFor(static_cast<uint32_t>(_height), ROW_GRAIN, [&](uint32_t _begin, uint32_t _end) {
+            size_t width = static_cast<size_t>(_width);
+            LoadTexels(_pixels, _begin * width, (_end - _begin) * width, _channels, _settings.usage,
+                       source.data());
+            CopyTexels(_pixels, _begin * width, (_end - _begin) * width, _channels, chain.channels,
+                       chain.pixels.data());
+        });
+
+        size_t levelOffset = chain.levels[0].size;
+
+        bool preserveCoverage = _hasAlpha && _settings.alphaCutoff > 0.f;
+        float coverage        = preserveCoverage
+                                    ? ComputeCoverage(source.data(), texelCount, _settings.alphaCutoff, 1.f)
+                                    : 0.f;
+
+        for (size_t level = 1; level < chain.levels.size(); level++) {
+            const TextureLevel &previous = chain.levels[level - 1U];
+            const TextureLevel &current  = chain.levels[level];
+
+            std::vector<FilterTaps> rowTaps    = ComputeTaps(previous.height, current.height);
+            std::vector<FilterTaps> columnTaps = ComputeTaps(previous.width, current.width);
+            size_t levelTexels = static_cast<size_t>(current.width) * static_cast<size_t>(current.height);
+
+            destination.resize(levelTexels * 4U);
+
+            pool.ParallelFor(static_cast<uint32_t>(current.height), ROW_GRAIN, [&](uint32_t _begin, uint32_t _end) {
+                FilterRows(source.data(), previous.width, destination.data(), current.width, rowTaps,
+                           columnTaps, _begin, _end);
+            });
+
+            // The next level filters the unscaled alpha
+            float alphaScale = preserveCoverage
+                                   ? FindAlphaScale(destination.data(), levelTexels, _settings.alphaCutoff, coverage)
+                                   : 1.f;
+
+            pool.ParallelFor(static_cast<uint32_t>(current.height), ROW_GRAIN, [&](uint32_t _begin, uint32_t _end) {
+                size_t width = static_cast<size_t>(current.width);
+                StoreTexels(destination.data(), _begin * width, (_end - _begin) * width, chain.channels,
+                            _settings.usage, alphaScale, chain.pixels.data() + levelOffset);
+            });
+
+            levelOffset += current.size;
+            source.swap(destination);
+        }
+
+        return chain;
+    }
+} // namespace DadEngine
@@ -0,0 +1,245 @@
+#include "scene-pack.hpp"
+
+#include <cstring>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+
+#include "helpers/file.hpp"
+#include "helpers/load-profiler.hpp"
+#include "model/model.hpp"
+#include "model/texture-streamer.hpp"
+#include "scene/scene-graph.hpp"
+
+namespace DadEngine
+{
+    std::vector<Mesh> LoadCookedScene(const std::filesystem::path &_path, GeometryPool *_pool,
+                                      SceneGraph *_sceneGraph)
+    {
+        // Shared with the texture streamer, which reads the levels it
+        // streams from the mapping
+        auto file = std::make_shared<MappedFile>(_path);
+        if (!file->IsValid()) {
+            return {};
+        }
+
+        std::span<const uint8_t> data = file->GetData();
+        ScenePackHeader header;
+
+        if (data.size() < sizeof(header)) {
+            std::cout << "Invalid scene pack : " << _path.string() << "\n";
+            return {};
+        }
+
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        if (header.magic != SCENE_PACK_MAGIC) {
+            std::cout << "Invalid scene pack : " << _path.string() << "\n";
+            return {};
+        }
+
+        if (header.version != SCENE_PACK_VERSION || header.vertexSize != sizeof(Vertex)) {
+            std::cout << "Scene pack " << _path.string()
+                      << " was cooked by another engine version, cook it again\n";
+            return {};
+        }
+
+        auto isInFile = [&](uint64_t _offset, uint64_t _size) {
+            return _offset <= data.size() && _size <= data.size() - _offset;
+        };
+
+        // The cooker aligns every table and blob, they are read in place
+        auto getTable = [&]<typename T>(uint64_t _offset, uint32_t _count) -> const T * {
+            if (!isInFile(_offset, uint64_t { _count } * sizeof(T)) || _offset % alignof(T) != 0) {
+                return nullptr;
+            }
+
+            return reinterpret_cast<const T *>(data.data() + _offset);
+        };
+
+        const auto *packedMeshes = getTable.operator()<PackedMesh>(header.meshesOffset, header.meshCount);
+        const auto *packedPrimitives
+            = getTable.operator()<PackedPrimitive>(header.primitivesOffset, header.primitiveCount);
+        const auto *packedMaterials
+            = getTable.operator()<PackedMaterial>(header.materialsOffset, header.materialCount);
+        const auto *packedTextures
+            = getTable.operator()<PackedTexture>(header.texturesOffset, header.textureCount);
+        const auto *packedLevels
+            = getTable.operator()<PackedTextureLevel>(header.levelsOffset, header.levelCount);
+        const auto *packedNodes = getTable.operator()<PackedNode>(header.nodesOffset, header.nodeCount);
+
+        if ((header.meshCount && !packedMeshes) || (header.primitiveCount && !packedPrimitives)
+            || (header.materialCount && !packedMaterials) || (header.textureCount && !packedTextures)
+            || (header.levelCount && !packedLevels) || (header.nodeCount && !packedNodes)) {
+            std::cout << "Truncated scene pack : " << _path.string() << "\n";
+            return {};
+        }
+
+        std::optional<ScopedLoadTimer> materialTimer(std::in_place, LoadStage::MaterialBuild);
+
+        // The levels go to the GPU straight from the mapping
+        TextureStreamer &streamer = TextureStreamer::Get();
+        std::vector<std::shared_ptr<Texture>> textures(header.textureCount);
+        for (uint32_t i = 0; i < header.textureCount; i++) {
+            const PackedTexture &packedTexture = packedTextures[i];
+
+            if (packedTexture.levelCount == 0 || packedTexture.firstLevel > header.levelCount
+                || packedTexture.levelCount > header.levelCount - packedTexture.firstLevel) {
+                continue;
+            }
+
+            if (packedTexture.format > static_cast<uint32_t>(TextureFormat::BC7)) {
+                std::cout << "Invalid format for texture " << i << " in scene pack\n";
+                continue;
+            }
+
+            auto format = static_cast<TextureFormat>(packedTexture.format);
+
+            std::vector<TextureLevel> levels;
+            for (uint32_t level = 0; level < packedTexture.levelCount; level++) {
+                const PackedTextureLevel &packedLevel = packedLevels[packedTexture.firstLevel + level];
+
+                if (packedLevel.width > 0 && packedLevel.height > 0
+                    && packedLevel.size >= GetTextureLevelSize(format, packedLevel.width, packedLevel.height)
+                    && isInFile(packedLevel.offset, packedLevel.size)) {
+                    levels.push_back({ data.data() + packedLevel.offset, packedLevel.size,
+                                       packedLevel.width, packedLevel.height });
+                }
+            }
+
+            if (levels.size() != packedTexture.levelCount) {
+                std::cout << "Truncated texture " << i << " in scene pack\n";
+                continue;
+            }
+
+#if defined(OPENGL)
+            Sampler sampler { packedTexture.magFilter, packedTexture.minFilter,
+                              packedTexture.wrapS, packedTexture.wrapT };
+#else
+            Sampler sampler;
+#endif
+
+            textures[i] = streamer.CreateTexture(format, levels, sampler, packedTexture.hasAlpha != 0, file);
+        }
+
+        auto getTexture = [&](uint32_t _textureIndex) {
+            return _textureIndex < textures.size() ? textures[_textureIndex]
+                                                   : std::shared_ptr<Texture> {};
+        };
+
+        std::vector<PBRMaterial> materials(header.materialCount);
+        for (uint32_t i = 0; i < header.materialCount; i++) {
+            const PackedMaterial &packedMaterial = packedMaterials[i];
+            PBRMaterial &material                = materials[i];
+
+            std::memcpy(&material.baseColorFactor, packedMaterial.baseColorFactor,
+                        sizeof(packedMaterial.baseColorFactor));
+            std::memcpy(&material.emissiveFactor, packedMaterial.emissiveFactor,
+                        sizeof(packedMaterial.emissiveFactor));
+            material.metallicFactor    = packedMaterial.metallicFactor;
+            material.roughnessFactor   = packedMaterial.roughnessFactor;
+            material.normalScale       = packedMaterial.normalScale;
+            material.occlusionStrength = packedMaterial.occlusionStrength;
+            material.hasTransparency   = packedMaterial.hasTransparency != 0;
+            material.id                = packedMaterial.id;
+
+            material.baseColorTexture         = getTexture(packedMaterial.textures[0]);
+            material.metallicRoughnessTexture = getTexture(packedMaterial.textures[1]);
+            material.normalTexture            = getTexture(packedMaterial.textures[2]);
+            material.occlusionTexture         = getTexture(packedMaterial.textures[3]);
+            material.emissiveTexture          = getTexture(packedMaterial.textures[4]);
+        }
+
+        materialTimer.reset();
+
+        std::vector<Mesh> meshes(header.meshCount);
+        for (uint32_t i = 0; i < header.meshCount; i++) {
+            const PackedMesh &packedMesh = packedMeshes[i];
+
+            if (packedMesh.firstPrimitive > header.primitiveCount
+                || packedMesh.primitiveCount > header.primitiveCount - packedMesh.firstPrimitive) {
+                std::cout << "Invalid mesh " << i << " in scene pack\n";
+                continue;
+            }
+
+            for (uint32_t p = 0; p < packedMesh.primitiveCount; p++) {
+                const PackedPrimitive &packedPrimitive = packedPrimitives[packedMesh.firstPrimitive + p];
+
+                const auto *vertices = getTable.operator()<Vertex>(packedPrimitive.verticesOffset,
+                                                                   packedPrimitive.vertexCount);
+                const auto *indices = getTable.operator()<uint32_t>(packedPrimitive.indicesOffset,
+                                                                    packedPrimitive.indexCount);
+
+                if ((packedPrimitive.vertexCount && !vertices)
+                    || (packedPrimitive.indexCount && !indices)) {
+                    std::cout << "Truncated primitive " << p << " of mesh " << i << " in scene pack\n";
+                    continue;
+                }
+
+                // Indices past the vertices would be read out of the buffers
+                // by the mesh processing and the draws
+                const uint32_t *indicesEnd = indices + packedPrimitive.indexCount;
+                if (std::any_of(indices, indicesEnd,
+                                [&](uint32_t _index) { return _index >= packedPrimitive.vertexCount; })) {
+                    std::cout << "Index out of range in primitive " << p << " of mesh " << i
+                              << " in scene pack\n";
+                    continue;
+                }
+
+                std::vector<Vertex> vertexBuffer;
+                std::vector<uint32_t> indicesBuffer;
+                {
+                    ScopedLoadTimer timer(LoadStage::BufferRead);
+                    vertexBuffer.assign(vertices, vertices + packedPrimitive.vertexCount);
+                    indicesBuffer.assign(indices, indices + packedPrimitive.indexCount);
+                }
+
+                VertexBuffer vb = _pool ? VertexBuffer(std::move(vertexBuffer), *_pool)
+                                        : VertexBuffer(std::move(vertexBuffer));
+                IndexBuffer ib = _pool ? IndexBuffer(std::move(indicesBuffer), *_pool)
+                                       : IndexBuffer(std::move(indicesBuffer));
+
+                PBRMaterial material = packedPrimitive.material < materials.size()
+                                           ? materials[packedPrimitive.material]
+                                           : PBRMaterial {};
+
+                AABB bounds { { packedPrimitive.boundsMin[0], packedPrimitive.boundsMin[1],
+                                packedPrimitive.boundsMin[2] },
+                              { packedPrimitive.boundsMax[0], packedPrimitive.boundsMax[1],
+                                packedPrimitive.boundsMax[2] } };
+
+                meshes[i].m_primitives.emplace_back(Primitive(std::move(vb), std::move(ib),
+                                                              packedPrimitive.drawMode, material,
+                                                              bounds));
+            }
+        }
+
+        if (_sceneGraph) {
+            // Parents are relative to the first node of the pack
+            uint32_t firstNode = _sceneGraph->GetNodeCount();
+
+            for (uint32_t i = 0; i < header.nodeCount; i++) {
+                const PackedNode &packedNode = packedNodes[i];
+                uint32_t parent = packedNode.parent != SCENE_PACK_INVALID ? firstNode + packedNode.parent
+                                                                          : INVALID_NODE;
+
+                uint32_t node = _sceneGraph->AddNode(
+                    parent,
+                    Vector3(packedNode.translation[0], packedNode.translation[1], packedNode.translation[2]),
+                    Quaternion(packedNode.rotation[3], packedNode.rotation[0], packedNode.rotation[1],
+                               packedNode.rotation[2]),
+                    Vector3(packedNode.scale[0], packedNode.scale[1], packedNode.scale[2]), packedNode.mesh);
+
+                if (node == INVALID_NODE) {
+                    std::cout << "Invalid node " << i << " in scene pack\n";
+                    break;
+                }
+            }
+        }
+
+        return meshes;
+    }
+} // namespace DadEngine
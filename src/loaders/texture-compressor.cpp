@@ -0,0 +1,766 @@
+#include "texture-compressor.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "helpers/simd.hpp"
+#include "helpers/thread-pool.hpp"
+
+namespace DadEngine
+{
+    namespace
+    {
+        constexpr uint32_t BLOCK_PIXELS = 16U;
+
+        // Index 0 and 1 are the endpoints, 2 and 3 lie at a third and two
+        // thirds from the first one
+        constexpr float BC1_WEIGHTS[4] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+
+        // Interpolation weights of the 4 bits indices, out of 64
+        constexpr uint32_t BC7_WEIGHTS[16] = { 0,  4,  9,  13, 17, 21, 26, 30,
+                                               34, 38, 43, 47, 51, 55, 60, 64 };
+
+        constexpr uint32_t BC7_TWO_BITS_WEIGHTS[4] = { 0, 21, 43, 64 };
+
+        // 4x4 pixels, one row of 16 values per channel so the kernels read
+        // 4 pixels of a channel at once
+        struct Block
+        {
+            alignas(16) float channels[4][BLOCK_PIXELS];
+        };
+
+        // Palette entries are indexed by channel whatever the channels used
+        using Palette = float[16][4];
+
+        // Little endian bit stream of a 128 bits BC7 block
+        struct BitWriter
+        {
+            uint64_t words[2] = {};
+            uint32_t position = 0;
+
+            void Write(uint64_t _value, uint32_t _count)
+            {
+                uint32_t word   = position >> 6U;
+                uint32_t offset = position & 63U;
+
+                words[word] |= _value << offset;
+                if (offset + _count > 64U) {
+                    words[word + 1U] |= _value >> (64U - offset);
+                }
+
+                position += _count;
+            }
+        };
+
+        // Grey images are spread over RGB, a missing alpha is opaque
+        void LoadBlock(const uint8_t *_pixels, int32_t _width, int32_t _height, int32_t _channels,
+                       int32_t _blockX, int32_t _blockY, Block &_block)
+        {
+            for (int32_t y = 0; y < 4; y++) {
+                size_t row = static_cast<size_t>(std::min(_blockY * 4 + y, _height - 1));
+
+                for (int32_t x = 0; x < 4; x++) {
+                    size_t column = static_cast<size_t>(std::min(_blockX * 4 + x, _width - 1));
+                    const uint8_t *pixel
+                        = _pixels + (row * static_cast<size_t>(_width) + column) * static_cast<size_t>(_channels);
+                    uint32_t index = static_cast<uint32_t>(y * 4 + x);
+
+                    float first               = pixel[0];
+                    _block.channels[0][index] = first;
+                    _block.channels[1][index] = _channels >= 3 ? pixel[1] : first;
+                    _block.channels[2][index] = _channels >= 3 ? pixel[2] : first;
+                    _block.channels[3][index] = _channels == 4   ? pixel[3]
+                                                : _channels == 2 ? pixel[1]
+                                                                 : 255.f;
+                }
+            }
+        }
+
+        // Closest palette entry of each pixel over the channels
+        // [_firstChannel, _firstChannel + _channelCount), returns the squared
+        // error of the block
+        float SelectIndices(const Block &_block, uint32_t _firstChannel, uint32_t _channelCount,
+                            const Palette &_palette, uint32_t _paletteSize, uint8_t *_indices)
+        {
+            float error = 0.f;
+
+#if defined(DADENGINE_SSE2)
+            for (uint32_t group = 0; group < BLOCK_PIXELS; group += 4U) {
+                __m128 pixels[4];
+                for (uint32_t channel = 0; channel < _channelCount; channel++) {
+                    pixels[channel] = _mm_load_ps(&_block.channels[_firstChannel + channel][group]);
+                }
+
+                __m128 bestDistance = _mm_set1_ps(std::numeric_limits<float>::max());
+                __m128i bestIndex   = _mm_setzero_si128();
+
+                for (uint32_t entry = 0; entry < _paletteSize; entry++) {
+                    __m128 distance = _mm_setzero_ps();
+
+                    for (uint32_t channel = 0; channel < _channelCount; channel++) {
+                        __m128 delta = _mm_sub_ps(pixels[channel],
+                                                  _mm_set1_ps(_palette[entry][_firstChannel + channel]));
+                        distance     = _mm_add_ps(distance, _mm_mul_ps(delta, delta));
+                    }
+
+                    __m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, bestDistance));
+                    bestDistance   = _mm_min_ps(distance, bestDistance);
+                    bestIndex      = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(static_cast<int32_t>(entry))),
+                                                  _mm_andnot_si128(closer, bestIndex));
+                }
+
+                alignas(16) int32_t indices[4];
+                alignas(16) float distances[4];
+                _mm_store_si128(reinterpret_cast<__m128i *>(indices), bestIndex);
+                _mm_store_ps(distances, bestDistance);
+
+                for (uint32_t i = 0; i < 4U; i++) {
+                    _indices[group + i] = static_cast<uint8_t>(indices[i]);
+                    error += distances[i];
+                }
+            }
+#else
+            for (uint32_t pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+                float bestDistance = std::numeric_limits<float>::max();
+                uint8_t bestIndex  = 0;
+
+                for (uint32_t entry = 0; entry < _paletteSize; entry++) {
+                    float distance = 0.f;
+
+                    for (uint32_t channel = _firstChannel; channel < _firstChannel + _channelCount; channel++) {
+                        float delta = _block.channels[channel][pixel] - _palette[entry][channel];
+                        distance += delta * delta;
+                    }
+
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        bestIndex    = static_cast<uint8_t>(entry);
+                    }
+                }
+
+                _indices[pixel] = bestIndex;
+                error += bestDistance;
+            }
+#endif
+
+            return error;
+        }
+
+        // Endpoints spanning the pixels along their principal axis, found by
+        // power iteration on the covariance of the channels
+        void FitEndpoints(const Block &_block, uint32_t _firstChannel, uint32_t _channelCount,
+                          float _endpoints[2][4])
+        {
+            uint32_t lastChannel   = _firstChannel + _channelCount;
+            float mean[4]          = {};
+            float covariance[4][4] = {};
+
+            for (uint32_t channel = _firstChannel; channel < lastChannel; channel++) {
+                for (uint32_t pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+                    mean[channel] += _block.channels[channel][pixel];
+                }
+
+                mean[channel] /= static_cast<float>(BLOCK_PIXELS);
+            }
+
+            for (uint32_t pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+                for (uint32_t a = _firstChannel; a < lastChannel; a++) {
+                    float deltaA = _block.channels[a][pixel] - mean[a];
+
+                    for (uint32_t b = a; b < lastChannel; b++) {
+                        covariance[a][b] += deltaA * (_block.channels[b][pixel] - mean[b]);
+                    }
+                }
+            }
+
+            // Starting from the row of the largest variance never leaves the
+            // axis orthogonal to the principal one
+            uint32_t largest = _firstChannel;
+            for (uint32_t a = _firstChannel; a < lastChannel; a++) {
+                for (uint32_t b = _firstChannel; b < a; b++) {
+                    covariance[a][b] = covariance[b][a];
+                }
+
+                if (covariance[a][a] > covariance[largest][largest]) {
+                    largest = a;
+                }
+            }
+
+            float axis[4] = {};
+            for (uint32_t channel = _firstChannel; channel < lastChannel; channel++) {
+                axis[channel] = covariance[largest][channel];
+            }
+
+            for (uint32_t iteration = 0; iteration < 8U; iteration++) {
+                float next[4] = {};
+                float scale   = 0.f;
+
+                for (uint32_t a = _firstChannel; a < lastChannel; a++) {
+                    for (uint32_t b = _firstChannel; b < lastChannel; b++) {
+                        next[a] += covariance[a][b] * axis[b];
+                    }
+
+                    scale = std::max(scale, std::abs(next[a]));
+                }
+
+                if (scale <= std::numeric_limits<float>::epsilon()) {
+                    break;
+                }
+
+                for (uint32_t channel = _firstChannel; channel < lastChannel; channel++) {
+                    axis[channel] = next[channel] / scale;
+                }
+            }
+
+            float length = 0.f;
+            for (uint32_t channel = _firstChannel; channel < lastChannel; channel++) {
+                length += axis[channel] * axis[channel];
+            }
+
+            // Solid block, both endpoints sit on the mean
+            float lowest  = 0.f;
+            float highest = 0.f;
+
+            if (length > std::numeric_limits<float>::epsilon()) {
+                length  = 1.f / std::sqrt(length);
+                lowest  = std::numeric_limits<float>::max();
+                highest = -std::numeric_limits<float>::max();
+
+                for (uint32_t channel = _firstChannel; channel < lastChannel; channel++) {
+                    axis[channel] *= length;
+                }
+
+                for (uint32_t pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+                    float projection = 0.f;
+
+                    for (uint32_t channel = _firstChannel; channel < lastChannel; channel++) {
+                        projection += (_block.channels[channel][pixel] - mean[channel]) * axis[channel];
+                    }
+
+                    lowest  = std::min(lowest, projection);
+                    highest = std::max(highest, projection);
+                }
+            }
+
+            for (uint32_t channel = _firstChannel; channel < lastChannel; channel++) {
+                _endpoints[0][channel] = std::clamp(mean[channel] + axis[channel] * lowest, 0.f, 255.f);
+                _endpoints[1][channel] = std::clamp(mean[channel] + axis[channel] * highest, 0.f, 255.f);
+            }
+        }
+
+        // Least squares endpoints for the indices found, _weights gives the
+        // position of each index between the first and the second endpoint.
+        // Fails when every pixel uses the same weight
+        bool RefineEndpoints(const Block &_block, uint32_t _firstChannel, uint32_t _channelCount,
+                             const uint8_t *_indices, const float *_weights, float _endpoints[2][4])
+        {
+            float firstSquared  = 0.f;
+            float cross         = 0.f;
+            float secondSquared = 0.f;
+            float first[4]      = {};
+            float second[4]     = {};
+
+            for (uint32_t pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+                float weight  = _weights[_indices[pixel]];
+                float inverse = 1.f - weight;
+
+                firstSquared += inverse * inverse;
+                cross += inverse * weight;
+                secondSquared += weight * weight;
+
+                for (uint32_t channel = _firstChannel; channel < _firstChannel + _channelCount; channel++) {
+                    first[channel] += inverse * _block.channels[channel][pixel];
+                    second[channel] += weight * _block.channels[channel][pixel];
+                }
+            }
+
+            float determinant = firstSquared * secondSquared - cross * cross;
+            if (std::abs(determinant) <= 1e-6f) {
+                return false;
+            }
+
+            determinant = 1.f / determinant;
+
+            for (uint32_t channel = _firstChannel; channel < _firstChannel + _channelCount; channel++) {
+                _endpoints[0][channel]
+                    = std::clamp((secondSquared * first[channel] - cross * second[channel]) * determinant, 0.f, 255.f);
+                _endpoints[1][channel]
+                    = std::clamp((firstSquared * second[channel] - cross * first[channel]) * determinant, 0.f, 255.f);
+            }
+
+            return true;
+        }
+
+        uint16_t ToRGB565(const float _color[4])
+        {
+            auto quantize = [](float _value, float _maximum) {
+                return static_cast<uint16_t>(std::lround(_value * _maximum / 255.f));
+            };
+
+            return static_cast<uint16_t>((quantize(_color[0], 31.f) << 11U)
+                                         | (quantize(_color[1], 63.f) << 5U) | quantize(_color[2], 31.f));
+        }
+
+        void FromRGB565(uint16_t _color, float _expanded[4])
+        {
+            uint32_t red   = (_color >> 11U) & 31U;
+            uint32_t green = (_color >> 5U) & 63U;
+            uint32_t blue  = _color & 31U;
+
+            _expanded[0] = static_cast<float>((red << 3U) | (red >> 2U));
+            _expanded[1] = static_cast<float>((green << 2U) | (green >> 4U));
+            _expanded[2] = static_cast<float>((blue << 3U) | (blue >> 2U));
+            _expanded[3] = 255.f;
+        }
+
+        // Rounds the endpoints to RGB565, ordered for the four colors mode,
+        // and picks the indices
+        float QuantizeBC1(const Block &_block, const float _endpoints[2][4], uint16_t _colors[2],
+                          uint8_t *_indices)
+        {
+            _colors[0] = ToRGB565(_endpoints[0]);
+            _colors[1] = ToRGB565(_endpoints[1]);
+
+            if (_colors[0] < _colors[1]) {
+                std::swap(_colors[0], _colors[1]);
+            }
+
+            Palette palette;
+            FromRGB565(_colors[0], palette[0]);
+            FromRGB565(_colors[1], palette[1]);
+
+            for (uint32_t channel = 0; channel < 3U; channel++) {
+                palette[2][channel] = (2.f * palette[0][channel] + palette[1][channel]) / 3.f;
+                palette[3][channel] = (palette[0][channel] + 2.f * palette[1][channel]) / 3.f;
+            }
+
+            // Equal colors switch the block to the three colors mode, only
+            // the first index is then safe
+            return SelectIndices(_block, 0, 3, palette, _colors[0] == _colors[1] ? 1U : 4U, _indices);
+        }
+
+        // Color only, the alpha of BC3 is a separate BC4 block
+        void EncodeBC1(const Block &_block, uint8_t *_destination)
+        {
+            float endpoints[2][4];
+            uint16_t colors[2];
+            uint8_t indices[BLOCK_PIXELS];
+
+            FitEndpoints(_block, 0, 3, endpoints);
+            float error = QuantizeBC1(_block, endpoints, colors, indices);
+
+            // One least squares pass on the indices of the axis fit
+            float refined[2][4];
+            if (error > 0.f && RefineEndpoints(_block, 0, 3, indices, BC1_WEIGHTS, refined)) {
+                uint16_t refinedColors[2];
+                uint8_t refinedIndices[BLOCK_PIXELS];
+
+                if (QuantizeBC1(_block, refined, refinedColors, refinedIndices) < error) {
+                    std::memcpy(colors, refinedColors, sizeof(colors));
+                    std::memcpy(indices, refinedIndices, sizeof(indices));
+                }
+            }
+
+            uint32_t packedIndices = 0;
+            for (uint32_t pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+                packedIndices |= static_cast<uint32_t>(indices[pixel]) << (pixel * 2U);
+            }
+
+            std::memcpy(_destination, colors, sizeof(colors));
+            std::memcpy(_destination + sizeof(colors), &packedIndices, sizeof(packedIndices));
+        }
+
+        // Single channel block in the eight values mode, the endpoints are
+        // the extremes of the channel
+        void EncodeBC4(const Block &_block, uint32_t _channel, uint8_t *_destination)
+        {
+            const float *values = _block.channels[_channel];
+            auto [lowest, highest] = std::minmax_element(values, values + BLOCK_PIXELS);
+
+            uint8_t endpoints[2] = { static_cast<uint8_t>(std::lround(*highest)),
+                                     static_cast<uint8_t>(std::lround(*lowest)) };
+
+            Palette palette;
+            palette[0][_channel] = endpoints[0];
+            palette[1][_channel] = endpoints[1];
+
+            for (uint32_t entry = 2; entry < 8U; entry++) {
+                float weight             = static_cast<float>(entry - 1U);
+                palette[entry][_channel] = ((7.f - weight) * endpoints[0] + weight * endpoints[1]) / 7.f;
+            }
+
+            uint8_t indices[BLOCK_PIXELS];
+            SelectIndices(_block, _channel, 1, palette, endpoints[0] == endpoints[1] ? 1U : 8U, indices);
+
+            uint64_t packedIndices = 0;
+            for (uint32_t pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+                packedIndices |= static_cast<uint64_t>(indices[pixel]) << (pixel * 3U);
+            }
+
+            std::memcpy(_destination, endpoints, sizeof(endpoints));
+            std::memcpy(_destination + sizeof(endpoints), &packedIndices, 6);
+        }
+
+        struct BC7Endpoints
+        {
+            uint8_t colors[2][4];
+            uint8_t pBits[2];
+        };
+
+        // Rounds the endpoints to 7 bits plus a shared lowest bit. A negative
+        // p-bit picks the one closest to each endpoint
+        float QuantizeBC7(const Block &_block, const float _endpoints[2][4], const int32_t _pBits[2],
+                          BC7Endpoints &_quantized, uint8_t *_indices)
+        {
+            uint32_t expanded[2][4];
+
+            for (uint32_t endpoint = 0; endpoint < 2U; endpoint++) {
+                float bestError = std::numeric_limits<float>::max();
+                uint32_t first  = _pBits[endpoint] < 0 ? 0U : static_cast<uint32_t>(_pBits[endpoint]);
+                uint32_t last   = _pBits[endpoint] < 0 ? 1U : first;
+
+                for (uint32_t pBit = first; pBit <= last; pBit++) {
+                    float error = 0.f;
+                    uint8_t colors[4];
+
+                    for (uint32_t channel = 0; channel < 4U; channel++) {
+                        float value     = (_endpoints[endpoint][channel] - static_cast<float>(pBit)) * 0.5f;
+                        colors[channel] = static_cast<uint8_t>(std::clamp(std::lround(value), 0L, 127L));
+
+                        float delta = static_cast<float>((colors[channel] << 1U) | pBit)
+                                      - _endpoints[endpoint][channel];
+                        error += delta * delta;
+                    }
+
+                    if (error < bestError) {
+                        bestError = error;
+                        std::memcpy(_quantized.colors[endpoint], colors, sizeof(colors));
+                        _quantized.pBits[endpoint] = static_cast<uint8_t>(pBit);
+                    }
+                }
+
+                for (uint32_t channel = 0; channel < 4U; channel++) {
+                    expanded[endpoint][channel]
+                        = (static_cast<uint32_t>(_quantized.colors[endpoint][channel]) << 1U)
+                          | _quantized.pBits[endpoint];
+                }
+            }
+
+            Palette palette;
+            for (uint32_t entry = 0; entry < 16U; entry++) {
+                for (uint32_t channel = 0; channel < 4U; channel++) {
+                    palette[entry][channel] = static_cast<float>(
+                        ((64U - BC7_WEIGHTS[entry]) * expanded[0][channel]
+                         + BC7_WEIGHTS[entry] * expanded[1][channel] + 32U)
+                        >> 6U);
+                }
+            }
+
+            return SelectIndices(_block, 0, 4, palette, 16U, _indices);
+        }
+
+        // Mode 6, a single RGBA subset with 4 bits indices. The quality adds
+        // least squares passes and the search of every p-bit pair
+        float EncodeBC7Mode6(const Block &_block, uint32_t _quality, uint8_t *_destination)
+        {
+            float weights[16];
+            for (uint32_t entry = 0; entry < 16U; entry++) {
+                weights[entry] = static_cast<float>(BC7_WEIGHTS[entry]) / 64.f;
+            }
+
+            float endpoints[2][4];
+            FitEndpoints(_block, 0, 4, endpoints);
+
+            BC7Endpoints best {};
+            uint8_t bestIndices[BLOCK_PIXELS];
+            float bestError = std::numeric_limits<float>::max();
+
+            for (uint32_t pass = 0; pass <= _quality; pass++) {
+                uint8_t passIndices[BLOCK_PIXELS];
+
+                uint32_t pBitPairs = _quality >= 2U ? 5U : 1U;
+                for (uint32_t pair = 0; pair < pBitPairs; pair++) {
+                    // The first pair is chosen per endpoint, the others are forced
+                    int32_t pBits[2] = { pair == 0 ? -1 : static_cast<int32_t>((pair - 1U) & 1U),
+                                         pair == 0 ? -1 : static_cast<int32_t>((pair - 1U) >> 1U) };
+
+                    BC7Endpoints quantized;
+                    uint8_t indices[BLOCK_PIXELS];
+                    float error = QuantizeBC7(_block, endpoints, pBits, quantized, indices);
+
+                    if (pair == 0) {
+                        std::memcpy(passIndices, indices, sizeof(indices));
+                    }
+
+                    if (error < bestError) {
+                        bestError = error;
+                        best      = quantized;
+                        std::memcpy(bestIndices, indices, sizeof(indices));
+                    }
+                }
+
+                if (bestError <= 0.f || pass == _quality
+                    || !RefineEndpoints(_block, 0, 4, passIndices, weights, endpoints)) {
+                    break;
+                }
+            }
+
+            // The anchor index drops its highest bit, it has to be below 8
+            if (bestIndices[0] >= 8U) {
+                std::swap(best.colors[0], best.colors[1]);
+                std::swap(best.pBits[0], best.pBits[1]);
+
+                for (uint8_t &index : bestIndices) {
+                    index = static_cast<uint8_t>(15U - index);
+                }
+            }
+
+            BitWriter writer;
+            writer.Write(1U << 6U, 7);
+
+            for (uint32_t channel = 0; channel < 4U; channel++) {
+                writer.Write(best.colors[0][channel], 7);
+                writer.Write(best.colors[1][channel], 7);
+            }
+
+            writer.Write(best.pBits[0], 1);
+            writer.Write(best.pBits[1], 1);
+            writer.Write(bestIndices[0], 3);
+
+            for (uint32_t pixel = 1; pixel < BLOCK_PIXELS; pixel++) {
+                writer.Write(bestIndices[pixel], 4);
+            }
+
+            std::memcpy(_destination, writer.words, sizeof(writer.words));
+
+            return bestError;
+        }
+
+        // Rounds the RGB endpoints of mode 5 to 7 bits and picks the 2 bits
+        // indices
+        float QuantizeBC7Colors(const Block &_block, const float _endpoints[2][4], uint8_t _colors[2][3],
+                                uint8_t *_indices)
+        {
+            uint32_t expanded[2][3];
+
+            for (uint32_t endpoint = 0; endpoint < 2U; endpoint++) {
+                for (uint32_t channel = 0; channel < 3U; channel++) {
+                    uint32_t color = static_cast<uint32_t>(std::lround(_endpoints[endpoint][channel] * 127.f / 255.f));
+
+                    _colors[endpoint][channel]  = static_cast<uint8_t>(color);
+                    expanded[endpoint][channel] = (color << 1U) | (color >> 6U);
+                }
+            }
+
+            Palette palette;
+            for (uint32_t entry = 0; entry < 4U; entry++) {
+                for (uint32_t channel = 0; channel < 3U; channel++) {
+                    palette[entry][channel] = static_cast<float>(
+                        ((64U - BC7_TWO_BITS_WEIGHTS[entry]) * expanded[0][channel]
+                         + BC7_TWO_BITS_WEIGHTS[entry] * expanded[1][channel] + 32U)
+                        >> 6U);
+                }
+            }
+
+            return SelectIndices(_block, 0, 3, palette, 4U, _indices);
+        }
+
+        // Mode 5, the alpha has its own 8 bits endpoints and 2 bits indices
+        // so it does not have to follow the colors. Only tried for blocks
+        // that are not opaque
+        float EncodeBC7Mode5(const Block &_block, uint32_t _quality, uint8_t *_destination)
+        {
+            float weights[4];
+            for (uint32_t entry = 0; entry < 4U; entry++) {
+                weights[entry] = static_cast<float>(BC7_TWO_BITS_WEIGHTS[entry]) / 64.f;
+            }
+
+            float endpoints[2][4];
+            FitEndpoints(_block, 0, 3, endpoints);
+
+            uint8_t colors[2][3];
+            uint8_t colorIndices[BLOCK_PIXELS];
+            float colorError = QuantizeBC7Colors(_block, endpoints, colors, colorIndices);
+
+            for (uint32_t pass = 0; pass < _quality && colorError > 0.f; pass++) {
+                uint8_t refinedColors[2][3];
+                uint8_t refinedIndices[BLOCK_PIXELS];
+
+                if (!RefineEndpoints(_block, 0, 3, colorIndices, weights, endpoints)) {
+                    break;
+                }
+
+                float error = QuantizeBC7Colors(_block, endpoints, refinedColors, refinedIndices);
+                if (error >= colorError) {
+                    break;
+                }
+
+                colorError = error;
+                std::memcpy(colors, refinedColors, sizeof(colors));
+                std::memcpy(colorIndices, refinedIndices, sizeof(colorIndices));
+            }
+
+            const float *alphas = _block.channels[3];
+            auto [lowest, highest] = std::minmax_element(alphas, alphas + BLOCK_PIXELS);
+            uint8_t alphaEndpoints[2] = { static_cast<uint8_t>(std::lround(*lowest)),
+                                          static_cast<uint8_t>(std::lround(*highest)) };
+
+            Palette palette;
+            for (uint32_t entry = 0; entry < 4U; entry++) {
+                palette[entry][3] = static_cast<float>(((64U - BC7_TWO_BITS_WEIGHTS[entry]) * alphaEndpoints[0]
+                                                        + BC7_TWO_BITS_WEIGHTS[entry] * alphaEndpoints[1] + 32U)
+                                                       >> 6U);
+            }
+
+            uint8_t alphaIndices[BLOCK_PIXELS];
+            float alphaError = SelectIndices(_block, 3, 1, palette, 4U, alphaIndices);
+
+            // Both anchor indices drop their highest bit
+            if (colorIndices[0] >= 2U) {
+                std::swap(colors[0], colors[1]);
+
+                for (uint8_t &index : colorIndices) {
+                    index = static_cast<uint8_t>(3U - index);
+                }
+            }
+
+            if (alphaIndices[0] >= 2U) {
+                std::swap(alphaEndpoints[0], alphaEndpoints[1]);
+
+                for (uint8_t &index : alphaIndices) {
+                    index = static_cast<uint8_t>(3U - index);
+                }
+            }
+
+            BitWriter writer;
+            writer.Write(1U << 5U, 6);
+            writer.Write(0, 2); // No channel rotation
+
+            for (uint32_t channel = 0; channel < 3U; channel++) {
+                writer.Write(colors[0][channel], 7);
+                writer.Write(colors[1][channel], 7);
+            }
+
+            writer.Write(alphaEndpoints[0], 8);
+            writer.Write(alphaEndpoints[1], 8);
+
+            for (const uint8_t *indices : { colorIndices, alphaIndices }) {
+                writer.Write(indices[0], 1);
+
+                for (uint32_t pixel = 1; pixel < BLOCK_PIXELS; pixel++) {
+                    writer.Write(indices[pixel], 2);
+                }
+            }
+
+            std::memcpy(_destination, writer.words, sizeof(writer.words));
+
+            return colorError + alphaError;
+        }
+
+        // Mode 6 fits most blocks, mode 5 wins when the alpha varies
+        // independently of the colors, such as foliage cutouts
+        void EncodeBC7(const Block &_block, uint32_t _quality, uint8_t *_destination)
+        {
+            float error = EncodeBC7Mode6(_block, _quality, _destination);
+
+            const float *alphas = _block.channels[3];
+            bool isOpaque       = std::all_of(alphas, alphas + BLOCK_PIXELS,
+                                              [](float _alpha) { return _alpha >= 255.f; });
+
+            uint8_t separateAlpha[16];
+            if (!isOpaque && error > 0.f && EncodeBC7Mode5(_block, _quality, separateAlpha) < error) {
+                std::memcpy(_destination, separateAlpha, sizeof(separateAlpha));
+            }
+        }
+    } // namespace
+
+    TextureFormat ChooseCompressedFormat(TextureUsage _usage, bool _hasAlpha,
+                                         const TextureCompressionSettings &_settings)
+    {
+        if (_usage == TextureUsage::Normal) {
+            return TextureFormat::BC5;
+        }
+
+        if (_settings.useBC7) {
+            return TextureFormat::BC7;
+        }
+
+        return _hasAlpha ? TextureFormat::BC3 : TextureFormat::BC1;
+    }
+
+    void CompressTexture(const uint8_t *_pixels, int32_t _width, int32_t _height, int32_t _channels,
+                         TextureFormat _format, uint32_t _bc7Quality, uint8_t *_destination)
+    {
+        int32_t blocksWide = (_width + 3) / 4;
+        int32_t blocksHigh = (_height + 3) / 4;
+        size_t blockSize   = _format == TextureFormat::BC1 || _format == TextureFormat::BC4 ? 8U : 16U;
+
+        ThreadPool::Get().ParallelFor(static_cast<uint32_t>(blocksHigh), 1, [&](uint32_t _begin, uint32_t _end) {
+            Block block;
+
+            for (uint32_t blockY = _begin; blockY < _end; blockY++) {
+                for (int32_t blockX = 0; blockX < blocksWide; blockX++) {
+                    LoadBlock(_pixels, _width, _height, _channels, blockX, static_cast<int32_t>(blockY), block);
+
+                    uint8_t *destination
+                        = _destination + (static_cast<size_t>(blockY) * static_cast<size_t>(blocksWide)
+                                          + static_cast<size_t>(blockX))
+                                             * blockSize;
+
+                    switch (_format) {
+                    case TextureFormat::BC1:
+                        EncodeBC1(block, destination);
+                        break;
+                    case TextureFormat::BC3:
+                        EncodeBC4(block, 3, destination);
+                        EncodeBC1(block, destination + 8);
+                        break;
+                    case TextureFormat::BC4:
+                        EncodeBC4(block, 0, destination);
+                        break;
+                    case TextureFormat::BC5:
+                        EncodeBC4(block, 0, destination);
+                        EncodeBC4(block, 1, destination + 8);
+                        break;
+                    case TextureFormat::BC7:
+                        EncodeBC7(block, _bc7Quality, destination);
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+        });
+    }
+
+    std::vector<TextureLevel> CompressLevels(const std::vector<TextureLevel> &_levels, int32_t _channels,
+                                             TextureFormat _format, uint32_t _bc7Quality,
+                                             std::vector<uint8_t> &_blocks)
+    {
+        size_t size = 0;
+        for (const auto &level : _levels) {
+            size += GetTextureLevelSize(_format, level.width, level.height);
+        }
+
+        _blocks.resize(size);
+
+        std::vector<TextureLevel> compressedLevels;
+        size_t offset = 0;
+
+        for (const auto &level : _levels) {
+            size_t levelSize = GetTextureLevelSize(_format, level.width, level.height);
+
+            CompressTexture(level.data, level.width, level.height, _channels, _format, _bc7Quality,
+                            _blocks.data() + offset);
+            compressedLevels.push_back({ _blocks.data() + offset, levelSize, level.width, level.height });
+
+            offset += levelSize;
+        }
+
+        return compressedLevels;
+    }
+} // namespace DadEngine
@@ -0,0 +1,269 @@
+#include "texture-container.hpp"
+
+#include <cstring>
+
+#include <algorithm>
+#include <iostream>
+
+namespace DadEngine
+{
+    namespace
+    {
+        constexpr uint32_t DDS_MAGIC          = 0x20534444U; // "DDS "
+        constexpr uint32_t DDS_FOURCC_DX10    = 0x30315844U; // "DX10"
+        constexpr uint32_t DDS_FOURCC_DXT1    = 0x31545844U; // "DXT1"
+        constexpr uint32_t DDS_FOURCC_DXT5    = 0x35545844U; // "DXT5"
+        constexpr uint32_t DDS_FOURCC_ATI1    = 0x31495441U; // "ATI1"
+        constexpr uint32_t DDS_FOURCC_BC4U    = 0x55344342U; // "BC4U"
+        constexpr uint32_t DDS_FOURCC_ATI2    = 0x32495441U; // "ATI2"
+        constexpr uint32_t DDS_FOURCC_BC5U    = 0x55354342U; // "BC5U"
+        constexpr size_t DDS_HEADER_SIZE      = 128U;        // Magic included
+        constexpr size_t DDS_DX10_HEADER_SIZE = 20U;
+
+        constexpr uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+                                                  0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+        constexpr size_t KTX2_HEADER_SIZE      = 80U;
+        constexpr size_t KTX2_LEVEL_INDEX_SIZE = 24U;
+
+        uint32_t ReadUint32(const uint8_t *_data)
+        {
+            uint32_t value;
+            std::memcpy(&value, _data, sizeof(value));
+            return value;
+        }
+
+        uint64_t ReadUint64(const uint8_t *_data)
+        {
+            uint64_t value;
+            std::memcpy(&value, _data, sizeof(value));
+            return value;
+        }
+
+        bool GetDXGIFormat(uint32_t _dxgiFormat, TextureFormat &_format, bool &_hasAlpha)
+        {
+            switch (_dxgiFormat) {
+            case 71U: // BC1_UNORM
+            case 72U: // BC1_UNORM_SRGB
+                _format   = TextureFormat::BC1;
+                _hasAlpha = false;
+                return true;
+            case 77U: // BC3_UNORM
+            case 78U: // BC3_UNORM_SRGB
+                _format   = TextureFormat::BC3;
+                _hasAlpha = true;
+                return true;
+            case 80U: // BC4_UNORM
+                _format   = TextureFormat::BC4;
+                _hasAlpha = false;
+                return true;
+            case 83U: // BC5_UNORM
+                _format   = TextureFormat::BC5;
+                _hasAlpha = false;
+                return true;
+            case 98U: // BC7_UNORM
+            case 99U: // BC7_UNORM_SRGB
+                _format   = TextureFormat::BC7;
+                _hasAlpha = true;
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        bool GetFourCCFormat(uint32_t _fourCC, TextureFormat &_format, bool &_hasAlpha)
+        {
+            switch (_fourCC) {
+            case DDS_FOURCC_DXT1:
+                _format   = TextureFormat::BC1;
+                _hasAlpha = false;
+                return true;
+            case DDS_FOURCC_DXT5:
+                _format   = TextureFormat::BC3;
+                _hasAlpha = true;
+                return true;
+            case DDS_FOURCC_ATI1:
+            case DDS_FOURCC_BC4U:
+                _format   = TextureFormat::BC4;
+                _hasAlpha = false;
+                return true;
+            case DDS_FOURCC_ATI2:
+            case DDS_FOURCC_BC5U:
+                _format   = TextureFormat::BC5;
+                _hasAlpha = false;
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        bool GetVkFormat(uint32_t _vkFormat, TextureFormat &_format, bool &_hasAlpha)
+        {
+            switch (_vkFormat) {
+            case 131U: // BC1_RGB_UNORM_BLOCK
+            case 132U: // BC1_RGB_SRGB_BLOCK
+                _format   = TextureFormat::BC1;
+                _hasAlpha = false;
+                return true;
+            case 133U: // BC1_RGBA_UNORM_BLOCK
+            case 134U: // BC1_RGBA_SRGB_BLOCK
+                _format   = TextureFormat::BC1;
+                _hasAlpha = true;
+                return true;
+            case 137U: // BC3_UNORM_BLOCK
+            case 138U: // BC3_SRGB_BLOCK
+                _format   = TextureFormat::BC3;
+                _hasAlpha = true;
+                return true;
+            case 139U: // BC4_UNORM_BLOCK
+                _format   = TextureFormat::BC4;
+                _hasAlpha = false;
+                return true;
+            case 141U: // BC5_UNORM_BLOCK
+                _format   = TextureFormat::BC5;
+                _hasAlpha = false;
+                return true;
+            case 145U: // BC7_UNORM_BLOCK
+            case 146U: // BC7_SRGB_BLOCK
+                _format   = TextureFormat::BC7;
+                _hasAlpha = true;
+                return true;
+            default:
+                return false;
+            }
+        }
+    } // namespace
+
+    bool IsTextureContainer(std::span<const uint8_t> _file)
+    {
+        return (_file.size() >= sizeof(uint32_t) && ReadUint32(_file.data()) == DDS_MAGIC)
+               || (_file.size() >= sizeof(KTX2_IDENTIFIER)
+                   && std::memcmp(_file.data(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0);
+    }
+
+    bool ParseDDS(std::span<const uint8_t> _file, CompressedImage &_image)
+    {
+        const uint8_t *data = _file.data();
+
+        if (_file.size() < DDS_HEADER_SIZE || ReadUint32(data) != DDS_MAGIC) {
+            return false;
+        }
+
+        auto height         = static_cast<int32_t>(ReadUint32(data + 12));
+        auto width          = static_cast<int32_t>(ReadUint32(data + 16));
+        uint32_t levelCount = std::max(ReadUint32(data + 28), 1U);
+        uint32_t fourCC     = ReadUint32(data + 84);
+        size_t offset       = DDS_HEADER_SIZE;
+
+        bool supported = false;
+        if (fourCC == DDS_FOURCC_DX10) {
+            if (_file.size() < DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE) {
+                return false;
+            }
+
+            supported = GetDXGIFormat(ReadUint32(data + offset), _image.format, _image.hasAlpha);
+            offset += DDS_DX10_HEADER_SIZE;
+        }
+        else {
+            supported = GetFourCCFormat(fourCC, _image.format, _image.hasAlpha);
+        }
+
+        if (!supported || width <= 0 || height <= 0) {
+            std::cout << "Unsupported DDS texture format\n";
+            return false;
+        }
+
+        // Levels are stored one after the other, largest first
+        _image.levels.clear();
+        for (uint32_t level = 0; level < levelCount; level++) {
+            int32_t levelWidth  = std::max(width >> level, 1);
+            int32_t levelHeight = std::max(height >> level, 1);
+            size_t size         = GetTextureLevelSize(_image.format, levelWidth, levelHeight);
+
+            if (size > _file.size() - offset) {
+                std::cout << "Truncated DDS texture\n";
+                return false;
+            }
+
+            _image.levels.push_back({ data + offset, size, levelWidth, levelHeight });
+            offset += size;
+
+            if (levelWidth == 1 && levelHeight == 1) {
+                break;
+            }
+        }
+
+        return true;
+    }
+
+    bool ParseKTX2(std::span<const uint8_t> _file, CompressedImage &_image)
+    {
+        const uint8_t *data = _file.data();
+
+        if (_file.size() < KTX2_HEADER_SIZE
+            || std::memcmp(data, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+            return false;
+        }
+
+        uint32_t vkFormat         = ReadUint32(data + 12);
+        auto width                = static_cast<int32_t>(ReadUint32(data + 20));
+        auto height               = static_cast<int32_t>(ReadUint32(data + 24));
+        uint32_t depth            = ReadUint32(data + 28);
+        uint32_t layerCount       = ReadUint32(data + 32);
+        uint32_t faceCount        = ReadUint32(data + 36);
+        uint32_t levelCount       = std::max(ReadUint32(data + 40), 1U);
+        uint32_t supercompression = ReadUint32(data + 44);
+
+        // Basis Universal payloads (KHR_texture_basisu) need a transcoder
+        if (supercompression != 0) {
+            std::cout << "Supercompressed KTX2 textures are not supported\n";
+            return false;
+        }
+
+        if (!GetVkFormat(vkFormat, _image.format, _image.hasAlpha)) {
+            std::cout << "Unsupported KTX2 texture format : " << vkFormat << "\n";
+            return false;
+        }
+
+        if (width <= 0 || height <= 0 || depth > 1U || layerCount > 1U || faceCount != 1U) {
+            std::cout << "Only 2D KTX2 textures are supported\n";
+            return false;
+        }
+
+        if (levelCount > 32U
+            || levelCount > (_file.size() - KTX2_HEADER_SIZE) / KTX2_LEVEL_INDEX_SIZE) {
+            return false;
+        }
+
+        // The level index lists the largest level first whatever the order
+        // of the level data in the file
+        _image.levels.clear();
+        for (uint32_t level = 0; level < levelCount; level++) {
+            const uint8_t *levelIndex = data + KTX2_HEADER_SIZE + level * KTX2_LEVEL_INDEX_SIZE;
+            uint64_t offset           = ReadUint64(levelIndex);
+            uint64_t length           = ReadUint64(levelIndex + 8);
+
+            int32_t levelWidth  = std::max(width >> level, 1);
+            int32_t levelHeight = std::max(height >> level, 1);
+
+            if (offset > _file.size() || length > _file.size() - offset
+                || length < GetTextureLevelSize(_image.format, levelWidth, levelHeight)) {
+                std::cout << "Truncated KTX2 texture\n";
+                return false;
+            }
+
+            _image.levels.push_back({ data + offset, static_cast<size_t>(length), levelWidth,
+                                      levelHeight });
+        }
+
+        return true;
+    }
+
+    bool ParseTextureContainer(std::span<const uint8_t> _file, CompressedImage &_image)
+    {
+        if (_file.size() >= sizeof(uint32_t) && ReadUint32(_file.data()) == DDS_MAGIC) {
+            return ParseDDS(_file, _image);
+        }
+
+        return ParseKTX2(_file, _image);
+    }
+} // namespace DadEngine
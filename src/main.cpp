@@ -1,19 +1,31 @@
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <iostream>
 #include <limits>
 #include <numeric>
 #include <vulkan/vulkan_core.h>
 
+#include "animation/animation.hpp"
+#include "animation/skinning.hpp"
 #include "camera/camera.hpp"
+#include "culling/masked-occlusion.hpp"
+#include "helpers/derived-data-cache.hpp"
 #include "helpers/file.hpp"
+#include "helpers/thread-pool.hpp"
 #include "math/matrix/matrix4x4.hpp"
 #include "model/model.hpp"
+#include "model/texture-streamer.hpp"
+#include "scene/scene-graph.hpp"
 #include "window/window.hpp"
 
 #include "loaders/gltf-loader.hpp"
+#include "loaders/scene-pack.hpp"
 
 using namespace DadEngine;
 
@@ -24,6 +36,9 @@ using namespace DadEngine;
 
 int main()
 {
+    auto startupStart = std::chrono::steady_clock::now();
+    bool firstFrame   = true;
+
     Application app { { "DadViewer", 1280, 720 } };
     OpenGLRenderer renderer { app.GetWindow(), true };
     std::string shaderName = "default";
@@ -32,17 +47,140 @@ int main()
     float aspect = static_cast<float>(rect.right) / static_cast<float>(rect.bottom);
     Camera camera(Vector3(2.f, 1.f, 0.f), Vector3(-1.f, 1.f, 0.f), aspect);
 
+    GeometryPool geometryPool { 1U << 18U, 1U << 20U };
+
+    // Textures stream their large mips in under the budget, in megabytes
+    // from DADENGINE_TEXTURE_BUDGET_MB, 0 uploads every level at load
+    TextureStreamingSettings streamingSettings;
+    streamingSettings.budget = 256U << 20U;
+    if (const char *budget = std::getenv("DADENGINE_TEXTURE_BUDGET_MB")) {
+        streamingSettings.budget = static_cast<size_t>(std::strtoull(budget, nullptr, 10)) << 20U;
+    }
+    TextureStreamer::Get().SetSettings(streamingSettings);
+
     std::filesystem::path modelPath("../data/sponza/Sponza.gltf");
-    Mesh sponza = LoadGLTF(modelPath)[0];
+    std::filesystem::path cookedPath("../data/sponza/Sponza.dpak");
+    auto loadStart = std::chrono::steady_clock::now();
+
+    // The pack written by dadengine-cook needs no parsing nor decoding
+    std::vector<Mesh> meshes;
+    SceneGraph sceneGraph;
+    std::vector<AnimationClip> animations;
+    std::vector<Skin> skins;
+    if (std::filesystem::exists(cookedPath)) {
+        meshes = LoadCookedScene(cookedPath, &geometryPool, &sceneGraph);
+    }
+
+    if (meshes.empty()) {
+        sceneGraph.Clear();
+        meshes = LoadGLTF(modelPath, &geometryPool, {}, &sceneGraph, &animations, &skins);
+    }
+
+    // One clip plays in a loop on the loaded nodes, instances must not share
+    // their targets. DADENGINE_ANIMATION picks it, the first one by default
+    std::vector<AnimationInstance> animationInstances;
+    if (!animations.empty()) {
+        size_t clip = 0U;
+        if (const char *animation = std::getenv("DADENGINE_ANIMATION")) {
+            clip = std::min(static_cast<size_t>(std::strtoull(animation, nullptr, 10)), animations.size() - 1U);
+        }
+
+        animationInstances.emplace_back(animations[clip]);
+    }
+
+    sceneGraph.UpdateWorldMatrices(&ThreadPool::Get());
+
+    Mesh &sponza = meshes[0];
+    std::chrono::duration<double, std::milli> loadTime
+        = std::chrono::steady_clock::now() - loadStart;
+
+    printf("Scene load : %.2f ms, %zu primitives\n", loadTime.count(),
+           sponza.m_primitives.size());
+    printf("Derived data cache : %llu hits, %llu misses\n",
+           static_cast<unsigned long long>(DerivedDataCache::Get().GetHitCount()),
+           static_cast<unsigned long long>(DerivedDataCache::Get().GetMissCount()));
+
+    sponza.Batch(&geometryPool);
+
+    // The first mesh is drawn with the transform of the first node using it,
+    // the other nodes with their own
+    uint32_t sponzaNode = INVALID_NODE;
+    for (uint32_t node = 0; node < sceneGraph.GetNodeCount() && sponzaNode == INVALID_NODE; node++) {
+        if (sceneGraph.GetMesh(node) == 0U) {
+            sponzaNode = node;
+        }
+    }
 
     Matrix4x4 model;
-    model.m_11 = 0.008f;
-    model.m_22 = 0.008f;
-    model.m_33 = 0.008f;
+    if (sponzaNode != INVALID_NODE) {
+        model = sceneGraph.GetWorldMatrix(sponzaNode).GetMatrix4x4();
+    }
+
+    MaskedOcclusionCulling occlusionCulling { 320, 180 };
+    OccluderMesh occluders = BuildOccluderMesh(sponza);
+
+    // Every drawn mesh is culled and feeds the texture streamer, so none of
+    // its textures stays at its tail
+    std::vector<std::vector<float>> uvDensities;
+    uvDensities.reserve(meshes.size());
+    for (const Mesh &mesh : meshes) {
+        uvDensities.push_back(ComputeUVDensities(mesh));
+    }
+
+    // Skinned nodes are posed on the CPU by linear blending, or with dual
+    // quaternions when DADENGINE_SKINNING is dq, or by the vertex shader
+    // when it is gpu. Either way their vertices end up in world space
+    const char *skinning          = std::getenv("DADENGINE_SKINNING");
+    bool gpuSkinning              = skinning && std::strcmp(skinning, "gpu") == 0;
+    SkinningMethod skinningMethod = skinning && std::strcmp(skinning, "dq") == 0 ? SkinningMethod::DualQuaternion
+                                                                                  : SkinningMethod::LinearBlend;
+
+    std::vector<uint32_t> skinnedNodes;
+    std::vector<CPUSkinnedMesh> skinnedMeshes;
+    for (uint32_t node = 0; node < sceneGraph.GetNodeCount(); node++) {
+        if (sceneGraph.GetMesh(node) < meshes.size() && sceneGraph.GetSkin(node) < skins.size()) {
+            skinnedNodes.push_back(node);
+
+            if (!gpuSkinning) {
+                skinnedMeshes.emplace_back(meshes[sceneGraph.GetMesh(node)]);
+            }
+        }
+    }
+
+    std::string skinnedShaderName = "skinned";
+    OpenGLShader skinnedShader {};
+    if (gpuSkinning && !skinnedNodes.empty()) {
+        skinnedShader = renderer.RegisterShader(skinnedShaderName, skinnedShaderName, shaderName);
+    }
+
+    std::vector<Matrix3x4> jointMatrices;
+    SkinningPalette skinningPalette;
+    std::vector<uint32_t> visibleSkinnedPrimitives;
+
+    // Nothing reads the geometry back from now on, the GPU copy is enough.
+    // DADENGINE_KEEP_CPU_DATA keeps it, e.g. to inspect it from a debugger
+    if (!std::getenv("DADENGINE_KEEP_CPU_DATA")) {
+        sponza.ReleaseCPUData();
+    }
+
+    auto frameStart = std::chrono::steady_clock::now();
 
     while (app.GetWindow().IsOpen()) {
         app.GetWindow().MessagePump();
 
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<float> deltaTime = now - frameStart;
+        frameStart                             = now;
+
+        if (!animationInstances.empty()) {
+            for (AnimationInstance &instance : animationInstances) {
+                instance.Advance(deltaTime.count());
+            }
+
+            EvaluateAnimations(animationInstances, sceneGraph, &ThreadPool::Get());
+            sceneGraph.UpdateWorldMatrices(&ThreadPool::Get());
+        }
+
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         glUseProgram(shader.programID);
@@ -74,9 +212,128 @@ int main()
         glUniform4fv(cameraPositionLocation, 1,
                      reinterpret_cast<float *>(&camera.position));
 
-        sponza.Render();
+        Matrix4x4 modelViewProjection = model * camera.view;
+        modelViewProjection *= camera.projection;
+
+        occlusionCulling.Clear();
+        occlusionCulling.SetTransform(modelViewProjection);
+        RenderOccluders(occlusionCulling, occluders, &ThreadPool::Get());
+
+        int32_t viewportHeight = static_cast<int32_t>(rect.bottom);
+        TextureStreamer::Get().BeginFrame();
+
+        std::vector<uint32_t> visiblePrimitives = CullPrimitives(sponza, occlusionCulling);
+        TextureStreamer::Get().AddVisiblePrimitives(camera, viewportHeight, sponza, uvDensities[0], model,
+                                                    visiblePrimitives);
+
+        sponza.Render(visiblePrimitives);
+
+        for (uint32_t node = 0; node < sceneGraph.GetNodeCount(); node++) {
+            uint32_t mesh = sceneGraph.GetMesh(node);
+            if (node == sponzaNode || mesh >= meshes.size() || sceneGraph.GetSkin(node) < skins.size()) {
+                continue;
+            }
+
+            Matrix4x4 nodeModel = sceneGraph.GetWorldMatrix(node).GetMatrix4x4();
+            Matrix4x4 nodeModelViewProjection = nodeModel * camera.view;
+            nodeModelViewProjection *= camera.projection;
+
+            occlusionCulling.SetTransform(nodeModelViewProjection);
+            visiblePrimitives = CullPrimitives(meshes[mesh], occlusionCulling);
+            if (visiblePrimitives.empty()) {
+                continue;
+            }
+
+            TextureStreamer::Get().AddVisiblePrimitives(camera, viewportHeight, meshes[mesh], uvDensities[mesh],
+                                                        nodeModel, visiblePrimitives);
+
+            glUniformMatrix4fv(modelLocation, 1, GL_FALSE, reinterpret_cast<float *>(&nodeModel));
+            meshes[mesh].Render(visiblePrimitives);
+        }
+
+        // Skinned vertices are already in world space, their bounds are
+        // tested once posed by the joints
+        Matrix4x4 viewProjection = camera.view;
+        viewProjection *= camera.projection;
+        occlusionCulling.SetTransform(viewProjection);
+
+        auto cullSkinnedPrimitives = [&](const Mesh &_mesh, const std::vector<float> &_uvDensities) {
+            // The joints scale the UV density as the model matrix would
+            float jointScale = 1.f;
+            if (!jointMatrices.empty()) {
+                const Matrix3x4 &root = jointMatrices.front();
+                jointScale = std::sqrt(root.m_11 * root.m_11 + root.m_21 * root.m_21 + root.m_31 * root.m_31);
+            }
+
+            visibleSkinnedPrimitives.clear();
+            for (uint32_t primitive = 0; primitive < _mesh.m_primitives.size(); primitive++) {
+                AABB bounds = ComputeSkinnedBounds(_mesh.m_primitives[primitive].bounds, jointMatrices);
+                if (!occlusionCulling.TestAABB(bounds)) {
+                    continue;
+                }
+
+                visibleSkinnedPrimitives.push_back(primitive);
+
+                if (primitive < _uvDensities.size()) {
+                    TextureStreamer::Get().AddVisiblePrimitive(camera, viewportHeight, _mesh.m_primitives[primitive],
+                                                               _uvDensities[primitive] * jointScale, bounds);
+                }
+            }
+        };
+
+        if (!gpuSkinning) {
+            Matrix4x4 identity;
+            glUniformMatrix4fv(modelLocation, 1, GL_FALSE, reinterpret_cast<float *>(&identity));
+
+            for (size_t skinned = 0; skinned < skinnedNodes.size(); skinned++) {
+                uint32_t node = skinnedNodes[skinned];
+                ComputeJointMatrices(skins[sceneGraph.GetSkin(node)], sceneGraph, 0U, jointMatrices);
+
+                Mesh &skinnedMesh = skinnedMeshes[skinned].GetMesh();
+                cullSkinnedPrimitives(skinnedMesh, uvDensities[sceneGraph.GetMesh(node)]);
+                if (visibleSkinnedPrimitives.empty()) {
+                    continue;
+                }
+
+                skinningPalette.Set(jointMatrices, skinningMethod);
+                skinnedMeshes[skinned].Update(skinningPalette, &ThreadPool::Get());
+                skinnedMesh.Render(visibleSkinnedPrimitives);
+            }
+        }
+        else if (!skinnedNodes.empty()) {
+            glUseProgram(skinnedShader.programID);
+            glUniformMatrix4fv(glGetUniformLocation(skinnedShader.programID, "view"), 1, GL_FALSE,
+                               reinterpret_cast<float *>(&camera.view));
+            glUniformMatrix4fv(glGetUniformLocation(skinnedShader.programID, "projection"), 1, GL_FALSE,
+                               reinterpret_cast<float *>(&camera.projection));
+            glUniform4fv(glGetUniformLocation(skinnedShader.programID, "cameraPosition"), 1,
+                         reinterpret_cast<float *>(&camera.position));
+            GLint jointRowsLocation = glGetUniformLocation(skinnedShader.programID, "jointRows");
+
+            for (uint32_t node : skinnedNodes) {
+                uint32_t mesh = sceneGraph.GetMesh(node);
+                ComputeJointMatrices(skins[sceneGraph.GetSkin(node)], sceneGraph, 0U, jointMatrices);
+
+                cullSkinnedPrimitives(meshes[mesh], uvDensities[mesh]);
+                if (!visibleSkinnedPrimitives.empty() && UploadJointMatrices(jointRowsLocation, jointMatrices)) {
+                    meshes[mesh].Render(visibleSkinnedPrimitives);
+                }
+            }
+        }
+
+        TextureStreamer::Get().EndFrame();
 
         renderer.Present();
+
+        if (firstFrame) {
+            std::chrono::duration<double, std::milli> firstFrameTime
+                = std::chrono::steady_clock::now() - startupStart;
+
+            printf("First frame : %.2f ms\n", firstFrameTime.count());
+            printf("Streamed textures : %zu, %.2f MB resident\n", TextureStreamer::Get().GetTextureCount(),
+                   static_cast<double>(TextureStreamer::Get().GetResidentSize()) / (1024.0 * 1024.0));
+            firstFrame = false;
+        }
     }
 
     return 0;
@@ -440,24 +697,25 @@ inline void CreateFramebuffer(uint32_t _virtualFrameIndex)
 
 inline void CreatePipeline()
 {
-    std::vector<uint8_t> vertexShaderCode
-        = DadEngine::ReadFile("../data/shaders/easy.vert.spv");
+    // Mapped pages are aligned enough for the SPIR-V words
+    DadEngine::MappedFile vertexShaderFile("../data/shaders/easy.vert.spv");
+    std::span<const uint8_t> vertexShaderCode = vertexShaderFile.GetData();
 
     VkShaderModuleCreateInfo vertexShaderModuleCreateInfo {
         VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, nullptr, 0,
-        vertexShaderCode.size() - 1,
-        reinterpret_cast<uint32_t *>(vertexShaderCode.data())
+        vertexShaderCode.size(),
+        reinterpret_cast<const uint32_t *>(vertexShaderCode.data())
     };
 
     vkCreateShaderModule(Device, &vertexShaderModuleCreateInfo, nullptr, &VertexShaderModule);
 
-    auto fragmentShaderCode
-        = DadEngine::ReadFile("../data/shaders/easy.frag.spv");
+    DadEngine::MappedFile fragmentShaderFile("../data/shaders/easy.frag.spv");
+    std::span<const uint8_t> fragmentShaderCode = fragmentShaderFile.GetData();
 
     VkShaderModuleCreateInfo fragmentShaderModuleCreateInfo {
         VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, nullptr, 0,
-        fragmentShaderCode.size() - 1,
-        reinterpret_cast<uint32_t *>(fragmentShaderCode.data())
+        fragmentShaderCode.size(),
+        reinterpret_cast<const uint32_t *>(fragmentShaderCode.data())
     };
 
     vkCreateShaderModule(Device, &fragmentShaderModuleCreateInfo, nullptr, &FragmentShaderModule);
@@ -0,0 +1,98 @@
+#include "aabb.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace DadEngine
+{
+    AABB::AABB(Vector3 _min, Vector3 _max)
+        : m_min(_min), m_max(_max)
+    {
+    }
+
+
+    // Standard bounding box functions
+    void AABB::Grow(const Vector3 &_point)
+    {
+        m_min.x = std::min(m_min.x, _point.x);
+        m_min.y = std::min(m_min.y, _point.y);
+        m_min.z = std::min(m_min.z, _point.z);
+
+        m_max.x = std::max(m_max.x, _point.x);
+        m_max.y = std::max(m_max.y, _point.y);
+        m_max.z = std::max(m_max.z, _point.z);
+    }
+
+    void AABB::Grow(const AABB &_box)
+    {
+        // Empty boxes would otherwise stretch the bounds to infinity
+        if (!_box.IsValid())
+        {
+            return;
+        }
+
+        Grow(_box.m_min);
+        Grow(_box.m_max);
+    }
+
+    bool AABB::IsValid() const
+    {
+        return m_min.x <= m_max.x && m_min.y <= m_max.y && m_min.z <= m_max.z;
+    }
+
+    bool AABB::Contains(const Vector3 &_point) const
+    {
+        return _point.x >= m_min.x && _point.x <= m_max.x
+               && _point.y >= m_min.y && _point.y <= m_max.y
+               && _point.z >= m_min.z && _point.z <= m_max.z;
+    }
+
+    bool AABB::Overlaps(const AABB &_box) const
+    {
+        return m_min.x <= _box.m_max.x && m_max.x >= _box.m_min.x
+               && m_min.y <= _box.m_max.y && m_max.y >= _box.m_min.y
+               && m_min.z <= _box.m_max.z && m_max.z >= _box.m_min.z;
+    }
+
+    Vector3 AABB::Center() const
+    {
+        return Vector3((m_min.x + m_max.x) * 0.5f, (m_min.y + m_max.y) * 0.5f,
+                       (m_min.z + m_max.z) * 0.5f);
+    }
+
+    Vector3 AABB::Extent() const
+    {
+        return Vector3(m_max.x - m_min.x, m_max.y - m_min.y, m_max.z - m_min.z);
+    }
+
+    float AABB::SurfaceArea() const
+    {
+        if (!IsValid())
+        {
+            return 0.f;
+        }
+
+        Vector3 extent = Extent();
+
+        return 2.f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+
+    uint32_t AABB::LargestAxis() const
+    {
+        Vector3 extent = Extent();
+
+        if (extent.x >= extent.y && extent.x >= extent.z)
+        {
+            return 0U;
+        }
+
+        return extent.y >= extent.z ? 1U : 2U;
+    }
+
+    AABB AABB::Empty()
+    {
+        constexpr float MAX = std::numeric_limits<float>::max();
+
+        return AABB(Vector3(MAX, MAX, MAX), Vector3(-MAX, -MAX, -MAX));
+    }
+} // namespace DadEngine
@@ -0,0 +1,153 @@
+#include "matrix/matrix3x4.hpp"
+
+#include "matrix/matrix4x4.hpp"
+#include "quaternion/quaternion.hpp"
+#include "vector/vector3.hpp"
+
+#include <cmath>
+
+namespace DadEngine
+{
+    Matrix3x4::Matrix3x4(float _11,
+                         float _12,
+                         float _13,
+                         float _14,
+                         float _21,
+                         float _22,
+                         float _23,
+                         float _24,
+                         float _31,
+                         float _32,
+                         float _33,
+                         float _34)
+    {
+        m_11 = _11, m_12 = _12, m_13 = _13, m_14 = _14;
+        m_21 = _21, m_22 = _22, m_23 = _23, m_24 = _24;
+        m_31 = _31, m_32 = _32, m_33 = _33, m_34 = _34;
+    }
+
+    Matrix3x4::Matrix3x4(const Matrix4x4 &_matrix)
+    {
+        m_11 = _matrix.m_11, m_12 = _matrix.m_21, m_13 = _matrix.m_31, m_14 = _matrix.m_41;
+        m_21 = _matrix.m_12, m_22 = _matrix.m_22, m_23 = _matrix.m_32, m_24 = _matrix.m_42;
+        m_31 = _matrix.m_13, m_32 = _matrix.m_23, m_33 = _matrix.m_33, m_34 = _matrix.m_43;
+    }
+
+
+    // Standard matrix functions
+    void Matrix3x4::SetIdentity()
+    {
+        m_11 = 1.f, m_12 = 0.f, m_13 = 0.f, m_14 = 0.f;
+        m_21 = 0.f, m_22 = 1.f, m_23 = 0.f, m_24 = 0.f;
+        m_31 = 0.f, m_32 = 0.f, m_33 = 1.f, m_34 = 0.f;
+    }
+
+    void Matrix3x4::SetTRS(const Vector3 &_translation, const Quaternion &_rotation, const Vector3 &_scale)
+    {
+        float x = _rotation.x, y = _rotation.y, z = _rotation.z, w = _rotation.w;
+
+        m_11 = (1.f - 2.f * (y * y + z * z)) * _scale.x;
+        m_12 = (2.f * (x * y - w * z)) * _scale.y;
+        m_13 = (2.f * (x * z + w * y)) * _scale.z;
+        m_14 = _translation.x;
+
+        m_21 = (2.f * (x * y + w * z)) * _scale.x;
+        m_22 = (1.f - 2.f * (x * x + z * z)) * _scale.y;
+        m_23 = (2.f * (y * z - w * x)) * _scale.z;
+        m_24 = _translation.y;
+
+        m_31 = (2.f * (x * z - w * y)) * _scale.x;
+        m_32 = (2.f * (y * z + w * x)) * _scale.y;
+        m_33 = (1.f - 2.f * (x * x + y * y)) * _scale.z;
+        m_34 = _translation.z;
+    }
+
+    void Matrix3x4::Decompose(Vector3 &_translation, Quaternion &_rotation, Vector3 &_scale) const
+    {
+        _translation = Vector3(m_14, m_24, m_34);
+
+        _scale = Vector3(std::sqrt(m_11 * m_11 + m_21 * m_21 + m_31 * m_31),
+                         std::sqrt(m_12 * m_12 + m_22 * m_22 + m_32 * m_32),
+                         std::sqrt(m_13 * m_13 + m_23 * m_23 + m_33 * m_33));
+
+        // A mirroring transform flips one axis
+        float determinant = m_11 * (m_22 * m_33 - m_23 * m_32) - m_12 * (m_21 * m_33 - m_23 * m_31)
+                            + m_13 * (m_21 * m_32 - m_22 * m_31);
+        if (determinant < 0.f) {
+            _scale.x = -_scale.x;
+        }
+
+        float invX = _scale.x != 0.f ? 1.f / _scale.x : 0.f;
+        float invY = _scale.y != 0.f ? 1.f / _scale.y : 0.f;
+        float invZ = _scale.z != 0.f ? 1.f / _scale.z : 0.f;
+
+        float r11 = m_11 * invX, r12 = m_12 * invY, r13 = m_13 * invZ;
+        float r21 = m_21 * invX, r22 = m_22 * invY, r23 = m_23 * invZ;
+        float r31 = m_31 * invX, r32 = m_32 * invY, r33 = m_33 * invZ;
+
+        // Divides by the largest component to stay accurate
+        float trace = r11 + r22 + r33;
+        if (trace > 0.f) {
+            float s   = std::sqrt(trace + 1.f) * 2.f;
+            _rotation = Quaternion(0.25f * s, (r32 - r23) / s, (r13 - r31) / s, (r21 - r12) / s);
+        }
+        else if (r11 > r22 && r11 > r33) {
+            float s   = std::sqrt(1.f + r11 - r22 - r33) * 2.f;
+            _rotation = Quaternion((r32 - r23) / s, 0.25f * s, (r12 + r21) / s, (r13 + r31) / s);
+        }
+        else if (r22 > r33) {
+            float s   = std::sqrt(1.f + r22 - r11 - r33) * 2.f;
+            _rotation = Quaternion((r13 - r31) / s, (r12 + r21) / s, 0.25f * s, (r23 + r32) / s);
+        }
+        else {
+            float s   = std::sqrt(1.f + r33 - r11 - r22) * 2.f;
+            _rotation = Quaternion((r21 - r12) / s, (r13 + r31) / s, (r23 + r32) / s, 0.25f * s);
+        }
+    }
+
+    Vector3 Matrix3x4::TransformPoint(const Vector3 &_point) const
+    {
+        return Vector3(m_11 * _point.x + m_12 * _point.y + m_13 * _point.z + m_14,
+                       m_21 * _point.x + m_22 * _point.y + m_23 * _point.z + m_24,
+                       m_31 * _point.x + m_32 * _point.y + m_33 * _point.z + m_34);
+    }
+
+    Vector3 Matrix3x4::TransformVector(const Vector3 &_vector) const
+    {
+        return Vector3(m_11 * _vector.x + m_12 * _vector.y + m_13 * _vector.z,
+                       m_21 * _vector.x + m_22 * _vector.y + m_23 * _vector.z,
+                       m_31 * _vector.x + m_32 * _vector.y + m_33 * _vector.z);
+    }
+
+    Matrix4x4 Matrix3x4::GetMatrix4x4() const
+    {
+        return Matrix4x4(m_11, m_21, m_31, 0.f,
+                         m_12, m_22, m_32, 0.f,
+                         m_13, m_23, m_33, 0.f,
+                         m_14, m_24, m_34, 1.f);
+    }
+
+
+    // Binary math operators
+    Matrix3x4 Matrix3x4::operator*(const Matrix3x4 &_matrix) const
+    {
+        Matrix3x4 result;
+
+        result.m_11 = m_11 * _matrix.m_11 + m_12 * _matrix.m_21 + m_13 * _matrix.m_31;
+        result.m_12 = m_11 * _matrix.m_12 + m_12 * _matrix.m_22 + m_13 * _matrix.m_32;
+        result.m_13 = m_11 * _matrix.m_13 + m_12 * _matrix.m_23 + m_13 * _matrix.m_33;
+        result.m_14 = m_11 * _matrix.m_14 + m_12 * _matrix.m_24 + m_13 * _matrix.m_34 + m_14;
+
+        result.m_21 = m_21 * _matrix.m_11 + m_22 * _matrix.m_21 + m_23 * _matrix.m_31;
+        result.m_22 = m_21 * _matrix.m_12 + m_22 * _matrix.m_22 + m_23 * _matrix.m_32;
+        result.m_23 = m_21 * _matrix.m_13 + m_22 * _matrix.m_23 + m_23 * _matrix.m_33;
+        result.m_24 = m_21 * _matrix.m_14 + m_22 * _matrix.m_24 + m_23 * _matrix.m_34 + m_24;
+
+        result.m_31 = m_31 * _matrix.m_11 + m_32 * _matrix.m_21 + m_33 * _matrix.m_31;
+        result.m_32 = m_31 * _matrix.m_12 + m_32 * _matrix.m_22 + m_33 * _matrix.m_32;
+        result.m_33 = m_31 * _matrix.m_13 + m_32 * _matrix.m_23 + m_33 * _matrix.m_33;
+        result.m_34 = m_31 * _matrix.m_14 + m_32 * _matrix.m_24 + m_33 * _matrix.m_34 + m_34;
+
+        return result;
+    }
+} // namespace DadEngine
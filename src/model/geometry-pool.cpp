@@ -0,0 +1,270 @@
+#include "geometry-pool.hpp"
+
+#include <algorithm>
+
+#include "model.hpp"
+
+namespace DadEngine
+{
+    RangeAllocator::RangeAllocator(uint32_t _capacity)
+        : m_capacity(_capacity), m_freeRanges({ { 0, _capacity } })
+    {
+    }
+
+    GeometryRange RangeAllocator::Allocate(uint32_t _size)
+    {
+        if (_size == 0)
+        {
+            return {};
+        }
+
+        auto best = m_freeRanges.end();
+        for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); ++it)
+        {
+            if (it->size >= _size && (best == m_freeRanges.end() || it->size < best->size))
+            {
+                best = it;
+
+                if (it->size == _size)
+                {
+                    break;
+                }
+            }
+        }
+
+        if (best == m_freeRanges.end())
+        {
+            return {};
+        }
+
+        GeometryRange range { best->offset, _size };
+
+        best->offset += _size;
+        best->size -= _size;
+
+        if (best->size == 0)
+        {
+            m_freeRanges.erase(best);
+        }
+
+        return range;
+    }
+
+    void RangeAllocator::Free(GeometryRange _range)
+    {
+        if (!_range.IsValid())
+        {
+            return;
+        }
+
+        auto next = std::lower_bound(m_freeRanges.begin(), m_freeRanges.end(), _range,
+                                     [](const GeometryRange &_a, const GeometryRange &_b) {
+                                         return _a.offset < _b.offset;
+                                     });
+
+        auto inserted = m_freeRanges.insert(next, _range);
+
+        // Merge with the following range
+        auto following = inserted + 1;
+        if (following != m_freeRanges.end()
+            && inserted->offset + inserted->size == following->offset)
+        {
+            inserted->size += following->size;
+            m_freeRanges.erase(following);
+        }
+
+        // Merge with the preceding range
+        if (inserted != m_freeRanges.begin())
+        {
+            auto preceding = inserted - 1;
+            if (preceding->offset + preceding->size == inserted->offset)
+            {
+                preceding->size += inserted->size;
+                m_freeRanges.erase(inserted);
+            }
+        }
+    }
+
+    void RangeAllocator::Grow(uint32_t _capacity)
+    {
+        if (_capacity <= m_capacity)
+        {
+            return;
+        }
+
+        Free({ m_capacity, _capacity - m_capacity });
+        m_capacity = _capacity;
+    }
+
+    uint32_t RangeAllocator::GetFreeSize() const
+    {
+        uint32_t freeSize = 0;
+        for (const auto &range : m_freeRanges)
+        {
+            freeSize += range.size;
+        }
+
+        return freeSize;
+    }
+
+
+    GeometryPool::GeometryPool(uint32_t _vertexCapacity, uint32_t _indexCapacity)
+        : m_vertices(_vertexCapacity), m_indices(_indexCapacity)
+    {
+#if defined(OPENGL)
+        glGenVertexArrays(1, &vertexArrayID);
+        glBindVertexArray(vertexArrayID);
+
+        glGenBuffers(1, &vertexBufferID);
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
+        glBufferData(GL_ARRAY_BUFFER,
+                     static_cast<GLsizeiptr>(_vertexCapacity * sizeof(Vertex)),
+                     nullptr, GL_STATIC_DRAW);
+
+        VertexBuffer::SetupVertexLayout();
+
+        // The element buffer binding is part of the vertex array state
+        glGenBuffers(1, &elementBufferID);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBufferID);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                     static_cast<GLsizeiptr>(_indexCapacity * sizeof(uint32_t)),
+                     nullptr, GL_STATIC_DRAW);
+
+        glBindVertexArray(0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+#elif defined(_VULKAN)
+#endif
+    }
+
+    GeometryPool::~GeometryPool()
+    {
+#if defined(OPENGL)
+        glDeleteBuffers(1, &vertexBufferID);
+        glDeleteBuffers(1, &elementBufferID);
+        glDeleteVertexArrays(1, &vertexArrayID);
+#elif defined(_VULKAN)
+#endif
+    }
+
+    GeometryRange GeometryPool::AllocateVertices(const std::vector<Vertex> &_vertices)
+    {
+        auto count          = static_cast<uint32_t>(_vertices.size());
+        GeometryRange range = m_vertices.Allocate(count);
+
+        if (!range.IsValid() && count != 0)
+        {
+            growVertices(m_vertices.GetCapacity() + count);
+            range = m_vertices.Allocate(count);
+        }
+
+#if defined(OPENGL)
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
+        glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(range.offset * sizeof(Vertex)),
+                        static_cast<GLsizeiptr>(count * sizeof(Vertex)), _vertices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+#elif defined(_VULKAN)
+#endif
+
+        return range;
+    }
+
+    GeometryRange GeometryPool::AllocateIndices(const std::vector<uint32_t> &_indices)
+    {
+        auto count          = static_cast<uint32_t>(_indices.size());
+        GeometryRange range = m_indices.Allocate(count);
+
+        if (!range.IsValid() && count != 0)
+        {
+            growIndices(m_indices.GetCapacity() + count);
+            range = m_indices.Allocate(count);
+        }
+
+#if defined(OPENGL)
+        // Upload through the copy binding to leave the vertex array state alone
+        glBindBuffer(GL_COPY_WRITE_BUFFER, elementBufferID);
+        glBufferSubData(GL_COPY_WRITE_BUFFER,
+                        static_cast<GLintptr>(range.offset * sizeof(uint32_t)),
+                        static_cast<GLsizeiptr>(count * sizeof(uint32_t)), _indices.data());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+#elif defined(_VULKAN)
+#endif
+
+        return range;
+    }
+
+    void GeometryPool::FreeVertices(GeometryRange _range)
+    {
+        m_vertices.Free(_range);
+    }
+
+    void GeometryPool::FreeIndices(GeometryRange _range)
+    {
+        m_indices.Free(_range);
+    }
+
+    void GeometryPool::growVertices(uint32_t _minimumCapacity)
+    {
+        uint32_t oldCapacity = m_vertices.GetCapacity();
+        uint32_t capacity    = std::max(oldCapacity * 2, _minimumCapacity);
+
+#if defined(OPENGL)
+        GLuint bufferID = 0;
+        glGenBuffers(1, &bufferID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(Vertex)),
+                     nullptr, GL_STATIC_DRAW);
+
+        glBindBuffer(GL_COPY_READ_BUFFER, vertexBufferID);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                            static_cast<GLsizeiptr>(oldCapacity * sizeof(Vertex)));
+
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        glDeleteBuffers(1, &vertexBufferID);
+        vertexBufferID = bufferID;
+
+        // Attribute pointers capture the buffer they were set with
+        glBindVertexArray(vertexArrayID);
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
+        VertexBuffer::SetupVertexLayout();
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+#elif defined(_VULKAN)
+#endif
+
+        m_vertices.Grow(capacity);
+    }
+
+    void GeometryPool::growIndices(uint32_t _minimumCapacity)
+    {
+        uint32_t oldCapacity = m_indices.GetCapacity();
+        uint32_t capacity    = std::max(oldCapacity * 2, _minimumCapacity);
+
+#if defined(OPENGL)
+        GLuint bufferID = 0;
+        glGenBuffers(1, &bufferID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(uint32_t)),
+                     nullptr, GL_STATIC_DRAW);
+
+        glBindBuffer(GL_COPY_READ_BUFFER, elementBufferID);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                            static_cast<GLsizeiptr>(oldCapacity * sizeof(uint32_t)));
+
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        glDeleteBuffers(1, &elementBufferID);
+        elementBufferID = bufferID;
+
+        glBindVertexArray(vertexArrayID);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBufferID);
+        glBindVertexArray(0);
+#elif defined(_VULKAN)
+#endif
+
+        m_indices.Grow(capacity);
+    }
+} // namespace DadEngine
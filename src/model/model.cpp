@@ -1,9 +1,14 @@
 #include "model.hpp"
 
+#include <algorithm>
+#include <utility>
+
 namespace DadEngine
 {
-    VertexBuffer::VertexBuffer(std::vector<Vertex> &&_vertices)
-        : vertices(_vertices)
+    constexpr uint32_t TRIANGLES_MODE = 4U; // Same value for glTF and OpenGL
+
+    VertexBuffer::VertexBuffer(std::vector<Vertex> &&_vertices, [[maybe_unused]] bool _dynamic)
+        : vertices(std::move(_vertices)), vertexCount(static_cast<uint32_t>(vertices.size()))
     {
 #if defined(OPENGL)
         glGenVertexArrays(1, &vertexArrayID);
@@ -14,8 +19,66 @@ namespace DadEngine
 
         glBufferData(GL_ARRAY_BUFFER,
                      static_cast<GLsizei>(vertices.size() * sizeof(Vertex)),
-                     vertices.data(), GL_STATIC_DRAW);
+                     vertices.data(), _dynamic ? GL_STREAM_DRAW : GL_STATIC_DRAW);
+
+        SetupVertexLayout();
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glBindVertexArray(0);
+#elif defined(_VULKAN)
+#endif
+    }
+
+    VertexBuffer::VertexBuffer(std::vector<Vertex> &&_vertices, GeometryPool &_pool)
+        : vertices(std::move(_vertices)), vertexCount(static_cast<uint32_t>(vertices.size())), pool(&_pool)
+    {
+        range = pool->AllocateVertices(vertices);
+
+#if defined(OPENGL)
+        vertexArrayID  = pool->vertexArrayID;
+        vertexBufferID = pool->vertexBufferID;
+#elif defined(_VULKAN)
+#endif
+    }
+
+    VertexBuffer::VertexBuffer(VertexBuffer &&_vertexBuffer) noexcept
+    {
+        *this = std::move(_vertexBuffer);
+    }
 
+    VertexBuffer &VertexBuffer::operator=(VertexBuffer &&_vertexBuffer) noexcept
+    {
+        if (this == &_vertexBuffer)
+        {
+            return *this;
+        }
+
+        Release();
+
+#if defined(OPENGL)
+        vertexArrayID  = std::exchange(_vertexBuffer.vertexArrayID, 0);
+        vertexBufferID = std::exchange(_vertexBuffer.vertexBufferID, 0);
+        skinBufferID   = std::exchange(_vertexBuffer.skinBufferID, 0);
+#elif defined(_VULKAN)
+#endif
+        vertices     = std::move(_vertexBuffer.vertices);
+        skinVertices = std::move(_vertexBuffer.skinVertices);
+        vertexCount  = std::exchange(_vertexBuffer.vertexCount, 0U);
+        pool         = std::exchange(_vertexBuffer.pool, nullptr);
+        range        = std::exchange(_vertexBuffer.range, {});
+
+        return *this;
+    }
+
+    VertexBuffer::~VertexBuffer()
+    {
+        Release();
+    }
+
+    void VertexBuffer::SetupVertexLayout()
+    {
+#if defined(OPENGL)
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
         glEnableVertexAttribArray(0);
 
@@ -30,9 +93,97 @@ namespace DadEngine
         glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
                               reinterpret_cast<void *>(offsetof(Vertex, uv0)));
         glEnableVertexAttribArray(3);
+#elif defined(_VULKAN)
+#endif
+    }
 
+    void VertexBuffer::Release()
+    {
+        // The pool keeps its buffers for the other primitives
+        if (pool)
+        {
+            pool->FreeVertices(range);
+            pool  = nullptr;
+            range = {};
+        }
+        else
+        {
+#if defined(OPENGL)
+            if (vertexArrayID != 0)
+            {
+                glDeleteBuffers(1, &vertexBufferID);
+                glDeleteVertexArrays(1, &vertexArrayID);
+            }
+
+            if (skinBufferID != 0)
+            {
+                glDeleteBuffers(1, &skinBufferID);
+            }
+#elif defined(_VULKAN)
+#endif
+        }
+
+#if defined(OPENGL)
+        vertexBufferID = 0;
+        vertexArrayID  = 0;
+        skinBufferID   = 0;
+#elif defined(_VULKAN)
+#endif
+    }
+
+    void VertexBuffer::ReleaseCPUData()
+    {
+        // clear() would keep the capacity
+        std::vector<Vertex>().swap(vertices);
+        std::vector<SkinVertex>().swap(skinVertices);
+    }
+
+    void VertexBuffer::Upload()
+    {
+#if defined(OPENGL)
+        if (pool)
+        {
+            return;
+        }
+
+        auto size = static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex));
+
+        // Orphaning the storage spares waiting on the draws still reading it
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
+        glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices.data());
         glBindBuffer(GL_ARRAY_BUFFER, 0);
+#elif defined(_VULKAN)
+#endif
+    }
+
+    void VertexBuffer::SetSkin(std::vector<SkinVertex> &&_skinVertices)
+    {
+        if (pool || _skinVertices.size() != vertexCount)
+        {
+            return;
+        }
+
+        skinVertices = std::move(_skinVertices);
+
+#if defined(OPENGL)
+        glBindVertexArray(vertexArrayID);
+
+        glGenBuffers(1, &skinBufferID);
+        glBindBuffer(GL_ARRAY_BUFFER, skinBufferID);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(skinVertices.size() * sizeof(SkinVertex)),
+                     skinVertices.data(), GL_STATIC_DRAW);
+
+        // Location 4 is the second UV set of the shaders
+        glVertexAttribIPointer(5, 4, GL_UNSIGNED_SHORT, sizeof(SkinVertex),
+                               reinterpret_cast<void *>(offsetof(SkinVertex, joints)));
+        glEnableVertexAttribArray(5);
+
+        glVertexAttribPointer(6, 4, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(SkinVertex),
+                              reinterpret_cast<void *>(offsetof(SkinVertex, weights)));
+        glEnableVertexAttribArray(6);
 
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
 #elif defined(_VULKAN)
 #endif
@@ -40,7 +191,7 @@ namespace DadEngine
 
 
     IndexBuffer::IndexBuffer(std::vector<uint32_t> &&_indices)
-        : indices(_indices)
+        : indices(std::move(_indices)), indexCount(static_cast<uint32_t>(indices.size()))
     {
 #if defined(OPENGL)
         glGenBuffers(1, &elementBufferID);
@@ -55,9 +206,130 @@ namespace DadEngine
 #endif
     }
 
-    Texture::Texture(uint8_t *_data, int32_t _width, int32_t _height, int32_t _channels, Sampler _sampler, bool _hasAlpha)
-        : sampler(_sampler), data(_data), width(_width), height(_height),
-          channels(_channels), hasAlpha(_hasAlpha)
+    IndexBuffer::IndexBuffer(std::vector<uint32_t> &&_indices, GeometryPool &_pool)
+        : indices(std::move(_indices)), indexCount(static_cast<uint32_t>(indices.size())), pool(&_pool)
+    {
+        range = pool->AllocateIndices(indices);
+
+#if defined(OPENGL)
+        elementBufferID = pool->elementBufferID;
+#elif defined(_VULKAN)
+#endif
+    }
+
+    IndexBuffer::IndexBuffer(IndexBuffer &&_indexBuffer) noexcept
+    {
+        *this = std::move(_indexBuffer);
+    }
+
+    IndexBuffer &IndexBuffer::operator=(IndexBuffer &&_indexBuffer) noexcept
+    {
+        if (this == &_indexBuffer)
+        {
+            return *this;
+        }
+
+        Release();
+
+#if defined(OPENGL)
+        elementBufferID = std::exchange(_indexBuffer.elementBufferID, 0);
+#elif defined(_VULKAN)
+#endif
+        indices    = std::move(_indexBuffer.indices);
+        indexCount = std::exchange(_indexBuffer.indexCount, 0U);
+        pool       = std::exchange(_indexBuffer.pool, nullptr);
+        range      = std::exchange(_indexBuffer.range, {});
+
+        return *this;
+    }
+
+    IndexBuffer::~IndexBuffer()
+    {
+        Release();
+    }
+
+    void IndexBuffer::Release()
+    {
+        if (pool)
+        {
+            pool->FreeIndices(range);
+            pool  = nullptr;
+            range = {};
+        }
+        else
+        {
+#if defined(OPENGL)
+            if (elementBufferID != 0)
+            {
+                glDeleteBuffers(1, &elementBufferID);
+            }
+#elif defined(_VULKAN)
+#endif
+        }
+
+#if defined(OPENGL)
+        elementBufferID = 0;
+#elif defined(_VULKAN)
+#endif
+    }
+
+    void IndexBuffer::ReleaseCPUData()
+    {
+        std::vector<uint32_t>().swap(indices);
+    }
+
+    bool IsBlockCompressed(TextureFormat _format)
+    {
+        return _format != TextureFormat::RGB8 && _format != TextureFormat::RGBA8;
+    }
+
+    size_t GetTextureLevelSize(TextureFormat _format, int32_t _width, int32_t _height)
+    {
+        auto width  = static_cast<size_t>(_width);
+        auto height = static_cast<size_t>(_height);
+
+        switch (_format)
+        {
+        case TextureFormat::RGB8:
+            return width * height * 3U;
+        case TextureFormat::RGBA8:
+            return width * height * 4U;
+        default:
+            break;
+        }
+
+        size_t blockCount = std::max<size_t>((width + 3U) / 4U, 1U)
+                            * std::max<size_t>((height + 3U) / 4U, 1U);
+        bool halfBlocks = _format == TextureFormat::BC1 || _format == TextureFormat::BC4;
+
+        return blockCount * (halfBlocks ? 8U : 16U);
+    }
+
+#if defined(OPENGL)
+    // sRGB content keeps the linear formats, the shaders convert it
+    inline GLenum GetCompressedInternalFormat(TextureFormat _format)
+    {
+        switch (_format)
+        {
+        case TextureFormat::BC1:
+            return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        case TextureFormat::BC3:
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case TextureFormat::BC4:
+            return GL_COMPRESSED_RED_RGTC1;
+        case TextureFormat::BC5:
+            return GL_COMPRESSED_RG_RGTC2;
+        default:
+            return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        }
+    }
+#endif
+
+    Texture::Texture([[maybe_unused]] const uint8_t *_data, int32_t _width, int32_t _height, int32_t _channels,
+                     Sampler _sampler, bool _hasAlpha)
+        : sampler(_sampler), width(_width), height(_height),
+          channels(_channels), hasAlpha(_hasAlpha),
+          format(_hasAlpha ? TextureFormat::RGBA8 : TextureFormat::RGB8)
     {
 #if defined(OPENGL)
         glGenTextures(1, &textureID);
@@ -69,7 +341,7 @@ namespace DadEngine
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, sampler.magFilter);
 
         glTexImage2D(GL_TEXTURE_2D, 0, hasAlpha ? GL_RGBA : GL_RGB, width, height,
-                     0, hasAlpha ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, data);
+                     0, hasAlpha ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, _data);
 
         glGenerateMipmap(GL_TEXTURE_2D);
 
@@ -78,50 +350,269 @@ namespace DadEngine
 #endif
     }
 
+#if defined(OPENGL)
+    // Rows of the small RGB mips are not 4 bytes aligned, the caller resets
+    // the unpack alignment once done
+    inline void UploadTextureLevel(TextureFormat _format, uint32_t _level, const TextureLevel &_textureLevel)
+    {
+        if (IsBlockCompressed(_format))
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(_level),
+                                   GetCompressedInternalFormat(_format), _textureLevel.width,
+                                   _textureLevel.height, 0,
+                                   static_cast<GLsizei>(_textureLevel.size), _textureLevel.data);
+        }
+        else
+        {
+            GLenum layout = _format == TextureFormat::RGBA8 ? GL_RGBA : GL_RGB;
+            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(_level), static_cast<GLint>(layout),
+                         _textureLevel.width, _textureLevel.height, 0, layout,
+                         GL_UNSIGNED_BYTE, _textureLevel.data);
+        }
+    }
+#endif
+
+    Texture::Texture(TextureFormat _format, const std::vector<TextureLevel> &_levels, Sampler _sampler, bool _hasAlpha,
+                     uint32_t _firstLevel)
+        : sampler(_sampler), width(_levels[0].width), height(_levels[0].height),
+          channels(_hasAlpha ? 4 : 3), hasAlpha(_hasAlpha), format(_format),
+          levelCount(static_cast<uint32_t>(_levels.size())),
+          residentLevel(std::min(_firstLevel, static_cast<uint32_t>(_levels.size()) - 1U))
+    {
+#if defined(OPENGL)
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, sampler.wrapS);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, sampler.wrapT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, sampler.minFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, sampler.magFilter);
+
+        // A lone uncompressed level gets its mips generated like the pixels
+        // constructor, a partial chain otherwise stays complete for
+        // mipmapped filters. The levels before the base one are never
+        // sampled so they do not need to be specified
+        bool generateMips = levelCount == 1U && !IsBlockCompressed(format);
+        if (!generateMips)
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(residentLevel));
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levelCount - 1U));
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        for (uint32_t level = residentLevel; level < levelCount; level++)
+        {
+            UploadTextureLevel(format, level, _levels[level]);
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        if (generateMips)
+        {
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+#elif defined(_VULKAN)
+#endif
+    }
+
+    Texture::~Texture()
+    {
+#if defined(OPENGL)
+        glDeleteTextures(1, &textureID);
+#elif defined(_VULKAN)
+#endif
+    }
+
+    void Texture::UploadLevel([[maybe_unused]] const TextureLevel &_level)
+    {
+        if (residentLevel == 0U)
+        {
+            return;
+        }
+
+        residentLevel--;
+
+#if defined(OPENGL)
+        glBindTexture(GL_TEXTURE_2D, textureID);
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        UploadTextureLevel(format, residentLevel, _level);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        // Only sampled once complete
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(residentLevel));
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+#elif defined(_VULKAN)
+#endif
+    }
+
+    void Texture::ReleaseLevel()
+    {
+        if (residentLevel + 1U >= levelCount)
+        {
+            return;
+        }
+
+        residentLevel++;
+
+#if defined(OPENGL)
+        auto level = static_cast<GLint>(residentLevel - 1U);
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(residentLevel));
+
+        // Respecifying the level as empty gives its memory back
+        if (IsBlockCompressed(format))
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, GetCompressedInternalFormat(format), 0, 0, 0, 0,
+                                   nullptr);
+        }
+        else
+        {
+            GLenum layout = format == TextureFormat::RGBA8 ? GL_RGBA : GL_RGB;
+            glTexImage2D(GL_TEXTURE_2D, level, static_cast<GLint>(layout), 0, 0, 0, layout,
+                         GL_UNSIGNED_BYTE, nullptr);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+#elif defined(_VULKAN)
+#endif
+    }
+
+    size_t Texture::GetResidentSize() const
+    {
+        size_t size = 0;
+        for (uint32_t level = residentLevel; level < levelCount; level++)
+        {
+            size += GetTextureLevelSize(format, std::max(width >> level, 1), std::max(height >> level, 1));
+        }
+
+        return size;
+    }
+
+#if defined(OPENGL)
+    // Unset material slots bind no texture
+    inline GLuint GetTextureID(const std::shared_ptr<Texture> &_texture)
+    {
+        return _texture ? _texture->textureID : 0;
+    }
+#endif
 
     void Primitive::Render()
     {
 #if defined(OPENGL)
         glBindVertexArray(vertices.vertexArrayID);
 
+        Draw();
+
+        glBindVertexArray(0);
+#elif defined(_VULKAN)
+#endif
+    }
+
+    void Primitive::Draw()
+    {
+#if defined(OPENGL)
         glUniform4fv(0, 1, reinterpret_cast<float *>(&material.baseColorFactor));
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, material.baseColorTexture.textureID);
+        glBindTexture(GL_TEXTURE_2D, GetTextureID(material.baseColorTexture));
         glUniform1i(1, 0);
 
         glUniform1f(3, material.metallicFactor);
         glUniform1f(9, material.roughnessFactor);
         glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, material.metallicRoughnessTexture.textureID);
+        glBindTexture(GL_TEXTURE_2D, GetTextureID(material.metallicRoughnessTexture));
         glUniform1i(4, 1);
 
         glUniform1f(6, material.normalScale);
         glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, material.normalTexture.textureID);
+        glBindTexture(GL_TEXTURE_2D, GetTextureID(material.normalTexture));
         glUniform1i(7, 2);
 
         // glUniform1f(8, material.occlusionStrength);
         // glActiveTexture(GL_TEXTURE3);
-        // glBindTexture(GL_TEXTURE_2D, material.occlusionTexture.textureID);
+        // glBindTexture(GL_TEXTURE_2D, GetTextureID(material.occlusionTexture));
         // glUniform1i(9, 3);
 
         // glUniform3f(4, material.emissiveFactor.x, material.emissiveFactor.y,
         // material.emissiveFactor.z); glActiveTexture(GL_TEXTURE4); glBindTexture(GL_TEXTURE_2D,
-        // material.emissiveTexture.textureID); glUniform1i(4, 4);
+        // GetTextureID(material.emissiveTexture)); glUniform1i(4, 4);
 
-        if (indices.indices.empty())
+        auto baseVertex = static_cast<GLint>(vertices.range.offset);
+
+        if (indices.indexCount == 0U)
+        {
+            glDrawArrays(drawMode, baseVertex, static_cast<GLsizei>(vertices.vertexCount));
+        }
+        else if (indices.pool)
         {
-            glDrawArrays(drawMode, 0, static_cast<GLsizei>(vertices.vertices.size()));
+            // The pool element buffer is already bound with its vertex array
+            glDrawElementsBaseVertex(
+                drawMode, static_cast<GLsizei>(indices.indexCount), GL_UNSIGNED_INT,
+                reinterpret_cast<void *>(indices.range.offset * sizeof(uint32_t)), baseVertex);
         }
         else
         {
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.elementBufferID);
 
-            glDrawElements(drawMode, static_cast<GLsizei>(indices.indices.size()),
+            glDrawElements(drawMode, static_cast<GLsizei>(indices.indexCount),
                            GL_UNSIGNED_INT, nullptr);
 
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         }
+#elif defined(_VULKAN)
+#endif
+    }
+
+    AABB ComputeBounds(const std::vector<Vertex> &_vertices)
+    {
+        AABB bounds = AABB::Empty();
+        for (const auto &vertex : _vertices)
+        {
+            bounds.Grow(vertex.position);
+        }
+
+        return bounds;
+    }
+
+    // Opaque primitives first then transparent ones, a null index list
+    // stands for every primitive
+    inline void RenderPrimitives([[maybe_unused]] std::vector<Primitive> &_primitives,
+                                 [[maybe_unused]] const std::vector<uint32_t> *_primitiveIndices)
+    {
+#if defined(OPENGL)
+        // Pooled primitives share their vertex array, only rebind on change
+        GLuint boundVertexArrayID = 0;
+        auto render               = [&](Primitive &_primitive) {
+            if (_primitive.vertices.vertexArrayID != boundVertexArrayID)
+            {
+                boundVertexArrayID = _primitive.vertices.vertexArrayID;
+                glBindVertexArray(boundVertexArrayID);
+            }
+
+            _primitive.Draw();
+        };
+
+        size_t count = _primitiveIndices ? _primitiveIndices->size() : _primitives.size();
+
+        for (bool transparentPass : { false, true })
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                Primitive &primitive
+                    = _primitives[_primitiveIndices ? (*_primitiveIndices)[i] : i];
+
+                if (primitive.material.hasTransparency == transparentPass)
+                {
+                    render(primitive);
+                }
+            }
+        }
 
         glBindVertexArray(0);
 #elif defined(_VULKAN)
@@ -130,20 +621,146 @@ namespace DadEngine
 
     void Mesh::Render()
     {
-        for (auto &primitive : m_primitives)
+        RenderPrimitives(m_primitives, nullptr);
+    }
+
+    void Mesh::Render(const std::vector<uint32_t> &_primitiveIndices)
+    {
+        RenderPrimitives(m_primitives, &_primitiveIndices);
+    }
+
+    void Mesh::Batch(GeometryPool *_pool, uint32_t _cellsPerAxis)
+    {
+        struct MaterialBatch
         {
-            if (!primitive.material.hasTransparency)
+            uint32_t materialID;
+            uint32_t cell;
+            std::vector<size_t> primitives;
+        };
+
+        std::vector<MaterialBatch> batches;
+        std::vector<Primitive> batchedPrimitives;
+
+        AABB meshBounds = AABB::Empty();
+        for (const Primitive &primitive : m_primitives)
+        {
+            meshBounds.Grow(primitive.bounds);
+        }
+
+        // Primitives go to the cell holding the center of their bounds
+        const uint32_t cellsPerAxis = std::max(_cellsPerAxis, 1U);
+
+        auto getCell = [&](const AABB &_bounds) {
+            Vector3 center    = _bounds.Center();
+            float position[3] = { center.x - meshBounds.m_min.x, center.y - meshBounds.m_min.y,
+                                  center.z - meshBounds.m_min.z };
+            float size[3]     = { meshBounds.m_max.x - meshBounds.m_min.x, meshBounds.m_max.y - meshBounds.m_min.y,
+                                  meshBounds.m_max.z - meshBounds.m_min.z };
+
+            uint32_t cell = 0U;
+            for (uint32_t axis = 0U; axis < 3U; axis++)
+            {
+                float coordinate = size[axis] > 0.f ? position[axis] / size[axis] * static_cast<float>(cellsPerAxis)
+                                                    : 0.f;
+                cell = cell * cellsPerAxis
+                       + std::min(static_cast<uint32_t>(std::max(coordinate, 0.f)), cellsPerAxis - 1U);
+            }
+
+            return cell;
+        };
+
+        for (size_t i = 0; i < m_primitives.size(); i++)
+        {
+            Primitive &primitive = m_primitives[i];
+
+            // Merging reads the vertices back from the CPU copy, skinned
+            // primitives keep their own stream
+            if (primitive.drawMode != TRIANGLES_MODE || primitive.material.id == ~0U
+                || !primitive.vertices.HasCPUData() || !primitive.indices.HasCPUData()
+                || !primitive.vertices.skinVertices.empty())
+            {
+                batchedPrimitives.push_back(std::move(primitive));
+                continue;
+            }
+
+            uint32_t cell = getCell(primitive.bounds);
+            auto batch    = std::find_if(batches.begin(), batches.end(), [&](const MaterialBatch &_batch) {
+                return _batch.materialID == primitive.material.id && _batch.cell == cell;
+            });
+
+            if (batch == batches.end())
+            {
+                batches.push_back({ primitive.material.id, cell, { i } });
+            }
+            else
             {
-                primitive.Render();
+                batch->primitives.push_back(i);
             }
         }
 
-        for (auto &primitive : m_primitives)
+        for (const auto &batch : batches)
         {
-            if (primitive.material.hasTransparency)
+            if (batch.primitives.size() == 1)
             {
-                primitive.Render();
+                batchedPrimitives.push_back(std::move(m_primitives[batch.primitives.front()]));
+                continue;
             }
+
+            std::vector<Vertex> vertices;
+            std::vector<uint32_t> indices;
+
+            for (size_t primitiveIndex : batch.primitives)
+            {
+                Primitive &primitive = m_primitives[primitiveIndex];
+                auto baseVertex      = static_cast<uint32_t>(vertices.size());
+
+                vertices.insert(vertices.end(), primitive.vertices.vertices.begin(),
+                                primitive.vertices.vertices.end());
+
+                if (primitive.indices.indices.empty())
+                {
+                    for (size_t k = 0; k < primitive.vertices.vertices.size(); k++)
+                    {
+                        indices.push_back(baseVertex + static_cast<uint32_t>(k));
+                    }
+                }
+                else
+                {
+                    for (uint32_t index : primitive.indices.indices)
+                    {
+                        indices.push_back(baseVertex + index);
+                    }
+                }
+
+                primitive.vertices.Release();
+                primitive.indices.Release();
+            }
+
+            const Primitive &first = m_primitives[batch.primitives.front()];
+
+            if (_pool)
+            {
+                batchedPrimitives.emplace_back(VertexBuffer(std::move(vertices), *_pool),
+                                               IndexBuffer(std::move(indices), *_pool),
+                                               first.drawMode, first.material);
+            }
+            else
+            {
+                batchedPrimitives.emplace_back(VertexBuffer(std::move(vertices)),
+                                               IndexBuffer(std::move(indices)),
+                                               first.drawMode, first.material);
+            }
+        }
+
+        m_primitives = std::move(batchedPrimitives);
+    }
+
+    void Mesh::ReleaseCPUData()
+    {
+        for (Primitive &primitive : m_primitives)
+        {
+            primitive.vertices.ReleaseCPUData();
+            primitive.indices.ReleaseCPUData();
         }
     }
 } // namespace DadEngine
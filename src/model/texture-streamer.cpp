@@ -0,0 +1,407 @@
+#include "texture-streamer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "camera/camera.hpp"
+#include "math/matrix/matrix4x4.hpp"
+
+namespace DadEngine
+{
+    constexpr uint32_t TRIANGLES_MODE = 4U; // Same value for glTF and OpenGL
+
+    std::vector<float> ComputeUVDensities(const Mesh &_mesh)
+    {
+        std::vector<float> densities(_mesh.m_primitives.size(), 0.f);
+
+        for (size_t p = 0; p < _mesh.m_primitives.size(); p++)
+        {
+            const Primitive &primitive = _mesh.m_primitives[p];
+            if (primitive.drawMode != TRIANGLES_MODE)
+            {
+                continue;
+            }
+
+            const std::vector<Vertex> &vertices  = primitive.vertices.vertices;
+            const std::vector<uint32_t> &indices = primitive.indices.indices;
+            size_t indexCount = indices.empty() ? vertices.size() : indices.size();
+
+            // Summed in double, batched primitives hold many triangles
+            double worldArea = 0.0;
+            double uvArea    = 0.0;
+            for (size_t i = 0; i + 2 < indexCount; i += 3)
+            {
+                const Vertex &v0 = vertices[indices.empty() ? i : indices[i]];
+                const Vertex &v1 = vertices[indices.empty() ? i + 1 : indices[i + 1]];
+                const Vertex &v2 = vertices[indices.empty() ? i + 2 : indices[i + 2]];
+
+                Vector3 origin = v0.position;
+                Vector3 edge1  = v1.position - origin;
+                Vector3 edge2  = v2.position - origin;
+                worldArea += (edge1 ^ edge2).Length() * 0.5f;
+
+                float u1 = v1.uv0.x - v0.uv0.x;
+                float t1 = v1.uv0.y - v0.uv0.y;
+                float u2 = v2.uv0.x - v0.uv0.x;
+                float t2 = v2.uv0.y - v0.uv0.y;
+                uvArea += std::abs(u1 * t2 - u2 * t1) * 0.5f;
+            }
+
+            if (uvArea > 0.0)
+            {
+                densities[p] = static_cast<float>(std::sqrt(worldArea / uvArea));
+            }
+        }
+
+        return densities;
+    }
+
+    // Distance from the point to the closest point of the box, 0 inside
+    inline float GetDistance(const AABB &_box, const Vector3 &_point)
+    {
+        float dx = std::max({ _box.m_min.x - _point.x, 0.f, _point.x - _box.m_max.x });
+        float dy = std::max({ _box.m_min.y - _point.y, 0.f, _point.y - _box.m_max.y });
+        float dz = std::max({ _box.m_min.z - _point.z, 0.f, _point.z - _box.m_max.z });
+
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    inline AABB TransformBounds(const AABB &_bounds, const Matrix4x4 &_matrix)
+    {
+        AABB bounds = AABB::Empty();
+        for (uint32_t corner = 0; corner < 8U; corner++)
+        {
+            Vector3 point((corner & 1U) ? _bounds.m_max.x : _bounds.m_min.x,
+                          (corner & 2U) ? _bounds.m_max.y : _bounds.m_min.y,
+                          (corner & 4U) ? _bounds.m_max.z : _bounds.m_min.z);
+
+            bounds.Grow(Vector3(
+                _matrix.m_11 * point.x + _matrix.m_21 * point.y + _matrix.m_31 * point.z + _matrix.m_41,
+                _matrix.m_12 * point.x + _matrix.m_22 * point.y + _matrix.m_32 * point.z + _matrix.m_42,
+                _matrix.m_13 * point.x + _matrix.m_23 * point.y + _matrix.m_33 * point.z + _matrix.m_43));
+        }
+
+        return bounds;
+    }
+
+    void TextureStreamer::SetSettings(const TextureStreamingSettings &_settings)
+    {
+        m_settings = _settings;
+
+        if (IsEnabled())
+        {
+            makeRoom(0U);
+        }
+    }
+
+    std::shared_ptr<Texture> TextureStreamer::CreateTexture(TextureFormat _format,
+                                                            const std::vector<TextureLevel> &_levels,
+                                                            Sampler _sampler,
+                                                            bool _hasAlpha,
+                                                            std::shared_ptr<const void> _owner)
+    {
+        // A lone uncompressed level gets its mips generated on the GPU
+        if (!IsEnabled() || _levels.size() < 2U)
+        {
+            return std::make_shared<Texture>(_format, _levels, _sampler, _hasAlpha);
+        }
+
+        auto tailLevel = static_cast<uint32_t>(_levels.size()) - 1U;
+        for (uint32_t level = 0; level < _levels.size(); level++)
+        {
+            if (std::max(_levels[level].width, _levels[level].height) <= m_settings.initialSize)
+            {
+                tailLevel = level;
+                break;
+            }
+        }
+
+        auto texture = std::make_shared<Texture>(_format, _levels, _sampler, _hasAlpha, tailLevel);
+
+        // The tail always stays on the GPU, only the larger levels are kept
+        StreamedTexture streamed;
+        streamed.texture = texture;
+        streamed.levels.assign(_levels.begin(), _levels.begin() + tailLevel);
+        streamed.owner   = std::move(_owner);
+
+        if (!streamed.owner)
+        {
+            size_t size = 0;
+            for (const TextureLevel &level : streamed.levels)
+            {
+                size += level.size;
+            }
+
+            auto storage  = std::make_shared<std::vector<uint8_t>>(size);
+            uint8_t *data = storage->data();
+            for (TextureLevel &level : streamed.levels)
+            {
+                std::memcpy(data, level.data, level.size);
+                level.data = data;
+                data += level.size;
+            }
+
+            streamed.owner = std::move(storage);
+        }
+
+        streamed.tailLevel     = tailLevel;
+        streamed.wantedLevel   = tailLevel;
+        streamed.residentSize  = texture->GetResidentSize();
+        streamed.lastUsedFrame = m_frame;
+
+        m_residentSize += streamed.residentSize;
+        m_indices[texture.get()] = static_cast<uint32_t>(m_textures.size());
+        m_textures.push_back(std::move(streamed));
+
+        return texture;
+    }
+
+    void TextureStreamer::BeginFrame()
+    {
+        if (!IsEnabled())
+        {
+            return;
+        }
+
+        m_frame++;
+        removeExpiredTextures();
+
+        // Only the visible textures need more than their tail
+        for (StreamedTexture &streamed : m_textures)
+        {
+            streamed.wantedLevel = streamed.tailLevel;
+        }
+    }
+
+    void TextureStreamer::AddVisiblePrimitives(const Camera &_camera,
+                                               int32_t _viewportHeight,
+                                               const Mesh &_mesh,
+                                               const std::vector<float> &_uvDensities,
+                                               const Matrix4x4 &_model,
+                                               const std::vector<uint32_t> &_visiblePrimitives)
+    {
+        if (!IsEnabled())
+        {
+            return;
+        }
+
+        float modelScale = std::sqrt(_model.m_11 * _model.m_11 + _model.m_12 * _model.m_12
+                                     + _model.m_13 * _model.m_13);
+
+        for (uint32_t primitiveIndex : _visiblePrimitives)
+        {
+            if (primitiveIndex >= _uvDensities.size())
+            {
+                continue;
+            }
+
+            const Primitive &primitive = _mesh.m_primitives[primitiveIndex];
+            AddVisiblePrimitive(_camera, _viewportHeight, primitive, _uvDensities[primitiveIndex] * modelScale,
+                                TransformBounds(primitive.bounds, _model));
+        }
+    }
+
+    void TextureStreamer::AddVisiblePrimitive(const Camera &_camera,
+                                              int32_t _viewportHeight,
+                                              const Primitive &_primitive,
+                                              float _unitsPerUV,
+                                              const AABB &_worldBounds)
+    {
+        if (!IsEnabled() || _unitsPerUV <= 0.f)
+        {
+            return;
+        }
+
+        // Screen pixels covered by a world unit at a distance of one
+        float pixelsPerUnit = static_cast<float>(_viewportHeight) * 0.5f * _camera.projection.m_22;
+        float distance      = std::max(GetDistance(_worldBounds, _camera.position), _camera.near);
+
+        // UV units covered by a pixel at the closest point of the bounds
+        float uvPerPixel = distance / (pixelsPerUnit * _unitsPerUV);
+
+        const PBRMaterial &material = _primitive.material;
+        for (const auto *slot : { &material.baseColorTexture, &material.metallicRoughnessTexture,
+                                  &material.normalTexture, &material.occlusionTexture, &material.emissiveTexture })
+        {
+            if (*slot)
+            {
+                requestLevel(**slot, uvPerPixel);
+            }
+        }
+    }
+
+    void TextureStreamer::EndFrame()
+    {
+        if (IsEnabled())
+        {
+            streamLevels();
+        }
+    }
+
+    size_t TextureStreamer::GetCompleteTextureCount() const
+    {
+        return static_cast<size_t>(std::count_if(m_textures.begin(), m_textures.end(),
+                                                 [](const StreamedTexture &_streamed) {
+                                                     auto texture = _streamed.texture.lock();
+                                                     return texture
+                                                            && texture->residentLevel <= _streamed.wantedLevel;
+                                                 }));
+    }
+
+    TextureStreamer &TextureStreamer::Get()
+    {
+        static TextureStreamer streamer;
+
+        return streamer;
+    }
+
+    void TextureStreamer::removeExpiredTextures()
+    {
+        for (size_t i = 0; i < m_textures.size();)
+        {
+            if (!m_textures[i].texture.expired())
+            {
+                i++;
+                continue;
+            }
+
+            // The GPU texture is already deleted
+            m_residentSize -= m_textures[i].residentSize;
+            std::erase_if(m_indices, [&](const auto &_entry) { return _entry.second == i; });
+
+            if (i + 1U < m_textures.size())
+            {
+                m_textures[i] = std::move(m_textures.back());
+                if (auto moved = m_textures[i].texture.lock())
+                {
+                    m_indices[moved.get()] = static_cast<uint32_t>(i);
+                }
+            }
+
+            m_textures.pop_back();
+        }
+    }
+
+    void TextureStreamer::requestLevel(const Texture &_texture, float _uvPerPixel)
+    {
+        auto found = m_indices.find(&_texture);
+        if (found == m_indices.end())
+        {
+            return;
+        }
+
+        StreamedTexture &streamed = m_textures[found->second];
+
+        // Largest level with no more than one texel per pixel, the ones
+        // below it would only be minified
+        float texelsPerPixel = _uvPerPixel
+                               * std::sqrt(static_cast<float>(_texture.width)
+                                           * static_cast<float>(_texture.height));
+        float level = std::floor(std::log2(std::max(texelsPerPixel, 1e-6f)) + m_settings.mipBias);
+
+        auto wantedLevel = static_cast<uint32_t>(std::clamp(level, 0.f, static_cast<float>(streamed.tailLevel)));
+
+        streamed.wantedLevel   = std::min(streamed.wantedLevel, wantedLevel);
+        streamed.lastUsedFrame = m_frame;
+    }
+
+    void TextureStreamer::streamLevels()
+    {
+        std::vector<bool> blocked(m_textures.size(), false);
+        size_t uploadedSize = 0;
+
+        for (;;)
+        {
+            // The texture the furthest from the level it needs goes first
+            // so the whole view sharpens evenly
+            StreamedTexture *next = nullptr;
+            std::shared_ptr<Texture> nextTexture;
+            uint32_t nextGap = 0;
+
+            for (size_t i = 0; i < m_textures.size(); i++)
+            {
+                StreamedTexture &streamed = m_textures[i];
+                auto texture              = streamed.texture.lock();
+
+                if (blocked[i] || !texture || texture->residentLevel <= streamed.wantedLevel)
+                {
+                    continue;
+                }
+
+                uint32_t gap = texture->residentLevel - streamed.wantedLevel;
+                if (gap > nextGap)
+                {
+                    next        = &streamed;
+                    nextTexture = std::move(texture);
+                    nextGap     = gap;
+                }
+            }
+
+            if (!next)
+            {
+                break;
+            }
+
+            const TextureLevel &level = next->levels[nextTexture->residentLevel - 1U];
+            if (uploadedSize != 0U && uploadedSize + level.size > m_settings.uploadBytesPerFrame)
+            {
+                break;
+            }
+
+            // What is left of the budget may still fit smaller levels
+            if (!makeRoom(level.size))
+            {
+                blocked[static_cast<size_t>(next - m_textures.data())] = true;
+                continue;
+            }
+
+            nextTexture->UploadLevel(level);
+
+            next->residentSize += level.size;
+            m_residentSize += level.size;
+            uploadedSize += level.size;
+        }
+    }
+
+    bool TextureStreamer::makeRoom(size_t _size)
+    {
+        while (m_residentSize + _size > m_settings.budget)
+        {
+            // Levels the camera does not need anymore, from the textures
+            // used the longest time ago then the largest levels
+            StreamedTexture *victim = nullptr;
+            std::shared_ptr<Texture> victimTexture;
+
+            for (StreamedTexture &streamed : m_textures)
+            {
+                auto texture = streamed.texture.lock();
+                if (!texture || texture->residentLevel >= streamed.wantedLevel)
+                {
+                    continue;
+                }
+
+                if (!victim || streamed.lastUsedFrame < victim->lastUsedFrame
+                    || (streamed.lastUsedFrame == victim->lastUsedFrame
+                        && texture->residentLevel < victimTexture->residentLevel))
+                {
+                    victim        = &streamed;
+                    victimTexture = std::move(texture);
+                }
+            }
+
+            if (!victim)
+            {
+                return false;
+            }
+
+            size_t size = victim->levels[victimTexture->residentLevel].size;
+            victimTexture->ReleaseLevel();
+
+            victim->residentSize -= size;
+            m_residentSize -= size;
+        }
+
+        return true;
+    }
+} // namespace DadEngine
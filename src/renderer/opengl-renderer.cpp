@@ -192,13 +192,13 @@ namespace DadEngine
     {
         auto vertexShaderFilename = _vertexShaderName + ".vert";
         auto vertexShaderPath = shadersDirectory;
-        std::vector<uint8_t> vertexShaderSource =
-            ReadFile(vertexShaderPath.append(vertexShaderFilename));
-        uint8_t *vertData = vertexShaderSource.data();
-        char **vertSource = reinterpret_cast<char **>(&vertData);
+        MappedFile vertexShaderFile(vertexShaderPath.append(vertexShaderFilename));
+        std::span<const uint8_t> vertexShaderSource = vertexShaderFile.GetData();
+        auto *vertSource = reinterpret_cast<const GLchar *>(vertexShaderSource.data());
+        auto vertLength  = static_cast<GLint>(vertexShaderSource.size());
 
         GLuint vertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShaderID, 1, vertSource, nullptr);
+        glShaderSource(vertexShaderID, 1, &vertSource, &vertLength);
         glCompileShader(vertexShaderID);
 
         int32_t success;
@@ -217,13 +217,13 @@ namespace DadEngine
 
         auto fragmentShaderFilename = _fragmentShaderName + ".frag";
         auto fragmentShaderPath = shadersDirectory;
-        std::vector<uint8_t> fragmentShaderSource =
-            ReadFile(fragmentShaderPath.append(fragmentShaderFilename));
-        uint8_t *fragData = fragmentShaderSource.data();
-        char **fragSource = reinterpret_cast<char **>(&fragData);
+        MappedFile fragmentShaderFile(fragmentShaderPath.append(fragmentShaderFilename));
+        std::span<const uint8_t> fragmentShaderSource = fragmentShaderFile.GetData();
+        auto *fragSource = reinterpret_cast<const GLchar *>(fragmentShaderSource.data());
+        auto fragLength  = static_cast<GLint>(fragmentShaderSource.size());
 
         GLuint fragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShaderID, 1, fragSource, nullptr);
+        glShaderSource(fragmentShaderID, 1, &fragSource, &fragLength);
         glCompileShader(fragmentShaderID);
 
         glGetShaderiv(fragmentShaderID, GL_COMPILE_STATUS, &success);
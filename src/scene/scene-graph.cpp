@@ -0,0 +1,148 @@
+#include "scene-graph.hpp"
+
+#include "helpers/thread-pool.hpp"
+
+namespace DadEngine
+{
+    // Nodes updated by a single job at most, below it the threading costs
+    // more than the matrices
+    constexpr uint32_t SUBTREE_JOB_SIZE = 512U;
+
+    uint32_t SceneGraph::AddNode(uint32_t _parent,
+                                 const Vector3 &_translation,
+                                 const Quaternion &_rotation,
+                                 const Vector3 &_scale,
+                                 uint32_t _mesh,
+                                 uint32_t _skin)
+    {
+        auto node = GetNodeCount();
+
+        // Only the subtrees still open at the end of the arrays can grow
+        if (_parent != INVALID_NODE && (_parent >= node || _parent + m_subtreeSizes[_parent] != node))
+        {
+            return INVALID_NODE;
+        }
+
+        for (uint32_t ancestor = _parent; ancestor != INVALID_NODE; ancestor = m_parents[ancestor])
+        {
+            m_subtreeSizes[ancestor]++;
+        }
+
+        m_parents.push_back(_parent);
+        m_subtreeSizes.push_back(1U);
+        m_meshes.push_back(_mesh);
+        m_skins.push_back(_skin);
+        m_translations.push_back(_translation);
+        m_rotations.push_back(_rotation);
+        m_scales.push_back(_scale);
+        m_worldMatrices.emplace_back();
+        m_dirty.push_back(1U);
+        m_worldChanged.push_back(0U);
+
+        m_jobsValid = false;
+
+        return node;
+    }
+
+    void SceneGraph::Clear()
+    {
+        m_parents.clear();
+        m_subtreeSizes.clear();
+        m_meshes.clear();
+        m_skins.clear();
+        m_translations.clear();
+        m_rotations.clear();
+        m_scales.clear();
+        m_worldMatrices.clear();
+        m_dirty.clear();
+        m_worldChanged.clear();
+        m_spineNodes.clear();
+        m_jobs.clear();
+        m_jobsValid = false;
+    }
+
+    void SceneGraph::UpdateWorldMatrices(ThreadPool *_threadPool)
+    {
+        if (!_threadPool || GetNodeCount() <= SUBTREE_JOB_SIZE)
+        {
+            updateRange(0U, GetNodeCount());
+            return;
+        }
+
+        if (!m_jobsValid)
+        {
+            buildJobs();
+        }
+
+        for (uint32_t node : m_spineNodes)
+        {
+            updateRange(node, node + 1U);
+        }
+
+        _threadPool->ParallelFor(static_cast<uint32_t>(m_jobs.size()), 1U, [&](uint32_t _begin, uint32_t _end) {
+            for (uint32_t job = _begin; job < _end; job++)
+            {
+                updateRange(m_jobs[job].first, m_jobs[job].second);
+            }
+        });
+    }
+
+    void SceneGraph::buildJobs()
+    {
+        m_spineNodes.clear();
+        m_jobs.clear();
+
+        // Walking depth first, a small enough subtree is a job and is
+        // skipped over, a larger one has its root updated beforehand and
+        // its children visited. Neighbouring jobs are merged while they fit
+        uint32_t node = 0U;
+        while (node < GetNodeCount())
+        {
+            uint32_t size = m_subtreeSizes[node];
+
+            if (size > SUBTREE_JOB_SIZE)
+            {
+                m_spineNodes.push_back(node);
+                node++;
+                continue;
+            }
+
+            if (!m_jobs.empty() && m_jobs.back().second == node
+                && m_jobs.back().second - m_jobs.back().first + size <= SUBTREE_JOB_SIZE)
+            {
+                m_jobs.back().second += size;
+            }
+            else
+            {
+                m_jobs.emplace_back(node, node + size);
+            }
+
+            node += size;
+        }
+
+        m_jobsValid = true;
+    }
+
+    void SceneGraph::updateRange(uint32_t _begin, uint32_t _end)
+    {
+        // Parents come first, their flag is already set for this update
+        for (uint32_t node = _begin; node < _end; node++)
+        {
+            uint32_t parent = m_parents[node];
+            bool changed    = m_dirty[node] != 0U || (parent != INVALID_NODE && m_worldChanged[parent] != 0U);
+
+            m_worldChanged[node] = changed ? 1U : 0U;
+            if (!changed)
+            {
+                continue;
+            }
+
+            m_dirty[node] = 0U;
+
+            Matrix3x4 local;
+            local.SetTRS(m_translations[node], m_rotations[node], m_scales[node]);
+
+            m_worldMatrices[node] = parent != INVALID_NODE ? m_worldMatrices[parent] * local : local;
+        }
+    }
+} // namespace DadEngine
@@ -0,0 +1,165 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include "animation/skinning.hpp"
+#include "helpers/derived-data-cache.hpp"
+#include "loaders/accessor-view.hpp"
+#include "loaders/gltf-document.hpp"
+#include "loaders/gltf-loader.hpp"
+#include "model/model.hpp"
+#include "scene/scene-graph.hpp"
+#include "test-helpers.hpp"
+
+using namespace DadEngine;
+
+namespace
+{
+    // Single accessor over the whole of a single buffer
+    struct AccessorFixture
+    {
+        AccessorFixture(uint32_t _componentType, uint32_t _componentCount, size_t _count, bool _normalized,
+                        size_t _stride = 0U)
+        {
+            size_t elementSize = GetComponentSize(_componentType) * _componentCount;
+            size_t stride      = _stride ? _stride : elementSize;
+
+            // Sized to the last element so any read past it is out of bounds
+            bytes.resize(stride * (_count - 1U) + elementSize);
+            for (size_t i = 0; i < bytes.size(); i++) {
+                bytes[i] = static_cast<uint8_t>(i * 37U + 11U);
+            }
+
+            document.buffers.push_back({ "", bytes.size() });
+            document.bufferViews.push_back({ 0U, 0U, bytes.size(), static_cast<uint32_t>(_stride) });
+
+            accessor.bufferView     = 0U;
+            accessor.componentType  = _componentType;
+            accessor.componentCount = _componentCount;
+            accessor.count          = _count;
+            accessor.normalized     = _normalized;
+            document.accessors.push_back(accessor);
+
+            buffers.push_back(bytes);
+        }
+
+        // Component converted as the glTF spec describes it
+        float Expected(size_t _element, uint32_t _component) const
+        {
+            size_t componentSize = GetComponentSize(accessor.componentType);
+            size_t stride        = document.bufferViews[0].byteStride ? document.bufferViews[0].byteStride
+                                                                      : componentSize * accessor.componentCount;
+            const uint8_t *component = bytes.data() + _element * stride + _component * componentSize;
+
+            int16_t signedShort;
+            uint16_t unsignedShort;
+            std::memcpy(&signedShort, component, sizeof(signedShort));
+            std::memcpy(&unsignedShort, component, sizeof(unsignedShort));
+
+            switch (accessor.componentType) {
+            case GLTF_BYTE: {
+                float value = static_cast<int8_t>(*component);
+                return accessor.normalized ? std::max(value / 127.f, -1.f) : value;
+            }
+            case GLTF_UNSIGNED_BYTE:
+                return accessor.normalized ? *component / 255.f : *component;
+            case GLTF_SHORT:
+                return accessor.normalized ? std::max(signedShort / 32767.f, -1.f) : signedShort;
+            case GLTF_UNSIGNED_SHORT:
+                return accessor.normalized ? unsignedShort / 65535.f : unsignedShort;
+            default: {
+                int exponent  = (unsignedShort >> 10U) & 0x1F;
+                int mantissa  = unsignedShort & 0x3FF;
+                float sign    = (unsignedShort & 0x8000U) ? -1.f : 1.f;
+
+                if (exponent == 0x1F) {
+                    return mantissa ? NAN : sign * INFINITY;
+                }
+                if (exponent == 0) {
+                    return sign * std::ldexp(static_cast<float>(mantissa), -24);
+                }
+                return sign * std::ldexp(static_cast<float>(mantissa + 0x400), exponent - 25);
+            }
+            }
+        }
+
+        std::vector<uint8_t> bytes;
+        GLTFDocument document;
+        GLTFAccessor accessor;
+        std::vector<std::span<const uint8_t>> buffers;
+    };
+} // namespace
+
+TEST_CASE("Matrix accessors of small components convert every component", "[accessor]")
+{
+    const std::pair<uint32_t, uint32_t> layouts[] = {
+        { GLTF_SHORT, 16U }, { GLTF_UNSIGNED_SHORT, 16U }, { GLTF_BYTE, 16U },       { GLTF_UNSIGNED_BYTE, 16U },
+        { GLTF_SHORT, 9U },  { GLTF_BYTE, 9U },            { GLTF_HALF_FLOAT, 16U }, { GLTF_HALF_FLOAT, 9U },
+    };
+
+    for (auto [componentType, componentCount] : layouts) {
+        for (bool normalized : { true, false }) {
+            for (size_t stride : { size_t { 0U }, size_t { 48U } }) {
+                // Only integers can be normalized
+                if (componentType == GLTF_HALF_FLOAT && normalized) {
+                    continue;
+                }
+
+                AccessorFixture fixture(componentType, componentCount, 5U, normalized, stride);
+                INFO("type " << componentType << " components " << componentCount << " normalized " << normalized
+                             << " stride " << stride);
+
+                std::vector<float> storage;
+                std::span<const float> floats;
+                REQUIRE(ReadFloatAccessor(fixture.document, fixture.buffers, fixture.accessor, storage, floats));
+                REQUIRE(floats.size() == 5U * componentCount);
+
+                for (size_t element = 0; element < 5U; element++) {
+                    for (uint32_t component = 0; component < componentCount; component++) {
+                        float expected = fixture.Expected(element, component);
+                        float value    = floats[element * componentCount + component];
+
+                        if (std::isnan(expected)) {
+                            CHECK(std::isnan(value));
+                        }
+                        else {
+                            CHECK(value == Approx(expected).epsilon(1e-6));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Inverse bind matrices must be floats", "[accessor]")
+{
+    DerivedDataCache::Get().SetEnabled(false);
+    TemporaryDirectory directory;
+
+    // The 36 bytes of the positions view hold one MAT4 of shorts, which
+    // would read without error
+    std::string skinned = ReplaceFirst(TRIANGLE_GLTF, "{\"mesh\": 0}", "{\"mesh\": 0, \"skin\": 0}");
+    skinned             = ReplaceFirst(skinned, "\"nodes\": [{",
+                                       "\"skins\": [{\"joints\": [0], \"inverseBindMatrices\": 2}], \"nodes\": [{");
+    skinned = ReplaceFirst(skinned, "\"type\": \"SCALAR\"}",
+                           "\"type\": \"SCALAR\"}, {\"bufferView\": 0, \"componentType\": 5122, \"normalized\": true, "
+                           "\"count\": 1, \"type\": \"MAT4\"}");
+
+    SceneGraph graph;
+    std::vector<Skin> skins;
+    std::filesystem::path path = directory.WriteFile("skinned.gltf", skinned);
+    std::vector<Mesh> meshes   = LoadGLTF(path, nullptr, {}, &graph, nullptr, &skins);
+
+    REQUIRE(skins.size() == 1U);
+    REQUIRE(skins[0].inverseBindMatrices.size() == 1U);
+
+    // Left at the identity instead of reading the shorts
+    const Matrix3x4 &matrix = skins[0].inverseBindMatrices[0];
+    Matrix3x4 identity;
+    CHECK(std::memcmp(&matrix, &identity, sizeof(matrix)) == 0);
+}
@@ -0,0 +1,135 @@
+#include <catch.hpp>
+
+#include <string>
+#include <vector>
+
+#include "helpers/base64.hpp"
+
+using namespace DadEngine;
+
+namespace
+{
+    // Plain encoder the decoder is checked against
+    std::string EncodeBase64(const std::vector<uint8_t> &_data, bool _padding)
+    {
+        constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        std::string encoded;
+        for (size_t i = 0; i < _data.size(); i += 3U) {
+            uint32_t group = static_cast<uint32_t>(_data[i]) << 16U;
+            size_t remaining = _data.size() - i;
+
+            if (remaining > 1U) {
+                group |= static_cast<uint32_t>(_data[i + 1U]) << 8U;
+            }
+            if (remaining > 2U) {
+                group |= _data[i + 2U];
+            }
+
+            encoded += ALPHABET[(group >> 18U) & 63U];
+            encoded += ALPHABET[(group >> 12U) & 63U];
+            if (remaining > 1U) {
+                encoded += ALPHABET[(group >> 6U) & 63U];
+            }
+            else if (_padding) {
+                encoded += '=';
+            }
+            if (remaining > 2U) {
+                encoded += ALPHABET[group & 63U];
+            }
+            else if (_padding) {
+                encoded += '=';
+            }
+        }
+
+        return encoded;
+    }
+
+    std::vector<uint8_t> MakeBytes(size_t _size)
+    {
+        std::vector<uint8_t> bytes(_size);
+        for (size_t i = 0; i < _size; i++) {
+            bytes[i] = static_cast<uint8_t>(i * 131U + 7U);
+        }
+
+        return bytes;
+    }
+} // namespace
+
+TEST_CASE("Base64 decodes the reference vectors", "[base64]")
+{
+    const std::pair<std::string_view, std::string_view> vectors[] = {
+        { "", "" },         { "Zg==", "f" },         { "Zm8=", "fo" },      { "Zm9v", "foo" },
+        { "Zm9vYg==", "foob" }, { "Zm9vYmE=", "fooba" }, { "Zm9vYmFy", "foobar" },
+    };
+
+    for (auto [encoded, decoded] : vectors) {
+        INFO(encoded);
+
+        REQUIRE(GetBase64DecodedSize(encoded) == decoded.size());
+
+        std::string output(decoded.size(), '\0');
+        REQUIRE(DecodeBase64(encoded, reinterpret_cast<uint8_t *>(output.data())));
+        CHECK(output == decoded);
+    }
+}
+
+TEST_CASE("Base64 matches a plain encoder across the block sizes", "[base64]")
+{
+    // Covers the scalar tail after every amount of 16 and 32 characters blocks
+    for (size_t size = 0; size < 200U; size++) {
+        std::vector<uint8_t> bytes = MakeBytes(size);
+
+        for (bool padding : { true, false }) {
+            std::string encoded = EncodeBase64(bytes, padding);
+            INFO("size " << size << " padding " << padding);
+
+            REQUIRE(GetBase64DecodedSize(encoded) == size);
+
+            std::vector<uint8_t> decoded(size);
+            REQUIRE(DecodeBase64(encoded, decoded.data()));
+            CHECK(decoded == bytes);
+        }
+    }
+}
+
+TEST_CASE("Base64 rejects characters outside the alphabet", "[base64]")
+{
+    std::vector<uint8_t> bytes = MakeBytes(150U);
+    std::string encoded        = EncodeBase64(bytes, false);
+    std::vector<uint8_t> decoded(bytes.size());
+
+    // Every position, so both the vector blocks and the tail see one
+    for (size_t i = 0; i < encoded.size(); i++) {
+        for (char invalid : { '-', '_', ' ', '\n', '\0', '\xFF' }) {
+            std::string corrupted = encoded;
+            corrupted[i]          = invalid;
+            INFO("position " << i << " character " << static_cast<int>(invalid));
+
+            CHECK_FALSE(DecodeBase64(corrupted, decoded.data()));
+        }
+    }
+}
+
+TEST_CASE("Base64 rejects misplaced padding and single character groups", "[base64]")
+{
+    uint8_t output[6] = {};
+
+    CHECK_FALSE(DecodeBase64("Zm=vYmFy", output));
+    CHECK_FALSE(DecodeBase64("Zm9vY", output));
+    CHECK_FALSE(DecodeBase64("Zm9vY===", output));
+}
+
+TEST_CASE("Base64 data URIs are split", "[base64]")
+{
+    std::string_view mimeType;
+    std::string_view payload;
+
+    REQUIRE(ParseBase64DataURI("data:application/octet-stream;base64,Zm9v", mimeType, payload));
+    CHECK(mimeType == "application/octet-stream");
+    CHECK(payload == "Zm9v");
+
+    CHECK_FALSE(ParseBase64DataURI("buffer.bin", mimeType, payload));
+    CHECK_FALSE(ParseBase64DataURI("data:text/plain,foo", mimeType, payload));
+    CHECK_FALSE(ParseBase64DataURI("data:", mimeType, payload));
+}
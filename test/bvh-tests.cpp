@@ -0,0 +1,213 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "bvh/bvh.hpp"
+
+using namespace DadEngine;
+
+namespace
+{
+    std::vector<BVHTriangle> MakeRandomTriangles(uint32_t _count, std::mt19937 &_random)
+    {
+        std::uniform_real_distribution<float> position(-10.f, 10.f);
+        std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+
+        std::vector<BVHTriangle> triangles(_count);
+        for (uint32_t i = 0; i < _count; i++) {
+            Vector3 center(position(_random), position(_random), position(_random));
+
+            auto jitter = [&]() {
+                return Vector3(center.x + offset(_random), center.y + offset(_random), center.z + offset(_random));
+            };
+
+            triangles[i].v0             = jitter();
+            triangles[i].v1             = jitter();
+            triangles[i].v2             = jitter();
+            triangles[i].primitiveIndex = 0U;
+            triangles[i].triangleIndex  = i;
+        }
+
+        return triangles;
+    }
+
+    // Möller-Trumbore, the distance or infinity when the ray misses
+    float IntersectTriangle(const Ray &_ray, const BVHTriangle &_triangle)
+    {
+        float edge1[3] = { _triangle.v1.x - _triangle.v0.x, _triangle.v1.y - _triangle.v0.y,
+                           _triangle.v1.z - _triangle.v0.z };
+        float edge2[3] = { _triangle.v2.x - _triangle.v0.x, _triangle.v2.y - _triangle.v0.y,
+                           _triangle.v2.z - _triangle.v0.z };
+        const Vector3 &d = _ray.direction;
+
+        float p[3] = { d.y * edge2[2] - d.z * edge2[1], d.z * edge2[0] - d.x * edge2[2],
+                       d.x * edge2[1] - d.y * edge2[0] };
+        float determinant = edge1[0] * p[0] + edge1[1] * p[1] + edge1[2] * p[2];
+        if (std::fabs(determinant) < 1e-8f) {
+            return INFINITY;
+        }
+
+        float inverse = 1.f / determinant;
+        float s[3]    = { _ray.origin.x - _triangle.v0.x, _ray.origin.y - _triangle.v0.y,
+                          _ray.origin.z - _triangle.v0.z };
+        float u       = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverse;
+        if (u < 0.f || u > 1.f) {
+            return INFINITY;
+        }
+
+        float q[3] = { s[1] * edge1[2] - s[2] * edge1[1], s[2] * edge1[0] - s[0] * edge1[2],
+                       s[0] * edge1[1] - s[1] * edge1[0] };
+        float v    = (d.x * q[0] + d.y * q[1] + d.z * q[2]) * inverse;
+        if (v < 0.f || u + v > 1.f) {
+            return INFINITY;
+        }
+
+        float t = (edge2[0] * q[0] + edge2[1] * q[1] + edge2[2] * q[2]) * inverse;
+
+        return t > 0.f && t < _ray.tMax ? t : INFINITY;
+    }
+
+    float IntersectAll(const Ray &_ray, const std::vector<BVHTriangle> &_triangles)
+    {
+        float closest = INFINITY;
+        for (const BVHTriangle &triangle : _triangles) {
+            closest = std::min(closest, IntersectTriangle(_ray, triangle));
+        }
+
+        return closest;
+    }
+
+    uint32_t GetDepth(const std::vector<BVHNode> &_nodes, uint32_t _node = 0U)
+    {
+        if (_nodes[_node].IsLeaf()) {
+            return 1U;
+        }
+
+        return 1U + std::max(GetDepth(_nodes, _node + 1U), GetDepth(_nodes, _nodes[_node].rightOrFirst));
+    }
+
+    Ray MakeRandomRay(std::mt19937 &_random)
+    {
+        std::uniform_real_distribution<float> position(-12.f, 12.f);
+        std::normal_distribution<float> direction;
+
+        Ray ray;
+        ray.origin = Vector3(position(_random), position(_random), position(_random));
+
+        float x = direction(_random), y = direction(_random), z = direction(_random);
+        float length  = std::sqrt(x * x + y * y + z * z);
+        ray.direction = Vector3(x / length, y / length, z / length);
+
+        return ray;
+    }
+
+    // Every ray must hit what the brute force hits, at the same distance
+    template <typename Tree>
+    void CheckRays(const Tree &_tree, const std::vector<BVHTriangle> &_triangles, std::mt19937 &_random)
+    {
+        for (uint32_t i = 0; i < 500U; i++) {
+            Ray ray        = MakeRandomRay(_random);
+            float expected = IntersectAll(ray, _triangles);
+
+            RayHit hit;
+            bool hasHit = _tree.Intersect(ray, hit);
+            INFO("ray " << i);
+
+            REQUIRE(hasHit == std::isfinite(expected));
+            if (hasHit) {
+                CHECK(hit.t == Approx(expected).epsilon(1e-4));
+            }
+        }
+    }
+} // namespace
+
+TEST_CASE("BVH rays match a brute force", "[bvh]")
+{
+    std::mt19937 random(42U);
+    std::vector<BVHTriangle> triangles = MakeRandomTriangles(2000U, random);
+
+    BVH bvh;
+    bvh.Build(std::vector<BVHTriangle>(triangles));
+    REQUIRE(bvh.GetTriangles().size() == triangles.size());
+
+    CheckRays(bvh, triangles, random);
+
+    WideBVH<4U> bvh4;
+    bvh4.Build(bvh);
+    CheckRays(bvh4, triangles, random);
+
+    WideBVH<8U> bvh8;
+    bvh8.Build(bvh);
+    CheckRays(bvh8, triangles, random);
+}
+
+TEST_CASE("BVH overlaps match a brute force", "[bvh]")
+{
+    std::mt19937 random(7U);
+    std::vector<BVHTriangle> triangles = MakeRandomTriangles(2000U, random);
+
+    BVH bvh;
+    bvh.Build(std::vector<BVHTriangle>(triangles));
+
+    AABB box(Vector3(-3.f, -2.f, -1.f), Vector3(1.f, 2.f, 3.f));
+
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < triangles.size(); i++) {
+        AABB bounds = AABB::Empty();
+        bounds.Grow(triangles[i].v0);
+        bounds.Grow(triangles[i].v1);
+        bounds.Grow(triangles[i].v2);
+
+        if (bounds.Overlaps(box)) {
+            expected.push_back(i);
+        }
+    }
+
+    std::vector<uint32_t> overlapping;
+    bvh.Overlap(box, overlapping);
+
+    // The BVH reorders its triangles, compare their source indices
+    std::vector<uint32_t> found;
+    for (uint32_t triangle : overlapping) {
+        found.push_back(bvh.GetTriangles()[triangle].triangleIndex);
+    }
+    std::sort(found.begin(), found.end());
+
+    CHECK(found == expected);
+}
+
+TEST_CASE("BVH depth stays bounded on degenerate input", "[bvh]")
+{
+    // With two bins, centroids spread exponentially all fall in the first
+    // one but the farthest, so every SAH split only peels off one triangle
+    std::vector<BVHTriangle> triangles;
+    for (uint32_t i = 0; i < 120U; i++) {
+        float x    = std::ldexp(1.f, static_cast<int>(i));
+        float size = x * 0.01f;
+
+        BVHTriangle triangle;
+        triangle.v0             = Vector3(x - size, -1.f, 0.f);
+        triangle.v1             = Vector3(x + size, -1.f, 0.f);
+        triangle.v2             = Vector3(x, 1.f, 0.f);
+        triangle.primitiveIndex = 0U;
+        triangle.triangleIndex  = i;
+        triangles.push_back(triangle);
+    }
+
+    BVH bvh;
+    bvh.Build(std::move(triangles), { .binCount = 2U, .maxLeafSize = 1U });
+
+    // MAX_TREE_DEPTH of the traversal stacks
+    CHECK(GetDepth(bvh.GetNodes()) <= 96U);
+
+    Ray ray;
+    ray.origin    = Vector3(1.f, 0.f, -1.f);
+    ray.direction = Vector3(0.f, 0.f, 1.f);
+
+    RayHit hit;
+    REQUIRE(bvh.Intersect(ray, hit));
+    CHECK(hit.t == Approx(1.f));
+}
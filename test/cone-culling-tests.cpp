@@ -0,0 +1,190 @@
+#include <catch.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "culling/cone-culling.hpp"
+#include "model/model.hpp"
+
+using namespace DadEngine;
+
+namespace
+{
+    // dot(normalize(apex - eye), axis) >= cutoff, in double precision
+    bool IsBackfacing(const ClusterCone &_cone, const Vector3 &_eye)
+    {
+        double x = static_cast<double>(_cone.apex.x) - _eye.x;
+        double y = static_cast<double>(_cone.apex.y) - _eye.y;
+        double z = static_cast<double>(_cone.apex.z) - _eye.z;
+
+        double dot = (x * _cone.axis.x + y * _cone.axis.y + z * _cone.axis.z) / std::sqrt(x * x + y * y + z * z);
+
+        return dot >= _cone.cutoff;
+    }
+
+    // Random cone which is not on the edge of being culled from the eye
+    ClusterCone MakeRandomCone(std::mt19937 &_random, const Vector3 &_eye)
+    {
+        std::uniform_real_distribution<float> position(-10.f, 10.f);
+        std::normal_distribution<float> direction;
+        std::uniform_real_distribution<float> cutoff(-0.2f, 1.f);
+
+        while (true) {
+            float x = direction(_random), y = direction(_random), z = direction(_random);
+            float length = std::sqrt(x * x + y * y + z * z);
+
+            ClusterCone cone;
+            cone.apex   = Vector3(position(_random), position(_random), position(_random));
+            cone.axis   = Vector3(x / length, y / length, z / length);
+            cone.cutoff = cutoff(_random);
+
+            ClusterCone lower = cone;
+            ClusterCone upper = cone;
+            lower.cutoff -= 1e-3f;
+            upper.cutoff += 1e-3f;
+
+            if (IsBackfacing(lower, _eye) == IsBackfacing(upper, _eye)) {
+                return cone;
+            }
+        }
+    }
+
+    // Triangles of the xy plane facing +z, or -z when _flipped, and a last
+    // one facing the other way when _spread
+    std::vector<Vector3> MakeClusterPositions(bool _flipped, bool _spread)
+    {
+        std::vector<Vector3> positions;
+        for (uint32_t i = 0; i < 4U; i++) {
+            float x = static_cast<float>(i);
+            positions.push_back(Vector3(x, 0.f, 0.f));
+            positions.push_back(_flipped ? Vector3(x, 1.f, 0.f) : Vector3(x + 1.f, 0.f, 0.f));
+            positions.push_back(_flipped ? Vector3(x + 1.f, 0.f, 0.f) : Vector3(x, 1.f, 0.f));
+        }
+
+        if (_spread) {
+            positions.push_back(Vector3(0.f, 0.f, 0.f));
+            positions.push_back(_flipped ? Vector3(1.f, 0.f, 0.f) : Vector3(0.f, 1.f, 0.f));
+            positions.push_back(_flipped ? Vector3(0.f, 1.f, 0.f) : Vector3(1.f, 0.f, 0.f));
+        }
+
+        return positions;
+    }
+
+    ClusterCone ComputeCone(const std::vector<Vector3> &_positions)
+    {
+        std::vector<uint32_t> indices(_positions.size());
+        for (uint32_t i = 0; i < indices.size(); i++) {
+            indices[i] = i;
+        }
+
+        return ComputeClusterCone(_positions.data(), indices.data(), static_cast<uint32_t>(indices.size() / 3U));
+    }
+} // namespace
+
+TEST_CASE("Cone culling matches a scalar reference", "[culling]")
+{
+    std::mt19937 random(3U);
+    const Vector3 eye(1.f, 2.f, -3.f);
+
+    // Every remainder of the four wide groups, and counts past a few groups
+    for (uint32_t count : { 0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 13U, 63U, 257U }) {
+        ClusterConeSet cones;
+        std::vector<uint32_t> expected;
+
+        for (uint32_t i = 0; i < count; i++) {
+            ClusterCone cone = MakeRandomCone(random, eye);
+            cones.Add(cone);
+
+            if (!IsBackfacing(cone, eye)) {
+                expected.push_back(i);
+            }
+        }
+
+        std::vector<uint32_t> visible;
+        INFO("count " << count);
+
+        CHECK(cones.Cull(eye, visible) == expected.size());
+        CHECK(visible == expected);
+    }
+}
+
+TEST_CASE("Cone culling keeps the survivors of full and partial groups", "[culling]")
+{
+    const Vector3 eye(0.f, 0.f, 10.f);
+
+    // Flat clusters facing the eye or away from it, in a pattern that does
+    // not repeat every four clusters
+    ClusterCone front = ComputeCone(MakeClusterPositions(false, false));
+    ClusterCone back  = ComputeCone(MakeClusterPositions(true, false));
+
+    ClusterConeSet cones;
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < 11U; i++) {
+        bool isFront = i % 3U == 0U;
+        cones.Add(isFront ? front : back);
+
+        if (isFront) {
+            expected.push_back(i);
+        }
+    }
+
+    std::vector<uint32_t> visible;
+    CHECK(cones.Cull(eye, visible) == expected.size());
+    CHECK(visible == expected);
+}
+
+TEST_CASE("Cluster cones cull the clusters facing away", "[culling]")
+{
+    ClusterCone front = ComputeCone(MakeClusterPositions(false, false));
+    CHECK(front.cutoff < 1.f);
+    CHECK(front.axis.z == Approx(1.f));
+
+    ClusterConeSet cones;
+    cones.Add(front);
+
+    std::vector<uint32_t> visible;
+    CHECK(cones.Cull(Vector3(1.f, 1.f, 10.f), visible) == 1U);
+    CHECK(cones.Cull(Vector3(1.f, 1.f, -10.f), visible) == 0U);
+
+    // Seen from the side, past the plane of the triangles
+    CHECK(cones.Cull(Vector3(100.f, 0.5f, 0.1f), visible) == 1U);
+}
+
+TEST_CASE("Cluster cones of spread or degenerate triangles are never culled", "[culling]")
+{
+    const std::vector<Vector3> degenerate = { Vector3(0.f, 0.f, 0.f), Vector3(1.f, 0.f, 0.f),
+                                              Vector3(2.f, 0.f, 0.f) };
+
+    for (const ClusterCone &cone : { ComputeCone(MakeClusterPositions(false, true)), ComputeCone(degenerate) }) {
+        CHECK(cone.cutoff > 1.f);
+
+        ClusterConeSet cones;
+        cones.Add(cone);
+
+        std::vector<uint32_t> visible;
+        for (const Vector3 &eye : { Vector3(1.f, 1.f, 10.f), Vector3(1.f, 1.f, -10.f), Vector3(1.f, -10.f, 0.5f) }) {
+            CHECK(cones.Cull(eye, visible) == 1U);
+        }
+    }
+}
+
+TEST_CASE("Primitives are split in clusters of consecutive triangles", "[culling]")
+{
+    std::vector<Vertex> vertices;
+    for (const Vector3 &position : MakeClusterPositions(false, false)) {
+        Vertex vertex {};
+        vertex.position = position;
+        vertices.push_back(vertex);
+    }
+
+    Primitive primitive(VertexBuffer(std::move(vertices)), IndexBuffer(), 4U, PBRMaterial());
+
+    ClusterConeSet cones;
+    BuildClusterCones(primitive, 3U, cones);
+    CHECK(cones.GetCount() == 2U);
+
+    std::vector<uint32_t> visible;
+    CHECK(cones.Cull(Vector3(1.f, 1.f, 10.f), visible) == 2U);
+    CHECK(cones.Cull(Vector3(1.f, 1.f, -10.f), visible) == 0U);
+}
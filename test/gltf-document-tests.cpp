@@ -0,0 +1,211 @@
+#include <catch.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "loaders/gltf-document.hpp"
+#include "test-helpers.hpp"
+
+using namespace DadEngine;
+
+namespace
+{
+    bool Parse(const std::string &_json, GLTFDocument &_document)
+    {
+        return ParseGLTFDocument(reinterpret_cast<const uint8_t *>(_json.data()), _json.size(), _document);
+    }
+
+    void AppendUint32(std::vector<uint8_t> &_bytes, uint32_t _value)
+    {
+        uint8_t bytes[4];
+        std::memcpy(bytes, &_value, sizeof(bytes));
+        _bytes.insert(_bytes.end(), bytes, bytes + 4);
+    }
+
+    void AppendChunk(std::vector<uint8_t> &_bytes, uint32_t _type, std::string_view _data, uint8_t _padding)
+    {
+        size_t alignedSize = (_data.size() + 3U) & ~size_t { 3U };
+
+        AppendUint32(_bytes, static_cast<uint32_t>(alignedSize));
+        AppendUint32(_bytes, _type);
+        _bytes.insert(_bytes.end(), _data.begin(), _data.end());
+        _bytes.resize(_bytes.size() + alignedSize - _data.size(), _padding);
+    }
+
+    std::vector<uint8_t> MakeGLB(std::string_view _json, std::string_view _bin)
+    {
+        std::vector<uint8_t> bytes;
+        AppendUint32(bytes, 0x46546C67U); // "glTF"
+        AppendUint32(bytes, 2U);
+        AppendUint32(bytes, 0U);
+
+        AppendChunk(bytes, 0x4E4F534AU, _json, ' ');
+        if (!_bin.empty()) {
+            AppendChunk(bytes, 0x004E4942U, _bin, 0U);
+        }
+
+        uint32_t length = static_cast<uint32_t>(bytes.size());
+        std::memcpy(bytes.data() + 8, &length, sizeof(length));
+
+        return bytes;
+    }
+} // namespace
+
+TEST_CASE("The parser reads the records of a document", "[gltf]")
+{
+    GLTFDocument document;
+    REQUIRE(Parse(TRIANGLE_GLTF, document));
+
+    REQUIRE(document.accessors.size() == 2U);
+    CHECK(document.accessors[0].componentType == 5126U);
+    CHECK(document.accessors[0].componentCount == 3U);
+    CHECK(document.accessors[1].count == 3U);
+
+    REQUIRE(document.bufferViews.size() == 2U);
+    CHECK(document.bufferViews[1].byteOffset == 36U);
+
+    REQUIRE(document.meshes.size() == 1U);
+    REQUIRE(document.meshes[0].primitives.size() == 1U);
+    CHECK(document.meshes[0].primitives[0].position == 0U);
+    CHECK(document.meshes[0].primitives[0].indices == 1U);
+    CHECK(document.meshes[0].primitives[0].material == GLTF_INVALID_INDEX);
+
+    REQUIRE(document.scenes.size() == 1U);
+    CHECK(document.scenes[0].nodes == std::vector<uint32_t> { 0U });
+}
+
+TEST_CASE("The parser rejects malformed JSON", "[gltf]")
+{
+    // Every truncation of a valid document is malformed
+    for (size_t size = 0; size < TRIANGLE_GLTF.size(); size += 7U) {
+        GLTFDocument document;
+        INFO("size " << size);
+
+        CHECK_FALSE(Parse(TRIANGLE_GLTF.substr(0, size), document));
+    }
+
+    GLTFDocument document;
+    CHECK_FALSE(Parse(ReplaceFirst(TRIANGLE_GLTF, "\"count\": 3,", "\"count\": 3,,"), document));
+    CHECK_FALSE(Parse(ReplaceFirst(TRIANGLE_GLTF, "\"scene\": 0", "\"scene\": zero"), document));
+}
+
+TEST_CASE("The parser rejects integers that do not fit their property", "[gltf]")
+{
+    for (std::string_view count : { "1.5", "-1", "1e30", "1e300" }) {
+        GLTFDocument document;
+        INFO(count);
+
+        CHECK_FALSE(Parse(ReplaceFirst(TRIANGLE_GLTF, "\"count\": 3", "\"count\": " + std::string(count)), document));
+    }
+
+    for (std::string_view byteLength : { "-1", "0.5", "9007199254740992" }) {
+        GLTFDocument document;
+        INFO(byteLength);
+
+        std::string json
+            = ReplaceFirst(TRIANGLE_GLTF, "\"byteLength\": 36", "\"byteLength\": " + std::string(byteLength));
+
+        CHECK_FALSE(Parse(json, document));
+    }
+
+    for (std::string_view indices : { "4294967295", "4294967296" }) {
+        GLTFDocument document;
+        INFO(indices);
+
+        CHECK_FALSE(
+            Parse(ReplaceFirst(TRIANGLE_GLTF, "\"indices\": 1", "\"indices\": " + std::string(indices)), document));
+    }
+
+    // A valid index that happens to be written as a float is accepted
+    GLTFDocument document;
+    REQUIRE(Parse(ReplaceFirst(TRIANGLE_GLTF, "\"indices\": 1", "\"indices\": 1.0"), document));
+    CHECK(document.meshes[0].primitives[0].indices == 1U);
+}
+
+TEST_CASE("The parser resets references past their records", "[gltf]")
+{
+    std::string json = ReplaceFirst(TRIANGLE_GLTF, "\"indices\": 1", "\"indices\": 1, \"material\": 5");
+    json             = ReplaceFirst(json, "\"POSITION\": 0", "\"POSITION\": 9");
+    json             = ReplaceFirst(json, "\"buffer\": 0", "\"buffer\": 3");
+    json             = ReplaceFirst(json, "\"nodes\": [0]", "\"nodes\": [0, 4]");
+    json             = ReplaceFirst(json, "{\"mesh\": 0}", "{\"mesh\": 2, \"children\": [7]}");
+
+    GLTFDocument document;
+    REQUIRE(Parse(json, document));
+
+    const GLTFPrimitive &primitive = document.meshes[0].primitives[0];
+    CHECK(primitive.position == GLTF_INVALID_INDEX);
+    CHECK(primitive.material == GLTF_INVALID_INDEX);
+    CHECK(primitive.indices == 1U);
+    CHECK(document.bufferViews[0].buffer == GLTF_INVALID_INDEX);
+    CHECK(document.bufferViews[1].buffer == 0U);
+    CHECK(document.scenes[0].nodes == std::vector<uint32_t> { 0U });
+    CHECK(document.nodes[0].mesh == GLTF_INVALID_INDEX);
+    CHECK(document.nodes[0].children.empty());
+}
+
+TEST_CASE("GLB containers are split into their chunks", "[gltf]")
+{
+    std::vector<uint8_t> glb = MakeGLB("{}", "abcde");
+
+    GLBChunks chunks;
+    REQUIRE(ParseGLBContainer(glb.data(), glb.size(), chunks));
+    REQUIRE(chunks.jsonSize == 4U);
+    CHECK(std::memcmp(chunks.json, "{}  ", 4U) == 0);
+    REQUIRE(chunks.binSize == 8U);
+    CHECK(std::memcmp(chunks.bin, "abcde", 5U) == 0);
+
+    std::vector<uint8_t> jsonOnly = MakeGLB("{}", "");
+    GLBChunks jsonOnlyChunks;
+    REQUIRE(ParseGLBContainer(jsonOnly.data(), jsonOnly.size(), jsonOnlyChunks));
+    CHECK(jsonOnlyChunks.bin == nullptr);
+}
+
+TEST_CASE("Malformed GLB containers are rejected", "[gltf]")
+{
+    const std::vector<uint8_t> glb = MakeGLB("{}", "abcde");
+
+    SECTION("Truncated")
+    {
+        // The declared length is past the end of every truncated copy
+        for (size_t size = 0; size < glb.size(); size++) {
+            GLBChunks chunks;
+            INFO("size " << size);
+
+            CHECK_FALSE(ParseGLBContainer(glb.data(), size, chunks));
+        }
+    }
+
+    SECTION("Bad magic or version")
+    {
+        for (size_t offset : { 0U, 4U }) {
+            std::vector<uint8_t> corrupted = glb;
+            corrupted[offset] ^= 0xFFU;
+
+            GLBChunks chunks;
+            CHECK_FALSE(ParseGLBContainer(corrupted.data(), corrupted.size(), chunks));
+        }
+    }
+
+    SECTION("Chunk past the declared length")
+    {
+        for (uint32_t chunkLength : { static_cast<uint32_t>(glb.size()), 0x7FFFFFFFU, 0xFFFFFFFFU }) {
+            std::vector<uint8_t> corrupted = glb;
+            std::memcpy(corrupted.data() + 12, &chunkLength, sizeof(chunkLength));
+            INFO("chunk length " << chunkLength);
+
+            GLBChunks chunks;
+            CHECK_FALSE(ParseGLBContainer(corrupted.data(), corrupted.size(), chunks));
+        }
+    }
+
+    SECTION("No JSON chunk")
+    {
+        std::vector<uint8_t> corrupted = glb;
+        corrupted[16] = 'X';
+
+        GLBChunks chunks;
+        CHECK_FALSE(ParseGLBContainer(corrupted.data(), corrupted.size(), chunks));
+    }
+}
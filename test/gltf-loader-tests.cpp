@@ -0,0 +1,189 @@
+#include <catch.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "animation/animation.hpp"
+#include "animation/skinning.hpp"
+#include "helpers/base64.hpp"
+#include "helpers/derived-data-cache.hpp"
+#include "loaders/gltf-loader.hpp"
+#include "model/model.hpp"
+#include "test-helpers.hpp"
+
+using namespace DadEngine;
+
+namespace
+{
+    std::vector<Mesh> Load(const TemporaryDirectory &_directory, std::string_view _name, std::string_view _content)
+    {
+        // Nothing of the broken assets must outlive the test
+        DerivedDataCache::Get().SetEnabled(false);
+
+        std::filesystem::path path = _directory.WriteFile(_name, _content);
+
+        return LoadGLTF(path);
+    }
+
+    size_t CountPrimitives(const std::vector<Mesh> &_meshes)
+    {
+        size_t count = 0U;
+        for (const Mesh &mesh : _meshes) {
+            count += mesh.m_primitives.size();
+        }
+
+        return count;
+    }
+
+    // Attributes that cannot be read are left zeroed, but no index may
+    // point past the vertices
+    bool IndicesInRange(const std::vector<Mesh> &_meshes)
+    {
+        for (const Mesh &mesh : _meshes) {
+            for (const Primitive &primitive : mesh.m_primitives) {
+                for (uint32_t index : primitive.indices.indices) {
+                    if (index >= primitive.vertices.vertices.size()) {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // Binary glTF of the triangle with its buffer moved to the BIN chunk
+    std::string MakeTriangleGLB()
+    {
+        constexpr std::string_view PAYLOAD = "AAAAAAAAAAAAAAAAAACAPwAAAAAAAAAAAAAAAAAAgD8AAAAAAAAAAAEAAAACAAAA";
+
+        std::string json = ReplaceFirst(TRIANGLE_GLTF, ", \"uri\": \"data:application/octet-stream;base64,", "");
+        json             = ReplaceFirst(json, std::string(PAYLOAD) + "\"", "");
+        json.resize((json.size() + 3U) & ~size_t { 3U }, ' ');
+
+        std::string bin(GetBase64DecodedSize(PAYLOAD), '\0');
+        DecodeBase64(PAYLOAD, reinterpret_cast<uint8_t *>(bin.data()));
+
+        auto appendUint32 = [](std::string &_bytes, uint32_t _value) {
+            _bytes.append(reinterpret_cast<const char *>(&_value), sizeof(_value));
+        };
+
+        std::string glb;
+        appendUint32(glb, 0x46546C67U); // "glTF"
+        appendUint32(glb, 2U);
+        appendUint32(glb, static_cast<uint32_t>(12U + 8U + json.size() + 8U + bin.size()));
+        appendUint32(glb, static_cast<uint32_t>(json.size()));
+        appendUint32(glb, 0x4E4F534AU);
+        glb += json;
+        appendUint32(glb, static_cast<uint32_t>(bin.size()));
+        appendUint32(glb, 0x004E4942U);
+        glb += bin;
+
+        return glb;
+    }
+} // namespace
+
+TEST_CASE("The loader reads an embedded triangle", "[gltf]")
+{
+    TemporaryDirectory directory;
+    std::vector<Mesh> meshes = Load(directory, "triangle.gltf", TRIANGLE_GLTF);
+
+    REQUIRE(meshes.size() == 1U);
+    REQUIRE(meshes[0].m_primitives.size() == 1U);
+
+    const Primitive &primitive = meshes[0].m_primitives[0];
+    CHECK(primitive.vertices.vertexCount == 3U);
+    CHECK(primitive.indices.indexCount == 3U);
+    CHECK(primitive.bounds.m_min.x == 0.f);
+    CHECK(primitive.bounds.m_max.x == 1.f);
+    CHECK(primitive.bounds.m_max.y == 1.f);
+}
+
+TEST_CASE("The loader reads a binary glTF", "[gltf]")
+{
+    TemporaryDirectory directory;
+    std::string glb = MakeTriangleGLB();
+
+    std::vector<Mesh> meshes = Load(directory, "triangle.glb", glb);
+    REQUIRE(CountPrimitives(meshes) == 1U);
+    CHECK(meshes[0].m_primitives[0].indices.indexCount == 3U);
+
+    // Cut inside the BIN chunk, then inside the JSON one
+    for (size_t size : { glb.size() - 4U, size_t { 40U }, size_t { 8U } }) {
+        INFO("size " << size);
+
+        CHECK(Load(directory, "truncated.glb", std::string_view(glb).substr(0, size)).empty());
+    }
+}
+
+TEST_CASE("The loader fails on unreadable documents", "[gltf]")
+{
+    TemporaryDirectory directory;
+
+    CHECK(Load(directory, "empty.gltf", "").empty());
+    CHECK(Load(directory, "truncated.gltf", std::string_view(TRIANGLE_GLTF).substr(0, 100U)).empty());
+    CHECK(Load(directory, "fraction.gltf", ReplaceFirst(TRIANGLE_GLTF, "\"count\": 3", "\"count\": 1.5")).empty());
+
+    std::filesystem::path missing = directory.GetPath() / "missing.gltf";
+    CHECK(LoadGLTF(missing).empty());
+}
+
+TEST_CASE("The loader drops the geometry indexing past its vertices", "[gltf]")
+{
+    TemporaryDirectory directory;
+
+    // The indices of the triangle are 0, 1 and 2, written as "AAAAAAEAAAACAAAA"
+    std::vector<Mesh> meshes
+        = Load(directory, "index.gltf", ReplaceFirst(TRIANGLE_GLTF, "AAAAAAEAAAACAAAA", "AAAAAAEAAAD/////"));
+
+    REQUIRE(CountPrimitives(meshes) == 1U);
+    CHECK(meshes[0].m_primitives[0].vertices.vertexCount == 0U);
+    CHECK(meshes[0].m_primitives[0].indices.indexCount == 0U);
+}
+
+TEST_CASE("The loader does not read out of the buffers", "[gltf]")
+{
+    TemporaryDirectory directory;
+
+    const std::pair<std::string_view, std::string> cases[] = {
+        { "view offset", ReplaceFirst(TRIANGLE_GLTF, "\"byteOffset\": 0,", "\"byteOffset\": 4000000000,") },
+        { "view length", ReplaceFirst(TRIANGLE_GLTF, "\"byteLength\": 36", "\"byteLength\": 3600") },
+        { "accessor count", ReplaceFirst(TRIANGLE_GLTF, "\"count\": 3", "\"count\": 3000") },
+        { "accessor offset", ReplaceFirst(TRIANGLE_GLTF, "\"count\": 3", "\"count\": 3, \"byteOffset\": 30") },
+        { "index view", ReplaceFirst(TRIANGLE_GLTF, "\"byteOffset\": 36", "\"byteOffset\": 40") },
+        { "accessor reference", ReplaceFirst(TRIANGLE_GLTF, "\"POSITION\": 0", "\"POSITION\": 9") },
+        { "buffer reference", ReplaceFirst(TRIANGLE_GLTF, "\"buffer\": 0", "\"buffer\": 3") },
+        { "buffer length", ReplaceFirst(TRIANGLE_GLTF, "\"byteLength\": 48", "\"byteLength\": 4800") },
+        { "external buffer", ReplaceFirst(TRIANGLE_GLTF, "data:application/octet-stream;base64,", "missing.bin#") },
+    };
+
+    for (const auto &[name, json] : cases) {
+        INFO(name);
+
+        std::vector<Mesh> meshes = Load(directory, "broken.gltf", json);
+
+        CHECK(CountPrimitives(meshes) == 1U);
+        CHECK(IndicesInRange(meshes));
+    }
+}
+
+TEST_CASE("The loader ignores broken references to optional records", "[gltf]")
+{
+    TemporaryDirectory directory;
+
+    std::string json = ReplaceFirst(TRIANGLE_GLTF, "\"indices\": 1", "\"indices\": 1, \"material\": 5");
+    json             = ReplaceFirst(json, "{\"mesh\": 0}", "{\"mesh\": 0, \"skin\": 4, \"children\": [7]}");
+    json             = ReplaceFirst(json, "\"nodes\": [{",
+                                    "\"animations\": [{\"channels\": [{\"sampler\": 0, \"target\": {\"node\": 0, "
+                                                "\"path\": \"translation\"}}], \"samplers\": [{\"input\": 11, "
+                                                "\"output\": 12}]}], \"nodes\": [{");
+
+    std::vector<AnimationClip> animations;
+    std::vector<Skin> skins;
+    std::filesystem::path path = directory.WriteFile("references.gltf", json);
+    std::vector<Mesh> meshes   = LoadGLTF(path, nullptr, {}, nullptr, &animations, &skins);
+
+    REQUIRE(CountPrimitives(meshes) == 1U);
+    CHECK(meshes[0].m_primitives[0].material.id == ~0U);
+}
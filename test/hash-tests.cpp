@@ -0,0 +1,40 @@
+#include <catch.hpp>
+
+#include <vector>
+
+#include "helpers/hash.hpp"
+
+using namespace DadEngine;
+
+TEST_CASE("XXH3 matches the reference implementation", "[hash]")
+{
+    // Values of the reference xxh3_64 for data[i] = i * 131 + 7, at the
+    // boundaries between its length classes
+    constexpr std::pair<size_t, uint64_t> REFERENCES[] = {
+        { 0U, 0x2D06800538D394C2ULL },      { 1U, 0x4C5CCA45D0F4811FULL },    { 3U, 0x6E3E2670E61106ACULL },
+        { 4U, 0x5C4C63133443D03FULL },      { 8U, 0xF9FD4DD0B04D78F5ULL },    { 9U, 0x7C20DF9712C26EDFULL },
+        { 16U, 0x86ABF6BACCEA0858ULL },     { 17U, 0xB58BF5DC5022D071ULL },   { 128U, 0x10D17F72C0CCBA41ULL },
+        { 129U, 0x1648BDC3DB49D1A2ULL },    { 240U, 0xB6CFAF343FAB81E6ULL },  { 241U, 0x956CAE592C67279EULL },
+        { 1024U, 0x70BD377D9574F4BBULL },   { 4109U, 0x951D4110FA1DE975ULL }, { 100000U, 0x14CE8D6FC2C4868BULL },
+    };
+
+    std::vector<uint8_t> data(100000U);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>(i * 131U + 7U);
+    }
+
+    for (auto [size, hash] : REFERENCES) {
+        INFO("size " << size);
+
+        CHECK(HashXXH3(data.data(), size) == hash);
+    }
+}
+
+TEST_CASE("Combined hashes depend on their order", "[hash]")
+{
+    uint64_t a = HashXXH3("a", 1U);
+    uint64_t b = HashXXH3("b", 1U);
+
+    CHECK(CombineHashes({ a, b }) != CombineHashes({ b, a }));
+    CHECK(CombineHashes({ a, b }) == CombineHashes({ a, b }));
+}
@@ -0,0 +1,147 @@
+#include <catch.hpp>
+
+#include <vector>
+
+#include "culling/masked-occlusion.hpp"
+#include "helpers/thread-pool.hpp"
+#include "model/model.hpp"
+
+using namespace DadEngine;
+
+namespace
+{
+    // With the identity transform positions are already in clip space, x
+    // and y span the screen from -1 to 1 and z the depth from -1 to 1
+    struct OcclusionFixture
+    {
+        OcclusionFixture()
+            : culling(128U, 64U)
+        {
+            culling.Clear();
+            culling.SetTransform(Matrix4x4());
+        }
+
+        // Quad at depth _z, counter clockwise unless _flipped
+        void RenderQuad(float _minX, float _minY, float _maxX, float _maxY, float _z, bool _flipped = false,
+                        ThreadPool *_pool = nullptr)
+        {
+            const Vector3 positions[] = { Vector3(_minX, _minY, _z), Vector3(_maxX, _minY, _z),
+                                          Vector3(_maxX, _maxY, _z), Vector3(_minX, _maxY, _z) };
+            const uint32_t counterClockwise[] = { 0U, 1U, 2U, 0U, 2U, 3U };
+            const uint32_t clockwise[]        = { 0U, 2U, 1U, 0U, 3U, 2U };
+
+            culling.RenderTriangles(positions, _flipped ? clockwise : counterClockwise, 2U, _pool);
+        }
+
+        bool IsVisible(Vector3 _min, Vector3 _max) const
+        {
+            return culling.TestAABB(AABB(_min, _max));
+        }
+
+        MaskedOcclusionCulling culling;
+    };
+
+    Vertex MakeVertex(float _x, float _y, float _z)
+    {
+        Vertex vertex {};
+        vertex.position = Vector3(_x, _y, _z);
+
+        return vertex;
+    }
+
+    // Corners of a box drawn as points, only their bounds matter to culling
+    // and points are never occluders
+    Primitive MakeBoxPrimitive(Vector3 _min, Vector3 _max)
+    {
+        std::vector<Vertex> vertices;
+        for (uint32_t corner = 0; corner < 8U; corner++) {
+            vertices.push_back(MakeVertex(corner & 1U ? _max.x : _min.x, corner & 2U ? _max.y : _min.y,
+                                          corner & 4U ? _max.z : _min.z));
+        }
+
+        return Primitive(VertexBuffer(std::move(vertices)), IndexBuffer(), 0U, PBRMaterial());
+    }
+} // namespace
+
+TEST_CASE("An empty depth buffer hides nothing on screen", "[culling]")
+{
+    OcclusionFixture fixture;
+
+    CHECK(fixture.IsVisible(Vector3(-0.2f, -0.2f, 0.3f), Vector3(0.2f, 0.2f, 0.5f)));
+    CHECK(fixture.IsVisible(Vector3(-0.2f, -0.2f, 0.9f), Vector3(0.2f, 0.2f, 0.95f)));
+
+    // Outside each side of the screen
+    CHECK_FALSE(fixture.IsVisible(Vector3(1.5f, -0.2f, 0.3f), Vector3(2.f, 0.2f, 0.5f)));
+    CHECK_FALSE(fixture.IsVisible(Vector3(-2.f, -0.2f, 0.3f), Vector3(-1.5f, 0.2f, 0.5f)));
+    CHECK_FALSE(fixture.IsVisible(Vector3(-0.2f, 2.f, 0.3f), Vector3(0.2f, 3.f, 0.5f)));
+    CHECK_FALSE(fixture.IsVisible(Vector3(-0.2f, -3.f, 0.3f), Vector3(0.2f, -2.f, 0.5f)));
+}
+
+TEST_CASE("An occluder hides the boxes entirely behind it", "[culling]")
+{
+    for (bool flipped : { false, true }) {
+        OcclusionFixture fixture;
+        fixture.RenderQuad(-0.5f, -0.5f, 0.5f, 0.5f, 0.f, flipped);
+        INFO("flipped " << flipped);
+
+        // Behind
+        CHECK_FALSE(fixture.IsVisible(Vector3(-0.2f, -0.2f, 0.3f), Vector3(0.2f, 0.2f, 0.5f)));
+
+        // In front, straddling the occluder depth, or wider than it
+        CHECK(fixture.IsVisible(Vector3(-0.2f, -0.2f, -0.5f), Vector3(0.2f, 0.2f, -0.3f)));
+        CHECK(fixture.IsVisible(Vector3(-0.2f, -0.2f, -0.1f), Vector3(0.2f, 0.2f, 0.1f)));
+        CHECK(fixture.IsVisible(Vector3(-0.2f, -0.2f, 0.3f), Vector3(0.8f, 0.2f, 0.5f)));
+    }
+}
+
+TEST_CASE("An occluder only hides its side of the screen", "[culling]")
+{
+    OcclusionFixture fixture;
+    fixture.RenderQuad(-1.f, -1.f, 0.f, 1.f, 0.f);
+
+    CHECK_FALSE(fixture.IsVisible(Vector3(-0.8f, -0.5f, 0.3f), Vector3(-0.2f, 0.5f, 0.5f)));
+    CHECK(fixture.IsVisible(Vector3(0.2f, -0.5f, 0.3f), Vector3(0.8f, 0.5f, 0.5f)));
+    CHECK(fixture.IsVisible(Vector3(-0.2f, -0.5f, 0.3f), Vector3(0.2f, 0.5f, 0.5f)));
+}
+
+TEST_CASE("Occluders rasterized on the thread pool hide the same boxes", "[culling]")
+{
+    OcclusionFixture fixture;
+    fixture.RenderQuad(-0.5f, -0.5f, 0.5f, 0.5f, 0.f, false, &ThreadPool::Get());
+
+    CHECK_FALSE(fixture.IsVisible(Vector3(-0.2f, -0.2f, 0.3f), Vector3(0.2f, 0.2f, 0.5f)));
+    CHECK(fixture.IsVisible(Vector3(-0.2f, -0.2f, -0.5f), Vector3(0.2f, 0.2f, -0.3f)));
+}
+
+TEST_CASE("Primitives behind the occluders of a mesh are culled", "[culling]")
+{
+    Mesh mesh;
+
+    // Large wall, then a box behind it, one in front and one beside it
+    std::vector<Vertex> wall = { MakeVertex(-0.5f, -0.5f, 0.f), MakeVertex(0.5f, -0.5f, 0.f),
+                                 MakeVertex(0.5f, 0.5f, 0.f),   MakeVertex(-0.5f, 0.5f, 0.f) };
+    mesh.m_primitives.emplace_back(VertexBuffer(std::move(wall)),
+                                   IndexBuffer(std::vector<uint32_t> { 0U, 1U, 2U, 0U, 2U, 3U }), 4U,
+                                   PBRMaterial());
+    mesh.m_primitives.push_back(MakeBoxPrimitive(Vector3(-0.2f, -0.2f, 0.3f), Vector3(0.2f, 0.2f, 0.5f)));
+    mesh.m_primitives.push_back(MakeBoxPrimitive(Vector3(-0.2f, -0.2f, -0.5f), Vector3(0.2f, 0.2f, -0.3f)));
+    mesh.m_primitives.push_back(MakeBoxPrimitive(Vector3(0.6f, -0.2f, 0.3f), Vector3(0.8f, 0.2f, 0.5f)));
+
+    // Tiny sliver, too small to be kept as an occluder
+    std::vector<Vertex> sliver = { MakeVertex(0.f, 0.f, -0.9f), MakeVertex(1e-4f, 0.f, -0.9f),
+                                   MakeVertex(0.f, 1e-4f, -0.9f) };
+    mesh.m_primitives.emplace_back(VertexBuffer(std::move(sliver)), IndexBuffer(), 4U, PBRMaterial());
+
+    // Only the two triangles of the wall are kept
+    OccluderMesh occluders = BuildOccluderMesh(mesh);
+    REQUIRE(occluders.indices.size() == 6U);
+    for (const Vector3 &position : occluders.positions) {
+        CHECK(position.z == 0.f);
+    }
+
+    OcclusionFixture fixture;
+    RenderOccluders(fixture.culling, occluders);
+
+    std::vector<uint32_t> visible = CullPrimitives(mesh, fixture.culling);
+    CHECK(visible == std::vector<uint32_t> { 0U, 2U, 3U, 4U });
+}
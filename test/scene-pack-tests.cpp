@@ -0,0 +1,154 @@
+#include <catch.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "cooker/scene-cooker.hpp"
+#include "helpers/derived-data-cache.hpp"
+#include "loaders/scene-pack.hpp"
+#include "model/model.hpp"
+#include "test-helpers.hpp"
+
+using namespace DadEngine;
+
+namespace
+{
+    // Pack cooked from the triangle, with its bytes for the tests to break
+    struct CookedTriangle
+    {
+        CookedTriangle()
+        {
+            DerivedDataCache::Get().SetEnabled(false);
+
+            std::filesystem::path source = directory.WriteFile("triangle.gltf", TRIANGLE_GLTF);
+            path                         = directory.GetPath() / "triangle.dpak";
+
+            REQUIRE(CookScene(source, path));
+            bytes = ReadBytes(path);
+            REQUIRE(bytes.size() >= sizeof(ScenePackHeader));
+            std::memcpy(&header, bytes.data(), sizeof(header));
+        }
+
+        std::vector<Mesh> Load(const std::vector<uint8_t> &_bytes) const
+        {
+            return LoadCookedScene(directory.WriteFile("broken.dpak", _bytes.data(), _bytes.size()));
+        }
+
+        // Copy of the pack with the value at _offset overwritten
+        template <typename T>
+        std::vector<uint8_t> Patch(uint64_t _offset, T _value) const
+        {
+            std::vector<uint8_t> patched = bytes;
+            std::memcpy(patched.data() + _offset, &_value, sizeof(_value));
+
+            return patched;
+        }
+
+        TemporaryDirectory directory;
+        std::filesystem::path path;
+        std::vector<uint8_t> bytes;
+        ScenePackHeader header;
+    };
+
+    size_t CountPrimitives(const std::vector<Mesh> &_meshes)
+    {
+        size_t count = 0U;
+        for (const Mesh &mesh : _meshes) {
+            count += mesh.m_primitives.size();
+        }
+
+        return count;
+    }
+} // namespace
+
+TEST_CASE("A cooked scene loads back", "[pack]")
+{
+    CookedTriangle pack;
+
+    CHECK(pack.header.magic == SCENE_PACK_MAGIC);
+    CHECK(pack.header.version == SCENE_PACK_VERSION);
+    CHECK(pack.header.vertexSize == sizeof(Vertex));
+
+    std::vector<Mesh> meshes = LoadCookedScene(pack.path);
+    REQUIRE(meshes.size() == 1U);
+    REQUIRE(meshes[0].m_primitives.size() == 1U);
+    CHECK(meshes[0].m_primitives[0].vertices.vertexCount == 3U);
+    CHECK(meshes[0].m_primitives[0].indices.indexCount == 3U);
+}
+
+TEST_CASE("Packs with another layout are rejected", "[pack]")
+{
+    CookedTriangle pack;
+
+    CHECK(pack.Load(pack.Patch(offsetof(ScenePackHeader, magic), 0x46546C67U)).empty());
+    CHECK(pack.Load(pack.Patch(offsetof(ScenePackHeader, version), SCENE_PACK_VERSION - 1U)).empty());
+    CHECK(pack.Load(pack.Patch(offsetof(ScenePackHeader, vertexSize), pack.header.vertexSize + 4U)).empty());
+    CHECK(LoadCookedScene(pack.directory.GetPath() / "missing.dpak").empty());
+}
+
+TEST_CASE("Truncated packs are rejected", "[pack]")
+{
+    CookedTriangle pack;
+
+    // Any cut loses at least the last blob, the tables or the header
+    for (size_t size : { size_t { 0U }, sizeof(ScenePackHeader) - 1U, sizeof(ScenePackHeader),
+                         pack.bytes.size() / 2U, pack.bytes.size() - 1U }) {
+        std::vector<uint8_t> truncated(pack.bytes.begin(), pack.bytes.begin() + static_cast<ptrdiff_t>(size));
+        INFO("size " << size);
+
+        CHECK(CountPrimitives(pack.Load(truncated)) == 0U);
+    }
+}
+
+TEST_CASE("Tables past the end of the pack are rejected", "[pack]")
+{
+    CookedTriangle pack;
+
+    for (uint64_t offset : { uint64_t { pack.bytes.size() }, ~uint64_t { 0U }, ~uint64_t { 0U } - 7U }) {
+        INFO("offset " << offset);
+
+        CHECK(pack.Load(pack.Patch(offsetof(ScenePackHeader, meshesOffset), offset)).empty());
+        CHECK(pack.Load(pack.Patch(offsetof(ScenePackHeader, primitivesOffset), offset)).empty());
+        CHECK(pack.Load(pack.Patch(offsetof(ScenePackHeader, nodesOffset), offset)).empty());
+    }
+
+    CHECK(pack.Load(pack.Patch(offsetof(ScenePackHeader, primitiveCount), 0x10000000U)).empty());
+}
+
+TEST_CASE("Primitives reading out of the pack are skipped", "[pack]")
+{
+    CookedTriangle pack;
+
+    const uint64_t primitive = pack.header.primitivesOffset;
+    const uint64_t mesh      = pack.header.meshesOffset;
+
+    PackedPrimitive packedPrimitive;
+    std::memcpy(&packedPrimitive, pack.bytes.data() + primitive, sizeof(packedPrimitive));
+
+    SECTION("Index past the vertices")
+    {
+        uint64_t lastIndex = packedPrimitive.indicesOffset + 2U * sizeof(uint32_t);
+
+        CHECK(CountPrimitives(pack.Load(pack.Patch(lastIndex, 3U))) == 0U);
+        CHECK(CountPrimitives(pack.Load(pack.Patch(lastIndex, ~0U))) == 0U);
+    }
+
+    SECTION("Blobs past the end")
+    {
+        uint64_t size = pack.bytes.size();
+
+        CHECK(CountPrimitives(pack.Load(pack.Patch(primitive + offsetof(PackedPrimitive, verticesOffset), size)))
+              == 0U);
+        CHECK(CountPrimitives(pack.Load(pack.Patch(primitive + offsetof(PackedPrimitive, indicesOffset), size)))
+              == 0U);
+        CHECK(CountPrimitives(pack.Load(pack.Patch(primitive + offsetof(PackedPrimitive, vertexCount), ~0U))) == 0U);
+        CHECK(CountPrimitives(pack.Load(pack.Patch(primitive + offsetof(PackedPrimitive, indexCount), ~0U))) == 0U);
+    }
+
+    SECTION("Primitive range past the table")
+    {
+        CHECK(CountPrimitives(pack.Load(pack.Patch(mesh + offsetof(PackedMesh, firstPrimitive), 1U))) == 0U);
+        CHECK(CountPrimitives(pack.Load(pack.Patch(mesh + offsetof(PackedMesh, primitiveCount), ~0U))) == 0U);
+    }
+}
@@ -0,0 +1,62 @@
+#include "test-helpers.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+namespace DadEngine
+{
+    const std::string TRIANGLE_GLTF =
+        R"({"asset": {"version": "2.0"}, "scene": 0, "scenes": [{"nodes": [0]}], "nodes": [{"mesh": 0}],)"
+        R"("meshes": [{"primitives": [{"attributes": {"POSITION": 0}, "indices": 1}]}],)"
+        R"("accessors": [{"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3"},)"
+        R"({"bufferView": 1, "componentType": 5125, "count": 3, "type": "SCALAR"}],)"
+        R"("bufferViews": [{"buffer": 0, "byteOffset": 0, "byteLength": 36},)"
+        R"({"buffer": 0, "byteOffset": 36, "byteLength": 12}],)"
+        R"("buffers": [{"byteLength": 48, "uri": "data:application/octet-stream;base64,)"
+        R"(AAAAAAAAAAAAAAAAAACAPwAAAAAAAAAAAAAAAAAAgD8AAAAAAAAAAAEAAAACAAAA"}]})";
+
+    std::string ReplaceFirst(std::string _text, std::string_view _from, std::string_view _to)
+    {
+        size_t position = _text.find(_from);
+        if (position != std::string::npos) {
+            _text.replace(position, _from.size(), _to);
+        }
+
+        return _text;
+    }
+
+    TemporaryDirectory::TemporaryDirectory()
+    {
+        static std::atomic<uint32_t> counter { 0U };
+
+        m_path = std::filesystem::temp_directory_path()
+                 / ("dadengine-tests-" + std::to_string(counter++) + "-" + std::to_string(std::random_device {}()));
+        std::filesystem::remove_all(m_path);
+        std::filesystem::create_directories(m_path);
+    }
+
+    TemporaryDirectory::~TemporaryDirectory()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(m_path, error);
+    }
+
+    std::filesystem::path TemporaryDirectory::WriteFile(std::string_view _name, const void *_data, size_t _size) const
+    {
+        std::filesystem::path path = m_path / _name;
+
+        std::ofstream file(path, std::ios::binary);
+        file.write(static_cast<const char *>(_data), static_cast<std::streamsize>(_size));
+
+        return path;
+    }
+
+    std::vector<uint8_t> ReadBytes(const std::filesystem::path &_path)
+    {
+        std::ifstream file(_path, std::ios::binary);
+
+        return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    }
+} // namespace DadEngine
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace DadEngine
+{
+    // Triangle with its buffer embedded as a data URI, the tests break a
+    // copy of it
+    extern const std::string TRIANGLE_GLTF;
+
+    // Copy of _text with the first _from replaced by _to
+    std::string ReplaceFirst(std::string _text, std::string_view _from, std::string_view _to);
+
+    // Empty directory of the test, removed with its files by the destructor
+    class TemporaryDirectory
+    {
+        public:
+        TemporaryDirectory();
+
+        ~TemporaryDirectory();
+
+        TemporaryDirectory(const TemporaryDirectory &) = delete;
+
+        TemporaryDirectory &operator=(const TemporaryDirectory &) = delete;
+
+        std::filesystem::path WriteFile(std::string_view _name, const void *_data, size_t _size) const;
+
+        std::filesystem::path WriteFile(std::string_view _name, std::string_view _text) const
+        {
+            return WriteFile(_name, _text.data(), _text.size());
+        }
+
+        const std::filesystem::path &GetPath() const
+        {
+            return m_path;
+        }
+
+        private:
+        std::filesystem::path m_path;
+    };
+
+    std::vector<uint8_t> ReadBytes(const std::filesystem::path &_path);
+} // namespace DadEngine